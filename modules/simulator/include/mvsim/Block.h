@@ -108,6 +108,13 @@ class Block : public VisualObject, public Simulable
 	bool isStatic() const;
 	void setIsStatic(bool b);
 
+	/** With the world option `<sleeping_enabled>`, whether Box2D has put this
+	 * block to sleep, or it is static. Sleeping blocks keep their former
+	 * obstacle fixtures in occupancy grids and voxel maps. Box2D wakes them up
+	 * when an awake body touches them or their island, or when a force is
+	 * applied; an external pose change wakes them up too. */
+	bool isSleeping() const;
+
 	const mrpt::img::TColor block_color() const { return block_color_; }
 	void block_color(const mrpt::img::TColor& c)
 	{
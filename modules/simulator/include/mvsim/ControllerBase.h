@@ -51,6 +51,13 @@ class ControllerBaseInterface
 	{
 		return false; /* default: no */
 	}
+
+	/** Returns the current twist setpoint of controllers that accept
+	 * setTwistCommand(), or nullopt for other controllers. */
+	virtual std::optional<mrpt::math::TTwist2D> getTwistCommand() const
+	{
+		return std::nullopt; /* default: no */
+	}
 };
 
 /** Virtual base for controllers of vehicles of any type (template) */
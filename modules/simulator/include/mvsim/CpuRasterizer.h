@@ -0,0 +1,133 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/img/CImage.h>
+#include <mrpt/img/TCamera.h>
+#include <mrpt/img/TColor.h>
+#include <mrpt/math/CMatrixDynamic.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace mvsim
+{
+/** Software renderer of depth and flat-shaded RGB images from the triangles
+ * of a COpenGLScene, as an alternative to mrpt::opengl::CFBORender that needs
+ * no GPU, OpenGL nor EGL.
+ *
+ * The image is split into square tiles, rasterized in parallel. The result
+ * does not depend on the number of threads. Only triangle-based geometry is
+ * rendered (points and lines are ignored) and textures are replaced by the
+ * vertex colors.
+ *
+ * Usage: call updateScene() once per frame, then render_depth() and/or
+ * render_RGB() for each camera.
+ */
+class CpuRasterizer
+{
+   public:
+	/** \param numThreads Number of rendering threads (0: one per CPU core) */
+	explicit CpuRasterizer(unsigned int numThreads = 0);
+	~CpuRasterizer();
+
+	/** Collects the visible objects of the main viewport and their current
+	 * poses. Their triangles are read and cached the first time each object
+	 * is seen, so changes in the geometry of an existing object are not
+	 * reflected later on (only changes in their poses).
+	 */
+	void updateScene(mrpt::opengl::COpenGLScene& scene);
+
+	/** Renders a depth image (distance along +Z, in meters, 0 meaning "no
+	 * return") with the camera at `cameraPose`, using the same axis
+	 * convention as mrpt::opengl::CCamera in 6DOF mode (+Z forward, +X
+	 * right, +Y down).
+	 */
+	void render_depth(
+		const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+		float clipMin, float clipMax, mrpt::math::CMatrixFloat& outDepth);
+
+	/** Renders a flat-shaded RGB image, see render_depth() */
+	void render_RGB(
+		const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+		float clipMin, float clipMax, mrpt::img::CImage& outRGB);
+
+	/** Number of triangles of the last updateScene() */
+	size_t triangleCount() const { return numTriangles_; }
+
+	static constexpr int TILE_SIZE = 32;
+
+   private:
+	struct Triangle
+	{
+		mrpt::math::TPoint3Df v[3];
+		mrpt::img::TColor color;
+	};
+
+	struct CachedObject
+	{
+		std::weak_ptr<mrpt::opengl::CRenderizable> obj;
+		std::vector<Triangle> tris;	 //!< In the object local frame
+		uint64_t lastSeenFrame = 0;
+	};
+
+	/** One object to render, with its pose in the world */
+	struct Instance
+	{
+		const std::vector<Triangle>* tris = nullptr;
+		mrpt::poses::CPose3D pose;
+		mrpt::math::TPoint3Df scale;
+	};
+
+	/** A triangle projected onto the image, ready to be rasterized */
+	struct ScreenTriangle
+	{
+		float x[3], y[3], invZ[3];
+		int32_t minX, maxX, minY, maxY;	 //!< Bounding box, in pixels
+		mrpt::img::TColor color;
+	};
+
+	std::map<const mrpt::opengl::CRenderizable*, CachedObject> cache_;
+	std::vector<Instance> instances_;
+	size_t numTriangles_ = 0;
+	uint64_t frame_ = 0;
+	mrpt::img::TColor background_{0x00, 0x00, 0x00};
+
+	unsigned int numThreads_ = 1;
+	std::unique_ptr<mrpt::WorkerThreadsPool> pool_;
+
+	// Buffers reused between calls, to avoid memory allocations:
+	std::vector<std::vector<ScreenTriangle>> screenTrisPerThread_;
+	std::vector<std::vector<const ScreenTriangle*>> tileBins_;
+	std::vector<float> invZBuffer_;
+	std::vector<const ScreenTriangle*> triBuffer_;
+
+	void collectObject(
+		const mrpt::opengl::CRenderizable::Ptr& obj, const mrpt::poses::CPose3D& parentPose);
+
+	const std::vector<Triangle>& cachedTriangles(const mrpt::opengl::CRenderizable::Ptr& obj);
+
+	/** Fills invZBuffer_ and triBuffer_, one entry per pixel */
+	void rasterize(
+		const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+		float clipMin, float clipMax, bool withColor);
+
+	/** Runs func(i) for i in [0,n), splitting the range among threads */
+	void parallelFor(size_t n, const std::function<void(size_t)>& func);
+};
+
+}  // namespace mvsim
@@ -11,18 +11,32 @@
 
 #include <mrpt/system/COutputLogger.h>
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace mvsim
 {
 /**
  * Keeps a local directory with cached archives and packages from remote
  * servers.
- * The cache directory is `$HOME/.cache/mvsim-storage/` in non-Windows systems.
+ * The cache directory is `$HOME/.cache/mvsim-storage/` in non-Windows systems,
+ * or the one in the environment variable `MVSIM_STORAGE_DIR`, if defined.
  *
  * See resolve_path() for the possible formats of URI addresses.
  *
+ * Downloads are done in-process (with libcurl, if available at build time)
+ * and can run in parallel, see prefetch(). Cache entries are written to
+ * temporary files and then renamed, and come with the MD5 hash of their
+ * contents, verified before using them. Lock files next to each entry
+ * protect them against concurrent launches of the simulator.
+ *
+ * All methods are thread-safe.
  */
 class RemoteResourcesManager : public mrpt::system::COutputLogger
 {
@@ -36,13 +50,35 @@ class RemoteResourcesManager : public mrpt::system::COutputLogger
 	 *  Possible formats for `uri`:
 	 *  - `/plain/path/to/file`: Then this returns the same string.
 	 *  - `file://<ACTUAL_LOCAL_PATH>`: This returns the local path.
+	 *  - `file://<ACTUAL_LOCAL_PATH>/package.zip/file.dae`: Extracts the file
+	 *     from a local ZIP package, into the cache directory.
 	 *  - `https://server.org/path/file.dae`: It downloads the file and returns
 	 *     a local path to it.
 	 *  - `https://server.org/path/package.zip/file.dae`: Downloads the ZIP
-	 * package, extracts
+	 *     package, extracts the directory of `file.dae` (with its textures,
+	 *     etc.) and returns the local path to `file.dae`.
 	 */
 	std::string resolve_path(const std::string& uri);
 
+	/** Downloads in parallel all the remote files and packages in the list
+	 * of URIs that are not in the cache yet, so later calls to
+	 * resolve_path() find them there. Errors are only logged as warnings,
+	 * since they will be reported again by resolve_path().
+	 */
+	void prefetch(const std::vector<std::string>& uris);
+
+	/** Returns all the remote URIs of 3D models (`<model_uri>` tags)
+	 * literally found in an XML text, e.g. for prefetch().
+	 * If `basePath` (the directory of the XML file) is given, the files in
+	 * `<include file="..."/>` tags are scanned too, recursively, unless
+	 * their paths contain variables. */
+	static std::vector<std::string> find_remote_uris(
+		const std::string& xmlText, const std::string& basePath = {});
+
+	/** Downloads a file from an http(s):// or file:// URL into the cache
+	 * directory, if it is not already there, and returns its local path. */
+	std::string fetch_to_cache(const std::string& url);
+
 	/** Returns true if the URI starts with "http[s]://"
 	 */
 	static bool is_remote(const std::string& uri);
@@ -54,13 +90,33 @@ class RemoteResourcesManager : public mrpt::system::COutputLogger
 
 	static std::string cache_directory();
 
+	/** Extracts one file from a ZIP package into memory. Only "stored" and
+	 * "deflate" members are supported. The CRC32 of the contents is checked.
+	 * \exception std::exception On any error, or if the member is not found.
+	 */
+	static std::vector<uint8_t> zip_read_member(
+		const std::string& zipFile, const std::string& memberName);
+
+	/** Lists the names of all members in a ZIP package */
+	static std::vector<std::string> zip_list_members(const std::string& zipFile);
+
    private:
 	std::string handle_remote_uri(const std::string& uri);
 
-	/// Returns the local file that internalURI refers to, possibly
-	/// decompressing the ZIP package first if it is the first time.
+	/// Returns the local file that internalURI refers to, extracting it
+	/// (and the rest of files in its directory) from the ZIP package first
+	/// if it is the first time.
 	std::string handle_local_zip_package(
-		const std::string& localZipFil, const std::string& internalURI);
+		const std::string& localZipFil, const std::string& internalURI,
+		const std::string& zipOutDir);
+
+	/// In-process locks, one per cache entry (local file path):
+	std::mutex entriesMtx_;
+	std::map<std::string, std::shared_ptr<std::mutex>> entryLocks_;
+	/// Cache files already verified against their MD5 by this process:
+	std::set<std::string> verifiedEntries_;
+
+	std::shared_ptr<std::mutex> entry_lock(const std::string& localPath);
 };
 
 }  // namespace mvsim
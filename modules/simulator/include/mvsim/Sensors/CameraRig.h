@@ -0,0 +1,112 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <mrpt/obs/CObservationImage.h>
+#include <mrpt/opengl/CFBORender.h>
+#include <mvsim/CpuRasterizer.h>
+#include <mvsim/Sensors/ObservationPool.h>
+#include <mvsim/Sensors/SensorBase.h>
+
+#include <mutex>
+#include <vector>
+
+namespace mvsim
+{
+/** A group of RGB cameras on board a vehicle (e.g. a stereo pair, or
+ * surround cameras), all rendered at once.
+ *
+ * Each `<camera name="...">` child defines one view, with the same
+ * parameters as CameraSensor, and its pose relative to the rig. Each view
+ * generates its own mrpt::obs::CObservationImage, labeled with the camera
+ * name.
+ *
+ * All views are laid out side by side as viewports of a single off-screen
+ * render target, sharing the objects of the world scene, so the whole rig
+ * takes one render pass instead of one per camera. With the CPU rasterizer,
+ * the scene is collected once and shared by all views.
+ */
+class CameraRig : public SensorBase
+{
+	DECLARES_REGISTER_SENSOR(CameraRig)
+
+   public:
+	CameraRig(Simulable& parent, const rapidxml::xml_node<char>* root);
+	virtual ~CameraRig();
+
+	// See docs in base class
+	virtual void loadConfigFrom(const rapidxml::xml_node<char>* root) override;
+
+	virtual void simul_pre_timestep(const TSimulContext& context) override;
+	virtual void simul_post_timestep(const TSimulContext& context) override;
+
+	void simulateOn3DScene(mrpt::opengl::COpenGLScene& gl_scene) override;
+
+	void freeOpenGLResources() override;
+
+   protected:
+	virtual void internalGuiUpdate(
+		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
+		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& physical, bool childrenOnly) override;
+
+	void notifySimulableSetPose(const mrpt::math::TPose3D& newPose) override;
+
+	mrpt::math::TPose3D getRelativePose() const override { return rigPose_.asTPose(); }
+	void setRelativePose(const mrpt::math::TPose3D& p) override
+	{
+		rigPose_ = mrpt::poses::CPose3D(p);
+	}
+
+	/** Pose of the rig on the vehicle. Views are given relative to it. */
+	mrpt::poses::CPose3D rigPose_;
+
+	struct View
+	{
+		/** Pattern observation, with the camera name, intrinsics, and
+		 * its pose on the vehicle (rigPose_ + the view pose) */
+		mrpt::obs::CObservationImage params;
+		mrpt::poses::CPose3D poseOnRig;
+		float clipMin = 1e-2, clipMax = 1e+4;
+
+		/** Position of this view in the render target, in pixels */
+		uint32_t atlasX = 0;
+
+		ObservationPool<mrpt::obs::CObservationImage> obsPool;
+	};
+	std::vector<View> views_;
+
+	std::mutex last_obs_cs_;
+	/** Last simulated images, one per view */
+	std::vector<mrpt::obs::CObservationImage::Ptr> last_obs_;
+	bool gui_uptodate_ = false;
+
+	/** Render target with all views side by side, and the scene with one
+	 * viewport per view, whose main viewport shares the world objects */
+	std::shared_ptr<mrpt::opengl::CFBORender> fbo_renderer_;
+	mrpt::opengl::COpenGLScene::Ptr rigScene_;
+	mrpt::img::CImage atlas_;
+	uint32_t atlasWidth_ = 0, atlasHeight_ = 0;
+
+	bool use_cpu_rasterizer_ = false;
+	unsigned int cpu_rasterizer_threads_ = 0;
+	std::unique_ptr<CpuRasterizer> cpu_rasterizer_;
+
+	std::optional<TSimulContext> has_to_render_;
+	std::mutex has_to_render_mtx_;
+
+	mrpt::opengl::CSetOfObjects::Ptr gl_sensor_origin_, gl_sensor_origin_corner_;
+	mrpt::opengl::CSetOfObjects::Ptr gl_sensor_fov_, gl_sensor_frustums_;
+
+	void internal_render_with_fbo(
+		mrpt::opengl::COpenGLScene& world3DScene,
+		const std::vector<mrpt::obs::CObservationImage::Ptr>& obs,
+		const std::vector<mrpt::poses::CPose3D>& globalPoses);
+};
+}  // namespace mvsim
@@ -11,6 +11,8 @@
 
 #include <mrpt/obs/CObservationImage.h>
 #include <mrpt/opengl/CFBORender.h>
+#include <mvsim/CpuRasterizer.h>
+#include <mvsim/Sensors/ObservationPool.h>
 #include <mvsim/Sensors/SensorBase.h>
 
 #include <mutex>
@@ -18,6 +20,9 @@
 namespace mvsim
 {
 /** A "RGB" camera sensor on board a vehicle.
+ *
+ * With `<cpu_rasterizer>true</cpu_rasterizer>`, images are rendered on the
+ * CPU (see CpuRasterizer) instead of OpenGL.
  */
 class CameraSensor : public SensorBase
 {
@@ -54,6 +59,9 @@ class CameraSensor : public SensorBase
 	// "pattern" to fill it with actual scan data.
 	mrpt::obs::CObservationImage sensor_params_;
 
+	/** Recycled observation objects, see ObservationPool */
+	ObservationPool<mrpt::obs::CObservationImage> obsPool_;
+
 	std::mutex last_obs_cs_;
 	/** Last simulated scan */
 	mrpt::obs::CObservationImage::Ptr last_obs_;
@@ -61,6 +69,15 @@ class CameraSensor : public SensorBase
 
 	std::shared_ptr<mrpt::opengl::CFBORender> fbo_renderer_rgb_;
 
+	/** If enabled, images are rendered by CpuRasterizer instead of OpenGL */
+	bool use_cpu_rasterizer_ = false;
+	unsigned int cpu_rasterizer_threads_ = 0;
+	std::unique_ptr<CpuRasterizer> cpu_rasterizer_;
+
+	void internal_render_with_fbo(
+		mrpt::opengl::COpenGLScene& world3DScene, mrpt::obs::CObservationImage& curObs,
+		const mrpt::poses::CPose3D& rgbSensorPose);
+
 	/** Whether gl_* have to be updated upon next call of
 	 * internalGuiUpdate() from last_scan2gui_ */
 	bool gui_uptodate_ = false;
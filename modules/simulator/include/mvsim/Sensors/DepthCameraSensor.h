@@ -12,6 +12,8 @@
 #include <mrpt/obs/CObservation3DRangeScan.h>
 #include <mrpt/opengl/CFBORender.h>
 #include <mrpt/opengl/CPointCloudColoured.h>
+#include <mvsim/CpuRasterizer.h>
+#include <mvsim/Sensors/ObservationPool.h>
 #include <mvsim/Sensors/SensorBase.h>
 
 #include <mutex>
@@ -29,6 +31,9 @@ namespace mvsim
  * to optionally disable the simulation of either the RGB or Depth part of
  * the outcoming mrpt::obs::CObservation3DRangeScan observations.
  *
+ * With `<cpu_rasterizer>true</cpu_rasterizer>`, images are rendered on the
+ * CPU (see CpuRasterizer) instead of OpenGL.
+ *
  */
 class DepthCameraSensor : public SensorBase
 {
@@ -68,6 +73,9 @@ class DepthCameraSensor : public SensorBase
 	// "pattern" to fill it with actual scan data.
 	mrpt::obs::CObservation3DRangeScan sensor_params_;
 
+	/** Recycled observation objects, see ObservationPool */
+	ObservationPool<mrpt::obs::CObservation3DRangeScan> obsPool_;
+
 	std::mutex last_obs_cs_;
 	/** Last simulated scan */
 	mrpt::obs::CObservation3DRangeScan::Ptr last_obs_;
@@ -76,6 +84,11 @@ class DepthCameraSensor : public SensorBase
 	// Note: we need 2 to support different resolutions for RGB vs Depth.
 	std::shared_ptr<mrpt::opengl::CFBORender> fbo_renderer_rgb_, fbo_renderer_depth_;
 
+	/** If enabled, images are rendered by CpuRasterizer instead of OpenGL */
+	bool use_cpu_rasterizer_ = false;
+	unsigned int cpu_rasterizer_threads_ = 0;
+	std::unique_ptr<CpuRasterizer> cpu_rasterizer_;
+
 	/** Whether gl_scan_ has to be updated upon next call of
 	 * internalGuiUpdate() from last_scan2gui_ */
 	bool gui_uptodate_ = false;
@@ -91,6 +104,13 @@ class DepthCameraSensor : public SensorBase
 	bool sense_depth_ = true;  //!< Simulate the DEPTH sensor part
 	bool sense_rgb_ = true;	 //!< Simulate the RGB sensor part
 
+	/** Optional regions of interest, as "x0 y0 width height" in pixels of
+	 * the full image, and decimation factors of the depth and RGB images.
+	 * Both are applied to the camera models on load, so only the pixels
+	 * actually published are ever rendered. */
+	TImageROI depth_roi_, rgb_roi_;
+	unsigned int depth_decimation_ = 1, rgb_decimation_ = 1;
+
 	float depth_noise_sigma_ = 1e-3;
 	bool show_3d_pointcloud_ = false;
 
@@ -98,5 +118,20 @@ class DepthCameraSensor : public SensorBase
 	mrpt::opengl::CSetOfObjects::Ptr gl_sensor_fov_, gl_sensor_frustum_;
 
 	mrpt::math::CMatrixFloat depthImage_;  // to avoid memory allocs
+
+	/** If enabled, observations also carry the 3D points (points3D_*
+	 * fields), unprojected by the sensor from the depth image. */
+	bool emit_points_ = false;
+
+	static constexpr size_t NOISE_SEQ_LEN = 7823;  // prime
+	std::vector<int32_t> noiseSeq_;
+	size_t noiseIdx_ = 0;
+
+	/** Unprojection factors, per column (Y) and per row (Z) */
+	std::vector<float> rayLUT_y_, rayLUT_z_;
+
+	/** depthImage_ -> obs.rangeImage with clamping and noise, plus the 3D
+	 * points if emit_points_ is enabled, in a single pass. */
+	void internal_convert_depth_image(mrpt::obs::CObservation3DRangeScan& obs);
 };
 }  // namespace mvsim
@@ -12,6 +12,7 @@
 #include <mrpt/obs/CObservationIMU.h>
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/random.h>
+#include <mvsim/Sensors/ObservationPool.h>
 #include <mvsim/Sensors/SensorBase.h>
 
 #include <mutex>
@@ -60,6 +61,9 @@ class IMU : public SensorBase
 	// "pattern" to fill it with actual data.
 	mrpt::obs::CObservationIMU obs_model_;
 
+	/** Recycled observation objects, see ObservationPool */
+	ObservationPool<mrpt::obs::CObservationIMU> obsPool_;
+
 	std::mutex last_obs_cs_;
 
 	/** Last simulated obs */
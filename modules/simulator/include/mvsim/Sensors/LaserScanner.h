@@ -13,6 +13,8 @@
 #include <mrpt/opengl/CFBORender.h>
 #include <mrpt/opengl/CPlanarLaserScan.h>
 #include <mrpt/poses/CPose2D.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mvsim/Sensors/ObservationPool.h>
 #include <mvsim/Sensors/SensorBase.h>
 
 #include <mutex>
@@ -46,6 +48,10 @@ class LaserScanner : public SensorBase
 
 	void registerOnServer(mvsim::Client& c) override;
 
+	/** Scan parameters (number of rays, aperture, maximum range...), with
+	 * no actual range data */
+	const mrpt::obs::CObservation2DRangeScan& getScanModel() const { return scan_model_; }
+
    protected:
 	virtual void internalGuiUpdate(
 		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
@@ -90,6 +96,17 @@ class LaserScanner : public SensorBase
 	// "pattern" to fill it with actual scan data.
 	mrpt::obs::CObservation2DRangeScan scan_model_;
 
+	/** Recycled observation objects, see ObservationPool */
+	ObservationPool<mrpt::obs::CObservation2DRangeScan> obsPool_;
+
+	/** Temporary per-world-element scans, see internal_simulate_lidar_2d_mode() */
+	std::vector<mrpt::obs::CObservation2DRangeScan> partialScans_;
+
+	/** Noise source of internal_simulate_lidar_2d_mode(). Seeded from the
+	 * global MRPT generator when loading, so `randomize(seed)` in the world
+	 * file makes the noise repeatable no matter the thread that simulates it. */
+	mrpt::random::CRandomGenerator rng_;
+
 	std::mutex last_scan_cs_;
 	/** Last simulated scan */
 	mrpt::obs::CObservation2DRangeScan::Ptr last_scan_;
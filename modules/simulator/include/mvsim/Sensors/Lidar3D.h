@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <mrpt/img/TCamera.h>
 #include <mrpt/obs/CObservationPointCloud.h>
 #include <mrpt/obs/CObservationRotatingScan.h>
 #include <mrpt/opengl/CFBORender.h>
@@ -75,6 +76,14 @@ class Lidar3D : public SensorBase
 	std::string vertical_ray_angles_str_;
 
 	int vertNumRays_ = 16, horzNumRays_ = 180;
+
+	/** Keep only one out of N horizontal rays / vertical rings (1=all).
+	 * Skipped rays are not rendered at all, and the FBO is smaller. */
+	int horzDecimation_ = 1, vertDecimation_ = 1;
+
+	/** Azimuth sector to simulate, counterclockwise from min to max, in
+	 * degrees. Sub-scans out of it are not rendered. Default: 360 degrees. */
+	double azimuthMin_ = -180.0, azimuthMax_ = 180.0;
 	double horzResolutionFactor_ = 1.0;
 	double vertResolutionFactor_ = 1.0;
 	float maxDepthInterpolationStepVert_ = 0.30f;
@@ -97,6 +106,17 @@ class Lidar3D : public SensorBase
 
 	std::shared_ptr<mrpt::opengl::CFBORender> fbo_renderer_depth_;
 
+	/** Computes the rings, the depth camera model of the sub-scan renders,
+	 * the LUT and the azimuth sector flags from the current parameters.
+	 * Called from loadConfigFrom(). */
+	void computeScanGeometry();
+
+	/// Pinhole model of the depth images rendered for each sub-scan
+	mrpt::img::TCamera fboCamModel_;
+
+	/// Azimuth of the center of each sub-scan render [rad]
+	std::vector<double> renderMidAngles_;
+
 	struct PerRayLUT
 	{
 		float u = 0, v = 0;	 //!< Pixel coords
@@ -109,8 +129,15 @@ class Lidar3D : public SensorBase
 
 	std::vector<PerHorzAngleLUT> lut_;
 
-	/// Upon initialization, vertical_rays_str_ is parsed in this vector of
-	/// angles in radians.
+	/// Upon initialization, vertical_ray_angles_str_ is parsed in this vector
+	/// of angles in radians. Only rings kept after vertical decimation.
 	std::vector<double> vertical_ray_angles_;
+
+	/// Original ring index of each entry in vertical_ray_angles_
+	std::vector<uint16_t> ringIds_;
+
+	/// Whether each horizontal ray (index in the whole scan) and each
+	/// sub-scan render lie within the azimuth sector.
+	std::vector<uint8_t> rayInSector_, renderInSector_;
 };
 }  // namespace mvsim
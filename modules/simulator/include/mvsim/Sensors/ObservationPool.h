@@ -0,0 +1,106 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mvsim
+{
+/**
+ * @brief A per-sensor pool of observation objects, to avoid one heap
+ * allocation (plus those of its internal buffers) per simulated reading.
+ *
+ * get() hands out observations as regular `OBS::Ptr` smart pointers. Once
+ * the last copy of one of them is released (by the GUI, the rawlog writer,
+ * a ROS publisher, etc., from any thread) the object returns to the pool,
+ * instead of being deleted, keeping its buffers allocated for the next
+ * reading. The pool can be safely destroyed while some of its observations
+ * are still in use; those will be just deleted when released.
+ *
+ * Recycled observations keep the contents of their former reading: callers
+ * must overwrite them, typically by assigning a "pattern" observation.
+ */
+template <class OBS>
+class ObservationPool
+{
+   public:
+	using obs_ptr_t = std::shared_ptr<OBS>;
+
+	/** \param maxFreeObjects Maximum number of released observations kept for
+	 * reuse. Others are deleted as usual. */
+	explicit ObservationPool(size_t maxFreeObjects = 4) : shared_(std::make_shared<Shared>())
+	{
+		shared_->maxFree = maxFreeObjects;
+	}
+
+	/** Returns a recycled observation if any is available, or a newly
+	 * allocated one otherwise. */
+	obs_ptr_t get()
+	{
+		std::unique_ptr<OBS> o;
+		{
+			std::lock_guard<std::mutex> lck(shared_->mtx);
+			if (!shared_->freeObjs.empty())
+			{
+				o = std::move(shared_->freeObjs.back());
+				shared_->freeObjs.pop_back();
+			}
+		}
+		if (!o) o = std::make_unique<OBS>();
+
+		return obs_ptr_t(o.release(), Recycler{shared_});
+	}
+
+	/** Like get(), then assigns the given pattern observation to it. */
+	obs_ptr_t get(const OBS& pattern)
+	{
+		auto o = get();
+		*o = pattern;
+		return o;
+	}
+
+	/** Number of observations available for reuse right now */
+	size_t freeCount() const
+	{
+		std::lock_guard<std::mutex> lck(shared_->mtx);
+		return shared_->freeObjs.size();
+	}
+
+   private:
+	struct Shared
+	{
+		std::mutex mtx;
+		std::vector<std::unique_ptr<OBS>> freeObjs;
+		size_t maxFree = 4;
+	};
+
+	/** Custom shared_ptr deleter returning the objects to the pool */
+	struct Recycler
+	{
+		std::weak_ptr<Shared> pool;
+
+		void operator()(OBS* o) const
+		{
+			std::unique_ptr<OBS> obj(o);
+			if (auto p = pool.lock(); p)
+			{
+				std::lock_guard<std::mutex> lck(p->mtx);
+				if (p->freeObjs.size() < p->maxFree) p->freeObjs.emplace_back(std::move(obj));
+			}
+			// else: obj is deleted here.
+		}
+	};
+
+	std::shared_ptr<Shared> shared_;
+};
+
+}  // namespace mvsim
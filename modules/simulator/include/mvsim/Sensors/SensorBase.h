@@ -17,6 +17,8 @@
 #include <mvsim/VisualObject.h>
 
 #include <memory>
+#include <mutex>
+#include <optional>
 
 namespace mvsim
 {
@@ -99,6 +101,22 @@ class SensorBase : public VisualObject, public Simulable
 
 	/// Assign a sensible default name/sensor label if none is provided:
 	void make_sure_we_have_a_name(const std::string& prefix);
+
+	/** Returns the global pose of the sensor, i.e. the vehicle pose composed
+	 * with sensorPoseOnVehicle. The result is cached, and only recomputed if
+	 * the vehicle moved or a different relative pose is given, so calling this
+	 * from both the simulation and the GUI threads is cheap. */
+	mrpt::poses::CPose3D sensorGlobalPose(const mrpt::poses::CPose3D& sensorPoseOnVehicle) const;
+
+   private:
+	struct GlobalPoseCache
+	{
+		uint64_t vehiclePoseVersion = 0;
+		mrpt::poses::CPose3D sensorPoseOnVehicle;
+		mrpt::poses::CPose3D globalPose;
+	};
+	mutable std::mutex globalPoseCacheMtx_;
+	mutable std::optional<GlobalPoseCache> globalPoseCache_;
 };
 
 using TListSensors = std::vector<SensorBase::Ptr>;
@@ -13,9 +13,13 @@
 #include <mrpt/math/TPoint2D.h>
 #include <mrpt/math/TPose3D.h>
 #include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mvsim/basic_types.h>
 
+#include <mutex>
+#include <optional>
+#include <set>
 #include <shared_mutex>
 
 namespace mvsim
@@ -58,6 +62,26 @@ class Simulable
 
 	virtual VisualObject* meAsVisualObject() { return nullptr; }
 
+	/** Pose, velocity and acceleration of the object, all of them from the
+	 * same time step. \sa getKinematicState() */
+	struct KinematicState
+	{
+		/** Global pose, as in getPose() */
+		mrpt::math::TPose3D pose = mrpt::math::TPose3D::Identity();
+		/** Velocity in global coordinates, as in getTwist() */
+		mrpt::math::TTwist2D twist{0, 0, 0};
+		/** Global acceleration, as in getLinearAcceleration() */
+		mrpt::math::TVector3D linearAcceleration{0, 0, 0};
+
+		/** Velocity in local coordinates, as in getVelocityLocal() */
+		mrpt::math::TTwist2D velocityLocal() const { return twist.rotated(-pose.yaw); }
+	};
+
+	/** Gets the pose, twist and acceleration under one single lock. Prefer
+	 * it to calling several of the individual getters one after another,
+	 * since it is cheaper and the values are guaranteed to be coherent. */
+	KinematicState getKinematicState() const;
+
 	/** Last time-step velocity (of the ref. point, in local coords) */
 	mrpt::math::TTwist2D getVelocityLocal() const;
 
@@ -95,9 +119,18 @@ class Simulable
 	/// Alternative to getPose()
 	mrpt::poses::CPose2D getCPose2D() const;
 
-	/// Alternative to getPose()
+	/** Alternative to getPose(). The CPose3D (with its rotation matrix) is
+	 * cached and only rebuilt after the pose changes. */
 	mrpt::poses::CPose3D getCPose3D() const;
 
+	/** A counter incremented each time the pose of this object changes, either
+	 * by the simulation or by setPose(). Useful to cache values derived from
+	 * the pose. */
+	uint64_t getPoseVersion() const;
+
+	/** Whether the object follows a keyframe animation path (`<animation>`) */
+	bool isAnimated() const { return anim_keyframes_path_ && !anim_keyframes_path_->empty(); }
+
 	/** User-supplied name of the vehicle (e.g. "r1", "veh1") */
 	const std::string& getName() const { return name_; }
 
@@ -135,6 +168,14 @@ class Simulable
 		return std::nullopt;
 	}
 
+	/** Like getElevationAt(), but inserting into `out` all elevations of this
+	 * object at the queried (x,y), for objects with several surfaces over the
+	 * same point (e.g. the floors of a building). */
+	virtual void getElevationsAt(const mrpt::math::TPoint2Df& worldXY, std::set<float>& out) const
+	{
+		if (const auto z = getElevationAt(worldXY); z) out.insert(*z);
+	}
+
    protected:
 	/** User-supplied name of the vehicle (e.g. "r1", "veh1") */
 	std::string name_;
@@ -174,6 +215,14 @@ class Simulable
 
 	mrpt::math::TPose3D former_q_;	//!< Updated in simul_post_timestep()
 
+	/** See getPoseVersion(). Protected by q_mtx_ */
+	uint64_t poseVersion_ = 0;
+
+	/** Cache for getCPose3D(), valid if its version matches poseVersion_ */
+	mutable std::mutex cachedCPose3DMtx_;
+	mutable mrpt::poses::CPose3D cachedCPose3D_;
+	mutable std::optional<uint64_t> cachedCPose3DVersion_;
+
 	// ============ ANIMATION VARIABLES ============
 	/** Initial pose, per configuration XML world file */
 	mrpt::math::TPose3D initial_q_ = mrpt::math::TPose3D::Identity();
@@ -32,6 +32,8 @@ namespace mvsim
  *  - "%point3d" => Expects "X Y [Z]". "Val" is a pointer to
  * mrpt::math::TPoint3D
  *  - "%bool" ==> bool*. Values: 'true'/'false' or '1'/'0'
+ *  - "%roi" => Expects "X0 Y0 WIDTH HEIGHT", in pixels. "val" is a pointer
+ * to mvsim::TImageROI
  *
  * \todo Rewrite using std::variant?
  */
@@ -29,6 +29,7 @@
 #include <atomic>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <string>
 
 #include "CsvLogger.h"
@@ -86,6 +87,11 @@ class VehicleBase : public VisualObject, public Simulable
 	std::vector<mrpt::math::TVector2D> getWheelsVelocityLocal(
 		const mrpt::math::TTwist2D& veh_vel_local) const;
 
+	/// \overload Reusing the memory of the output vector
+	void getWheelsVelocityLocal(
+		const mrpt::math::TTwist2D& veh_vel_local,
+		std::vector<mrpt::math::TVector2D>& out_vels) const;
+
 	/** Gets the current estimation of odometry-based velocity as reconstructed
 	 * solely from wheels spinning velocities and geometry.
 	 * This is the input of any realistic low-level controller onboard.
@@ -124,6 +130,15 @@ class VehicleBase : public VisualObject, public Simulable
 
 	void registerOnServer(mvsim::Client& c) override;
 
+	/** Whether the vehicle has been put to sleep because it stayed at rest,
+	 * with null motor torques, for long enough (see the world option
+	 * `<sleeping_enabled>`). Sleeping vehicles skip their dynamics, terrain and
+	 * obstacle processing, but keep running their sensors. They wake up on a
+	 * contact with an awake body, a new motor command (torque, steering, or
+	 * twist setpoint), or an external pose change. Vehicles with an
+	 * `<animation>` never sleep. */
+	bool isSleeping() const { return sleeping_; }
+
 	b2Fixture* get_fixture_chassis() { return fixture_chassis_; }
 	std::vector<b2Fixture*>& get_fixture_wheels() { return fixture_wheels_; }
 	const b2Fixture* get_fixture_chassis() const { return fixture_chassis_; }
@@ -157,7 +172,10 @@ class VehicleBase : public VisualObject, public Simulable
 	 * block. */
 	virtual void dynamics_load_params_from_xml(const rapidxml::xml_node<char>* xml_node) = 0;
 
-	virtual std::vector<double> invoke_motor_controllers(const TSimulContext& context) = 0;
+	/** Runs the controller and returns the motor torque for each wheel.
+	 * out_torque_per_wheel is given with getNumWheels() zeros. */
+	virtual void invoke_motor_controllers(
+		const TSimulContext& context, std::vector<double>& out_torque_per_wheel) = 0;
 
 	virtual void invoke_motor_controllers_post_step([[maybe_unused]] const TSimulContext& context)
 	{
@@ -205,6 +223,9 @@ class VehicleBase : public VisualObject, public Simulable
 	 * constructor. */
 	std::vector<b2Fixture*> fixture_wheels_;
 
+	/** Wheel yaw the shape of each fixture_wheels_ was last built for */
+	std::vector<double> fixture_wheels_yaw_;
+
    private:
 	// Called from internalGuiUpdate()
 	void internal_internalGuiUpdate_sensors(
@@ -223,6 +244,24 @@ class VehicleBase : public VisualObject, public Simulable
 	std::vector<mrpt::math::TSegment3D> torqueSegmentsForRendering_;
 	std::mutex forceSegmentsForRenderingMtx_;
 
+	// Sleeping state, see isSleeping(). Only accessed from the simulation
+	// thread.
+	bool sleeping_ = false;
+	double timeAtRest_ = 0;	 //!< [s]
+	bool lastMotorTorquesNull_ = true;
+	mrpt::math::TPose3D sleepingPose_;
+	std::optional<mrpt::math::TTwist2D> sleepingTwistCommand_;
+
+	// Per-step buffers of simul_pre_timestep(), kept to reuse their memory:
+	std::vector<double> wheelTorque_;
+	std::vector<mrpt::math::TVector2D> wheelLocalVels_;
+	std::vector<mrpt::math::TSegment3D> forceVectors_, torqueVectors_;
+	std::vector<std::shared_ptr<CSVLogger>> wheelLoggers_;
+
+	bool internal_must_wake_up(const std::vector<double>& wheelTorque);
+	void internal_update_sleeping_state(const TSimulContext& context);
+	void internal_wake_up();
+
    public:	// data logger header entries
 	static constexpr char DL_TIMESTAMP[] = "timestamp";
 	static constexpr char LOGGER_POSE[] = "logger_pose";
@@ -115,6 +115,11 @@ class DynamicsAckermannDrivetrain : public VehicleBase
 			return true;
 		}
 
+		std::optional<mrpt::math::TTwist2D> getTwistCommand() const override
+		{
+			return mrpt::math::TTwist2D(setpoint_lin_speed, 0, setpoint_ang_speed);
+		}
+
 	   private:
 		double dist_fWheels_, r2f_L_;
 		PID_Controller PID_;
@@ -172,7 +177,8 @@ class DynamicsAckermannDrivetrain : public VehicleBase
 	// See base class docs
 	virtual void dynamics_load_params_from_xml(const rapidxml::xml_node<char>* xml_node) override;
 	// See base class doc
-	virtual std::vector<double> invoke_motor_controllers(const TSimulContext& context) override;
+	virtual void invoke_motor_controllers(
+		const TSimulContext& context, std::vector<double>& out_torque_per_wheel) override;
 
    private:
 	ControllerBase::Ptr controller_;  //!< The installed controller
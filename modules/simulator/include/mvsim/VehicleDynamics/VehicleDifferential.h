@@ -139,6 +139,8 @@ class DynamicsDifferential : public VehicleBase
 			return t;
 		}
 
+		std::optional<mrpt::math::TTwist2D> getTwistCommand() const override { return setpoint(); }
+
 	   private:
 		double distWheels_ = 0;
 		std::array<PID_Controller, 2> PIDs_;
@@ -183,6 +185,8 @@ class DynamicsDifferential : public VehicleBase
 			return t;
 		}
 
+		std::optional<mrpt::math::TTwist2D> getTwistCommand() const override { return setpoint(); }
+
 	   private:
 		double distWheels_ = 0;
 		mrpt::math::TTwist2D setpoint_{0, 0, 0};  //!< "vx" and "omega" only
@@ -204,7 +208,8 @@ class DynamicsDifferential : public VehicleBase
 	// See base class docs
 	virtual void dynamics_load_params_from_xml(const rapidxml::xml_node<char>* xml_node) override;
 	// See base class docs
-	virtual std::vector<double> invoke_motor_controllers(const TSimulContext& context) override;
+	virtual void invoke_motor_controllers(
+		const TSimulContext& context, std::vector<double>& out_torque_per_wheel) override;
 	virtual void invoke_motor_controllers_post_step(const TSimulContext& context) override;
 
 	/// Defined at ctor time:
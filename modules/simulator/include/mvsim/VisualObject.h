@@ -37,6 +37,9 @@ class VisualObject
 	/** This creates a new object in the scene and/or update it according to the
 	 * current state of the object. If none of the scenes are passed, the poses
 	 * of existing visual objects are updated, but no new ones are created.
+	 *
+	 * \note Must be called from the GUI (or headless rendering) thread only,
+	 * never from the physics thread. See World::internalUpdate3DSceneObjects()
 	 */
 	virtual void guiUpdate(
 		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
@@ -11,6 +11,7 @@
 
 #include <box2d/b2_body.h>
 #include <box2d/b2_world.h>
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/core/bits_math.h>
 #include <mrpt/core/format.h>
 #include <mrpt/gui/CDisplayWindowGUI.h>
@@ -33,10 +34,12 @@
 #include <mvsim/VehicleBase.h>
 #include <mvsim/WorldElements/WorldElementBase.h>
 
+#include <condition_variable>
 #include <functional>
 #include <list>
 #include <map>
 #include <set>
+#include <shared_mutex>
 #include <unordered_map>
 
 #if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
@@ -51,6 +54,7 @@ class SrvSetControllerTwist;
 class SrvSetControllerTwistAnswer;
 class SrvShutdown;
 class SrvShutdownAnswer;
+class PartitionState;
 }  // namespace mvsim_msgs
 #endif
 
@@ -262,6 +266,9 @@ class World : public mrpt::system::COutputLogger
 	std::atomic_bool lastKeyEventValid_ = false;
 	std::mutex lastKeyEventMtx_;
 
+	/// See sensor_has_to_create_egl_context()
+	std::atomic_bool eglContextCreated_ = false;
+
 	bool is_GUI_open() const;  //!< Return true if the GUI window is open, after
 							   //! a previous call to update_GUI()
 
@@ -318,6 +325,36 @@ class World : public mrpt::system::COutputLogger
 	 */
 	std::string xmlPathToActualPath(const std::string& modelURI) const;
 
+	/** Time spent on one external resource while loading the world */
+	struct ResourceLoadStats
+	{
+		/** "include", "fetch", "model", "elevation_map", "gridmap", etc. */
+		std::string kind;
+		/** The URI or file, as given in the XML file */
+		std::string uri;
+		double elapsed = 0;	 //!< [s]
+	};
+
+	/** Returns the external resources (included files, downloads, 3D models,
+	 * maps...) processed by load_from_XML(), in loading order, with the time
+	 * spent on each one.
+	 */
+	std::vector<ResourceLoadStats> resource_load_stats() const
+	{
+		std::lock_guard<std::mutex> lck(resourceLoadStatsMtx_);
+		return resourceLoadStats_;
+	}
+
+	/** Used by world elements to report the time spent loading a resource.
+	 * \sa resource_load_stats()
+	 */
+	void register_resource_load(
+		const std::string& kind, const std::string& uri, double elapsed) const
+	{
+		std::lock_guard<std::mutex> lck(resourceLoadStatsMtx_);
+		resourceLoadStats_.push_back({kind, uri, elapsed});
+	}
+
 	/** @} */
 
 	/** \name Visitors API
@@ -361,6 +398,9 @@ class World : public mrpt::system::COutputLogger
 	mvsim::Client& commsClient() { return client_; }
 	const mvsim::Client& commsClient() const { return client_; }
 
+	/** Frees the 3D scenes of this world. Resources shared by all worlds
+	 * in the process (the 3D models cache) are only freed if this is the
+	 * last World alive. */
 	void free_opengl_resources();
 
 	auto& physical_objects_mtx() { return worldPhysicalMtx_; }
@@ -368,6 +408,9 @@ class World : public mrpt::system::COutputLogger
 	bool headless() const { return guiOptions_.headless; }
 	void headless(bool setHeadless) { guiOptions_.headless = setHeadless; }
 
+	/** In headless mode, returns true only for the first sensor of this
+	 * world asking for it, which creates the EGL context the rest reuse.
+	 * Thread-safe. */
 	bool sensor_has_to_create_egl_context();
 
 	const std::map<std::string, std::string>& user_defined_variables() const
@@ -404,6 +447,9 @@ class World : public mrpt::system::COutputLogger
 
 	mvsim::Client client_{"World"};
 
+	/// Frees the OpenGL resources shared by all worlds, if this is the last one
+	void internal_free_shared_opengl_resources();
+
 	std::vector<on_observation_callback_t> callbacksOnObservation_;
 
 	// -------- World Params ----------
@@ -426,6 +472,17 @@ class World : public mrpt::system::COutputLogger
 	/** Distance between two body edges to be considered a collision. */
 	float collisionThreshold_ = 0.03f;
 
+	/** Number of threads for the per-vehicle computations of each time step
+	 * that are independent from the rest of vehicles (e.g. terrain
+	 * elevation). 1 (default) means no parallelization, 0 means one thread
+	 * per CPU core. */
+	int simulThreads_ = 1;
+	std::unique_ptr<mrpt::WorkerThreadsPool> simulWorkerPool_;
+
+	/** Runs func(i) for all i in [0,n), split among simulThreads_ threads.
+	 *  func() must be safe to run in parallel for different indices. */
+	void internal_parallel_for(size_t n, const std::function<void(size_t)>& func);
+
 	std::string serverAddress_ = "localhost";
 
 	/** If non-empty, all observations will be saved to a .rawlog */
@@ -442,6 +499,13 @@ class World : public mrpt::system::COutputLogger
 	double max_slope_to_collide_ = 0.30;
 	double min_slope_to_collide_ = -0.50;
 
+	/** If enabled, vehicles that stay at rest, with null motor torques, for
+	 * `sleepTime_` seconds are put to sleep. See VehicleBase::isSleeping() */
+	bool sleepingEnabled_ = false;
+	double sleepTime_ = 2.0;  //!< [s]
+	double sleepLinearSpeed_ = 0.01;  //!< [m/s]
+	double sleepAngularSpeed_ = 0.035;	//!< [rad/s]
+
 	const TParameterDefinitions otherWorldParams_ = {
 		{"server_address", {"%s", &serverAddress_}},
 		{"gravity", {"%lf", &gravity_}},
@@ -449,6 +513,7 @@ class World : public mrpt::system::COutputLogger
 		{"b2d_vel_iters", {"%i", &b2dVelIters_}},
 		{"b2d_pos_iters", {"%i", &b2dPosIters_}},
 		{"collision_threshold", {"%f", &collisionThreshold_}},
+		{"simul_threads", {"%i", &simulThreads_}},
 		{"joystick_enabled", {"%bool", &joystickEnabled_}},
 		{"save_to_rawlog", {"%s", &save_to_rawlog_}},
 		{"rawlog_odometry_rate", {"%lf", &rawlog_odometry_rate_}},
@@ -456,6 +521,10 @@ class World : public mrpt::system::COutputLogger
 		{"ground_truth_rate", {"%lf", &ground_truth_rate_}},
 		{"max_slope_to_collide", {"%lf", &max_slope_to_collide_}},
 		{"min_slope_to_collide", {"%lf", &min_slope_to_collide_}},
+		{"sleeping_enabled", {"%bool", &sleepingEnabled_}},
+		{"sleep_time", {"%lf", &sleepTime_}},
+		{"sleep_linear_speed", {"%lf", &sleepLinearSpeed_}},
+		{"sleep_angular_speed", {"%lf", &sleepAngularSpeed_}},
 	};
 
 	/** User-defined variables as defined via `<variable name='' value='' />`
@@ -494,6 +563,9 @@ class World : public mrpt::system::COutputLogger
 		float clip_plane_max = 10e3f;
 		mrpt::math::TPoint3D camera_point_to{0, 0, 0};
 		std::string follow_vehicle;	 //!< Vehicle name to follow (empty=none)
+		/** If enabled, sensor observation windows (camera images, depth, etc.)
+		 * are only updated for the selected or the followed vehicle. */
+		bool show_only_selected_vehicle_sensors = false;
 		bool headless = false;
 
 		const TParameterDefinitions params = {
@@ -505,6 +577,7 @@ class World : public mrpt::system::COutputLogger
 			{"force_scale", {"%lf", &force_scale}},
 			{"fov_deg", {"%lf", &fov_deg}},
 			{"follow_vehicle", {"%s", &follow_vehicle}},
+			{"show_only_selected_vehicle_sensors", {"%bool", &show_only_selected_vehicle_sensors}},
 			{"start_maximized", {"%bool", &start_maximized}},
 			{"refresh_fps", {"%i", &refresh_fps}},
 			{"headless", {"%bool", &headless}},
@@ -595,10 +668,163 @@ class World : public mrpt::system::COutputLogger
 
 	const GeoreferenceOptions& georeferenceOptions() const { return georeferenceOptions_; }
 
+	/** Limits of one tile in the (experimental) distributed simulation mode */
+	struct PartitionTileLimits
+	{
+		double x_min = 0, x_max = 0, y_min = 0, y_max = 0;
+
+		/** Distance from a world (x,y) point to this tile (0 if inside) */
+		double distanceTo(double x, double y) const;
+	};
+
+	/** Options for the (experimental) distributed simulation mode, where a
+	 * large world is split into rectangular tiles, each one simulated by its
+	 * own mvsim process, kept in lockstep via the comms server.
+	 * See: https://mvsimulator.readthedocs.io/en/latest/world_partition.html
+	 */
+	struct PartitionOptions
+	{
+		PartitionOptions() = default;
+
+		void parse_from(const rapidxml::xml_node<char>& node, COutputLogger& logger);
+
+		/** Unique name of the tile simulated by this process. Empty (default)
+		 * means partitioning is disabled. */
+		std::string name;
+
+		/** Space-separated names of all the other tiles. */
+		std::string peers;
+
+		/** Limits of this tile, in world coordinates [m] */
+		PartitionTileLimits limits;
+
+		/** Vehicles owned by other tiles are kept as "ghost" (kinematic)
+		 * bodies if they are closer than this distance to this tile [m] */
+		double ghost_margin = 5.0;
+
+		/** Maximum wall-clock time to wait for the other tiles at each time
+		 * step [s] */
+		double sync_timeout = 10.0;
+
+		/** Maximum wall-clock time to wait for all the other tiles to start
+		 * up, before the first time step [s] */
+		double startup_timeout = 60.0;
+
+		const TParameterDefinitions params = {
+			{"name", {"%s", &name}},
+			{"peers", {"%s", &peers}},
+			{"x_min", {"%lf", &limits.x_min}},
+			{"x_max", {"%lf", &limits.x_max}},
+			{"y_min", {"%lf", &limits.y_min}},
+			{"y_max", {"%lf", &limits.y_max}},
+			{"ghost_margin", {"%lf", &ghost_margin}},
+			{"sync_timeout", {"%lf", &sync_timeout}},
+			{"startup_timeout", {"%lf", &startup_timeout}},
+		};
+
+		bool enabled() const { return !name.empty(); }
+	};
+
+	const PartitionOptions& partitionOptions() const { return partitionOptions_; }
+
+	/** In partitioned mode, returns true if the given object is a vehicle
+	 * simulated by another process (a "ghost"), whose state is only
+	 * mirrored here.
+	 */
+	bool isPartitionGhost(const std::string& objectName) const
+	{
+		if (!partitionConnected_) return false;
+		std::shared_lock lck(partitionGhostsMtx_);
+		return partitionGhosts_.count(objectName) != 0;
+	}
+
+	/** Whether this process must publish the topics of the given object:
+	 * always in non-partitioned mode. Otherwise, vehicles are published by
+	 * the tile simulating them, and all other objects by the first tile (by
+	 * name order) only. */
+	bool isPartitionPublisher(const std::string& objectName) const;
+
    private:
 	/** Options for lights */
 	GeoreferenceOptions georeferenceOptions_;
 
+	PartitionOptions partitionOptions_;
+
+	/** Vehicles currently simulated by other partitions. Only modified from
+	 * the simulation thread, with the list of simulable objects locked. */
+	std::set<std::string> partitionGhosts_;
+	mutable std::shared_mutex partitionGhostsMtx_;
+
+	/** Number of time steps run so far, for partition lockstep sync */
+	uint64_t partitionStepIndex_ = 0;
+
+	std::atomic_bool partitionConnected_ = false;
+
+	/** Whether this is the first tile by name, which also serves the global
+	 * (non-namespaced) services and publishes non-vehicle topics */
+	bool partitionIsPrimary_ = false;
+
+	struct PartitionObjectState
+	{
+		mrpt::math::TPose3D pose;
+		mrpt::math::TTwist2D twist;
+		std::optional<mrpt::math::TTwist2D> twistSetPoint;
+		std::vector<double> wheelPhi, wheelW, wheelYaw;
+	};
+	using partition_objects_t = std::map<std::string, PartitionObjectState>;
+
+	/** A service call to be applied by the tile simulating the object */
+	struct PartitionCommand
+	{
+		std::string objectId;
+		std::optional<mrpt::math::TPose3D> setPose;
+		std::optional<mrpt::math::TTwist2D> setControllerTwist;
+	};
+
+	struct PartitionStepData
+	{
+		partition_objects_t objects;
+		std::vector<PartitionCommand> commands;
+	};
+
+	/** All partition data below is protected by partitionMtx_ */
+	std::mutex partitionMtx_;
+	std::condition_variable partitionCV_;
+
+	/** Received states from other partitions: [peer name][step index] */
+	std::map<std::string, std::map<uint64_t, PartitionStepData>> partitionPeerStates_;
+
+	/** Limits of all tiles (this one included), by name */
+	std::map<std::string, PartitionTileLimits> partitionTiles_;
+
+	/** Peers known to receive our messages, during the startup handshake */
+	std::set<std::string> partitionPeersReady_;
+
+	/** Commands received by this process services, to be sent to all other
+	 * tiles with the next state */
+	std::vector<PartitionCommand> partitionPendingCommands_;
+
+	/** Serializes all publications to the partition topic, since they may
+	 * come from the simulation thread or from service calls */
+	std::mutex partitionPublishMtx_;
+
+	void internal_partition_connect();	// called from connectToServer()
+	void internal_partition_handshake();
+	void internal_partition_sync();	 // called at the beginning of each step
+	void internal_partition_update_ghosts();
+	void internal_partition_publish_shutdown();
+
+	/** Name of the tile that must simulate an object at (x,y): the tile
+	 * containing it or, if none does, the nearest one. */
+	const std::string& internal_partition_owner(double x, double y) const;
+
+	/** Applies a command received by any tile, if it concerns this one */
+	void internal_partition_apply_command(const PartitionCommand& cmd, bool fromPeer);
+
+	/** In partitioned mode, queues a service call for an object that this
+	 * tile does not simulate. Returns false if it must be applied here. */
+	bool internal_partition_forward(const PartitionCommand& cmd);
+
 	// -------- World contents ----------
 	/** Mutex protecting simulation objects from multi-thread access */
 	std::recursive_mutex world_cs_;
@@ -728,6 +954,20 @@ class World : public mrpt::system::COutputLogger
 	std::set<std::string> reset_collision_flags_;
 	std::mutex reset_collision_flags_mtx_;
 
+	/** Latest observation of each sensor, by (vehicle, sensorLabel), pending
+	 * to be shown in the GUI. Newer observations overwrite older ones, so the
+	 * GUI thread handles, at most, one per sensor and frame. */
+	std::map<std::pair<const Simulable*, std::string>, mrpt::obs::CObservation::Ptr>
+		guiPendingObservations_;
+	std::mutex guiPendingObservationsMtx_;
+
+	/// Called from any thread upon new observations:
+	void internal_gui_enqueue_observation(
+		const Simulable& veh, const mrpt::obs::CObservation::Ptr& obs);
+	/// Called from the GUI thread, once per frame:
+	void internal_process_pending_gui_observations();
+	bool internal_gui_is_sensor_viz_enabled(const Simulable& veh) const;
+
 	void internal_gui_on_observation(const Simulable& veh, const mrpt::obs::CObservation::Ptr& obs);
 	void internal_gui_on_observation_3Dscan(
 		const Simulable& veh, const std::shared_ptr<mrpt::obs::CObservation3DRangeScan>& obs);
@@ -793,6 +1033,7 @@ class World : public mrpt::system::COutputLogger
 	void parse_tag_gui(const XmlParserContext& ctx);
 	void parse_tag_lights(const XmlParserContext& ctx);
 	void parse_tag_georeference(const XmlParserContext& ctx);
+	void parse_tag_partition(const XmlParserContext& ctx);
 	void parse_tag_walls(const XmlParserContext& ctx);
 	void parse_tag_include(const XmlParserContext& ctx);
 	void parse_tag_variable(const XmlParserContext& ctx);
@@ -803,6 +1044,9 @@ class World : public mrpt::system::COutputLogger
 
 	mutable RemoteResourcesManager remoteResources_;
 
+	mutable std::mutex resourceLoadStatsMtx_;
+	mutable std::vector<ResourceLoadStats> resourceLoadStats_;
+
 	void internalOnObservation(const Simulable& veh, const mrpt::obs::CObservation::Ptr& obs);
 
 	void internalPostSimulStepForRawlog();
@@ -835,6 +1079,9 @@ class World : public mrpt::system::COutputLogger
 		const std::vector<float>* wheel_heights = nullptr;
 		std::vector<float> contour_heights;
 		std::vector<TFixturePtr> collide_fixtures;
+		/** Sleeping objects (and partition ghosts) keep their former
+		 * fixtures */
+		bool sleeping = false;
 	};
 	std::vector<std::optional<TInfoPerCollidableobj>> obstacles_for_each_obj_;
 	// ============ end of elevation field collision =================
@@ -849,6 +1096,8 @@ class World : public mrpt::system::COutputLogger
 	mvsim_msgs::SrvSetControllerTwistAnswer srv_set_controller_twist(
 		const mvsim_msgs::SrvSetControllerTwist& req);
 	mvsim_msgs::SrvShutdownAnswer srv_shutdown(const mvsim_msgs::SrvShutdown& req);
+
+	void internal_partition_on_peer_state(const mvsim_msgs::PartitionState& msg);
 #endif
 };
 }  // namespace mvsim
@@ -15,6 +15,7 @@
 #include <mrpt/opengl/CPointCloud.h>
 #include <mrpt/opengl/CSetOfObjects.h>
 #include <mrpt/poses/CPose2D.h>
+#include <mvsim/GridRaycaster.h>
 #include <mvsim/WorldElements/WorldElementBase.h>
 
 #include <mutex>
@@ -38,14 +39,22 @@ class OccupancyGridMap : public WorldElementBase
 	virtual void simul_pre_timestep(const TSimulContext& context) override;
 
 	const mrpt::maps::COccupancyGridMap2D& getOccGrid() const { return grid_; }
+	/** Call updateRaycaster() after modifying the grid */
 	mrpt::maps::COccupancyGridMap2D& getOccGrid() { return grid_; }
 
+	/** Ray casting over the grid, used by lidars and to find obstacles for
+	 * collisions */
+	const GridRaycaster& getRaycaster() const { return raycaster_; }
+
+	void updateRaycaster() { raycaster_.build(grid_); }
+
    protected:
 	virtual void internalGuiUpdate(
 		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
 		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& physical, bool childrenOnly) override;
 
 	mrpt::maps::COccupancyGridMap2D grid_;
+	GridRaycaster raycaster_;
 
 	bool gui_uptodate_;	 //!< Whether gl_grid_ has to be updated upon next
 						 //! call of internalGuiUpdate()
@@ -66,6 +75,9 @@ class OccupancyGridMap : public WorldElementBase
 		mrpt::obs::CObservation2DRangeScan::Ptr scan;
 		std::vector<TFixturePtr> collide_fixtures;
 		float max_obstacles_ranges = 0;
+		/** Sleeping objects keep their former fixtures, since they did not
+		 * move */
+		bool sleeping = false;
 	};
 
 	std::vector<TInfoPerCollidableobj> obstacles_for_each_obj_;
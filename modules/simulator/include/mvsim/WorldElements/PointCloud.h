@@ -14,10 +14,17 @@
 #include <mrpt/opengl/CSetOfObjects.h>
 #include <mvsim/WorldElements/WorldElementBase.h>
 
+#include <cstdint>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace mvsim
 {
+/** A static point cloud, loaded from ASCII or binary (PLY, LAS, raw float32)
+ * files. For rendering, it is split into an octree whose leaves are
+ * independent 3D objects, with a subsampled level of detail for the GUI.
+ * Optionally, it is also visible to 3D lidars and depth cameras. */
 class PointCloud : public WorldElementBase
 {
 	DECLARES_REGISTER_WORLD_ELEMENT(PointCloud)
@@ -37,6 +44,9 @@ class PointCloud : public WorldElementBase
 	const mrpt::maps::CPointsMap::Ptr& getPoints() const { return points_; }
 	mrpt::maps::CPointsMap::Ptr& getPoints() { return points_; }
 
+	/** Number of octree leaves the cloud is split into for rendering */
+	size_t octreeLeafCount() const { return octreeLeaves_.size(); }
+
    protected:
 	virtual void internalGuiUpdate(
 		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
@@ -48,9 +58,41 @@ class PointCloud : public WorldElementBase
 	/// internalGuiUpdate()
 	bool gui_uptodate_ = false;
 	mrpt::opengl::CSetOfObjects::Ptr gl_points_;
+	/// Points in the "physical" scene (seen by sensors), if they cannot be
+	/// just gl_points_ due to a different level of detail or point size.
+	mrpt::opengl::CSetOfObjects::Ptr gl_points_sensors_;
 
 	double render_points_size_ = 3.0;
+	mrpt::img::TColor render_points_color_ = {0x00, 0x00, 0xff};
 	mrpt::poses::CPose3D pointcloud_pose_ = mrpt::poses::CPose3D::Identity();
+
+	/// Keep one out of every `decimation_` points from the input file.
+	unsigned int decimation_ = 1;
+	/// Number of float32 values per point in `file_bin_xyz` files.
+	unsigned int bin_floats_per_point_ = 3;
+
+	unsigned int octree_max_points_per_leaf_ = 100000;
+	/// Maximum number of points rendered in the GUI (0=all).
+	unsigned int render_max_points_ = 5000000;
+	bool visible_to_sensors_ = true;
+	/// Maximum number of points rendered for sensors (-1=same as in the GUI,
+	/// 0=all). The GUI points are reused for sensors if both budgets and point
+	/// sizes match, instead of keeping a second copy of them.
+	int sensor_max_points_ = -1;
+	/// Point size for sensors (0=same as in the GUI).
+	double sensor_points_size_ = 0;
+
+	/// Octree leaves, as [first,last) ranges of octreeIndices_.
+	std::vector<std::pair<size_t, size_t>> octreeLeaves_;
+	std::vector<uint32_t> octreeIndices_;
+
+	void internal_build_octree();
+
+	/** Keep one out of every N points to render at most `maxPoints` (0=all) */
+	size_t internal_decimation_for(size_t maxPoints) const;
+
+	mrpt::opengl::CSetOfObjects::Ptr internal_create_gl_points(
+		size_t maxPoints, double pointSize) const;
 };
 
 }  // namespace mvsim
@@ -0,0 +1,173 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mvsim/WorldElements/WorldElementBase.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace mvsim
+{
+/** A sparse 3D voxel map of occupied space, stored as hashed blocks of 8x8x8
+ * voxels (one bit per voxel), for terrain and obstacles that cannot be
+ * described in 2.5D: multiple floors, overhangs, tunnels, etc.
+ *
+ * It provides: terrain elevations (one per floor) for vehicle wheels,
+ * Box2D collision fixtures around vehicles and blocks (as
+ * OccupancyGridMap), and CPU ray casting (3D DDA) for 2D lidars.
+ */
+class VoxelMap : public WorldElementBase
+{
+	DECLARES_REGISTER_WORLD_ELEMENT(VoxelMap)
+   public:
+	VoxelMap(World* parent, const rapidxml::xml_node<char>* root);
+	virtual ~VoxelMap();
+
+	void doLoadConfigFrom(const rapidxml::xml_node<char>* root);
+
+	virtual void loadConfigFrom(const rapidxml::xml_node<char>* root) override
+	{
+		doLoadConfigFrom(root);
+	}
+
+	virtual void simul_pre_timestep(const TSimulContext& context) override;
+
+	/** Returns the highest floor elevation at the given (x,y), if any */
+	std::optional<float> getElevationAt(const mrpt::math::TPoint2Df& worldXY) const override;
+
+	/** Returns the elevation of all floors (top faces of occupied voxels
+	 * with free space above them) at the given (x,y) */
+	void getElevationsAt(const mrpt::math::TPoint2Df& worldXY, std::set<float>& out) const override;
+
+	/** \name Voxel map API
+	 * @{ */
+
+	float resolution() const { return resolution_; }
+
+	/** Removes all voxels and changes the resolution (voxel size) */
+	void clear(float resolution);
+
+	bool isOccupied(int32_t ix, int32_t iy, int32_t iz) const;
+	bool isOccupied(const mrpt::math::TPoint3Df& pt) const
+	{
+		return isOccupied(coord2idx(pt.x), coord2idx(pt.y), coord2idx(pt.z));
+	}
+	void setOccupied(int32_t ix, int32_t iy, int32_t iz, bool occupied = true);
+
+	/** Marks as occupied all voxels containing at least one point, plus
+	 * `offset`, added in double precision (see load_points_las()) */
+	void insertPoints(
+		const mrpt::maps::CPointsMap& pts, const mrpt::math::TPoint3D& offset = {0, 0, 0});
+
+	size_t occupiedCount() const;
+
+	/** Casts a ray from `origin` along the unit vector `dir`, returning the
+	 * distance to the first occupied voxel, if any within `maxRange`. */
+	std::optional<float> raycast(
+		const mrpt::math::TPoint3Df& origin, const mrpt::math::TPoint3Df& dir,
+		float maxRange) const;
+
+	/** Saves the map to its compact binary format (see loadFromFile()) */
+	void saveToFile(const std::string& file) const;
+
+	/** Loads a map saved with saveToFile(). Throws on errors */
+	void loadFromFile(const std::string& file);
+
+	int32_t coord2idx(float x) const
+	{
+		return static_cast<int32_t>(std::floor(x / resolution_));
+	}
+	float idx2coord(int32_t i) const { return (static_cast<float>(i) + 0.5f) * resolution_; }
+
+	/** @} */
+
+   protected:
+	virtual void internalGuiUpdate(
+		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
+		const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& physical, bool childrenOnly) override;
+
+	static constexpr int BLOCK_BITS = 3;
+	static constexpr int32_t BLOCK_SIZE = 1 << BLOCK_BITS;
+	static constexpr int32_t BLOCK_MASK = BLOCK_SIZE - 1;
+
+	/** 8x8x8 voxels. Each word holds one z-layer of 8x8 bits (bit: x+8*y) */
+	struct Block
+	{
+		std::array<uint64_t, BLOCK_SIZE> layers = {};
+
+		bool get(int32_t lx, int32_t ly, int32_t lz) const
+		{
+			return (layers[lz] >> (lx | (ly << BLOCK_BITS))) & 1;
+		}
+	};
+
+	static uint64_t blockKey(int32_t bx, int32_t by, int32_t bz)
+	{
+		constexpr uint64_t m = (1ULL << 21) - 1;
+		constexpr int32_t off = 1 << 20;
+		return (static_cast<uint64_t>(bx + off) & m) |
+			   ((static_cast<uint64_t>(by + off) & m) << 21) |
+			   ((static_cast<uint64_t>(bz + off) & m) << 42);
+	}
+	static uint64_t columnKey(int32_t bx, int32_t by) { return blockKey(bx, by, 0); }
+
+	const Block* findBlock(int32_t bx, int32_t by, int32_t bz) const
+	{
+		auto it = blocks_.find(blockKey(bx, by, bz));
+		return it == blocks_.end() ? nullptr : &it->second;
+	}
+
+	float resolution_ = 0.10f;
+	std::unordered_map<uint64_t, Block> blocks_;
+	/** For each (bx,by) block column, the sorted list of its blocks "bz" */
+	std::unordered_map<uint64_t, std::vector<int32_t>> columns_;
+
+	/** Whether any voxel is occupied in the (ix,iy) column within [iz0,iz1] */
+	bool isColumnOccupied(int32_t ix, int32_t iy, int32_t iz0, int32_t iz1) const;
+
+	bool gui_uptodate_ = false;
+	mrpt::opengl::CSetOfObjects::Ptr gl_voxels_;
+
+	/** Obstacles within this height range, relative to each object, become
+	 * collision fixtures. The lower limit avoids colliding with the floor. */
+	double collision_min_height_ = 0.15;
+	double collision_max_height_ = 1.80;
+	bool show_collisions_ = false;
+	double restitution_ = 0.01;
+	double lateral_friction_ = 0.5;
+
+	struct TInfoPerCollidableobj
+	{
+		TInfoPerCollidableobj() = default;
+
+		mrpt::math::TPose3D pose;
+		b2Body* collide_body = nullptr;
+		std::vector<b2Fixture*> collide_fixtures;
+		float max_obstacles_ranges = 0;
+		bool sleeping = false;
+	};
+	std::vector<TInfoPerCollidableobj> obstacles_for_each_obj_;
+
+	std::mutex gl_obs_clouds_buffer_cs_;
+	std::vector<mrpt::opengl::CPointCloud::Ptr> gl_obs_clouds_buffer_;
+	std::vector<mrpt::opengl::CSetOfObjects::Ptr> gl_obs_clouds_;
+};
+}  // namespace mvsim
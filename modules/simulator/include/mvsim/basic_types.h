@@ -64,6 +64,14 @@ struct TSimulContext
 /// Used to signal a Box2D fixture as "invisible" to sensors.
 constexpr uintptr_t INVISIBLE_FIXTURE_USER_DATA = 1;
 
+/// A rectangular region of an image, in pixels. Empty means the whole image.
+struct TImageROI
+{
+	unsigned int x0 = 0, y0 = 0, width = 0, height = 0;
+
+	bool empty() const { return width == 0 || height == 0; }
+};
+
 struct TJoyStickEvent
 {
 	std::vector<float> axes;
@@ -0,0 +1,101 @@
+# ---------------------------------------------------------------------
+# Gym-style vectorized environment on top of the in-process simulator.
+#
+# It follows the stable-baselines3 VecEnv conventions: batched reset()
+# and step(), with episodes automatically restarted when they end.
+# ---------------------------------------------------------------------
+
+import numpy as np
+
+from . import pymvsim_simulator
+
+try:
+    from gymnasium import spaces
+except ImportError:
+    spaces = None
+
+
+class VecEnv:
+    """
+    num_envs copies of a world, stepped in parallel C++ threads with the
+    Python GIL released. One vehicle is controlled in each copy, with actions
+    given as (vx, vy, w) twist commands for its controller.
+
+    Observations are dicts of batched NumPy arrays:
+    - "ranges": (num_envs, lidar_size) float32, if a lidar is given. The
+      latest scan of each env, or NaN if it has none yet (see below).
+    - "ranges_valid": (num_envs,) bool, false for envs without any scan yet.
+      reset() simulates until the first scan arrives, so this only happens
+      if the lidar does not produce any within 10 s of simulated time.
+    - "poses": (num_envs, 3) float64, as (x, y, yaw).
+    - "twists": (num_envs, 3) float64, as (vx, vy, w) in global coordinates.
+    - "collisions": (num_envs,) bool, whether the vehicle collided since the
+      former observation.
+
+    reward_fn(obs, actions) must return the (num_envs,) rewards. By default,
+    all rewards are zero.
+    """
+
+    def __init__(self, world_file, num_envs, vehicle, lidar="", steps_per_action=1,
+                 num_threads=0, max_episode_steps=1000, reward_fn=None,
+                 terminate_on_collision=True):
+        self._env = pymvsim_simulator.VecEnv(
+            world_file, num_envs, vehicle, lidar, steps_per_action, num_threads)
+        self.num_envs = num_envs
+        self.max_episode_steps = max_episode_steps
+        self.reward_fn = reward_fn
+        self.terminate_on_collision = terminate_on_collision
+        self._episode_steps = np.zeros(num_envs, dtype=np.int64)
+
+        self.observation_space = None
+        self.action_space = None
+        if spaces is not None:
+            n = self._env.lidar_size
+            self.observation_space = spaces.Dict({
+                "ranges": spaces.Box(0.0, self._env.lidar_max_range, (n,), np.float32),
+                "poses": spaces.Box(-np.inf, np.inf, (3,), np.float64),
+                "twists": spaces.Box(-np.inf, np.inf, (3,), np.float64),
+                "collisions": spaces.MultiBinary(1),
+                "ranges_valid": spaces.MultiBinary(1),
+            })
+            self.action_space = spaces.Box(-np.inf, np.inf, (3,), np.float64)
+
+    def reset(self):
+        self._episode_steps[:] = 0
+        return self._env.reset()
+
+    def step(self, actions):
+        actions = np.asarray(actions, dtype=np.float64).reshape(self.num_envs, 3)
+        obs = self._env.step(actions)
+        self._episode_steps += 1
+
+        if self.reward_fn is not None:
+            rewards = np.asarray(self.reward_fn(obs, actions), dtype=np.float32)
+        else:
+            rewards = np.zeros(self.num_envs, dtype=np.float32)
+
+        if self.terminate_on_collision:
+            terminated = obs["collisions"].copy()
+        else:
+            terminated = np.zeros(self.num_envs, dtype=bool)
+        truncated = self._episode_steps >= self.max_episode_steps
+        dones = terminated | truncated
+
+        infos = [{} for _ in range(self.num_envs)]
+        if dones.any():
+            idxs = np.flatnonzero(dones)
+            for i in idxs:
+                infos[i]["terminal_observation"] = {k: v[i].copy() for k, v in obs.items()}
+                infos[i]["TimeLimit.truncated"] = bool(truncated[i] and not terminated[i])
+            obs = self._env.reset(idxs.tolist())
+            self._episode_steps[idxs] = 0
+
+        return obs, rewards, dones, infos
+
+    @property
+    def steps_per_second(self):
+        """Achieved environment steps per second, since construction"""
+        return self._env.env_steps_per_second
+
+    def close(self):
+        self._env.close()
@@ -0,0 +1,719 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+// In-process Python bindings for mvsim::World.
+// Unlike the comms bindings (generated with binder), these ones are written by
+// hand, since they expose a small, Python-friendly API instead of the full C++
+// one: sensor observations are returned as NumPy arrays sharing memory with
+// the MRPT observation objects, with no copies nor serialization.
+
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mrpt/obs/CObservationImage.h>
+#include <mrpt/obs/CObservationPointCloud.h>
+#include <mvsim/Sensors/LaserScanner.h>
+#include <mvsim/World.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace
+{
+/** Wraps a NumPy array around an existing buffer, keeping alive the
+ * observation that owns it for as long as the array (or any view of it)
+ * exists. Arrays are read-only, since the buffer is shared with any other
+ * consumer of the same observation (GUI, loggers, etc.) */
+template <typename T>
+py::array make_array_view(
+	const mrpt::obs::CObservation::Ptr& obs, const T* data, std::vector<py::ssize_t> shape,
+	std::vector<py::ssize_t> stridesBytes)
+{
+	py::capsule owner(
+		new mrpt::obs::CObservation::Ptr(obs),
+		[](void* p) { delete reinterpret_cast<mrpt::obs::CObservation::Ptr*>(p); });
+
+	py::array arr(
+		py::dtype::of<T>(), std::move(shape), std::move(stridesBytes),
+		static_cast<const void*>(data), owner);
+	arr.attr("flags").attr("writeable") = false;
+	return arr;
+}
+
+py::tuple pose_to_tuple(const mrpt::math::TPose3D& p)
+{
+	return py::make_tuple(p.x, p.y, p.z, p.yaw, p.pitch, p.roll);
+}
+
+mrpt::math::TPose3D pose_from_vector(const std::vector<double>& v, mrpt::math::TPose3D p)
+{
+	if (v.size() == 3)
+	{
+		p.x = v[0];
+		p.y = v[1];
+		p.yaw = v[2];
+	}
+	else if (v.size() == 6)
+	{
+		p = mrpt::math::TPose3D(v[0], v[1], v[2], v[3], v[4], v[5]);
+	}
+	else
+	{
+		THROW_EXCEPTION_FMT(
+			"Pose must be given as [x,y,yaw] or [x,y,z,yaw,pitch,roll], but got %u values",
+			static_cast<unsigned>(v.size()));
+	}
+	return p;
+}
+
+/** A simulated World, owned by Python, with a background thread running the
+ * GUI or the off-screen rendering of camera-like sensors. */
+class PyWorld
+{
+   public:
+	PyWorld() = default;
+	~PyWorld() { close(); }
+
+	void load(const std::string& xmlFile, bool headless)
+	{
+		close();
+
+		world_ = std::make_unique<mvsim::World>();
+		world_->headless(headless);
+		world_->load_from_XML_file(xmlFile);
+
+		world_->registerCallbackOnObservation(
+			[this](const mvsim::Simulable& veh, const mrpt::obs::CObservation::Ptr& obs)
+			{
+				if (!obs) return;
+				auto lck = mrpt::lockHelper(latestObsMtx_);
+				latestObs_[{veh.getName(), obs->sensorLabel}] = obs;
+			});
+
+		// Initial state, for reset():
+		{
+			auto lck = mrpt::lockHelper(world_->getListOfSimulableObjectsMtx());
+			for (const auto& [name, s] : world_->getListOfSimulableObjects())
+				if (s) initialPoses_.emplace_back(name, s->getPose());
+		}
+
+		closing_ = false;
+		guiThread_ = std::thread(&PyWorld::guiThreadMain, this);
+	}
+
+	void close()
+	{
+		if (!world_) return;
+
+		closing_ = true;
+		world_->simulator_must_close(true);
+		if (guiThread_.joinable()) guiThread_.join();
+
+		world_->free_opengl_resources();
+		world_.reset();
+
+		auto lck = mrpt::lockHelper(latestObsMtx_);
+		latestObs_.clear();
+		initialPoses_.clear();
+	}
+
+	/** Runs `n` simulation time steps. The GIL is released meanwhile, so other
+	 * Python threads (e.g. other environments) can run in parallel. */
+	double step(unsigned int n)
+	{
+		auto& w = world();
+		{
+			py::gil_scoped_release noGil;
+			run_steps(n);
+		}
+		return w.get_simul_time();
+	}
+
+	/** Like step(), to be called without holding the GIL */
+	void run_steps(unsigned int n)
+	{
+		auto& w = world();
+		w.run_simulation(n * w.get_simul_timestep());
+	}
+
+	/** Restores all vehicles and blocks to their initial poses, at rest.
+	 * Simulation time is not reset, since it drives sensor timing. */
+	void reset()
+	{
+		auto& w = world();
+
+		auto lck = mrpt::lockHelper(w.getListOfSimulableObjectsMtx());
+		for (const auto& [name, pose] : initialPoses_)
+		{
+			const auto range = w.getListOfSimulableObjects().equal_range(name);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				it->second->setPose(pose);
+				it->second->setTwist({0, 0, 0});
+			}
+		}
+		for (auto& [name, veh] : w.getListOfVehicles())
+		{
+			if (auto* c = veh->getControllerInterface(); c) c->setTwistCommand({0, 0, 0});
+		}
+		lck.unlock();
+
+		auto lckObs = mrpt::lockHelper(latestObsMtx_);
+		latestObs_.clear();
+	}
+
+	double time() { return world().get_simul_time(); }
+
+	std::vector<std::string> vehicles()
+	{
+		std::vector<std::string> names;
+		for (const auto& [name, veh] : world().getListOfVehicles()) names.push_back(name);
+		return names;
+	}
+
+	py::tuple get_pose(const std::string& name)
+	{
+		return pose_to_tuple(findSimulable(name).getPose());
+	}
+
+	void set_pose(const std::string& name, const std::vector<double>& pose)
+	{
+		auto lck = mrpt::lockHelper(world().getListOfSimulableObjectsMtx());
+		auto& s = findSimulable(name);
+		s.setPose(pose_from_vector(pose, s.getPose()));
+	}
+
+	py::tuple get_twist(const std::string& name)
+	{
+		const auto t = findSimulable(name).getTwist();
+		return py::make_tuple(t.vx, t.vy, t.omega);
+	}
+
+	void set_twist_command(const std::string& name, double vx, double vy, double w)
+	{
+		auto* c = findVehicle(name).getControllerInterface();
+		if (!c || !c->setTwistCommand({vx, vy, w}))
+		{
+			THROW_EXCEPTION_FMT(
+				"The controller of vehicle '%s' does not accept twist commands", name.c_str());
+		}
+	}
+
+	/** List of (vehicle,sensor) with at least one observation so far */
+	std::vector<std::pair<std::string, std::string>> observations()
+	{
+		auto lck = mrpt::lockHelper(latestObsMtx_);
+		std::vector<std::pair<std::string, std::string>> ret;
+		for (const auto& [key, obs] : latestObs_) ret.push_back(key);
+		return ret;
+	}
+
+	std::optional<double> observation_time(const std::string& vehicle, const std::string& sensor)
+	{
+		const auto obs = latestObservation(vehicle, sensor);
+		if (!obs) return {};
+		return mrpt::Clock::toDouble(obs->timestamp);
+	}
+
+	py::object lidar_ranges(const std::string& vehicle, const std::string& sensor)
+	{
+		const auto obs = latestObservation(vehicle, sensor);
+		auto scan = std::dynamic_pointer_cast<mrpt::obs::CObservation2DRangeScan>(obs);
+		if (!scan) return py::none();
+
+		const auto n = static_cast<py::ssize_t>(scan->getScanSize());
+		if (n == 0) return py::array_t<float>(0);
+
+		return make_array_view(obs, &scan->getScanRange(0), {n}, {sizeof(float)});
+	}
+
+	py::object point_cloud(const std::string& vehicle, const std::string& sensor)
+	{
+		const auto obs = latestObservation(vehicle, sensor);
+
+		// Depth cameras with <emit_points>:
+		if (auto o3 = std::dynamic_pointer_cast<mrpt::obs::CObservation3DRangeScan>(obs);
+			o3 && o3->hasPoints3D)
+		{
+			const auto n = static_cast<py::ssize_t>(o3->points3D_x.size());
+			if (n == 0)
+			{
+				py::array_t<float> empty(0);
+				return py::make_tuple(empty, empty, empty);
+			}
+			return py::make_tuple(
+				make_array_view(obs, o3->points3D_x.data(), {n}, {sizeof(float)}),
+				make_array_view(obs, o3->points3D_y.data(), {n}, {sizeof(float)}),
+				make_array_view(obs, o3->points3D_z.data(), {n}, {sizeof(float)}));
+		}
+
+		auto o = std::dynamic_pointer_cast<mrpt::obs::CObservationPointCloud>(obs);
+		if (!o || !o->pointcloud) return py::none();
+
+		const auto& pc = *o->pointcloud;
+		const auto n = static_cast<py::ssize_t>(pc.size());
+		if (n == 0)
+		{
+			py::array_t<float> empty(0);
+			return py::make_tuple(empty, empty, empty);
+		}
+
+		return py::make_tuple(
+			make_array_view(obs, pc.getPointsBufferRef_x().data(), {n}, {sizeof(float)}),
+			make_array_view(obs, pc.getPointsBufferRef_y().data(), {n}, {sizeof(float)}),
+			make_array_view(obs, pc.getPointsBufferRef_z().data(), {n}, {sizeof(float)}));
+	}
+
+	py::object image(const std::string& vehicle, const std::string& sensor)
+	{
+		const auto obs = latestObservation(vehicle, sensor);
+
+		const mrpt::img::CImage* img = nullptr;
+		if (auto o = std::dynamic_pointer_cast<mrpt::obs::CObservationImage>(obs); o)
+			img = &o->image;
+		else if (auto o3 = std::dynamic_pointer_cast<mrpt::obs::CObservation3DRangeScan>(obs);
+				 o3 && o3->hasIntensityImage)
+			img = &o3->intensityImage;
+
+		if (!img || img->isEmpty()) return py::none();
+
+		ASSERTMSG_(
+			img->getPixelDepth() == mrpt::img::PixelDepth::D8U,
+			"Only 8-bit images can be mapped to NumPy arrays");
+
+		const auto h = static_cast<py::ssize_t>(img->getHeight());
+		const auto w = static_cast<py::ssize_t>(img->getWidth());
+		const auto ch = static_cast<py::ssize_t>(img->channels());
+		const auto stride = static_cast<py::ssize_t>(img->getRowStride());
+
+		return make_array_view(
+			obs, img->ptrLine<uint8_t>(0), {h, w, ch}, {stride, ch, py::ssize_t(1)});
+	}
+
+	py::object depth_image(const std::string& vehicle, const std::string& sensor)
+	{
+		const auto obs = latestObservation(vehicle, sensor);
+		auto o = std::dynamic_pointer_cast<mrpt::obs::CObservation3DRangeScan>(obs);
+		if (!o || !o->hasRangeImage || o->rangeImage.size() == 0) return py::none();
+
+		const auto rows = static_cast<py::ssize_t>(o->rangeImage.rows());
+		const auto cols = static_cast<py::ssize_t>(o->rangeImage.cols());
+		constexpr auto e = static_cast<py::ssize_t>(sizeof(uint16_t));
+
+		return py::make_tuple(
+			make_array_view(obs, o->rangeImage.data(), {rows, cols}, {cols * e, e}),
+			o->rangeUnits);
+	}
+
+	mvsim::World& world()
+	{
+		if (!world_) THROW_EXCEPTION("No world loaded yet: call load() first");
+		return *world_;
+	}
+
+	mvsim::VehicleBase& findVehicle(const std::string& name)
+	{
+		auto& vehs = world().getListOfVehicles();
+		auto it = vehs.find(name);
+		if (it == vehs.end() || !it->second)
+			THROW_EXCEPTION_FMT("No vehicle named '%s'", name.c_str());
+		return *it->second;
+	}
+
+	mvsim::Simulable& findSimulable(const std::string& name)
+	{
+		auto& lst = world().getListOfSimulableObjects();
+		auto it = lst.find(name);
+		if (it == lst.end() || !it->second)
+			THROW_EXCEPTION_FMT("No simulable object named '%s'", name.c_str());
+		return *it->second;
+	}
+
+	mrpt::obs::CObservation::Ptr latestObservation(
+		const std::string& vehicle, const std::string& sensor)
+	{
+		auto lck = mrpt::lockHelper(latestObsMtx_);
+		auto it = latestObs_.find({vehicle, sensor});
+		if (it == latestObs_.end()) return {};
+		return it->second;
+	}
+
+   private:
+	std::unique_ptr<mvsim::World> world_;
+	std::thread guiThread_;
+	std::atomic_bool closing_ = false;
+
+	std::mutex latestObsMtx_;
+	std::map<std::pair<std::string, std::string>, mrpt::obs::CObservation::Ptr> latestObs_;
+	std::vector<std::pair<std::string, mrpt::math::TPose3D>> initialPoses_;
+
+	// Same than the mvsim-cli GUI and headless threads: camera-like sensors are
+	// rendered from here, and World::run_simulation() waits for them.
+	void guiThreadMain()
+	{
+		try
+		{
+			auto& w = *world_;
+			while (!closing_ && !w.simulator_must_close())
+			{
+				if (w.headless())
+				{
+					w.internalGraphicsLoopTasksForSimulation();
+					std::this_thread::sleep_for(std::chrono::microseconds(
+						mrpt::round(w.get_simul_timestep() * 1000000)));
+				}
+				else
+				{
+					w.update_GUI();
+					std::this_thread::sleep_for(std::chrono::milliseconds(25));
+				}
+			}
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "[pymvsim_simulator] GUI thread exception: " << e.what() << std::endl;
+		}
+	}
+};
+
+/** N independent copies of one world, stepped in parallel C++ threads with the
+ * GIL released, returning batched observations of one vehicle per world. */
+class PyVecEnv
+{
+   public:
+	PyVecEnv(
+		const std::string& xmlFile, size_t numEnvs, const std::string& vehicle,
+		const std::string& lidar, unsigned int stepsPerAction, size_t numThreads)
+		: vehicle_(vehicle), lidar_(lidar), stepsPerAction_(stepsPerAction)
+	{
+		ASSERT_GE_(numEnvs, 1U);
+		ASSERT_GE_(stepsPerAction, 1U);
+
+		for (size_t i = 0; i < numEnvs; i++)
+		{
+			auto& env = envs_.emplace_back(std::make_unique<PyWorld>());
+			env->load(xmlFile, true /*headless*/);
+			vehicles_.push_back(&env->findVehicle(vehicle));
+		}
+		// Fail now, instead of in the first step():
+		set_twist_command(0, {0, 0, 0});
+
+		if (!lidar.empty())
+		{
+			const mvsim::LaserScanner* laser = nullptr;
+			for (const auto& s : vehicles_.front()->getSensors())
+			{
+				if (!s || s->getName() != lidar) continue;
+				laser = dynamic_cast<const mvsim::LaserScanner*>(s.get());
+				break;
+			}
+			ASSERTMSG_(
+				laser, mrpt::format(
+						   "Vehicle '%s' has no 2D lidar named '%s'", vehicle.c_str(),
+						   lidar.c_str()));
+
+			lidarSize_ = laser->getScanModel().getScanSize();
+			lidarMaxRange_ = laser->getScanModel().maxRange;
+		}
+
+		if (numThreads == 0)
+			numThreads = std::min<size_t>(numEnvs, std::thread::hardware_concurrency());
+
+		pool_ = std::make_unique<mrpt::WorkerThreadsPool>(
+			std::max<size_t>(1, numThreads), mrpt::WorkerThreadsPool::POLICY_FIFO,
+			"pymvsim_vecenv");
+	}
+
+	~PyVecEnv() { close(); }
+
+	void close()
+	{
+		pool_.reset();
+		envs_.clear();
+		vehicles_.clear();
+	}
+
+	size_t num_envs() const { return envs_.size(); }
+	size_t lidar_size() const { return lidarSize_; }
+	double lidar_max_range() const { return lidarMaxRange_; }
+
+	/** Environment steps (one action applied to one env) per second of wall
+	 * clock time spent in step(), since construction */
+	double env_steps_per_second() const
+	{
+		return stepsWallTime_ > 0 ? static_cast<double>(envSteps_) / stepsWallTime_ : .0;
+	}
+	uint64_t env_steps() const { return envSteps_; }
+
+	/** Applies one (vx,vy,w) action per env (a Nx3 array), runs
+	 * `steps_per_action` time steps in all of them, and returns the new
+	 * batched observations. The latest lidar scan of each env is returned,
+	 * even if it is older than this step, if the lidar period is longer than
+	 * the action period. */
+	py::dict step(const py::array_t<double, py::array::c_style | py::array::forcecast>& actions)
+	{
+		const auto n = static_cast<py::ssize_t>(envs_.size());
+		if (actions.ndim() != 2 || actions.shape(0) != n || actions.shape(1) != 3)
+			THROW_EXCEPTION_FMT("Expected actions as a %ux3 array", static_cast<unsigned>(n));
+
+		const double* a = actions.data();
+
+		std::vector<size_t> all(envs_.size());
+		for (size_t i = 0; i < all.size(); i++) all[i] = i;
+
+		const auto t0 = std::chrono::steady_clock::now();
+		auto obs = run_batch(
+			all,
+			[&](size_t i)
+			{ set_twist_command(i, {a[3 * i + 0], a[3 * i + 1], a[3 * i + 2]}); });
+		stepsWallTime_ +=
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		envSteps_ += all.size();
+
+		return obs;
+	}
+
+	/** Resets the given envs (or all of them) to their initial state, runs one
+	 * action period at rest, plus as many time steps as needed for their lidar
+	 * to produce a first scan, and returns the batched observations of all
+	 * envs. */
+	py::dict reset(const std::optional<std::vector<size_t>>& indices)
+	{
+		std::vector<size_t> which;
+		if (indices)
+			which = *indices;
+		else
+			for (size_t i = 0; i < envs_.size(); i++) which.push_back(i);
+
+		for (const auto i : which) ASSERT_LT_(i, envs_.size());
+
+		return run_batch(
+			which, [this](size_t i) { envs_[i]->reset(); }, true /*wait for scans*/);
+	}
+
+   private:
+	std::vector<std::unique_ptr<PyWorld>> envs_;
+	std::vector<mvsim::VehicleBase*> vehicles_;
+	std::unique_ptr<mrpt::WorkerThreadsPool> pool_;
+
+	const std::string vehicle_, lidar_;
+	const unsigned int stepsPerAction_;
+	size_t lidarSize_ = 0;
+	float lidarMaxRange_ = 0;
+
+	uint64_t envSteps_ = 0;
+	double stepsWallTime_ = 0;
+
+	/// Simulated time to wait for the first lidar scan after a reset
+	static constexpr double MAX_FIRST_SCAN_WAIT = 10.0;
+
+	void set_twist_command(size_t i, const mrpt::math::TTwist2D& t)
+	{
+		auto* c = vehicles_[i]->getControllerInterface();
+		if (!c || !c->setTwistCommand(t))
+		{
+			THROW_EXCEPTION_FMT(
+				"The controller of vehicle '%s' does not accept twist commands",
+				vehicle_.c_str());
+		}
+	}
+
+	bool has_scan(size_t i)
+	{
+		const auto scan = std::dynamic_pointer_cast<mrpt::obs::CObservation2DRangeScan>(
+			envs_[i]->latestObservation(vehicle_, lidar_));
+		return scan && scan->getScanSize() == lidarSize_;
+	}
+
+	/** Runs `prepare(i)` then the simulation, for each env in `which`, in
+	 * parallel. Then, collects the observations of all envs. */
+	py::dict run_batch(
+		const std::vector<size_t>& which, const std::function<void(size_t)>& prepare,
+		bool waitForScans = false)
+	{
+		const auto n = static_cast<py::ssize_t>(envs_.size());
+
+		py::array_t<float> ranges({n, static_cast<py::ssize_t>(lidarSize_)});
+		py::array_t<double> poses({n, py::ssize_t(3)});
+		py::array_t<double> twists({n, py::ssize_t(3)});
+		py::array_t<bool> collisions(n);
+		py::array_t<bool> rangesValid(n);
+
+		float* r = ranges.mutable_data();
+		double* p = poses.mutable_data();
+		double* t = twists.mutable_data();
+		bool* c = collisions.mutable_data();
+		bool* rv = rangesValid.mutable_data();
+
+		{
+			py::gil_scoped_release noGil;
+
+			std::vector<std::future<void>> futs;
+			for (const auto i : which)
+			{
+				futs.emplace_back(pool_->enqueue(
+					[this, &prepare, i, waitForScans]()
+					{
+						prepare(i);
+						auto& env = *envs_[i];
+						env.run_steps(stepsPerAction_);
+
+						if (!waitForScans || lidarSize_ == 0) return;
+						const double tEnd = env.time() + MAX_FIRST_SCAN_WAIT;
+						while (!has_scan(i) && env.time() < tEnd) env.run_steps(1);
+					}));
+			}
+			// Wait for all before get() may rethrow, since tasks use this
+			// stack frame:
+			for (auto& f : futs) f.wait();
+			for (auto& f : futs) f.get();
+
+			for (size_t i = 0; i < envs_.size(); i++)
+				collect(i, r + i * lidarSize_, p + 3 * i, t + 3 * i, c[i], rv[i]);
+		}
+
+		py::dict obs;
+		obs["ranges"] = ranges;
+		obs["ranges_valid"] = rangesValid;
+		obs["poses"] = poses;
+		obs["twists"] = twists;
+		obs["collisions"] = collisions;
+		return obs;
+	}
+
+	void collect(
+		size_t i, float* ranges, double* pose, double* twist, bool& collision, bool& rangesValid)
+	{
+		auto& veh = *vehicles_[i];
+		{
+			auto lck = mrpt::lockHelper(envs_[i]->world().getListOfSimulableObjectsMtx());
+
+			const auto ks = veh.getKinematicState();
+			pose[0] = ks.pose.x;
+			pose[1] = ks.pose.y;
+			pose[2] = ks.pose.yaw;
+			twist[0] = ks.twist.vx;
+			twist[1] = ks.twist.vy;
+			twist[2] = ks.twist.omega;
+
+			collision = veh.hadCollision();
+			veh.resetCollisionFlag();
+		}
+
+		rangesValid = true;
+		if (lidarSize_ == 0) return;
+
+		const auto scan = std::dynamic_pointer_cast<mrpt::obs::CObservation2DRangeScan>(
+			envs_[i]->latestObservation(vehicle_, lidar_));
+		rangesValid = scan && scan->getScanSize() == lidarSize_;
+
+		// No scan yet: never make up free space.
+		if (rangesValid)
+			std::copy_n(&scan->getScanRange(0), lidarSize_, ranges);
+		else
+			std::fill_n(ranges, lidarSize_, std::numeric_limits<float>::quiet_NaN());
+	}
+};
+
+}  // namespace
+
+PYBIND11_MODULE(pymvsim_simulator, m)
+{
+	m.doc() = "In-process MVSim simulator, with zero-copy NumPy access to sensor observations";
+
+	py::class_<PyWorld>(m, "World")
+		.def(py::init<>())
+		.def(
+			"load", &PyWorld::load, py::arg("xml_file"), py::arg("headless") = true,
+			"Loads a world XML file, replacing any former one")
+		.def("close", &PyWorld::close, "Stops the simulation and frees its resources")
+		.def(
+			"step", &PyWorld::step, py::arg("n") = 1,
+			"Runs n simulation time steps, returning the new simulation time")
+		.def("reset", &PyWorld::reset, "Moves all objects back to their initial poses, at rest")
+		.def_property_readonly("time", &PyWorld::time, "Simulation time [s]")
+		.def("vehicles", &PyWorld::vehicles, "Names of all vehicles")
+		.def(
+			"get_pose", &PyWorld::get_pose, py::arg("name"),
+			"Global pose of a vehicle or block, as (x,y,z,yaw,pitch,roll)")
+		.def(
+			"set_pose", &PyWorld::set_pose, py::arg("name"), py::arg("pose"),
+			"Teleports a vehicle or block to [x,y,yaw] or [x,y,z,yaw,pitch,roll]")
+		.def(
+			"get_twist", &PyWorld::get_twist, py::arg("name"),
+			"Velocity of a vehicle or block in global coordinates, as (vx,vy,omega)")
+		.def(
+			"set_twist_command", &PyWorld::set_twist_command, py::arg("name"), py::arg("vx"),
+			py::arg("vy"), py::arg("w"),
+			"Sets the (vx,vy,w) velocity setpoint of a vehicle controller, in local coordinates")
+		.def(
+			"observations", &PyWorld::observations,
+			"(vehicle,sensor) pairs with at least one observation received")
+		.def(
+			"observation_time", &PyWorld::observation_time, py::arg("vehicle"),
+			py::arg("sensor"), "Timestamp of the latest observation, or None")
+		.def(
+			"lidar_ranges", &PyWorld::lidar_ranges, py::arg("vehicle"), py::arg("sensor"),
+			"Latest 2D lidar ranges as a float32 array, or None")
+		.def(
+			"point_cloud", &PyWorld::point_cloud, py::arg("vehicle"), py::arg("sensor"),
+			"Latest point cloud as a tuple of (x,y,z) float32 arrays, or None")
+		.def(
+			"image", &PyWorld::image, py::arg("vehicle"), py::arg("sensor"),
+			"Latest camera (or RGBD intensity) image as a HxWxC uint8 array, or None")
+		.def(
+			"depth_image", &PyWorld::depth_image, py::arg("vehicle"), py::arg("sensor"),
+			"Latest depth image as (HxW uint16 array, range units in meters), or None");
+
+	py::class_<PyVecEnv>(m, "VecEnv")
+		.def(
+			py::init<
+				const std::string&, size_t, const std::string&, const std::string&, unsigned int,
+				size_t>(),
+			py::arg("xml_file"), py::arg("num_envs"), py::arg("vehicle"), py::arg("lidar") = "",
+			py::arg("steps_per_action") = 1, py::arg("num_threads") = 0,
+			"Loads num_envs headless copies of a world. One vehicle of each one is controlled, "
+			"and optionally one of its 2D lidars observed. num_threads=0 means automatic.")
+		.def("close", &PyVecEnv::close)
+		.def(
+			"step", &PyVecEnv::step, py::arg("actions"),
+			"Applies a (num_envs x 3) array of (vx,vy,w) twist commands, simulates "
+			"steps_per_action time steps, and returns a dict of batched observations")
+		.def(
+			"reset", &PyVecEnv::reset, py::arg("indices") = py::none(),
+			"Resets the given envs (default: all), returning the batched observations")
+		.def_property_readonly("num_envs", &PyVecEnv::num_envs)
+		.def_property_readonly("lidar_size", &PyVecEnv::lidar_size)
+		.def_property_readonly("lidar_max_range", &PyVecEnv::lidar_max_range)
+		.def_property_readonly("env_steps", &PyVecEnv::env_steps)
+		.def_property_readonly(
+			"env_steps_per_second", &PyVecEnv::env_steps_per_second,
+			"Achieved env steps per second of wall-clock time spent in step()");
+}
@@ -219,6 +219,16 @@ Block::Ptr Block::factory(World* parent, const std::string& xml_text)
 
 void Block::simul_pre_timestep(const TSimulContext& context)
 {
+	// Moved from outside (e.g. set_pose service, or the GUI)? Box2D does not
+	// wake up bodies on SetTransform():
+	if (b2dBody_ && !b2dBody_->IsAwake() && b2dBody_->GetType() != b2_staticBody)
+	{
+		const auto p = getPose();
+		const b2Vec2& pos = b2dBody_->GetPosition();
+		if (p.x != pos.x || p.y != pos.y || p.yaw != b2dBody_->GetAngle())
+			b2dBody_->SetAwake(true);
+	}
+
 	Simulable::simul_pre_timestep(context);
 }
 
@@ -260,10 +270,8 @@ void Block::internalGuiUpdate(
 		}
 
 		// Update them:
-		// If "viz" does not have a value, it's because we are already
-		// inside a setPose() change event, so my caller already holds the
-		// mutex and we don't need/can't acquire it again:
-		const auto objectPose = viz.has_value() ? getPose() : getPoseNoLock();
+		// Pull the latest pose written by the physics thread:
+		const auto objectPose = getPose();
 
 		if (gl_block_) gl_block_->setPose(objectPose);
 	}
@@ -418,6 +426,12 @@ bool Block::isStatic() const
 	return b2dBody_->GetType() == b2_staticBody;
 }
 
+bool Block::isSleeping() const
+{
+	if (!world_->sleepingEnabled_ || intangible_ || !b2dBody_) return false;
+	return !b2dBody_->IsAwake();
+}
+
 void Block::setIsStatic(bool b)
 {
 	if (intangible_) return;
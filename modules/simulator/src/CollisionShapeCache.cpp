@@ -11,10 +11,13 @@
 #include <mrpt/opengl/CAssimpModel.h>
 #include <mrpt/opengl/CBox.h>
 #include <mrpt/opengl/CCylinder.h>
+#include <mrpt/opengl/CSetOfObjects.h>
 #include <mrpt/opengl/CSphere.h>
 #include <mrpt/version.h>
 #include <mvsim/CollisionShapeCache.h>
 
+#include <functional>
+
 using namespace mvsim;
 
 CollisionShapeCache& CollisionShapeCache::Instance()
@@ -155,34 +158,6 @@ Shape2p5 CollisionShapeCache::processGenericGeometry(
 {
 	Shape2p5 ret;
 
-	// Make sure the points and vertices buffers are up to date, so we can
-	// access them:
-	auto* oAssimp = dynamic_cast<mrpt::opengl::CAssimpModel*>(&obj);
-	if (oAssimp)
-	{
-		oAssimp->onUpdateBuffers_all();
-	}
-	auto* oRSWF = dynamic_cast<mrpt::opengl::CRenderizableShaderWireFrame*>(&obj);
-	if (oRSWF)
-	{
-		oRSWF->onUpdateBuffers_Wireframe();
-	}
-	auto* oRST = dynamic_cast<mrpt::opengl::CRenderizableShaderTriangles*>(&obj);
-	if (oRST)
-	{
-		oRST->onUpdateBuffers_Triangles();
-	}
-	auto* oRSTT = dynamic_cast<mrpt::opengl::CRenderizableShaderTexturedTriangles*>(&obj);
-	if (oRSTT)
-	{
-		oRSTT->onUpdateBuffers_TexturedTriangles();
-	}
-	auto* oRP = dynamic_cast<mrpt::opengl::CRenderizableShaderPoints*>(&obj);
-	if (oRP)
-	{
-		oRP->onUpdateBuffers_Points();
-	}
-
 	// Slice bbox in z up to a given relevant height:
 	size_t numTotalPts = 0, numPassedPts = 0;
 
@@ -195,10 +170,14 @@ Shape2p5 CollisionShapeCache::processGenericGeometry(
 		mrpt::math::TPoint2Df(coarseBB.min.x, coarseBB.min.y),
 		mrpt::math::TPoint2Df(coarseBB.max.x, coarseBB.max.y));
 
+	// Pose of the object being processed, within the model (not identity
+	// only for the children of CSetOfObjects):
+	mrpt::poses::CPose3D objPose;
+
 	auto lambdaUpdatePt = [&](const mrpt::math::TPoint3Df& orgPt)
 	{
 		numTotalPts++;
-		auto pt = modelPose.composePoint(orgPt * modelScale);
+		auto pt = modelPose.composePoint(objPose.composePoint(orgPt) * modelScale);
 		if (pt.z < zMin || pt.z > zMax) return;	 // skip
 		ret.buildAddPoint(pt);
 		numPassedPts++;
@@ -208,7 +187,8 @@ Shape2p5 CollisionShapeCache::processGenericGeometry(
 		numTotalPts += 3;
 		// transform the whole triangle, then compare with [z,z] limits:
 		mrpt::opengl::TTriangle t = tri;
-		for (int i = 0; i < 3; i++) t.vertex(i) = modelPose.composePoint(t.vertex(i) * modelScale);
+		for (int i = 0; i < 3; i++)
+			t.vertex(i) = modelPose.composePoint(objPose.composePoint(t.vertex(i)) * modelScale);
 
 		// does any of the point lie within the valid Z range, or is the
 		// triangle going all the way down to top?
@@ -230,45 +210,88 @@ Shape2p5 CollisionShapeCache::processGenericGeometry(
 		numPassedPts += 3;
 	};
 
-	if (oRST)
-	{
-		auto lck = mrpt::lockHelper(oRST->shaderTrianglesBufferMutex().data);
-		const auto& tris = oRST->shaderTrianglesBuffer();
-		for (const auto& tri : tris) lambdaUpdateTri(tri);
-	}
-	if (oRSTT)
-	{
-		auto lck = mrpt::lockHelper(oRSTT->shaderTexturedTrianglesBufferMutex().data);
-		const auto& tris = oRSTT->shaderTexturedTrianglesBuffer();
-		for (const auto& tri : tris) lambdaUpdateTri(tri);
-	}
-	if (oRP)
-	{
-		auto lck = mrpt::lockHelper(oRP->shaderPointsBuffersMutex().data);
-		const auto& pts = oRP->shaderPointsVertexPointBuffer();
-		for (const auto& pt : pts) lambdaUpdatePt(pt);
-	}
-	if (oRSWF)
+	std::function<void(mrpt::opengl::CRenderizable&, const mrpt::poses::CPose3D&)> lambdaAddObj;
+	lambdaAddObj = [&](mrpt::opengl::CRenderizable& o, const mrpt::poses::CPose3D& pose)
 	{
-		auto lck = mrpt::lockHelper(oRSWF->shaderWireframeBuffersMutex().data);
-		const auto& pts = oRSWF->shaderWireframeVertexPointBuffer();
-		for (const auto& pt : pts) lambdaUpdatePt(pt);
-	}
+		// Sets of objects (e.g. models from the ModelsCache binary cache):
+		if (auto* oSet = dynamic_cast<mrpt::opengl::CSetOfObjects*>(&o); oSet)
+		{
+			for (const auto& child : *oSet)
+				if (child) lambdaAddObj(*child, pose + child->getPose());
+			return;
+		}
+		objPose = pose;
 
-#if MRPT_VERSION >= 0x260
-	if (oAssimp)
-	{
-		const auto& txtrdObjs = oAssimp->texturedObjects();	 // mrpt>=2.6.0
-		for (const auto& o : txtrdObjs)
+		// Make sure the points and vertices buffers are up to date, so we can
+		// access them:
+		auto* oAssimp = dynamic_cast<mrpt::opengl::CAssimpModel*>(&o);
+		if (oAssimp)
+		{
+			oAssimp->onUpdateBuffers_all();
+		}
+		auto* oRSWF = dynamic_cast<mrpt::opengl::CRenderizableShaderWireFrame*>(&o);
+		if (oRSWF)
+		{
+			oRSWF->onUpdateBuffers_Wireframe();
+		}
+		auto* oRST = dynamic_cast<mrpt::opengl::CRenderizableShaderTriangles*>(&o);
+		if (oRST)
+		{
+			oRST->onUpdateBuffers_Triangles();
+		}
+		auto* oRSTT = dynamic_cast<mrpt::opengl::CRenderizableShaderTexturedTriangles*>(&o);
+		if (oRSTT)
+		{
+			oRSTT->onUpdateBuffers_TexturedTriangles();
+		}
+		auto* oRP = dynamic_cast<mrpt::opengl::CRenderizableShaderPoints*>(&o);
+		if (oRP)
 		{
-			if (!o) continue;
+			oRP->onUpdateBuffers_Points();
+		}
 
-			auto lck = mrpt::lockHelper(o->shaderTexturedTrianglesBufferMutex().data);
-			const auto& tris = o->shaderTexturedTrianglesBuffer();
+		if (oRST)
+		{
+			auto lck = mrpt::lockHelper(oRST->shaderTrianglesBufferMutex().data);
+			const auto& tris = oRST->shaderTrianglesBuffer();
 			for (const auto& tri : tris) lambdaUpdateTri(tri);
 		}
-	}
+		if (oRSTT)
+		{
+			auto lck = mrpt::lockHelper(oRSTT->shaderTexturedTrianglesBufferMutex().data);
+			const auto& tris = oRSTT->shaderTexturedTrianglesBuffer();
+			for (const auto& tri : tris) lambdaUpdateTri(tri);
+		}
+		if (oRP)
+		{
+			auto lck = mrpt::lockHelper(oRP->shaderPointsBuffersMutex().data);
+			const auto& pts = oRP->shaderPointsVertexPointBuffer();
+			for (const auto& pt : pts) lambdaUpdatePt(pt);
+		}
+		if (oRSWF)
+		{
+			auto lck = mrpt::lockHelper(oRSWF->shaderWireframeBuffersMutex().data);
+			const auto& pts = oRSWF->shaderWireframeVertexPointBuffer();
+			for (const auto& pt : pts) lambdaUpdatePt(pt);
+		}
+
+#if MRPT_VERSION >= 0x260
+		if (oAssimp)
+		{
+			const auto& txtrdObjs = oAssimp->texturedObjects();	 // mrpt>=2.6.0
+			for (const auto& to : txtrdObjs)
+			{
+				if (!to) continue;
+
+				auto lck = mrpt::lockHelper(to->shaderTexturedTrianglesBufferMutex().data);
+				const auto& tris = to->shaderTexturedTrianglesBuffer();
+				for (const auto& tri : tris) lambdaUpdateTri(tri);
+			}
+		}
 #endif
+	};
+
+	lambdaAddObj(obj, mrpt::poses::CPose3D::Identity());
 
 	// Convert all points into an actual 2.5D volume:
 	// ---------------------------------------------------------
@@ -0,0 +1,434 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/opengl/CAssimpModel.h>
+#include <mrpt/opengl/CRenderizableShaderTexturedTriangles.h>
+#include <mrpt/opengl/CRenderizableShaderTriangles.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/version.h>
+#include <mvsim/CpuRasterizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace mvsim;
+
+CpuRasterizer::CpuRasterizer(unsigned int numThreads)
+	: numThreads_(numThreads > 0 ? numThreads : std::thread::hardware_concurrency())
+{
+	if (numThreads_ < 1) numThreads_ = 1;
+}
+
+CpuRasterizer::~CpuRasterizer() = default;
+
+void CpuRasterizer::updateScene(mrpt::opengl::COpenGLScene& scene)
+{
+	frame_++;
+	instances_.clear();
+	numTriangles_ = 0;
+
+	auto viewport = scene.getViewport();
+	if (!viewport) return;
+
+	background_ = viewport->getCustomBackgroundColor().asTColor();
+
+	for (const auto& obj : *viewport) collectObject(obj, mrpt::poses::CPose3D::Identity());
+
+	// Forget about objects no longer in the scene:
+	for (auto it = cache_.begin(); it != cache_.end();)
+	{
+		if (it->second.lastSeenFrame != frame_)
+			it = cache_.erase(it);
+		else
+			++it;
+	}
+}
+
+void CpuRasterizer::collectObject(
+	const mrpt::opengl::CRenderizable::Ptr& obj, const mrpt::poses::CPose3D& parentPose)
+{
+	if (!obj || !obj->isVisible()) return;
+
+	const auto pose = parentPose + obj->getCPose();
+
+	if (auto set = dynamic_cast<const mrpt::opengl::CSetOfObjects*>(obj.get()); set)
+	{
+		for (const auto& child : *set) collectObject(child, pose);
+		return;
+	}
+
+	const auto& tris = cachedTriangles(obj);
+	if (tris.empty()) return;
+
+	Instance inst;
+	inst.tris = &tris;
+	inst.pose = pose;
+	inst.scale = {obj->getScaleX(), obj->getScaleY(), obj->getScaleZ()};
+	instances_.push_back(inst);
+
+	numTriangles_ += tris.size();
+}
+
+const std::vector<CpuRasterizer::Triangle>& CpuRasterizer::cachedTriangles(
+	const mrpt::opengl::CRenderizable::Ptr& obj)
+{
+	auto& e = cache_[obj.get()];
+	e.lastSeenFrame = frame_;
+
+	// Already cached? (and not a new object reusing the same address)
+	if (e.obj.lock() == obj) return e.tris;
+
+	e.obj = obj;
+	e.tris.clear();
+
+	auto lambdaAddTri = [&](const mrpt::opengl::TTriangle& t)
+	{
+		if (t.a(0) == 0) return;  // fully transparent
+		Triangle tri;
+		for (int i = 0; i < 3; i++) tri.v[i] = t.vertex(i);
+		tri.color = mrpt::img::TColor(t.r(0), t.g(0), t.b(0));
+		e.tris.push_back(tri);
+	};
+
+	// Make sure the triangle buffers are up to date, as CollisionShapeCache:
+	auto* oAssimp = dynamic_cast<mrpt::opengl::CAssimpModel*>(obj.get());
+	if (oAssimp) oAssimp->onUpdateBuffers_all();
+
+	if (auto* oRST = dynamic_cast<mrpt::opengl::CRenderizableShaderTriangles*>(obj.get()); oRST)
+	{
+		oRST->onUpdateBuffers_Triangles();
+		auto lck = mrpt::lockHelper(oRST->shaderTrianglesBufferMutex().data);
+		for (const auto& t : oRST->shaderTrianglesBuffer()) lambdaAddTri(t);
+	}
+	if (auto* oRSTT = dynamic_cast<mrpt::opengl::CRenderizableShaderTexturedTriangles*>(obj.get());
+		oRSTT)
+	{
+		oRSTT->onUpdateBuffers_TexturedTriangles();
+		auto lck = mrpt::lockHelper(oRSTT->shaderTexturedTrianglesBufferMutex().data);
+		for (const auto& t : oRSTT->shaderTexturedTrianglesBuffer()) lambdaAddTri(t);
+	}
+#if MRPT_VERSION >= 0x260
+	if (oAssimp)
+	{
+		for (const auto& o : oAssimp->texturedObjects())
+		{
+			if (!o) continue;
+			auto lck = mrpt::lockHelper(o->shaderTexturedTrianglesBufferMutex().data);
+			for (const auto& t : o->shaderTexturedTrianglesBuffer()) lambdaAddTri(t);
+		}
+	}
+#endif
+
+	return e.tris;
+}
+
+void CpuRasterizer::parallelFor(size_t n, const std::function<void(size_t)>& func)
+{
+	if (numThreads_ <= 1 || n <= 1)
+	{
+		for (size_t i = 0; i < n; i++) func(i);
+		return;
+	}
+
+	if (!pool_)
+	{
+		pool_ = std::make_unique<mrpt::WorkerThreadsPool>(
+			numThreads_, mrpt::WorkerThreadsPool::POLICY_FIFO, "mvsim_raster");
+	}
+
+	// More chunks than threads, to balance tiles with different workloads:
+	const size_t nChunks = std::min<size_t>(n, numThreads_ * 4);
+	std::vector<std::future<void>> futs;
+	futs.reserve(nChunks);
+	for (size_t c = 0; c < nChunks; c++)
+	{
+		const size_t i0 = c * n / nChunks, i1 = (c + 1) * n / nChunks;
+		futs.emplace_back(pool_->enqueue(
+			[&func, i0, i1]()
+			{
+				for (size_t i = i0; i < i1; i++) func(i);
+			}));
+	}
+	// Wait for all of them before get(), which may rethrow an exception:
+	for (auto& f : futs) f.wait();
+	for (auto& f : futs) f.get();
+}
+
+namespace
+{
+struct CamVertex
+{
+	float x, y, z;
+};
+
+CamVertex lerpAtZ(const CamVertex& a, const CamVertex& b, float z)
+{
+	const float t = (z - a.z) / (b.z - a.z);
+	return {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y), z};
+}
+
+}  // namespace
+
+void CpuRasterizer::rasterize(
+	const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+	float clipMin, float clipMax, bool withColor)
+{
+	ASSERT_GT_(clipMin, 0.f);
+	ASSERT_GT_(clipMax, clipMin);
+
+	const int32_t W = static_cast<int32_t>(cameraParams.ncols);
+	const int32_t H = static_cast<int32_t>(cameraParams.nrows);
+	const float fx = cameraParams.fx(), fy = cameraParams.fy();
+	const float cx = cameraParams.cx(), cy = cameraParams.cy();
+
+	const auto camInv = -cameraPose;
+
+	// A directional light, fixed in the world, expressed in the camera frame:
+	const auto& Rc = camInv.getRotationMatrix();
+	const float Lw[3] = {-0.40825f, -0.40825f, -0.8165f};
+	float Lc[3];
+	for (int i = 0; i < 3; i++)
+		Lc[i] = static_cast<float>(Rc(i, 0) * Lw[0] + Rc(i, 1) * Lw[1] + Rc(i, 2) * Lw[2]);
+
+	// 1) Transform and project all triangles, in parallel by groups of
+	// objects. Each group writes to its own list, to keep a deterministic
+	// order of triangles in the tiles.
+	// ----------------------------------------------------------------------
+	const size_t nGroups = std::max<size_t>(1, std::min<size_t>(numThreads_, instances_.size()));
+	screenTrisPerThread_.resize(nGroups);
+
+	auto lambdaProjectGroup = [&](size_t g)
+	{
+		auto& out = screenTrisPerThread_[g];
+		out.clear();
+
+		const size_t i0 = g * instances_.size() / nGroups;
+		const size_t i1 = (g + 1) * instances_.size() / nGroups;
+
+		for (size_t idx = i0; idx < i1; idx++)
+		{
+			const Instance& inst = instances_[idx];
+			const auto T = camInv + inst.pose;
+			const auto& R = T.getRotationMatrix();
+			const float t[3] = {
+				static_cast<float>(T.x()), static_cast<float>(T.y()), static_cast<float>(T.z())};
+			const float s[3] = {inst.scale.x, inst.scale.y, inst.scale.z};
+			float r[3][3];
+			for (int i = 0; i < 3; i++)
+				for (int j = 0; j < 3; j++) r[i][j] = static_cast<float>(R(i, j)) * s[j];
+
+			for (const Triangle& tri : *inst.tris)
+			{
+				CamVertex v[3];
+				int nInFront = 0, nBeyondFar = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					const auto& p = tri.v[k];
+					v[k].x = r[0][0] * p.x + r[0][1] * p.y + r[0][2] * p.z + t[0];
+					v[k].y = r[1][0] * p.x + r[1][1] * p.y + r[1][2] * p.z + t[1];
+					v[k].z = r[2][0] * p.x + r[2][1] * p.y + r[2][2] * p.z + t[2];
+					if (v[k].z >= clipMin) nInFront++;
+					if (v[k].z > clipMax) nBeyondFar++;
+				}
+				if (nInFront == 0 || nBeyondFar == 3) continue;
+
+				mrpt::img::TColor color = tri.color;
+				if (withColor)
+				{
+					// Flat shading:
+					const float ax = v[1].x - v[0].x, ay = v[1].y - v[0].y, az = v[1].z - v[0].z;
+					const float bx = v[2].x - v[0].x, by = v[2].y - v[0].y, bz = v[2].z - v[0].z;
+					const float n[3] = {ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx};
+					const float nn = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+					if (nn <= 0) continue;	// degenerate
+					const float cosAng = std::abs(n[0] * Lc[0] + n[1] * Lc[1] + n[2] * Lc[2]) / nn;
+					const float shade = 0.5f + 0.5f * cosAng;
+					color.R = static_cast<uint8_t>(color.R * shade);
+					color.G = static_cast<uint8_t>(color.G * shade);
+					color.B = static_cast<uint8_t>(color.B * shade);
+				}
+
+				// Clip against the near plane, which may give a quad:
+				CamVertex poly[4];
+				int nPoly = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					const CamVertex& a = v[k];
+					const CamVertex& b = v[(k + 1) % 3];
+					const bool aIn = a.z >= clipMin, bIn = b.z >= clipMin;
+					if (aIn) poly[nPoly++] = a;
+					if (aIn != bIn) poly[nPoly++] = lerpAtZ(a, b, clipMin);
+				}
+
+				// Project and fan-triangulate:
+				float px[4], py[4], piz[4];
+				for (int k = 0; k < nPoly; k++)
+				{
+					piz[k] = 1.0f / poly[k].z;
+					px[k] = fx * poly[k].x * piz[k] + cx;
+					py[k] = fy * poly[k].y * piz[k] + cy;
+				}
+				for (int k = 1; k + 1 < nPoly; k++)
+				{
+					const int ids[3] = {0, k, k + 1};
+					ScreenTriangle st;
+					float minX = px[0], maxX = px[0], minY = py[0], maxY = py[0];
+					for (int m = 0; m < 3; m++)
+					{
+						st.x[m] = px[ids[m]];
+						st.y[m] = py[ids[m]];
+						st.invZ[m] = piz[ids[m]];
+						minX = std::min(minX, st.x[m]);
+						maxX = std::max(maxX, st.x[m]);
+						minY = std::min(minY, st.y[m]);
+						maxY = std::max(maxY, st.y[m]);
+					}
+					// Pixels are sampled at integer coordinates:
+					st.minX = std::max<int32_t>(0, static_cast<int32_t>(std::ceil(minX)));
+					st.maxX = std::min<int32_t>(W - 1, static_cast<int32_t>(std::floor(maxX)));
+					st.minY = std::max<int32_t>(0, static_cast<int32_t>(std::ceil(minY)));
+					st.maxY = std::min<int32_t>(H - 1, static_cast<int32_t>(std::floor(maxY)));
+					if (st.minX > st.maxX || st.minY > st.maxY) continue;
+
+					const float area = (st.x[1] - st.x[0]) * (st.y[2] - st.y[0]) -
+									   (st.y[1] - st.y[0]) * (st.x[2] - st.x[0]);
+					if (std::abs(area) < 1e-9f) continue;
+
+					st.color = color;
+					out.push_back(st);
+				}
+			}
+		}
+	};
+	parallelFor(nGroups, lambdaProjectGroup);
+
+	// 2) Bin triangles into tiles:
+	// ----------------------------------------------------------------------
+	const int32_t nTilesX = (W + TILE_SIZE - 1) / TILE_SIZE;
+	const int32_t nTilesY = (H + TILE_SIZE - 1) / TILE_SIZE;
+	tileBins_.resize(nTilesX * nTilesY);
+	for (auto& bin : tileBins_) bin.clear();
+
+	for (const auto& group : screenTrisPerThread_)
+	{
+		for (const auto& st : group)
+		{
+			for (int32_t ty = st.minY / TILE_SIZE; ty <= st.maxY / TILE_SIZE; ty++)
+				for (int32_t tx = st.minX / TILE_SIZE; tx <= st.maxX / TILE_SIZE; tx++)
+					tileBins_[ty * nTilesX + tx].push_back(&st);
+		}
+	}
+
+	// 3) Rasterize tiles in parallel, with a 1/z buffer:
+	// ----------------------------------------------------------------------
+	invZBuffer_.assign(static_cast<size_t>(W) * H, .0f);
+	triBuffer_.assign(static_cast<size_t>(W) * H, nullptr);
+
+	const float invZFar = 1.0f / clipMax;
+
+	auto lambdaRasterTile = [&](size_t tileIdx)
+	{
+		const int32_t tx = static_cast<int32_t>(tileIdx) % nTilesX;
+		const int32_t ty = static_cast<int32_t>(tileIdx) / nTilesX;
+		const int32_t tileX0 = tx * TILE_SIZE, tileY0 = ty * TILE_SIZE;
+		const int32_t tileX1 = std::min(W - 1, tileX0 + TILE_SIZE - 1);
+		const int32_t tileY1 = std::min(H - 1, tileY0 + TILE_SIZE - 1);
+
+		for (const ScreenTriangle* stp : tileBins_[tileIdx])
+		{
+			const ScreenTriangle& st = *stp;
+			const int32_t x0 = std::max(st.minX, tileX0), x1 = std::min(st.maxX, tileX1);
+			const int32_t y0 = std::max(st.minY, tileY0), y1 = std::min(st.maxY, tileY1);
+
+			// Edge functions, normalized so they are positive inside:
+			float area = (st.x[1] - st.x[0]) * (st.y[2] - st.y[0]) -
+						 (st.y[1] - st.y[0]) * (st.x[2] - st.x[0]);
+			const float sign = area > 0 ? 1.0f : -1.0f;
+			area *= sign;
+
+			float dwdx[3], dwdy[3], wOrg[3];
+			for (int e = 0; e < 3; e++)
+			{
+				// Edge opposite to vertex "e", from vertex a to b:
+				const int a = (e + 1) % 3, b = (e + 2) % 3;
+				dwdx[e] = -sign * (st.y[b] - st.y[a]);
+				dwdy[e] = sign * (st.x[b] - st.x[a]);
+				wOrg[e] = sign * ((st.x[b] - st.x[a]) * (y0 - st.y[a]) -
+								  (st.y[b] - st.y[a]) * (x0 - st.x[a]));
+			}
+			const float invArea = 1.0f / area;
+
+			for (int32_t y = y0; y <= y1; y++)
+			{
+				float w[3];
+				for (int e = 0; e < 3; e++) w[e] = wOrg[e] + dwdy[e] * (y - y0);
+
+				float* zRow = &invZBuffer_[static_cast<size_t>(y) * W];
+				const ScreenTriangle** tRow = &triBuffer_[static_cast<size_t>(y) * W];
+
+				for (int32_t x = x0; x <= x1; x++)
+				{
+					if (w[0] >= 0 && w[1] >= 0 && w[2] >= 0)
+					{
+						const float iz =
+							(w[0] * st.invZ[0] + w[1] * st.invZ[1] + w[2] * st.invZ[2]) * invArea;
+						if (iz > zRow[x] && iz >= invZFar)
+						{
+							zRow[x] = iz;
+							tRow[x] = stp;
+						}
+					}
+					for (int e = 0; e < 3; e++) w[e] += dwdx[e];
+				}
+			}
+		}
+	};
+	parallelFor(tileBins_.size(), lambdaRasterTile);
+}
+
+void CpuRasterizer::render_depth(
+	const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+	float clipMin, float clipMax, mrpt::math::CMatrixFloat& outDepth)
+{
+	rasterize(cameraPose, cameraParams, clipMin, clipMax, false);
+
+	const size_t W = cameraParams.ncols, H = cameraParams.nrows;
+	outDepth.resize(H, W);
+	for (size_t r = 0; r < H; r++)
+	{
+		const float* zRow = &invZBuffer_[r * W];
+		for (size_t c = 0; c < W; c++) outDepth(r, c) = zRow[c] > 0 ? 1.0f / zRow[c] : .0f;
+	}
+}
+
+void CpuRasterizer::render_RGB(
+	const mrpt::poses::CPose3D& cameraPose, const mrpt::img::TCamera& cameraParams,
+	float clipMin, float clipMax, mrpt::img::CImage& outRGB)
+{
+	rasterize(cameraPose, cameraParams, clipMin, clipMax, true);
+
+	const size_t W = cameraParams.ncols, H = cameraParams.nrows;
+	outRGB.resize(W, H, mrpt::img::CH_RGB);
+
+	for (size_t r = 0; r < H; r++)
+	{
+		const ScreenTriangle* const* tRow = &triBuffer_[r * W];
+		// Color images are stored in BGR order, as rendered by CFBORender:
+		uint8_t* dst = outRGB.ptrLine<uint8_t>(r);
+		for (size_t c = 0; c < W; c++, dst += 3)
+		{
+			const auto& col = tRow[c] ? tRow[c]->color : background_;
+			dst[0] = col.B;
+			dst[1] = col.G;
+			dst[2] = col.R;
+		}
+	}
+}
@@ -73,7 +73,8 @@ mrpt::math::TVector2D EllipseCurveMethod::evaluate_friction(
 	// Velocity of the wheel cog in the frame of the wheel itself:
 	const mrpt::math::TVector2D vel_w = wRot.inverseComposePoint(input.wheelCogLocalVel);
 
-	const mrpt::math::TTwist2D& vel = myVehicle_.getVelocityLocal();  // ¿Está bien?
+	const auto vehState = myVehicle_.getKinematicState();
+	const mrpt::math::TTwist2D vel = vehState.velocityLocal();	// ¿Está bien?
 	const double m = myVehicle_.getChassisMass();  // masa del conjunto
 	const double afs = 5.0 * M_PI / 180.0;
 	const double CA = CA_;
@@ -107,7 +108,7 @@ mrpt::math::TVector2D EllipseCurveMethod::evaluate_friction(
 	ASSERT_(Axr > 0);
 
 	const mrpt::math::TPoint3D_<double> linAccLocal =
-		myVehicle_.getLinearAcceleration();	 // ¿Está bien?
+		vehState.linearAcceleration;  // ¿Está bien?
 
 	// 1) Vertical forces (decoupled sub-problem)
 	// --------------------------------------------
@@ -0,0 +1,185 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/poses/CPose3D.h>
+#include <mvsim/GridRaycaster.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+using namespace mvsim;
+
+void GridRaycaster::build(const mrpt::maps::COccupancyGridMap2D& grid, float occupiedThreshold)
+{
+	using mrpt::maps::COccupancyGridMap2D;
+
+	cellsX_ = static_cast<int>(grid.getSizeX());
+	cellsY_ = static_cast<int>(grid.getSizeY());
+	tilesX_ = (cellsX_ + TILE_SIZE - 1) >> TILE_BITS;
+	tilesY_ = (cellsY_ + TILE_SIZE - 1) >> TILE_BITS;
+	xMin_ = grid.getXMin();
+	yMin_ = grid.getYMin();
+	resolution_ = grid.getResolution();
+
+	tiles_.assign(static_cast<size_t>(tilesX_) * tilesY_, Tile());
+
+	// Cells store log-odds of being free: same test than laserScanSimulator()
+	const auto freeThreshold = COccupancyGridMap2D::p2l(1.0f - occupiedThreshold);
+
+	for (int cy = 0; cy < cellsY_; cy++)
+	{
+		const auto* row = grid.getRow(cy);
+		for (int cx = 0; cx < cellsX_; cx++)
+		{
+			const auto v = row[cx];
+			if (v > freeThreshold) continue;
+
+			Tile& tile = tiles_[(cy >> TILE_BITS) * tilesX_ + (cx >> TILE_BITS)];
+			const uint64_t mask = uint64_t(1) << bitIndex(cx, cy);
+			tile.blocking |= mask;
+			if (std::abs(static_cast<int>(v)) <= 1) tile.unknown |= mask;
+		}
+	}
+}
+
+GridRaycaster::Hit GridRaycaster::raycast(
+	float x, float y, float dirX, float dirY, float maxRange) const
+{
+	const Hit noHit{maxRange, false};
+	if (tiles_.empty()) return noHit;
+
+	// Everything in cell units from here on:
+	const double gx = (x - xMin_) / resolution_;
+	const double gy = (y - yMin_) / resolution_;
+	const double maxT = maxRange / resolution_;
+
+	int cx = static_cast<int>(std::floor(gx));
+	int cy = static_cast<int>(std::floor(gy));
+
+	auto outOfGrid = [this](int ix, int iy)
+	{
+		return static_cast<unsigned>(ix) >= static_cast<unsigned>(cellsX_) ||
+			   static_cast<unsigned>(iy) >= static_cast<unsigned>(cellsY_);
+	};
+	if (outOfGrid(cx, cy)) return noHit;
+
+	constexpr double INF = std::numeric_limits<double>::infinity();
+	const int stepX = dirX >= 0 ? 1 : -1;
+	const int stepY = dirY >= 0 ? 1 : -1;
+	const double invDx = dirX != 0 ? 1.0 / dirX : INF;
+	const double invDy = dirY != 0 ? 1.0 / dirY : INF;
+	const double tDeltaX = std::abs(invDx), tDeltaY = std::abs(invDy);
+
+	// Ray parameter where the ray leaves column ix (or row iy):
+	auto exitX = [&](int ix)
+	{ return dirX > 0 ? (ix + 1 - gx) * invDx : (dirX < 0 ? (ix - gx) * invDx : INF); };
+	auto exitY = [&](int iy)
+	{ return dirY > 0 ? (iy + 1 - gy) * invDy : (dirY < 0 ? (iy - gy) * invDy : INF); };
+
+	double t = 0;  // where the ray enters the current cell
+	double tNextX = exitX(cx), tNextY = exitY(cy);
+
+	for (;;)
+	{
+		const int tx = cx >> TILE_BITS, ty = cy >> TILE_BITS;
+		const Tile& tile = tiles_[ty * tilesX_ + tx];
+
+		if (tile.blocking == 0)
+		{
+			// Empty tile: jump to the next one at once.
+			const int x0 = tx << TILE_BITS, y0 = ty << TILE_BITS;
+			const int lastX = stepX > 0 ? x0 + TILE_SIZE - 1 : x0;
+			const int lastY = stepY > 0 ? y0 + TILE_SIZE - 1 : y0;
+			const double tExitX = exitX(lastX), tExitY = exitY(lastY);
+
+			if (tExitX < tExitY)
+			{
+				t = tExitX;
+				cx = lastX + stepX;
+				cy = std::clamp(
+					static_cast<int>(std::floor(gy + t * dirY)), y0, y0 + TILE_SIZE - 1);
+			}
+			else
+			{
+				t = tExitY;
+				cy = lastY + stepY;
+				cx = std::clamp(
+					static_cast<int>(std::floor(gx + t * dirX)), x0, x0 + TILE_SIZE - 1);
+			}
+			tNextX = exitX(cx);
+			tNextY = exitY(cy);
+		}
+		else
+		{
+			const int bit = bitIndex(cx, cy);
+			if ((tile.blocking >> bit) & 1)
+			{
+				if (((tile.unknown >> bit) & 1) || t >= maxT) return noHit;
+				return {static_cast<float>(t * resolution_), true};
+			}
+
+			// Next cell along the ray:
+			if (tNextX < tNextY)
+			{
+				t = tNextX;
+				tNextX += tDeltaX;
+				cx += stepX;
+			}
+			else
+			{
+				t = tNextY;
+				tNextY += tDeltaY;
+				cy += stepY;
+			}
+		}
+
+		if (t >= maxT || outOfGrid(cx, cy)) return noHit;
+	}
+}
+
+void GridRaycaster::simulateScan(
+	mrpt::obs::CObservation2DRangeScan& scan, const mrpt::poses::CPose2D& robotPose,
+	size_t nRays, float rangeNoiseStd, float angleNoiseStd,
+	mrpt::random::CRandomGenerator* rng) const
+{
+	ASSERTMSG_(
+		rng || (rangeNoiseStd <= 0 && angleNoiseStd <= 0),
+		"A random generator is required to simulate noise");
+
+	// The grid is 2D: drop the height and tilt of the sensor:
+	const mrpt::poses::CPose2D sensorPose(mrpt::poses::CPose3D(robotPose) + scan.sensorPose);
+
+	scan.resizeScan(nRays);
+	if (nRays == 0) return;
+
+	const double A0 = sensorPose.phi() + (scan.rightToLeft ? -0.5 : +0.5) * scan.aperture;
+	const double AA =
+		nRays > 1 ? (scan.rightToLeft ? 1.0 : -1.0) * (scan.aperture / (nRays - 1)) : 0.0;
+
+	const float ox = static_cast<float>(sensorPose.x());
+	const float oy = static_cast<float>(sensorPose.y());
+
+	for (size_t i = 0; i < nRays; i++)
+	{
+		double A = A0 + AA * i;
+		if (angleNoiseStd > 0) A += rng->drawGaussian1D_normalized() * angleNoiseStd;
+
+		Hit hit = raycast(
+			ox, oy, static_cast<float>(std::cos(A)), static_cast<float>(std::sin(A)),
+			scan.maxRange);
+
+		if (hit.valid && rangeNoiseStd > 0)
+			hit.range += static_cast<float>(rng->drawGaussian1D_normalized() * rangeNoiseStd);
+
+		scan.setScanRange(i, hit.range);
+		scan.setScanRangeValidity(i, hit.valid);
+	}
+}
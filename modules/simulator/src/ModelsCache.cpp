@@ -10,31 +10,164 @@
 #include "ModelsCache.h"
 
 #include <mrpt/core/get_env.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/opengl/CSetOfTexturedTriangles.h>
+#include <mrpt/opengl/CSetOfTriangles.h>
+#include <mrpt/serialization/CArchive.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/version.h>
+#include <mvsim/RemoteResourcesManager.h>
 
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <random>
 
 using namespace mvsim;
 
+namespace
+{
+// Change the version suffix whenever the contents of cache files change:
+const char* BINARY_CACHE_MAGIC = "MVSIM_MODEL_CACHE_V1";
+
+std::string binaryCacheDirectory()
+{
+	const auto baseDir = RemoteResourcesManager::cache_directory();
+	const auto dir = baseDir + "models/";
+	if (!mrpt::system::directoryExists(dir))
+	{
+		mrpt::system::createDirectory(baseDir);
+		mrpt::system::createDirectory(dir);
+	}
+	return dir;
+}
+
+mrpt::opengl::CSetOfObjects::Ptr readBinaryCache(
+	const std::string& file, const std::string& description)
+{
+	if (!mrpt::system::fileExists(file)) return {};
+	try
+	{
+		mrpt::io::CFileGZInputStream f(file);
+		auto arch = mrpt::serialization::archiveFrom(f);
+
+		std::string magic, storedDescription;
+		arch >> magic >> storedDescription;
+		// Different format, or a hash collision:
+		if (magic != BINARY_CACHE_MAGIC || storedDescription != description) return {};
+
+		return arch.ReadObject<mrpt::opengl::CSetOfObjects>();
+	}
+	catch (const std::exception&)
+	{
+		// Corrupted or truncated file: just load the original model again.
+		return {};
+	}
+}
+
+void writeBinaryCache(
+	const std::string& file, const std::string& description,
+	const mrpt::opengl::CSetOfObjects& obj)
+{
+	// Write to a temporary file first, so other processes never see a
+	// partially-written cache file. Its name is unique, since other processes
+	// may be writing the same cache file right now:
+	std::random_device rd;
+	const auto tmpFile = file + mrpt::format(".%08x%08x.tmp", rd(), rd());
+	try
+	{
+		{
+			mrpt::io::CFileGZOutputStream f(tmpFile);
+			auto arch = mrpt::serialization::archiveFrom(f);
+			arch << std::string(BINARY_CACHE_MAGIC) << description;
+			arch.WriteObject(&obj);
+		}
+		// It may fail if another process renamed its copy first (Windows):
+		// theirs is as good as ours.
+		if (!mrpt::system::renameFile(tmpFile, file)) mrpt::system::deleteFile(tmpFile);
+	}
+	catch (const std::exception&)
+	{
+		// The cache is an optimization only: e.g. a read-only home directory
+		// must not prevent loading the model.
+		mrpt::system::deleteFile(tmpFile);
+	}
+}
+
+}  // namespace
+
 ModelsCache& ModelsCache::Instance()
 {
 	static ModelsCache o;
 	return o;
 }
 
-mrpt::opengl::CAssimpModel::Ptr ModelsCache::get(
+mrpt::opengl::CRenderizable::Ptr ModelsCache::get(
 	const std::string& localFileName, const Options& options)
 {
-	// already cached?
-	if (auto it = cache.find(localFileName); it != cache.end()) return it->second;
+	const auto& c = options.modelColor;
+	const std::string key = mrpt::format(
+		"%s|%02x%02x%02x%02x|%s|%g", localFileName.c_str(), c.R, c.G, c.B, c.A,
+		options.modelCull.c_str(), options.splitSize);
+
+	std::shared_ptr<Entry> e;
+	{
+		std::lock_guard<std::mutex> lck(cacheMtx_);
+		auto& entry = cache_[key];
+		if (!entry) entry = std::make_shared<Entry>();
+		e = entry;
+	}
+
+	// Only one thread loads a given model, others wait for it here:
+	std::lock_guard<std::mutex> lck(e->mtx);
 
-	// No, it's a new model path, create its placeholder:
-	auto m = cache[localFileName] = mrpt::opengl::CAssimpModel::Create();
+	// already cached?
+	if (e->model) return e->model;
 
 	ASSERT_FILE_EXISTS_(localFileName);
 
+	// Try with the binary cache first:
+	const bool useBinaryCache =
+		options.splitSize == 0 && mrpt::get_env<bool>("MVSIM_MODELS_BINARY_CACHE", true);
+
+	std::string binFile, binDescription;
+	if (useBinaryCache)
+	{
+		binDescription = mrpt::format(
+			"%s|%lu|%.06f", key.c_str(),
+			static_cast<unsigned long>(mrpt::system::getFileSize(localFileName)),
+			mrpt::Clock::toDouble(mrpt::system::getFileModificationTime(localFileName)));
+
+		binFile = binaryCacheDirectory() +
+				  mrpt::format("%016zx_", std::hash<std::string>()(binDescription)) +
+				  mrpt::system::extractFileName(localFileName) + ".bin";
+
+		if (auto m = readBinaryCache(binFile, binDescription); m)
+		{
+			e->model = m;
+			return m;
+		}
+	}
+
+	auto m = loadWithAssimp(localFileName, options);
+	e->model = m;
+
+	if (useBinaryCache)
+	{
+		if (auto flat = flattenModel(*m, options); flat)
+			writeBinaryCache(binFile, binDescription, *flat);
+	}
+
+	return m;
+}
+
+mrpt::opengl::CAssimpModel::Ptr ModelsCache::loadWithAssimp(
+	const std::string& localFileName, const Options& options)
+{
+	auto m = mrpt::opengl::CAssimpModel::Create();
+
 	// En/Dis-able the extra verbosity while loading the 3D model:
 	int loadFlags = mrpt::opengl::CAssimpModel::LoadFlags::RealTimeMaxQuality |
 					mrpt::opengl::CAssimpModel::LoadFlags::FlipUVs;
@@ -57,3 +190,53 @@ mrpt::opengl::CAssimpModel::Ptr ModelsCache::get(
 
 	return m;
 }
+
+mrpt::opengl::CSetOfObjects::Ptr ModelsCache::flattenModel(
+	[[maybe_unused]] mrpt::opengl::CAssimpModel& model, [[maybe_unused]] const Options& options)
+{
+#if MRPT_VERSION >= 0x260  // texturedObjects() requires mrpt>=2.6.0
+	model.onUpdateBuffers_all();
+
+	// Only triangles are stored. Keep models with lines or points as they are:
+	{
+		auto lck = mrpt::lockHelper(model.shaderWireframeBuffersMutex().data);
+		if (!model.shaderWireframeVertexPointBuffer().empty()) return {};
+	}
+	{
+		auto lck = mrpt::lockHelper(model.shaderPointsBuffersMutex().data);
+		if (!model.shaderPointsVertexPointBuffer().empty()) return {};
+	}
+
+	const auto cull =
+		mrpt::typemeta::TEnumType<mrpt::opengl::TCullFace>::name2value(options.modelCull);
+
+	auto out = mrpt::opengl::CSetOfObjects::Create();
+
+	// Triangles with their final colors (material or modelColor):
+	auto tris = mrpt::opengl::CSetOfTriangles::Create();
+	{
+		auto lck = mrpt::lockHelper(model.shaderTrianglesBufferMutex().data);
+		const auto& buf = model.shaderTrianglesBuffer();
+		tris->insertTriangles(buf.begin(), buf.end());
+	}
+	if (tris->getTrianglesCount() != 0)
+	{
+		tris->cullFaces(cull);
+		out->insert(tris);
+	}
+
+	// Textured meshes, with their texture images. Copies, since the model
+	// itself is already in the cache and in use:
+	for (const auto& o : model.texturedObjects())
+	{
+		if (!o) continue;
+		auto copy = std::make_shared<mrpt::opengl::CSetOfTexturedTriangles>(*o);
+		copy->cullFaces(cull);
+		out->insert(copy);
+	}
+
+	return out;
+#else
+	return {};
+#endif
+}
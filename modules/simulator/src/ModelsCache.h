@@ -8,11 +8,27 @@
   +-------------------------------------------------------------------------+ */
 
 #include <mrpt/opengl/CAssimpModel.h>
+#include <mrpt/opengl/CSetOfObjects.h>
 
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace mvsim
 {
+/** Loads 3D models only once per file and set of options.
+ *
+ * get() is thread-safe: different models can be loaded in parallel, while
+ * concurrent requests for the same one wait for the first load to end.
+ *
+ * After loading a model with Assimp, its post-processed triangles (with
+ * colors, normals, and textures) are stored in a binary file under
+ * `RemoteResourcesManager::cache_directory()/models/`, so later runs load
+ * that file instead of running Assimp again. Cache files are invalidated
+ * when the model file changes (size or modification time) or the options
+ * differ. Set the environment variable `MVSIM_MODELS_BINARY_CACHE=false` to
+ * disable it.
+ */
 class ModelsCache
 {
    public:
@@ -26,19 +42,43 @@ class ModelsCache
 		/** See mrpt::opengl::CAssimpModel::split_triangles_rendering_bbox().
 		 *  Default (0)=disabled. Any other value, split the model into voxels of this size
 		 *  to help sorting triangles by depth so semitransparent meshes are rendered correctly.
+		 *  Models with splitting enabled are not stored in the binary cache.
 		 */
 		float splitSize = .0f;
 	};
 
-	mrpt::opengl::CAssimpModel::Ptr get(const std::string& url, const Options& options);
+	/** Returns the model, either a CAssimpModel or a CSetOfObjects with
+	 * its triangles if it comes from the binary cache. */
+	mrpt::opengl::CRenderizable::Ptr get(const std::string& url, const Options& options);
 
-	void clear() { cache.clear(); }
+	void clear()
+	{
+		std::lock_guard<std::mutex> lck(cacheMtx_);
+		cache_.clear();
+	}
 
    private:
 	ModelsCache() = default;
 	~ModelsCache() = default;
 
-	std::map<std::string, mrpt::opengl::CAssimpModel::Ptr> cache;
+	struct Entry
+	{
+		std::mutex mtx;
+		mrpt::opengl::CRenderizable::Ptr model;
+	};
+
+	std::mutex cacheMtx_;
+
+	/** Key: file path and options, see get() */
+	std::map<std::string, std::shared_ptr<Entry>> cache_;
+
+	static mrpt::opengl::CAssimpModel::Ptr loadWithAssimp(
+		const std::string& localFileName, const Options& options);
+
+	/** Copies the triangles of a loaded model, ready to be serialized.
+	 *  Returns nullptr if the model has geometry that is not supported. */
+	static mrpt::opengl::CSetOfObjects::Ptr flattenModel(
+		mrpt::opengl::CAssimpModel& model, const Options& options);
 };
 
 }  // namespace mvsim
@@ -0,0 +1,401 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include "PointCloudLoaders.h"
+
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mvsim;
+
+namespace
+{
+/** Read-only view of a whole file contents, memory-mapped where supported,
+ * or read into memory otherwise. */
+class MappedFile
+{
+   public:
+	explicit MappedFile(const std::string& file)
+	{
+#if defined(_WIN32)
+		std::ifstream f(file, std::ios::binary | std::ios::ate);
+		if (!f.is_open()) THROW_EXCEPTION_FMT("Cannot open file: '%s'", file.c_str());
+		buf_.resize(static_cast<size_t>(f.tellg()));
+		f.seekg(0);
+		f.read(buf_.data(), buf_.size());
+		data_ = reinterpret_cast<const uint8_t*>(buf_.data());
+		size_ = buf_.size();
+#else
+		const int fd = ::open(file.c_str(), O_RDONLY);
+		if (fd < 0) THROW_EXCEPTION_FMT("Cannot open file: '%s'", file.c_str());
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+		{
+			::close(fd);
+			THROW_EXCEPTION_FMT("Cannot stat file: '%s'", file.c_str());
+		}
+		size_ = static_cast<size_t>(st.st_size);
+
+		if (size_ > 0)
+		{
+			void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+			if (p == MAP_FAILED) THROW_EXCEPTION_FMT("Cannot mmap file: '%s'", file.c_str());
+
+			::madvise(p, size_, MADV_SEQUENTIAL);
+			data_ = static_cast<const uint8_t*>(p);
+		}
+		else
+		{
+			::close(fd);
+		}
+#endif
+	}
+
+	~MappedFile()
+	{
+#if !defined(_WIN32)
+		if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return data_; }
+	size_t size() const { return size_; }
+
+   private:
+	const uint8_t* data_ = nullptr;
+	size_t size_ = 0;
+#if defined(_WIN32)
+	std::vector<char> buf_;
+#endif
+};
+
+// Note: all supported binary formats are little-endian, as all platforms
+// mvsim is built for.
+template <typename T>
+T read_le(const uint8_t* p)
+{
+	T v;
+	std::memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+void reserve_for(mrpt::maps::CPointsMap& out, size_t n, size_t decimation)
+{
+	out.reserve(out.size() + (n + decimation - 1) / decimation);
+}
+
+// PLY scalar types:
+enum class PlyType : uint8_t
+{
+	Int8,
+	UInt8,
+	Int16,
+	UInt16,
+	Int32,
+	UInt32,
+	Float32,
+	Float64
+};
+
+PlyType ply_type_from_string(const std::string& s)
+{
+	if (s == "char" || s == "int8") return PlyType::Int8;
+	if (s == "uchar" || s == "uint8") return PlyType::UInt8;
+	if (s == "short" || s == "int16") return PlyType::Int16;
+	if (s == "ushort" || s == "uint16") return PlyType::UInt16;
+	if (s == "int" || s == "int32") return PlyType::Int32;
+	if (s == "uint" || s == "uint32") return PlyType::UInt32;
+	if (s == "float" || s == "float32") return PlyType::Float32;
+	if (s == "double" || s == "float64") return PlyType::Float64;
+	THROW_EXCEPTION_FMT("Unknown PLY property type: '%s'", s.c_str());
+}
+
+size_t ply_type_size(PlyType t)
+{
+	switch (t)
+	{
+		case PlyType::Int8:
+		case PlyType::UInt8:
+			return 1;
+		case PlyType::Int16:
+		case PlyType::UInt16:
+			return 2;
+		case PlyType::Int32:
+		case PlyType::UInt32:
+		case PlyType::Float32:
+			return 4;
+		case PlyType::Float64:
+			return 8;
+	};
+	return 0;
+}
+
+float ply_read_binary(const uint8_t* p, PlyType t)
+{
+	switch (t)
+	{
+		case PlyType::Int8:
+			return static_cast<float>(read_le<int8_t>(p));
+		case PlyType::UInt8:
+			return static_cast<float>(read_le<uint8_t>(p));
+		case PlyType::Int16:
+			return static_cast<float>(read_le<int16_t>(p));
+		case PlyType::UInt16:
+			return static_cast<float>(read_le<uint16_t>(p));
+		case PlyType::Int32:
+			return static_cast<float>(read_le<int32_t>(p));
+		case PlyType::UInt32:
+			return static_cast<float>(read_le<uint32_t>(p));
+		case PlyType::Float32:
+			return read_le<float>(p);
+		case PlyType::Float64:
+			return static_cast<float>(read_le<double>(p));
+	};
+	return 0;
+}
+
+}  // namespace
+
+void mvsim::load_points_raw_float32(
+	const std::string& file, mrpt::maps::CPointsMap& out, size_t floatsPerPoint, size_t decimation)
+{
+	ASSERT_GE_(floatsPerPoint, 3U);
+	ASSERT_GE_(decimation, 1U);
+
+	const MappedFile f(file);
+
+	const size_t recordSize = floatsPerPoint * sizeof(float);
+	if (f.size() % recordSize != 0)
+	{
+		THROW_EXCEPTION_FMT(
+			"Size of file '%s' (%zu bytes) is not a multiple of the point record size (%zu "
+			"bytes)",
+			file.c_str(), f.size(), recordSize);
+	}
+	const size_t n = f.size() / recordSize;
+
+	reserve_for(out, n, decimation);
+	for (size_t i = 0; i < n; i += decimation)
+	{
+		const uint8_t* p = f.data() + i * recordSize;
+		out.insertPointFast(read_le<float>(p), read_le<float>(p + 4), read_le<float>(p + 8));
+	}
+	out.mark_as_modified();
+}
+
+void mvsim::load_points_ply(
+	const std::string& file, mrpt::maps::CPointsMap& out, size_t decimation)
+{
+	ASSERT_GE_(decimation, 1U);
+
+	const MappedFile f(file);
+	const char* txt = reinterpret_cast<const char*>(f.data());
+
+	// Header:
+	const std::string endHeader = "end_header";
+	size_t headerLen = 0;
+	for (size_t i = 0; i + endHeader.size() < f.size(); i++)
+	{
+		if (std::memcmp(txt + i, endHeader.data(), endHeader.size()) != 0) continue;
+		headerLen = i + endHeader.size();
+		if (headerLen < f.size() && txt[headerLen] == '\r') headerLen++;
+		if (headerLen < f.size() && txt[headerLen] == '\n') headerLen++;
+		break;
+	}
+	if (headerLen == 0 || std::memcmp(txt, "ply", 3) != 0)
+		THROW_EXCEPTION_FMT("Not a valid PLY file: '%s'", file.c_str());
+
+	std::string format;
+	size_t numVertices = 0;
+	bool inVertex = false, vertexSeen = false;
+	std::vector<PlyType> types;
+	int idxX = -1, idxY = -1, idxZ = -1;
+
+	std::istringstream header(std::string(txt, headerLen));
+	for (std::string line; std::getline(header, line);)
+	{
+		std::istringstream ss(line);
+		std::string kw;
+		ss >> kw;
+		if (kw == "format")
+		{
+			ss >> format;
+		}
+		else if (kw == "element")
+		{
+			std::string name;
+			ss >> name;
+			if (name == "vertex")
+			{
+				ss >> numVertices;
+				inVertex = true;
+				vertexSeen = true;
+			}
+			else
+			{
+				if (!vertexSeen)
+					THROW_EXCEPTION_FMT(
+						"PLY file '%s': 'vertex' must be the first element", file.c_str());
+				inVertex = false;
+			}
+		}
+		else if (kw == "property" && inVertex)
+		{
+			std::string type, name;
+			ss >> type >> name;
+			if (type == "list")
+				THROW_EXCEPTION_FMT(
+					"PLY file '%s': list properties in 'vertex' are not supported",
+					file.c_str());
+
+			if (name == "x") idxX = static_cast<int>(types.size());
+			if (name == "y") idxY = static_cast<int>(types.size());
+			if (name == "z") idxZ = static_cast<int>(types.size());
+			types.push_back(ply_type_from_string(type));
+		}
+	}
+
+	if (idxX < 0 || idxY < 0 || idxZ < 0)
+		THROW_EXCEPTION_FMT("PLY file '%s': missing vertex x/y/z properties", file.c_str());
+
+	reserve_for(out, numVertices, decimation);
+
+	if (format == "binary_little_endian")
+	{
+		std::vector<size_t> offsets;
+		size_t recordSize = 0;
+		for (const auto t : types)
+		{
+			offsets.push_back(recordSize);
+			recordSize += ply_type_size(t);
+		}
+
+		if (f.size() < headerLen + numVertices * recordSize)
+			THROW_EXCEPTION_FMT("PLY file '%s' is truncated", file.c_str());
+
+		const uint8_t* data = f.data() + headerLen;
+		for (size_t i = 0; i < numVertices; i += decimation)
+		{
+			const uint8_t* p = data + i * recordSize;
+			out.insertPointFast(
+				ply_read_binary(p + offsets[idxX], types[idxX]),
+				ply_read_binary(p + offsets[idxY], types[idxY]),
+				ply_read_binary(p + offsets[idxZ], types[idxZ]));
+		}
+	}
+	else if (format == "ascii")
+	{
+		size_t pos = headerLen;
+		std::string line;
+		std::vector<float> vals(types.size());
+		for (size_t i = 0; i < numVertices && pos < f.size(); i++)
+		{
+			const size_t start = pos;
+			while (pos < f.size() && txt[pos] != '\n') pos++;
+			const size_t end = pos++;
+
+			if (i % decimation != 0) continue;
+
+			line.assign(txt + start, end - start);
+			const char* s = line.c_str();
+			for (auto& v : vals)
+			{
+				char* next = nullptr;
+				v = std::strtof(s, &next);
+				if (next == s)
+					THROW_EXCEPTION_FMT(
+						"PLY file '%s': malformed vertex #%zu", file.c_str(), i);
+				s = next;
+			}
+			out.insertPointFast(vals[idxX], vals[idxY], vals[idxZ]);
+		}
+	}
+	else
+	{
+		THROW_EXCEPTION_FMT(
+			"PLY file '%s': unsupported format '%s'", file.c_str(), format.c_str());
+	}
+
+	out.mark_as_modified();
+}
+
+mrpt::math::TPoint3D mvsim::load_points_las(
+	const std::string& file, mrpt::maps::CPointsMap& out, size_t decimation)
+{
+	ASSERT_GE_(decimation, 1U);
+
+	const MappedFile f(file);
+	const uint8_t* d = f.data();
+
+	// Public header block, see the ASPRS LAS specification:
+	if (f.size() < 227 || std::memcmp(d, "LASF", 4) != 0)
+		THROW_EXCEPTION_FMT("Not a valid LAS file: '%s'", file.c_str());
+
+	const uint8_t versionMinor = d[25];
+	const auto pointDataOffset = read_le<uint32_t>(d + 96);
+	const uint8_t pointFormat = d[104];
+	const auto recordSize = read_le<uint16_t>(d + 105);
+	uint64_t n = read_le<uint32_t>(d + 107);
+	if (versionMinor >= 4 && f.size() >= 255) n = std::max(n, read_le<uint64_t>(d + 247));
+
+	if (pointFormat & 0x80)
+		THROW_EXCEPTION_FMT(
+			"LAS file '%s': compressed (LAZ) files are not supported", file.c_str());
+
+	const double scale[3] = {
+		read_le<double>(d + 131), read_le<double>(d + 139), read_le<double>(d + 147)};
+	const double offset[3] = {
+		read_le<double>(d + 155), read_le<double>(d + 163), read_le<double>(d + 171)};
+	const double minXYZ[3] = {
+		read_le<double>(d + 187), read_le<double>(d + 203), read_le<double>(d + 219)};
+
+	const bool hasOffset = offset[0] != 0 || offset[1] != 0 || offset[2] != 0;
+	const mrpt::math::TPoint3D origin = hasOffset
+		? mrpt::math::TPoint3D(offset[0], offset[1], offset[2])
+		: mrpt::math::TPoint3D(minXYZ[0], minXYZ[1], minXYZ[2]);
+	const double shift[3] = {offset[0] - origin.x, offset[1] - origin.y, offset[2] - origin.z};
+
+	ASSERT_GE_(recordSize, 12U);
+	if (f.size() < pointDataOffset + n * recordSize)
+		THROW_EXCEPTION_FMT("LAS file '%s' is truncated", file.c_str());
+
+	reserve_for(out, n, decimation);
+	const uint8_t* data = d + pointDataOffset;
+	for (uint64_t i = 0; i < n; i += decimation)
+	{
+		const uint8_t* p = data + i * recordSize;
+		out.insertPointFast(
+			static_cast<float>(read_le<int32_t>(p) * scale[0] + shift[0]),
+			static_cast<float>(read_le<int32_t>(p + 4) * scale[1] + shift[1]),
+			static_cast<float>(read_le<int32_t>(p + 8) * scale[2] + shift[2]));
+	}
+	out.mark_as_modified();
+
+	return origin;
+}
@@ -0,0 +1,48 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#pragma once
+
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TPoint3D.h>
+
+#include <string>
+
+namespace mvsim
+{
+/** \name Loaders of large point clouds from binary files.
+ *
+ * Files are memory-mapped (where supported) and parsed in a single pass.
+ * All loaders append the read points to `out`, keeping only one out of every
+ * `decimation` points. Errors are reported as exceptions.
+ * @{ */
+
+/** Raw little-endian float32 values, `floatsPerPoint` per point (>=3), the
+ * first three being (x,y,z). E.g. floatsPerPoint=4 for KITTI-like files. */
+void load_points_raw_float32(
+	const std::string& file, mrpt::maps::CPointsMap& out, size_t floatsPerPoint = 3,
+	size_t decimation = 1);
+
+/** PLY files, ASCII or binary little-endian, from the "x", "y", "z"
+ * properties of its "vertex" element, which must be the first one. */
+void load_points_ply(const std::string& file, mrpt::maps::CPointsMap& out, size_t decimation = 1);
+
+/** Uncompressed LAS files (versions 1.0 to 1.4, any point data format).
+ *
+ * Since georeferenced coordinates do not fit in float32 without losing
+ * precision, points are stored relative to an origin, computed in double
+ * precision: the header offset or, if it is zero, the bounding box minimum.
+ * \return The origin, to be added to the points to get the file coordinates.
+ */
+mrpt::math::TPoint3D load_points_las(
+	const std::string& file, mrpt::maps::CPointsMap& out, size_t decimation = 1);
+
+/** @} */
+
+}  // namespace mvsim
@@ -7,43 +7,487 @@
   |   See COPYING                                                           |
   +-------------------------------------------------------------------------+ */
 
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/get_env.h>
+#include <mrpt/io/vector_loadsave.h>
+#include <mrpt/system/datetime.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/md5.h>
+#include <mrpt/system/string_utils.h>
 #include <mvsim/RemoteResourcesManager.h>
+#include <zlib.h>
 
+#if defined(MVSIM_HAS_CURL)
+#include <curl/curl.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <future>
+#include <regex>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
 
 using namespace mvsim;
 
-RemoteResourcesManager::RemoteResourcesManager()
-	: mrpt::system::COutputLogger("mvsim::RemoteResourcesManager")
+namespace
+{
+// Inter-process advisory lock on a file next to a cache entry. The OS
+// releases it when the file is closed, including when the process dies, so
+// there are no stale locks. The lock file itself is never deleted, since
+// another process may be already waiting on it.
+class CacheLockFile
+{
+   public:
+	CacheLockFile(const std::string& path, const mrpt::system::COutputLogger& logger)
+	{
+		using namespace std::chrono_literals;
+		constexpr auto LOG_PERIOD = 10s;
+
+		auto nextLog = std::chrono::steady_clock::now();
+		while (!tryLock(path))
+		{
+			if (const auto now = std::chrono::steady_clock::now(); now >= nextLog)
+			{
+				logger.logFmt(
+					mrpt::system::LVL_INFO,
+					"Waiting for another process to release the lock file '%s'...", path.c_str());
+				nextLog = now + LOG_PERIOD;
+			}
+			std::this_thread::sleep_for(100ms);
+		}
+	}
+	~CacheLockFile()
+	{
+#if defined(_WIN32)
+		CloseHandle(handle_);
+#else
+		::close(fd_);  // releases the lock too
+#endif
+	}
+
+	CacheLockFile(const CacheLockFile&) = delete;
+	CacheLockFile& operator=(const CacheLockFile&) = delete;
+
+   private:
+#if defined(_WIN32)
+	HANDLE handle_ = INVALID_HANDLE_VALUE;
+
+	bool tryLock(const std::string& path)
+	{
+		// No sharing: nobody else can open it until we close it.
+		handle_ = CreateFileA(
+			path.c_str(), GENERIC_READ | GENERIC_WRITE, 0 /*share mode*/, nullptr, OPEN_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle_ != INVALID_HANDLE_VALUE) return true;
+		if (GetLastError() == ERROR_SHARING_VIOLATION) return false;
+
+		THROW_EXCEPTION_FMT(
+			"Cannot open lock file '%s' (error %lu)", path.c_str(),
+			static_cast<unsigned long>(GetLastError()));
+	}
+#else
+	int fd_ = -1;
+
+	bool tryLock(const std::string& path)
+	{
+		if (fd_ < 0) fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fd_ < 0)
+			THROW_EXCEPTION_FMT(
+				"Cannot open lock file '%s': %s", path.c_str(), std::strerror(errno));
+
+		if (::flock(fd_, LOCK_EX | LOCK_NB) == 0) return true;
+		if (errno == EWOULDBLOCK || errno == EINTR) return false;
+
+		const int err = errno;
+		::close(fd_);
+		fd_ = -1;
+		THROW_EXCEPTION_FMT("Cannot lock file '%s': %s", path.c_str(), std::strerror(err));
+	}
+#endif
+};
+
+void createDirectories(const std::string& dir)
 {
+	for (size_t pos = dir.find_first_of("/\\", 1); pos != std::string::npos;
+		 pos = dir.find_first_of("/\\", pos + 1))
+	{
+		const auto d = dir.substr(0, pos);
+		if (!mrpt::system::directoryExists(d)) mrpt::system::createDirectory(d);
+	}
+	if (!mrpt::system::directoryExists(dir)) mrpt::system::createDirectory(dir);
+	ASSERT_DIRECTORY_EXISTS_(dir);
 }
 
-bool RemoteResourcesManager::is_remote(const std::string& url)
+std::string md5Prefix(const std::string& s) { return mrpt::system::md5(s).substr(0, 12); }
+
+// Writes to a temporary file and renames it, so other processes never see
+// partially-written files:
+void writeFileAtomically(const std::string& file, const std::vector<uint8_t>& data)
 {
-	return 0 == ::strncmp(url.c_str(), "http://", strlen("http://")) ||
-		   0 == ::strncmp(url.c_str(), "https://", strlen("https://"));
+	const auto tmpFile = file + ".part";
+	if (!mrpt::io::vectorToBinaryFile(data, tmpFile))
+		THROW_EXCEPTION_FMT("Error writing to file '%s'", tmpFile.c_str());
+
+	// Both replace an existing target file in one step:
+#if defined(_WIN32)
+	if (!::MoveFileExA(tmpFile.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING))
+		THROW_EXCEPTION_FMT(
+			"Error renaming '%s' -> '%s' (error %lu)", tmpFile.c_str(), file.c_str(),
+			static_cast<unsigned long>(GetLastError()));
+#else
+	if (std::rename(tmpFile.c_str(), file.c_str()) != 0)
+		THROW_EXCEPTION_FMT(
+			"Error renaming '%s' -> '%s': %s", tmpFile.c_str(), file.c_str(),
+			std::strerror(errno));
+#endif
 }
 
-std::string RemoteResourcesManager::resolve_path(const std::string& uri)
+std::string loadTextFile(const std::string& file)
+{
+	std::vector<uint8_t> data;
+	if (!mrpt::system::fileExists(file) || !mrpt::io::loadBinaryFile(data, file)) return {};
+	return std::string(data.begin(), data.end());
+}
+
+// Identifies the contents of a ZIP package: the MD5 hash of downloaded files
+// is in their ".md5" sidecar file. Local files are not hashed on each access,
+// their size and modification time are used instead.
+std::string zipContentsId(const std::string& zipFile)
+{
+	if (auto md5 = loadTextFile(zipFile + ".md5"); !md5.empty()) return md5;
+
+	return md5Prefix(mrpt::format(
+		"%lu|%.06f", static_cast<unsigned long>(mrpt::system::getFileSize(zipFile)),
+		mrpt::Clock::toDouble(mrpt::system::getFileModificationTime(zipFile))));
+}
+
+// A cache entry is valid if it exists and matches the MD5 hash in its
+// ".md5" sidecar file, which is written last.
+bool isValidCacheEntry(const std::string& file)
+{
+	const auto md5File = file + ".md5";
+	if (!mrpt::system::fileExists(file) || !mrpt::system::fileExists(md5File)) return false;
+
+	std::vector<uint8_t> data, storedMd5;
+	if (!mrpt::io::loadBinaryFile(data, file) || !mrpt::io::loadBinaryFile(storedMd5, md5File))
+		return false;
+
+	return mrpt::system::md5(data) == std::string(storedMd5.begin(), storedMd5.end());
+}
+
+void writeCacheEntry(const std::string& file, const std::vector<uint8_t>& data)
+{
+	const auto md5 = mrpt::system::md5(data);
+	writeFileAtomically(file, data);
+	writeFileAtomically(file + ".md5", std::vector<uint8_t>(md5.begin(), md5.end()));
+}
+
+#if defined(MVSIM_HAS_CURL)
+size_t curlWriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata)
+{
+	auto& out = *reinterpret_cast<std::vector<uint8_t>*>(userdata);
+	out.insert(out.end(), ptr, ptr + size * nmemb);
+	return size * nmemb;
+}
+#endif
+
+std::vector<uint8_t> downloadUrl(const std::string& url)
+{
+	std::vector<uint8_t> data;
+
+	if (url.substr(0, 7) == "file://")
+	{
+		const auto localFile = url.substr(7);
+		if (!mrpt::io::loadBinaryFile(data, localFile))
+			THROW_EXCEPTION_FMT("Error reading file '%s'", localFile.c_str());
+		return data;
+	}
+
+#if defined(MVSIM_HAS_CURL)
+	static std::once_flag curlInit;
+	std::call_once(curlInit, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+	CURL* curl = curl_easy_init();
+	ASSERTMSG_(curl, "curl_easy_init() failed");
+
+	char errBuf[CURL_ERROR_SIZE] = {0};
+	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+	curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);  // required for multithreading
+	// Give up on unreachable servers and stalled transfers, instead of
+	// blocking the world loading forever:
+	curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+	curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);  // bytes/s...
+	curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 60L);  // ...during this many seconds
+	curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errBuf);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &curlWriteCallback);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &data);
+
+	const CURLcode ret = curl_easy_perform(curl);
+	curl_easy_cleanup(curl);
+
+	if (ret != CURLE_OK)
+		THROW_EXCEPTION_FMT(
+			"[mvsim] Error downloading '%s': %s", url.c_str(),
+			errBuf[0] ? errBuf : curl_easy_strerror(ret));
+#else
+	// No libcurl at build time: use wget instead.
+	const auto tmpFile = mrpt::system::getTempFileName();
+	const auto cmd = mrpt::format(
+		"wget -q --connect-timeout=30 --read-timeout=60 --tries=2 -O \"%s\" \"%s\"",
+		tmpFile.c_str(), url.c_str());
+
+	const int ret = ::system(cmd.c_str());
+	const bool readOk = ret == 0 && mrpt::io::loadBinaryFile(data, tmpFile);
+	mrpt::system::deleteFile(tmpFile);
+
+	if (!readOk)
+		THROW_EXCEPTION_FMT(
+			"[mvsim] Error (code=%i) executing the following command "
+			"trying to acquire a remote resource:\n%s",
+			ret, cmd.c_str());
+#endif
+
+	return data;
+}
+
+// ----------------- ZIP packages -----------------
+uint16_t rd16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+uint32_t rd32(const uint8_t* p) { return rd16(p) | (static_cast<uint32_t>(rd16(p + 2)) << 16); }
+
+struct ZipEntry
+{
+	std::string name;
+	uint16_t flags = 0, method = 0;
+	uint32_t crc = 0, compressedSize = 0, size = 0, localHeaderOffset = 0;
+};
+
+std::vector<ZipEntry> zipCentralDirectory(
+	const std::vector<uint8_t>& z, const std::string& zipFile)
+{
+	// The "end of central directory" record is at the end, only followed by
+	// an optional comment of up to 64 KiB:
+	constexpr size_t EOCD_SIZE = 22;
+	if (z.size() < EOCD_SIZE) THROW_EXCEPTION_FMT("'%s' is not a ZIP file", zipFile.c_str());
+
+	const size_t minPos = z.size() > EOCD_SIZE + 0xFFFF ? z.size() - EOCD_SIZE - 0xFFFF : 0;
+	size_t eocd = std::string::npos;
+	for (size_t i = z.size() - EOCD_SIZE + 1; i-- > minPos;)
+	{
+		if (rd32(z.data() + i) == 0x06054b50)
+		{
+			eocd = i;
+			break;
+		}
+	}
+	if (eocd == std::string::npos)
+		THROW_EXCEPTION_FMT("'%s' is not a ZIP file", zipFile.c_str());
+
+	const uint16_t numEntries = rd16(z.data() + eocd + 10);
+	const uint32_t cdOffset = rd32(z.data() + eocd + 16);
+	if (numEntries == 0xFFFF || cdOffset == 0xFFFFFFFF)
+		THROW_EXCEPTION_FMT("ZIP64 package '%s' is not supported", zipFile.c_str());
+
+	std::vector<ZipEntry> entries;
+	size_t p = cdOffset;
+	for (unsigned int i = 0; i < numEntries; i++)
+	{
+		if (p + 46 > z.size() || rd32(z.data() + p) != 0x02014b50)
+			THROW_EXCEPTION_FMT("Corrupted ZIP package '%s'", zipFile.c_str());
+
+		ZipEntry e;
+		e.flags = rd16(z.data() + p + 8);
+		e.method = rd16(z.data() + p + 10);
+		e.crc = rd32(z.data() + p + 16);
+		e.compressedSize = rd32(z.data() + p + 20);
+		e.size = rd32(z.data() + p + 24);
+		const size_t nameLen = rd16(z.data() + p + 28);
+		const size_t extraLen = rd16(z.data() + p + 30);
+		const size_t commentLen = rd16(z.data() + p + 32);
+		e.localHeaderOffset = rd32(z.data() + p + 42);
+
+		if (p + 46 + nameLen > z.size())
+			THROW_EXCEPTION_FMT("Corrupted ZIP package '%s'", zipFile.c_str());
+		e.name.assign(reinterpret_cast<const char*>(z.data() + p + 46), nameLen);
+
+		entries.push_back(std::move(e));
+		p += 46 + nameLen + extraLen + commentLen;
+	}
+	return entries;
+}
+
+std::vector<uint8_t> zipExtract(
+	const std::vector<uint8_t>& z, const ZipEntry& e, const std::string& zipFile)
 {
-	if (is_remote(uri))
+	if (e.flags & 0x01)
+		THROW_EXCEPTION_FMT(
+			"Encrypted member '%s' in '%s' is not supported", e.name.c_str(), zipFile.c_str());
+
+	const size_t lh = e.localHeaderOffset;
+	if (lh + 30 > z.size() || rd32(z.data() + lh) != 0x04034b50)
+		THROW_EXCEPTION_FMT("Corrupted ZIP package '%s'", zipFile.c_str());
+
+	const size_t dataStart = lh + 30 + rd16(z.data() + lh + 26) + rd16(z.data() + lh + 28);
+	if (dataStart + e.compressedSize > z.size())
+		THROW_EXCEPTION_FMT("Corrupted ZIP package '%s'", zipFile.c_str());
+
+	std::vector<uint8_t> out(e.size);
+
+	if (e.method == 0)	// stored
 	{
-		return handle_remote_uri(uri);
+		if (e.compressedSize != e.size)
+			THROW_EXCEPTION_FMT("Corrupted ZIP package '%s'", zipFile.c_str());
+		if (e.size) std::memcpy(out.data(), z.data() + dataStart, e.size);
 	}
-	else if (uri.substr(0, 7) == "file://")
+	else if (e.method == 8)	 // deflate
 	{
-		return uri.substr(7);
+		if (e.size)
+		{
+			z_stream strm{};
+			if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) THROW_EXCEPTION("inflateInit2() failed");
+
+			strm.next_in = const_cast<Bytef*>(z.data() + dataStart);
+			strm.avail_in = static_cast<uInt>(e.compressedSize);
+			strm.next_out = out.data();
+			strm.avail_out = static_cast<uInt>(e.size);
+
+			const int ret = inflate(&strm, Z_FINISH);
+			const auto produced = strm.total_out;
+			inflateEnd(&strm);
+
+			if (ret != Z_STREAM_END || produced != e.size)
+				THROW_EXCEPTION_FMT(
+					"Error decompressing '%s' in '%s'", e.name.c_str(), zipFile.c_str());
+		}
 	}
 	else
 	{
-		return uri;
+		THROW_EXCEPTION_FMT(
+			"Unsupported compression method (%u) for '%s' in '%s'",
+			static_cast<unsigned>(e.method), e.name.c_str(), zipFile.c_str());
+	}
+
+	if (crc32(0L, out.data(), static_cast<uInt>(out.size())) != e.crc)
+		THROW_EXCEPTION_FMT("CRC error in '%s' in '%s'", e.name.c_str(), zipFile.c_str());
+
+	return out;
+}
+
+// Rejects members that would be written outside of the output directory:
+void checkSafeMemberName(const std::string& name, const std::string& zipFile)
+{
+	const bool unsafe = name.empty() || name[0] == '/' || name[0] == '\\' ||
+						name.find(':') != std::string::npos || name == ".." ||
+						name.compare(0, 3, "../") == 0 ||
+						name.find("/../") != std::string::npos ||
+						(name.size() >= 3 && name.compare(name.size() - 3, 3, "/..") == 0);
+	if (unsafe)
+		THROW_EXCEPTION_FMT(
+			"Refusing to extract member '%s' from '%s'", name.c_str(), zipFile.c_str());
+}
+
+std::vector<uint8_t> loadZipFile(const std::string& zipFile)
+{
+	std::vector<uint8_t> z;
+	if (!mrpt::io::loadBinaryFile(z, zipFile))
+		THROW_EXCEPTION_FMT("Error reading ZIP package '%s'", zipFile.c_str());
+	return z;
+}
+
+void findRemoteUris(
+	const std::string& xmlText, const std::string& basePath, std::set<std::string>& visitedFiles,
+	std::vector<std::string>& uris)
+{
+	static const std::regex reModel(R"(<model_uri>\s*(https?://[^<\s]+)\s*</model_uri>)");
+	static const std::regex reInclude(R"(<include\s[^>]*\bfile\s*=\s*["']([^"']+)["'])");
+
+	// Skip URIs and paths with variables, which are only known after parsing:
+	const auto hasVariables = [](const std::string& s) { return s.find('$') != std::string::npos; };
+
+	for (auto it = std::sregex_iterator(xmlText.begin(), xmlText.end(), reModel);
+		 it != std::sregex_iterator(); ++it)
+	{
+		if (const auto uri = (*it)[1].str(); !hasVariables(uri)) uris.push_back(uri);
 	}
+
+	if (basePath.empty()) return;
+
+	for (auto it = std::sregex_iterator(xmlText.begin(), xmlText.end(), reInclude);
+		 it != std::sregex_iterator(); ++it)
+	{
+		const auto relFile = mrpt::system::trim((*it)[1].str());
+		if (relFile.empty() || hasVariables(relFile)) continue;
+
+		const bool isAbsolute = relFile[0] == '/' || relFile[0] == '\\' ||
+								(relFile.size() > 2 && relFile[1] == ':');
+		const auto path = isAbsolute ? relFile : mrpt::system::pathJoin({basePath, relFile});
+		if (!mrpt::system::fileExists(path)) continue;
+
+		// Each file only once, which also breaks recursive includes:
+		const auto file = mrpt::system::toAbsolutePath(path, true /*canonical*/);
+		if (!visitedFiles.insert(file).second) continue;
+
+		findRemoteUris(
+			mrpt::io::file_get_contents(file), mrpt::system::extractFileDirectory(file),
+			visitedFiles, uris);
+	}
+}
+}  // namespace
+
+RemoteResourcesManager::RemoteResourcesManager()
+	: mrpt::system::COutputLogger("mvsim::RemoteResourcesManager")
+{
+}
+
+bool RemoteResourcesManager::is_remote(const std::string& url)
+{
+	return 0 == ::strncmp(url.c_str(), "http://", strlen("http://")) ||
+		   0 == ::strncmp(url.c_str(), "https://", strlen("https://"));
+}
+
+std::string RemoteResourcesManager::resolve_path(const std::string& uri)
+{
+	if (is_remote(uri)) return handle_remote_uri(uri);
+
+	const auto localPath = uri.substr(0, 7) == "file://" ? uri.substr(7) : uri;
+
+	const auto [isZipPkg, zipFile, internalURI] = zip_uri_split(localPath);
+	if (!isZipPkg || !mrpt::system::fileExists(zipFile)) return localPath;
+
+	// Local ZIP package: extract into the cache directory. Its size and
+	// modification time are part of the name, to notice changes:
+	const auto id = md5Prefix(mrpt::format(
+		"%s|%lu|%.06f", zipFile.c_str(),
+		static_cast<unsigned long>(mrpt::system::getFileSize(zipFile)),
+		mrpt::Clock::toDouble(mrpt::system::getFileModificationTime(zipFile))));
+
+	const auto zipOutDir =
+		cache_directory() + id + "_" + mrpt::system::extractFileName(zipFile) + ".out";
+
+	return handle_local_zip_package(zipFile, internalURI, zipOutDir);
 }
 
 std::string RemoteResourcesManager::cache_directory()
 {
+	if (const auto dir = mrpt::get_env<std::string>("MVSIM_STORAGE_DIR"); !dir.empty())
+		return (dir.back() == '/' || dir.back() == '\\') ? dir : dir + "/";
+
 	std::string local_directory;
 #ifdef _WIN32
 	local_directory = std::getenv("APPDATA");
@@ -70,70 +514,67 @@ std::tuple<bool, std::string, std::string> RemoteResourcesManager::zip_uri_split
 	return {true, zipUri, internalUri};
 }
 
-std::string RemoteResourcesManager::handle_remote_uri(const std::string& uri)
+std::shared_ptr<std::mutex> RemoteResourcesManager::entry_lock(const std::string& localPath)
+{
+	std::lock_guard<std::mutex> lck(entriesMtx_);
+	auto& m = entryLocks_[localPath];
+	if (!m) m = std::make_shared<std::mutex>();
+	return m;
+}
+
+std::string RemoteResourcesManager::fetch_to_cache(const std::string& url)
 {
 	using namespace std::string_literals;
 
 	const auto localDir = cache_directory();
-	std::string cacheUsageStats;
+	createDirectories(localDir);
+	MRPT_LOG_ONCE_INFO("Using local storage directory: '"s + localDir + "'"s);
 
-	if (!mrpt::system::directoryExists(localDir))
+	// The URL hash avoids collisions between files with the same name:
+	const auto fileName = mrpt::system::extractFileName(url) + "." +
+						  mrpt::system::extractFileExtension(url);
+	const auto localFil = localDir + md5Prefix(url) + "_" + fileName;
+
+	auto mtx = entry_lock(localFil);
+	std::lock_guard<std::mutex> lck(*mtx);
 	{
-#ifdef _WIN32
-		mrpt::system::createDirectory(localDir);
-#else
-		const auto cmd = "mkdir -p \""s + localDir + "\""s;
-		if (int ret = ::system(cmd.c_str()); ret != 0)
-		{
-			MRPT_LOG_ERROR_STREAM("Error executing command: " << cmd);
-		}
-#endif
-		ASSERT_DIRECTORY_EXISTS_(localDir);
+		std::lock_guard<std::mutex> lck2(entriesMtx_);
+		if (verifiedEntries_.count(localFil)) return localFil;
 	}
-	else
+
 	{
-		// get usage stats:
-		if (0 == mrpt::system::executeCommand(
-					 mrpt::format("du -sh0 \"%s\"", localDir.c_str()), &cacheUsageStats))
+		// Another process may be downloading it right now:
+		CacheLockFile lockFile(localFil + ".lock", *this);
+
+		if (!isValidCacheEntry(localFil))
 		{
-			// usage stats are valid.
+			MRPT_LOG_INFO_STREAM("Downloading remote resources from: '" << url << "'");
+			writeCacheEntry(localFil, downloadUrl(url));
 		}
 	}
-	MRPT_LOG_ONCE_INFO(
-		"Using local storage directory: '"s + localDir + "' (Usage: "s + cacheUsageStats + ")"s);
 
+	std::lock_guard<std::mutex> lck2(entriesMtx_);
+	verifiedEntries_.insert(localFil);
+
+	return localFil;
+}
+
+std::string RemoteResourcesManager::handle_remote_uri(const std::string& uri)
+{
 	const auto [isZipPkg, zipOrFileURI, internalURI] = zip_uri_split(uri);
 
 	MRPT_LOG_DEBUG_STREAM(
 		"Split URI: isZipPkg=" << isZipPkg << " zipOrFileURI=" << zipOrFileURI
 							   << " internalURI=" << internalURI);
 
-	const auto fileName = mrpt::system::extractFileName(zipOrFileURI) + "." +
-						  mrpt::system::extractFileExtension(zipOrFileURI);
-	const auto localFil = localDir + fileName;
-
-	// Download if it does not exist already from a past download:
-	if (!mrpt::system::fileExists(localFil))
-	{
-		const auto cmd =
-			mrpt::format("wget -q -O \"%s\" %s", localFil.c_str(), zipOrFileURI.c_str());
-
-		MRPT_LOG_INFO_STREAM("Downloading remote resources from: '" << uri << "'");
-
-		if (int ret = ::system(cmd.c_str()); ret != 0)
-		{
-			THROW_EXCEPTION_FMT(
-				"[mvsim] Error (code=%i)  executing the following command "
-				"trying to acquire a remote resource:\n%s",
-				ret, cmd.c_str());
-		}
-	}
+	const auto localFil = fetch_to_cache(zipOrFileURI);
 
 	// Is it a simple model file, or a zip?
 	if (isZipPkg)
 	{
 		// process the ZIP package:
-		return handle_local_zip_package(localFil, internalURI);
+		return handle_local_zip_package(
+			localFil, internalURI, mrpt::system::fileNameChangeExtension(localFil, "out"));
 	}
 	else
 	{
@@ -143,33 +584,123 @@ std::string RemoteResourcesManager::handle_remote_uri(const std::string& uri)
 }
 
 std::string RemoteResourcesManager::handle_local_zip_package(
-	const std::string& localZipFil, const std::string& internalURI)
+	const std::string& localZipFil, const std::string& internalURI, const std::string& zipOutDir)
 {
-	using namespace std::string_literals;
-
 	ASSERT_FILE_EXISTS_(localZipFil);
 
 	const auto filExtension = mrpt::system::extractFileExtension(localZipFil);
 	ASSERT_EQUAL_(filExtension, "zip");
 
+	checkSafeMemberName(internalURI, localZipFil);
+
+	// Models usually refer to textures and other files next to them, so the
+	// whole directory of the member is extracted:
+	const auto slashPos = internalURI.rfind('/');
+	const auto memberDir =
+		slashPos == std::string::npos ? std::string() : internalURI.substr(0, slashPos + 1);
+
+	const auto outFile = zipOutDir + "/" + internalURI;
+	// Written after all files are extracted, with the ID of the ZIP contents,
+	// so a ZIP downloaded again is extracted again:
+	const auto marker = zipOutDir + "/.extracted_" + md5Prefix(memberDir);
+	const auto zipId = zipContentsId(localZipFil);
+
+	auto mtx = entry_lock(marker);
+	std::lock_guard<std::mutex> lck(*mtx);
+
+	const auto isExtracted = [&]()
+	{ return mrpt::system::fileExists(outFile) && loadTextFile(marker) == zipId; };
+
 	// already decompressed?
-	const auto zipOutDir = mrpt::system::fileNameChangeExtension(localZipFil, "out");
+	if (isExtracted()) return outFile;
 
-	if (!mrpt::system::directoryExists(zipOutDir))
+	createDirectories(zipOutDir);
+	CacheLockFile lockFile(marker + ".lock", *this);
+
+	if (isExtracted()) return outFile;
+
+	const auto z = loadZipFile(localZipFil);
+	bool found = false;
+
+	for (const auto& e : zipCentralDirectory(z, localZipFil))
 	{
-		mrpt::system::createDirectory(zipOutDir);
-		ASSERT_DIRECTORY_EXISTS_(zipOutDir);
+		if (e.name.compare(0, memberDir.size(), memberDir) != 0) continue;
+		if (e.name.empty() || e.name.back() == '/') continue;  // directory entries
 
-		const std::string cmd = "unzip -q \""s + localZipFil + "\" -d \""s + zipOutDir + "\""s;
+		checkSafeMemberName(e.name, localZipFil);
+		if (e.name == internalURI) found = true;
 
-		if (int ret = ::system(cmd.c_str()); ret != 0)
-		{
-			THROW_EXCEPTION_FMT(
-				"[mvsim] Error (code=%i) executing the following command "
-				"trying to unzip a remote resource:\n%s",
-				ret, cmd.c_str());
-		}
+		const auto dstFile = zipOutDir + "/" + e.name;
+		createDirectories(mrpt::system::extractFileDirectory(dstFile));
+		writeFileAtomically(dstFile, zipExtract(z, e, localZipFil));
+	}
+
+	if (!found)
+		THROW_EXCEPTION_FMT(
+			"File '%s' not found in ZIP package '%s'", internalURI.c_str(), localZipFil.c_str());
+
+	writeFileAtomically(marker, std::vector<uint8_t>(zipId.begin(), zipId.end()));
+
+	return outFile;
+}
+
+void RemoteResourcesManager::prefetch(const std::vector<std::string>& uris)
+{
+	// Unique remote files or packages:
+	std::set<std::string> urls;
+	for (const auto& uri : uris)
+		if (is_remote(uri)) urls.insert(std::get<1>(zip_uri_split(uri)));
+
+	if (urls.empty()) return;
+
+	constexpr size_t MAX_PARALLEL_DOWNLOADS = 8;
+	mrpt::WorkerThreadsPool pool(
+		std::min(urls.size(), MAX_PARALLEL_DOWNLOADS), mrpt::WorkerThreadsPool::POLICY_FIFO,
+		"mvsim_fetch");
+
+	std::vector<std::future<void>> tasks;
+	for (const auto& url : urls)
+	{
+		tasks.emplace_back(pool.enqueue(
+			[this, url]()
+			{
+				try
+				{
+					fetch_to_cache(url);
+				}
+				catch (const std::exception& e)
+				{
+					MRPT_LOG_WARN_STREAM("Error prefetching '" << url << "':\n" << e.what());
+				}
+			}));
 	}
+	for (auto& t : tasks) t.get();
+}
 
-	return zipOutDir + "/"s + internalURI;
+std::vector<std::string> RemoteResourcesManager::find_remote_uris(
+	const std::string& xmlText, const std::string& basePath)
+{
+	std::set<std::string> visitedFiles;
+	std::vector<std::string> uris;
+	findRemoteUris(xmlText, basePath, visitedFiles, uris);
+	return uris;
+}
+
+std::vector<uint8_t> RemoteResourcesManager::zip_read_member(
+	const std::string& zipFile, const std::string& memberName)
+{
+	const auto z = loadZipFile(zipFile);
+	for (const auto& e : zipCentralDirectory(z, zipFile))
+		if (e.name == memberName) return zipExtract(z, e, zipFile);
+
+	THROW_EXCEPTION_FMT(
+		"File '%s' not found in ZIP package '%s'", memberName.c_str(), zipFile.c_str());
+}
+
+std::vector<std::string> RemoteResourcesManager::zip_list_members(const std::string& zipFile)
+{
+	std::vector<std::string> names;
+	for (const auto& e : zipCentralDirectory(loadZipFile(zipFile), zipFile))
+		names.push_back(e.name);
+	return names;
 }
@@ -0,0 +1,353 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/opengl/CFrustum.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/stock_objects.h>
+#include <mrpt/version.h>
+#include <mvsim/Sensors/CameraRig.h>
+#include <mvsim/VehicleBase.h>
+#include <mvsim/World.h>
+
+#include <algorithm>
+
+#include "xml_utils.h"
+
+using namespace mvsim;
+using namespace rapidxml;
+
+CameraRig::CameraRig(Simulable& parent, const rapidxml::xml_node<char>* root) : SensorBase(parent)
+{
+	this->loadConfigFrom(root);
+}
+
+CameraRig::~CameraRig() {}
+
+void CameraRig::loadConfigFrom(const rapidxml::xml_node<char>* root)
+{
+	gui_uptodate_ = false;
+
+	SensorBase::loadConfigFrom(root);
+	SensorBase::make_sure_we_have_a_name("camera_rig");
+
+	fbo_renderer_.reset();
+	rigScene_.reset();
+	cpu_rasterizer_.reset();
+	views_.clear();
+
+	rigPose_ = mrpt::poses::CPose3D(0, 0, 0.5, 0, 0, 0);
+
+	TParameterDefinitions params;
+	params["pose_3d"] = TParamEntry("%pose3d", &rigPose_);
+	params["cpu_rasterizer"] = TParamEntry("%bool", &use_cpu_rasterizer_);
+	params["cpu_rasterizer_threads"] = TParamEntry("%u", &cpu_rasterizer_threads_);
+
+	// Parse XML params:
+	parse_xmlnode_children_as_param(*root, params, varValues_);
+
+	// One view per <camera> entry:
+	for (auto n = root->first_node("camera"); n; n = n->next_sibling("camera"))
+	{
+		View& v = views_.emplace_back();
+
+		using namespace mrpt;  // _deg
+		v.poseOnRig = mrpt::poses::CPose3D(0, 0, 0, -90.0_deg, 0, -90.0_deg);
+
+		// Default values, same than CameraSensor:
+		auto& c = v.params.cameraParams;
+		c.ncols = 640;
+		c.nrows = 480;
+		c.cx(c.ncols / 2);
+		c.cy(c.nrows / 2);
+		c.fx(500);
+		c.fy(500);
+
+		TParameterDefinitions camParams;
+		camParams["pose_3d"] = TParamEntry("%pose3d", &v.poseOnRig);
+		camParams["cx"] = TParamEntry("%lf", &c.intrinsicParams(0, 2));
+		camParams["cy"] = TParamEntry("%lf", &c.intrinsicParams(1, 2));
+		camParams["fx"] = TParamEntry("%lf", &c.intrinsicParams(0, 0));
+		camParams["fy"] = TParamEntry("%lf", &c.intrinsicParams(1, 1));
+
+		unsigned int ncols = c.ncols, nrows = c.nrows;
+		camParams["ncols"] = TParamEntry("%u", &ncols);
+		camParams["nrows"] = TParamEntry("%u", &nrows);
+
+		camParams["clip_min"] = TParamEntry("%f", &v.clipMin);
+		camParams["clip_max"] = TParamEntry("%f", &v.clipMax);
+
+		parse_xmlnode_children_as_param(*n, camParams, varValues_);
+
+		c.ncols = ncols;
+		c.nrows = nrows;
+
+		// Each view is published with its own label:
+		if (const auto nameAttr = n->first_attribute("name"); nameAttr && nameAttr->value())
+			v.params.sensorLabel = nameAttr->value();
+		else
+			v.params.sensorLabel = mrpt::format("%s_cam%zu", name_.c_str(), views_.size() - 1);
+	}
+
+	if (views_.empty())
+		THROW_EXCEPTION_FMT(
+			"camera_rig '%s': at least one <camera> entry is required", name_.c_str());
+
+	// Lay out all views side by side in one render target:
+	atlasWidth_ = 0;
+	atlasHeight_ = 0;
+	for (auto& v : views_)
+	{
+		v.atlasX = atlasWidth_;
+		atlasWidth_ += v.params.cameraParams.ncols;
+		atlasHeight_ = std::max<uint32_t>(atlasHeight_, v.params.cameraParams.nrows);
+	}
+
+	last_obs_.assign(views_.size(), {});
+}
+
+void CameraRig::internalGuiUpdate(
+	const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
+	[[maybe_unused]] const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& physical,
+	[[maybe_unused]] bool childrenOnly)
+{
+	if (!gl_sensor_origin_ && viz)
+	{
+		gl_sensor_origin_ = mrpt::opengl::CSetOfObjects::Create();
+#if MRPT_VERSION >= 0x270
+		gl_sensor_origin_->castShadows(false);
+#endif
+		gl_sensor_origin_corner_ = mrpt::opengl::stock_objects::CornerXYZSimple(0.15f);
+
+		gl_sensor_origin_->insert(gl_sensor_origin_corner_);
+
+		gl_sensor_origin_->setVisibility(false);
+		viz->get().insert(gl_sensor_origin_);
+		SensorBase::RegisterSensorOriginViz(gl_sensor_origin_);
+	}
+	if (!gl_sensor_fov_ && viz)
+	{
+		gl_sensor_fov_ = mrpt::opengl::CSetOfObjects::Create();
+		gl_sensor_fov_->setVisibility(false);
+		viz->get().insert(gl_sensor_fov_);
+		SensorBase::RegisterSensorFOVViz(gl_sensor_fov_);
+	}
+
+	if (!gui_uptodate_)
+	{
+		{
+			std::lock_guard<std::mutex> csl(last_obs_cs_);
+
+			if (!gl_sensor_frustums_)
+			{
+				// One frustum per view:
+				gl_sensor_frustums_ = mrpt::opengl::CSetOfObjects::Create();
+
+				const float frustumScale = 0.4e-3;
+				for (const auto& v : views_)
+				{
+					auto f = mrpt::opengl::CSetOfObjects::Create();
+					f->insert(mrpt::opengl::CFrustum::Create(v.params.cameraParams, frustumScale));
+					gl_sensor_frustums_->insert(f);
+				}
+				gl_sensor_fov_->insert(gl_sensor_frustums_);
+			}
+
+			gl_sensor_origin_corner_->setPose(rigPose_);
+
+			using namespace mrpt;  // _deg
+			const auto opticalToFrustum =
+				-mrpt::poses::CPose3D::FromYawPitchRoll(-90.0_deg, 0.0_deg, -90.0_deg);
+
+			auto itFrustum = gl_sensor_frustums_->begin();
+			for (size_t i = 0; i < views_.size(); i++, ++itFrustum)
+				(*itFrustum)->setPose(rigPose_ + views_[i].poseOnRig + opticalToFrustum);
+		}
+		gui_uptodate_ = true;
+	}
+
+	// Move with vehicle:
+	const auto& p = vehicle_.getPose();
+
+	gl_sensor_fov_->setPose(p);
+	gl_sensor_origin_->setPose(p);
+
+	if (glCustomVisual_) glCustomVisual_->setPose(sensorGlobalPose(rigPose_));
+}
+
+void CameraRig::simul_pre_timestep([[maybe_unused]] const TSimulContext& context) {}
+
+void CameraRig::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
+{
+	{
+		auto lckHasTo = mrpt::lockHelper(has_to_render_mtx_);
+		if (!has_to_render_.has_value()) return;
+	}
+
+	auto tleWhole = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGB.rig");
+
+	if (glCustomVisual_) glCustomVisual_->setVisibility(false);
+
+	const auto now = world_->get_simul_timestamp();
+
+	// Make copies of the pattern observations, all with the same timestamp:
+	std::vector<mrpt::obs::CObservationImage::Ptr> curObs(views_.size());
+	std::vector<mrpt::poses::CPose3D> globalPoses(views_.size());
+	for (size_t i = 0; i < views_.size(); i++)
+	{
+		auto& v = views_[i];
+		curObs[i] = v.obsPool.get(v.params);
+		curObs[i]->timestamp = now;
+		curObs[i]->cameraPose = rigPose_ + v.poseOnRig;
+		globalPoses[i] = sensorGlobalPose(curObs[i]->cameraPose);
+	}
+
+	if (use_cpu_rasterizer_)
+	{
+		if (!cpu_rasterizer_)
+			cpu_rasterizer_ = std::make_unique<CpuRasterizer>(cpu_rasterizer_threads_);
+
+		auto tle2 = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGB.render");
+
+		// The scene is collected once, then shared by all views:
+		cpu_rasterizer_->updateScene(world3DScene);
+		for (size_t i = 0; i < views_.size(); i++)
+		{
+			const auto& v = views_[i];
+			cpu_rasterizer_->render_RGB(
+				globalPoses[i], v.params.cameraParams, v.clipMin, v.clipMax, curObs[i]->image);
+		}
+	}
+	else
+	{
+		internal_render_with_fbo(world3DScene, curObs, globalPoses);
+	}
+
+	// Store generated obs:
+	{
+		std::lock_guard<std::mutex> csl(last_obs_cs_);
+		last_obs_ = curObs;
+	}
+
+	{
+		auto lckHasTo = mrpt::lockHelper(has_to_render_mtx_);
+		for (const auto& o : curObs) SensorBase::reportNewObservation(o, *has_to_render_);
+
+		if (glCustomVisual_) glCustomVisual_->setVisibility(true);
+
+		gui_uptodate_ = false;
+		has_to_render_.reset();
+	}
+}
+
+void CameraRig::internal_render_with_fbo(
+	mrpt::opengl::COpenGLScene& world3DScene,
+	const std::vector<mrpt::obs::CObservationImage::Ptr>& obs,
+	const std::vector<mrpt::poses::CPose3D>& globalPoses)
+{
+	// Create FBO on first use, now that we are here at the GUI / OpenGL thread.
+	if (!fbo_renderer_)
+	{
+		mrpt::opengl::CFBORender::Parameters p;
+		p.width = atlasWidth_;
+		p.height = atlasHeight_;
+		p.create_EGL_context = world()->sensor_has_to_create_egl_context();
+
+		fbo_renderer_ = std::make_shared<mrpt::opengl::CFBORender>(p);
+	}
+
+	// Viewport "main" is view #0, the rest are clones of it with their own
+	// camera, so all of them draw the same objects:
+	if (!rigScene_)
+	{
+		rigScene_ = mrpt::opengl::COpenGLScene::Create();
+		for (size_t i = 1; i < views_.size(); i++)
+		{
+			auto vp = rigScene_->createViewport(mrpt::format("view%u", static_cast<unsigned>(i)));
+			vp->setCloneView("main");
+		}
+	}
+
+	// Share (do not copy) the objects of the world, updated every frame since
+	// they may have been added or removed:
+	auto worldViewport = world3DScene.getViewport();
+	auto mainViewport = rigScene_->getViewport();
+	mainViewport->clear();
+	for (const auto& o : *worldViewport) mainViewport->insert(o);
+
+	for (size_t i = 0; i < views_.size(); i++)
+	{
+		const auto& v = views_[i];
+		const auto& c = v.params.cameraParams;
+
+		auto vp = mainViewport;
+		if (i != 0) vp = rigScene_->getViewport(mrpt::format("view%u", static_cast<unsigned>(i)));
+
+		// Fractional coordinates (pixel values are ambiguous for 1-pixel sizes).
+		// OpenGL viewports are bottom-up, so views are aligned to the bottom:
+		vp->setViewportPosition(
+			double(v.atlasX) / atlasWidth_, 0.0, double(c.ncols) / atlasWidth_,
+			double(c.nrows) / atlasHeight_);
+		vp->setViewportClipDistances(v.clipMin, v.clipMax);
+		vp->lightParameters() = worldViewport->lightParameters();
+		vp->setCustomBackgroundColor(worldViewport->getCustomBackgroundColor());
+
+		auto& cam = vp->getCamera();
+		cam.set6DOFMode(true);
+		cam.setProjectiveFromPinhole(c);
+		cam.setPose(globalPoses[i]);
+	}
+
+	{
+		auto tle2 = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGB.render");
+		fbo_renderer_->render_RGB(*rigScene_, atlas_);
+	}
+
+	// Split the render target into the individual images
+	// (image rows are top-down, so views are at the bottom rows):
+	for (size_t i = 0; i < views_.size(); i++)
+	{
+		const auto& v = views_[i];
+		const auto& c = v.params.cameraParams;
+		atlas_.extract_patch(obs[i]->image, v.atlasX, atlasHeight_ - c.nrows, c.ncols, c.nrows);
+	}
+
+	// Do not keep references to world objects:
+	mainViewport->clear();
+}
+
+// Simulate sensor AFTER timestep, with the updated vehicle dynamical state:
+void CameraRig::simul_post_timestep(const TSimulContext& context)
+{
+	Simulable::simul_post_timestep(context);
+	if (SensorBase::should_simulate_sensor(context))
+	{
+		has_to_render_ = context;
+		world_->mark_as_pending_running_sensors_on_3D_scene();
+	}
+
+	// Keep sensor global pose up-to-date:
+	Simulable::setPose(sensorGlobalPose(rigPose_).asTPose(), false /*do not notify*/);
+}
+
+void CameraRig::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
+{
+	// The editor has moved the sensor in global coordinates.
+	// Convert back to local:
+	const auto& p = vehicle_.getPose();
+	rigPose_ = mrpt::poses::CPose3D(newPose - p);
+}
+
+void CameraRig::freeOpenGLResources()
+{
+	fbo_renderer_.reset();
+	rigScene_.reset();
+}
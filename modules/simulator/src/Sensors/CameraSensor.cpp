@@ -38,6 +38,7 @@ void CameraSensor::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	SensorBase::make_sure_we_have_a_name("camera");
 
 	fbo_renderer_rgb_.reset();
+	cpu_rasterizer_.reset();
 
 	using namespace mrpt;  // _deg
 	sensor_params_.cameraPose = mrpt::poses::CPose3D(0, 0, 0.5, 90.0_deg, 0, 90.0_deg);
@@ -70,6 +71,9 @@ void CameraSensor::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	params["clip_min"] = TParamEntry("%f", &rgbClipMin_);
 	params["clip_max"] = TParamEntry("%f", &rgbClipMax_);
 
+	params["cpu_rasterizer"] = TParamEntry("%bool", &use_cpu_rasterizer_);
+	params["cpu_rasterizer_threads"] = TParamEntry("%u", &cpu_rasterizer_threads_);
+
 	// Parse XML params:
 	parse_xmlnode_children_as_param(*root, params, varValues_);
 
@@ -145,9 +149,7 @@ void CameraSensor::internalGuiUpdate(
 	gl_sensor_fov_->setPose(p);
 	gl_sensor_origin_->setPose(p);
 
-	const auto globalSensorPose = p + sensor_params_.cameraPose.asTPose();
-
-	if (glCustomVisual_) glCustomVisual_->setPose(globalSensorPose);
+	if (glCustomVisual_) glCustomVisual_->setPose(sensorGlobalPose(sensor_params_.cameraPose));
 }
 
 void CameraSensor::simul_pre_timestep([[maybe_unused]] const TSimulContext& context) {}
@@ -166,11 +168,56 @@ void CameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	if (glCustomVisual_) glCustomVisual_->setVisibility(false);
 
 	// Start making a copy of the pattern observation:
-	auto curObs = mrpt::obs::CObservationImage::Create(sensor_params_);
+	auto curObs = obsPool_.get(sensor_params_);
 
 	// Set timestamp:
 	curObs->timestamp = world_->get_simul_timestamp();
 
+	// RGB camera pose:
+	//   vehicle (+) relativePoseOnVehicle (+) relativePoseIntensityWRTDepth
+	//
+	// Note: relativePoseOnVehicle should be (y,p,r)=(-90deg,0,-90deg) to make
+	// the camera to look forward:
+	const auto rgbSensorPose = sensorGlobalPose(curObs->cameraPose);
+
+	if (use_cpu_rasterizer_)
+	{
+		if (!cpu_rasterizer_)
+			cpu_rasterizer_ = std::make_unique<CpuRasterizer>(cpu_rasterizer_threads_);
+
+		auto tle2 = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGB.render");
+
+		cpu_rasterizer_->updateScene(world3DScene);
+		cpu_rasterizer_->render_RGB(
+			rgbSensorPose, curObs->cameraParams, rgbClipMin_, rgbClipMax_, curObs->image);
+	}
+	else
+	{
+		internal_render_with_fbo(world3DScene, *curObs, rgbSensorPose);
+	}
+
+	// Store generated obs:
+	{
+		std::lock_guard<std::mutex> csl(last_obs_cs_);
+		last_obs_ = std::move(curObs);
+		last_obs2gui_ = last_obs_;
+	}
+
+	{
+		auto lckHasTo = mrpt::lockHelper(has_to_render_mtx_);
+		SensorBase::reportNewObservation(last_obs_, *has_to_render_);
+
+		if (glCustomVisual_) glCustomVisual_->setVisibility(true);
+
+		gui_uptodate_ = false;
+		has_to_render_.reset();
+	}
+}
+
+void CameraSensor::internal_render_with_fbo(
+	mrpt::opengl::COpenGLScene& world3DScene, mrpt::obs::CObservationImage& curObs,
+	const mrpt::poses::CPose3D& rgbSensorPose)
+{
 	// Create FBO on first use, now that we are here at the GUI / OpenGL thread.
 	if (!fbo_renderer_rgb_)
 	{
@@ -186,53 +233,19 @@ void CameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 
 	auto& cam = fbo_renderer_rgb_->getCamera(world3DScene);
 
-	const auto fixedAxisConventionRot =
-		mrpt::poses::CPose3D(0, 0, 0, -90.0_deg, 0.0_deg, -90.0_deg);
-
 	// ----------------------------------------------------------
 	// RGB with its camera intrinsics & clip distances
 	// ----------------------------------------------------------
 	cam.set6DOFMode(true);
-	cam.setProjectiveFromPinhole(curObs->cameraParams);
-
-	// RGB camera pose:
-	//   vehicle (+) relativePoseOnVehicle (+) relativePoseIntensityWRTDepth
-	//
-	// Note: relativePoseOnVehicle should be (y,p,r)=(-90deg,0,-90deg) to make
-	// the camera to look forward:
-
-	const auto vehiclePose = mrpt::poses::CPose3D(vehicle_.getPose());
-	const auto rgbSensorPose = vehiclePose + curObs->cameraPose;
-
+	cam.setProjectiveFromPinhole(curObs.cameraParams);
 	cam.setPose(rgbSensorPose);
 
-	ASSERT_(fbo_renderer_rgb_);
-
 	auto tle2 = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGB.render");
 
 	// viewport->setCustomBackgroundColor({0.3f, 0.3f, 0.3f, 1.0f});
 	viewport->setViewportClipDistances(rgbClipMin_, rgbClipMax_);
 
-	fbo_renderer_rgb_->render_RGB(world3DScene, curObs->image);
-
-	tle2.stop();
-
-	// Store generated obs:
-	{
-		std::lock_guard<std::mutex> csl(last_obs_cs_);
-		last_obs_ = std::move(curObs);
-		last_obs2gui_ = last_obs_;
-	}
-
-	{
-		auto lckHasTo = mrpt::lockHelper(has_to_render_mtx_);
-		SensorBase::reportNewObservation(last_obs_, *has_to_render_);
-
-		if (glCustomVisual_) glCustomVisual_->setVisibility(true);
-
-		gui_uptodate_ = false;
-		has_to_render_.reset();
-	}
+	fbo_renderer_rgb_->render_RGB(world3DScene, curObs.image);
 }
 
 // Simulate sensor AFTER timestep, with the updated vehicle dynamical state:
@@ -246,9 +259,8 @@ void CameraSensor::simul_post_timestep(const TSimulContext& context)
 	}
 
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + sensor_params_.cameraPose.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(
+		sensorGlobalPose(sensor_params_.cameraPose).asTPose(), false /*do not notify*/);
 }
 
 void CameraSensor::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
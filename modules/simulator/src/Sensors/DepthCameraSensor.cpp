@@ -22,6 +22,43 @@
 using namespace mvsim;
 using namespace rapidxml;
 
+namespace
+{
+// Turns a camera model into the one of a region of its image and/or a
+// decimated image, so the rendering itself is done at the reduced size.
+void applyRoiAndDecimation(
+	mrpt::img::TCamera& c, const TImageROI& roi, unsigned int decimation,
+	const std::string& sensorName)
+{
+	if (!roi.empty())
+	{
+		if (roi.x0 + roi.width > c.ncols || roi.y0 + roi.height > c.nrows)
+		{
+			THROW_EXCEPTION_FMT(
+				"Sensor '%s': ROI '%u %u %u %u' does not fit within the %ux%u image",
+				sensorName.c_str(), roi.x0, roi.y0, roi.width, roi.height, c.ncols, c.nrows);
+		}
+		c.ncols = roi.width;
+		c.nrows = roi.height;
+		c.cx(c.cx() - roi.x0);
+		c.cy(c.cy() - roi.y0);
+	}
+
+	ASSERT_GE_(decimation, 1U);
+	if (decimation > 1)
+	{
+		// Keep pixel centers aligned with the full resolution image:
+		const double k = 1.0 / decimation;
+		c.ncols = std::max(1U, c.ncols / decimation);
+		c.nrows = std::max(1U, c.nrows / decimation);
+		c.cx((c.cx() + 0.5) * k - 0.5);
+		c.cy((c.cy() + 0.5) * k - 0.5);
+		c.fx(c.fx() * k);
+		c.fy(c.fy() * k);
+	}
+}
+}  // namespace
+
 DepthCameraSensor::DepthCameraSensor(Simulable& parent, const rapidxml::xml_node<char>* root)
 	: SensorBase(parent)
 {
@@ -39,6 +76,10 @@ void DepthCameraSensor::loadConfigFrom(const rapidxml::xml_node<char>* root)
 
 	fbo_renderer_depth_.reset();
 	fbo_renderer_rgb_.reset();
+	cpu_rasterizer_.reset();
+	noiseSeq_.clear();
+	rayLUT_y_.clear();
+	rayLUT_z_.clear();
 
 	using namespace mrpt;  // _deg
 	sensor_params_.sensorPose = mrpt::poses::CPose3D(0, 0, 0.5, 90.0_deg, 0, 90.0_deg);
@@ -90,8 +131,17 @@ void DepthCameraSensor::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	params["depth_clip_max"] = TParamEntry("%f", &depth_clip_max_);
 	params["depth_resolution"] = TParamEntry("%f", &depth_resolution_);
 
+	params["depth_roi"] = TParamEntry("%roi", &depth_roi_);
+	params["rgb_roi"] = TParamEntry("%roi", &rgb_roi_);
+	params["depth_decimation"] = TParamEntry("%u", &depth_decimation_);
+	params["rgb_decimation"] = TParamEntry("%u", &rgb_decimation_);
+
 	params["depth_noise_sigma"] = TParamEntry("%f", &depth_noise_sigma_);
 	params["show_3d_pointcloud"] = TParamEntry("%bool", &show_3d_pointcloud_);
+	params["emit_points"] = TParamEntry("%bool", &emit_points_);
+
+	params["cpu_rasterizer"] = TParamEntry("%bool", &use_cpu_rasterizer_);
+	params["cpu_rasterizer_threads"] = TParamEntry("%u", &cpu_rasterizer_threads_);
 
 	// Parse XML params:
 	parse_xmlnode_children_as_param(*root, params, varValues_);
@@ -102,6 +152,9 @@ void DepthCameraSensor::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	rgbCam.ncols = rgb_ncols;
 	rgbCam.nrows = rgb_nrows;
 
+	applyRoiAndDecimation(depthCam, depth_roi_, depth_decimation_, name_);
+	applyRoiAndDecimation(rgbCam, rgb_roi_, rgb_decimation_, name_);
+
 	// save sensor label here too:
 	sensor_params_.sensorLabel = name_;
 
@@ -159,7 +212,21 @@ void DepthCameraSensor::internalGuiUpdate(
 			std::lock_guard<std::mutex> csl(last_obs_cs_);
 			if (last_obs2gui_ && glVizSensors->isVisible())
 			{
-				if (show_3d_pointcloud_)
+				if (show_3d_pointcloud_ && last_obs2gui_->hasPoints3D)
+				{
+					// Already unprojected by the sensor:
+					const auto& o = *last_obs2gui_;
+					gl_obs_->clear();
+					gl_obs_->reserve(o.points3D_x.size());
+					for (size_t i = 0; i < o.points3D_x.size(); i++)
+					{
+						const auto pt = o.sensorPose.composePoint(
+							{o.points3D_x[i], o.points3D_y[i], o.points3D_z[i]});
+						gl_obs_->push_back(pt.x, pt.y, pt.z, 1.0f, 1.0f, 1.0f);
+					}
+					gl_obs_->recolorizeByCoordinate(0.0f, sensor_params_.maxRange, 0 /*x*/);
+				}
+				else if (show_3d_pointcloud_)
 				{
 					mrpt::obs::T3DPointsProjectionParams pp;
 					pp.takeIntoAccountSensorPoseOnRobot = true;
@@ -196,7 +263,7 @@ void DepthCameraSensor::internalGuiUpdate(
 	if (gl_sensor_fov_) gl_sensor_fov_->setPose(p);
 	if (gl_sensor_origin_) gl_sensor_origin_->setPose(p);
 
-	if (glCustomVisual_) glCustomVisual_->setPose(p + sensor_params_.sensorPose.asTPose());
+	if (glCustomVisual_) glCustomVisual_->setPose(sensorGlobalPose(sensor_params_.sensorPose));
 }
 
 void DepthCameraSensor::simul_pre_timestep([[maybe_unused]] const TSimulContext& context) {}
@@ -218,15 +285,43 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 
 	if (glCustomVisual_) glCustomVisual_->setVisibility(false);
 
-	// Start making a copy of the pattern observation:
-	auto curObsPtr = mrpt::obs::CObservation3DRangeScan::Create(sensor_params_);
+	// Start making a copy of the pattern observation, reusing the range image
+	// buffer of a recycled observation, if any (the intensity image is not
+	// reused, since CImage copies are shallow and might still be alive):
+	auto curObsPtr = obsPool_.get();
 	auto& curObs = *curObsPtr;
+	{
+		mrpt::math::CMatrix_u16 rangeImgBuf;
+		std::swap(rangeImgBuf, curObs.rangeImage);
+		auto ptsX = std::move(curObs.points3D_x), ptsY = std::move(curObs.points3D_y),
+			 ptsZ = std::move(curObs.points3D_z);
+		auto idxX = std::move(curObs.points3D_idxs_x), idxY = std::move(curObs.points3D_idxs_y);
+
+		curObs = sensor_params_;
+
+		std::swap(rangeImgBuf, curObs.rangeImage);
+		curObs.points3D_x = std::move(ptsX);
+		curObs.points3D_y = std::move(ptsY);
+		curObs.points3D_z = std::move(ptsZ);
+		curObs.points3D_idxs_x = std::move(idxX);
+		curObs.points3D_idxs_y = std::move(idxY);
+	}
 
 	// Set timestamp:
 	curObs.timestamp = world_->get_simul_timestamp();
 
+	if (use_cpu_rasterizer_)
+	{
+		if (!cpu_rasterizer_)
+			cpu_rasterizer_ = std::make_unique<CpuRasterizer>(cpu_rasterizer_threads_);
+
+		auto tle2 =
+			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.cpuScene");
+		cpu_rasterizer_->updateScene(world3DScene);
+	}
+
 	// Create FBO on first use, now that we are here at the GUI / OpenGL thread.
-	if (!fbo_renderer_rgb_ && sense_rgb_)
+	if (!fbo_renderer_rgb_ && sense_rgb_ && !use_cpu_rasterizer_)
 	{
 		auto tle2 =
 			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.createFBO");
@@ -239,7 +334,7 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 		fbo_renderer_rgb_ = std::make_shared<mrpt::opengl::CFBORender>(p);
 	}
 
-	if (!fbo_renderer_depth_ && sense_depth_)
+	if (!fbo_renderer_depth_ && sense_depth_ && !use_cpu_rasterizer_)
 	{
 		auto tle2 =
 			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.createFBO");
@@ -270,14 +365,25 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 	// Note: relativePoseOnVehicle should be (y,p,r)=(-90deg,0,-90deg) to make
 	// the camera to look forward:
 
-	const auto vehiclePose = mrpt::poses::CPose3D(vehicle_.getPose());
+	const auto vehiclePose = vehicle_.getCPose3D();
 
 	const auto depthSensorPose = vehiclePose + curObs.sensorPose + fixedAxisConventionRot;
 
 	const auto rgbSensorPose =
 		vehiclePose + curObs.sensorPose + curObs.relativePoseIntensityWRTDepth;
 
-	if (fbo_renderer_rgb_)
+	if (cpu_rasterizer_ && sense_rgb_)
+	{
+		auto tle2 =
+			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderRGB");
+
+		cpu_rasterizer_->render_RGB(
+			rgbSensorPose, curObs.cameraParamsIntensity, rgbClipMin_, rgbClipMax_,
+			curObs.intensityImage);
+
+		curObs.hasIntensityImage = true;
+	}
+	else if (fbo_renderer_rgb_)
 	{
 		auto tle2 =
 			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderRGB");
@@ -301,25 +407,34 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 	// ----------------------------------------------------------
 	// DEPTH camera next
 	// ----------------------------------------------------------
-	if (fbo_renderer_depth_)
+	if (fbo_renderer_depth_ || (cpu_rasterizer_ && sense_depth_))
 	{
 		auto tle2 = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderD");
 
-		camDepth->setProjectiveFromPinhole(curObs.cameraParams);
+		auto tle2c =
+			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderD_core");
 
-		// Camera pose: vehicle + relativePoseOnVehicle:
-		// Note: relativePoseOnVehicle should be (y,p,r)=(90deg,0,90deg) to make
-		// the camera to look forward:
-		camDepth->set6DOFMode(true);
-		camDepth->setPose(depthSensorPose);
+		if (cpu_rasterizer_)
+		{
+			cpu_rasterizer_->render_depth(
+				depthSensorPose, curObs.cameraParams, depth_clip_min_, depth_clip_max_,
+				depthImage_);
+		}
+		else
+		{
+			camDepth->setProjectiveFromPinhole(curObs.cameraParams);
 
-		// viewport->setCustomBackgroundColor({0.3f, 0.3f, 0.3f, 1.0f});
-		viewport->setViewportClipDistances(depth_clip_min_, depth_clip_max_);
+			// Camera pose: vehicle + relativePoseOnVehicle:
+			// Note: relativePoseOnVehicle should be (y,p,r)=(90deg,0,90deg) to
+			// make the camera to look forward:
+			camDepth->set6DOFMode(true);
+			camDepth->setPose(depthSensorPose);
 
-		auto tle2c =
-			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderD_core");
+			// viewport->setCustomBackgroundColor({0.3f, 0.3f, 0.3f, 1.0f});
+			viewport->setViewportClipDistances(depth_clip_min_, depth_clip_max_);
 
-		fbo_renderer_depth_->render_depth(world3DScene, depthImage_);
+			fbo_renderer_depth_->render_depth(world3DScene, depthImage_);
+		}
 
 		tle2c.stop();
 
@@ -330,52 +445,7 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 		auto tle2cnv =
 			mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.RGBD.renderD_cast");
 
-		// float -> uint16_t with "curObs.rangeUnits" units:
-		curObs.rangeImage_setSize(depthImage_.rows(), depthImage_.cols());
-		curObs.rangeImage =
-			(depthImage_.asEigen().cwiseMin(curObs.maxRange) / curObs.rangeUnits).cast<uint16_t>();
-
-		tle2cnv.stop();
-
-		// Add random noise:
-		if (depth_noise_sigma_ > 0)
-		{
-			// Each thread must create its own rng:
-			thread_local mrpt::random::CRandomGenerator rng;
-			thread_local std::vector<int16_t> noiseSeq;
-			thread_local size_t noiseIdx = 0;
-			constexpr size_t noiseLen = 7823;  // prime
-			if (noiseSeq.empty())
-			{
-				noiseSeq.reserve(noiseLen);
-				for (size_t i = 0; i < noiseLen; i++)
-				{
-					noiseSeq.push_back(static_cast<int16_t>(mrpt::round(
-						rng.drawGaussian1D(0.0, depth_noise_sigma_) / curObs.rangeUnits)));
-				}
-			}
-
-			auto tle2noise = mrpt::system::CTimeLoggerEntry(
-				world_->getTimeLogger(), "sensor.RGBD.renderD_noise");
-
-			uint16_t* d = curObs.rangeImage.data();
-			const size_t N = curObs.rangeImage.size();
-
-			const int16_t maxRangeInts = static_cast<int16_t>(curObs.maxRange / curObs.rangeUnits);
-
-			for (size_t i = 0; i < N; i++)
-			{
-				if (d[i] == 0) continue;  // it was an invalid ray return.
-
-				const int16_t dNoisy = static_cast<int16_t>(d[i]) + noiseSeq[noiseIdx++];
-
-				if (noiseIdx >= noiseLen) noiseIdx = 0;
-
-				if (dNoisy > maxRangeInts) continue;
-
-				d[i] = static_cast<uint16_t>(dNoisy);
-			}
-		}
+		internal_convert_depth_image(curObs);
 	}
 	else
 	{
@@ -408,6 +478,89 @@ void DepthCameraSensor::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DSce
 	}
 }
 
+void DepthCameraSensor::internal_convert_depth_image(mrpt::obs::CObservation3DRangeScan& obs)
+{
+	const size_t nRows = depthImage_.rows(), nCols = depthImage_.cols();
+	obs.rangeImage_setSize(nRows, nCols);
+
+	const float maxRange = obs.maxRange;
+	const float units = obs.rangeUnits;
+	const float invUnits = 1.0f / units;
+	const int32_t maxRangeInts = static_cast<int32_t>(maxRange * invUnits);
+
+	// Gaussian noise, in range units, precomputed once. The sequence is
+	// extended with a copy of its first nCols samples, so the noise for any
+	// image row is a contiguous block starting at noiseIdx_:
+	const bool addNoise = depth_noise_sigma_ > 0;
+	if (addNoise && noiseSeq_.size() != NOISE_SEQ_LEN + nCols)
+	{
+		thread_local mrpt::random::CRandomGenerator rng;
+		noiseSeq_.resize(NOISE_SEQ_LEN);
+		for (auto& n : noiseSeq_)
+			n = mrpt::round(rng.drawGaussian1D(0.0, depth_noise_sigma_) * invUnits);
+		for (size_t i = 0; i < nCols; i++) noiseSeq_.push_back(noiseSeq_[i % NOISE_SEQ_LEN]);
+		noiseIdx_ = 0;
+	}
+
+	// Ray LUT: the depth camera model is a distortion-free pinhole, so rays
+	// are separable in one factor per column (Y) and another per row (Z).
+	// Same convention as CObservation3DRangeScan::unprojectInto(): +X forward.
+	obs.hasPoints3D = emit_points_;
+	if (emit_points_ && (rayLUT_y_.size() != nCols || rayLUT_z_.size() != nRows))
+	{
+		const auto& cam = obs.cameraParams;
+		rayLUT_y_.resize(nCols);
+		rayLUT_z_.resize(nRows);
+		for (size_t c = 0; c < nCols; c++) rayLUT_y_[c] = (cam.cx() - c) / cam.fx();
+		for (size_t r = 0; r < nRows; r++) rayLUT_z_[r] = (cam.cy() - r) / cam.fy();
+	}
+	if (emit_points_) obs.resizePoints3DVectors(nRows * nCols);
+
+	size_t nPts = 0;
+	for (size_t r = 0; r < nRows; r++)
+	{
+		const float* src = &depthImage_(r, 0);
+		uint16_t* dst = &obs.rangeImage(r, 0);
+
+		// Convert, clamp and add noise, branch-free so it is vectorized:
+		if (addNoise)
+		{
+			const int32_t* noise = &noiseSeq_[noiseIdx_];
+			for (size_t c = 0; c < nCols; c++)
+			{
+				const auto d = static_cast<int32_t>(std::min(src[c], maxRange) * invUnits);
+				const int32_t dNoisy = d + noise[c];
+				// Keep invalid returns (d=0) and noisy values out of range as is:
+				const bool useNoisy = (d != 0) & (dNoisy > 0) & (dNoisy <= maxRangeInts);
+				dst[c] = static_cast<uint16_t>(useNoisy ? dNoisy : d);
+			}
+			noiseIdx_ = (noiseIdx_ + nCols) % NOISE_SEQ_LEN;
+		}
+		else
+		{
+			for (size_t c = 0; c < nCols; c++)
+				dst[c] = static_cast<uint16_t>(std::min(src[c], maxRange) * invUnits);
+		}
+
+		if (!emit_points_) continue;
+
+		// Unproject valid pixels, while the row is still in the cache:
+		const float kz = rayLUT_z_[r];
+		for (size_t c = 0; c < nCols; c++)
+		{
+			if (dst[c] == 0) continue;
+			const float x = dst[c] * units;
+			obs.points3D_x[nPts] = x;
+			obs.points3D_y[nPts] = x * rayLUT_y_[c];
+			obs.points3D_z[nPts] = x * kz;
+			obs.points3D_idxs_x[nPts] = static_cast<uint16_t>(c);
+			obs.points3D_idxs_y[nPts] = static_cast<uint16_t>(r);
+			nPts++;
+		}
+	}
+	if (emit_points_) obs.resizePoints3DVectors(nPts);
+}
+
 // Simulate sensor AFTER timestep, with the updated vehicle dynamical state:
 void DepthCameraSensor::simul_post_timestep(const TSimulContext& context)
 {
@@ -419,9 +572,8 @@ void DepthCameraSensor::simul_post_timestep(const TSimulContext& context)
 		world_->mark_as_pending_running_sensors_on_3D_scene();
 	}
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + sensor_params_.sensorPose.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(
+		sensorGlobalPose(sensor_params_.sensorPose).asTPose(), false /*do not notify*/);
 }
 
 void DepthCameraSensor::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
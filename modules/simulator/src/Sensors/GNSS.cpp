@@ -78,7 +78,7 @@ void GNSS::internalGuiUpdate(
 		SensorBase::RegisterSensorOriginViz(gl_sensor_origin_);
 	}
 
-	const mrpt::poses::CPose3D p = vehicle_.getCPose3D() + obs_model_.sensorPose;
+	const mrpt::poses::CPose3D p = sensorGlobalPose(obs_model_.sensorPose);
 
 	if (gl_sensor_origin_) gl_sensor_origin_->setPose(p);
 	if (glCustomVisual_) glCustomVisual_->setPose(p);
@@ -97,9 +97,7 @@ void GNSS::simul_post_timestep(const TSimulContext& context)
 	}
 
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + obs_model_.sensorPose.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(sensorGlobalPose(obs_model_.sensorPose).asTPose(), false /*do not notify*/);
 }
 
 void GNSS::internal_simulate_gnss(const TSimulContext& context)
@@ -108,7 +106,7 @@ void GNSS::internal_simulate_gnss(const TSimulContext& context)
 
 	auto tle = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.GNSS");
 
-	auto outObs = CObservationGPS::Create(obs_model_);
+	auto outObs = obsPool_.get(obs_model_);
 
 	outObs->timestamp = world_->get_simul_timestamp();
 	outObs->sensorLabel = name_;
@@ -126,7 +124,7 @@ void GNSS::internal_simulate_gnss(const TSimulContext& context)
 		mrpt::poses::CPose3D::FromYawPitchRoll(georef.world_to_enu_rotation, .0, .0);
 
 	const mrpt::math::TPoint3D sensorPt =
-		(worldRotation + (vehicle().getCPose3D() + outObs->sensorPose)).translation() + noise;
+		(worldRotation + sensorGlobalPose(outObs->sensorPose)).translation() + noise;
 
 	// convert from ENU (world coordinates) to geodetic:
 	const thread_local auto WGS84 = mrpt::topography::TEllipsoid::Ellipsoid_WGS84();
@@ -70,7 +70,7 @@ void IMU::internalGuiUpdate(
 		SensorBase::RegisterSensorOriginViz(gl_sensor_origin_);
 	}
 
-	const mrpt::poses::CPose3D p = vehicle_.getCPose3D() + obs_model_.sensorPose;
+	const mrpt::poses::CPose3D p = sensorGlobalPose(obs_model_.sensorPose);
 
 	if (gl_sensor_origin_) gl_sensor_origin_->setPose(p);
 	if (glCustomVisual_) glCustomVisual_->setPose(p);
@@ -88,9 +88,7 @@ void IMU::simul_post_timestep(const TSimulContext& context)
 		internal_simulate_imu(context);
 	}
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + obs_model_.sensorPose.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(sensorGlobalPose(obs_model_.sensorPose).asTPose(), false /*do not notify*/);
 }
 
 void IMU::internal_simulate_imu(const TSimulContext& context)
@@ -99,13 +97,15 @@ void IMU::internal_simulate_imu(const TSimulContext& context)
 
 	auto tle = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "sensor.IMU");
 
-	auto outObs = CObservationIMU::Create(obs_model_);
+	auto outObs = obsPool_.get(obs_model_);
 
 	outObs->timestamp = world_->get_simul_timestamp();
 	outObs->sensorLabel = name_;
 
+	const auto vehState = vehicle_.getKinematicState();
+
 	// angular velocity:
-	mrpt::math::TVector3D w(0.0, 0.0, vehicle_.getTwist().omega);
+	mrpt::math::TVector3D w(0.0, 0.0, vehState.twist.omega);
 	rng_.drawGaussian1DVector(w, 0.0, angularVelocityStdNoise_);
 
 	outObs->set(mrpt::obs::IMU_WX, w.x);
@@ -119,7 +119,7 @@ void IMU::internal_simulate_imu(const TSimulContext& context)
 	rng_.drawGaussian1DVector(linAccNoise, 0.0, linearAccelerationStdNoise_);
 
 	const mrpt::math::TVector3D linAccLocal =
-		vehicle_.getPose().inverseComposePoint(vehicle_.getLinearAcceleration() + g) + linAccNoise;
+		vehState.pose.inverseComposePoint(vehState.linearAcceleration + g) + linAccNoise;
 
 	outObs->set(mrpt::obs::IMU_X_ACC, linAccLocal.x);
 	outObs->set(mrpt::obs::IMU_Y_ACC, linAccLocal.y);
@@ -16,6 +16,7 @@
 #include <mvsim/VehicleBase.h>
 #include <mvsim/World.h>
 #include <mvsim/WorldElements/OccupancyGridMap.h>
+#include <mvsim/WorldElements/VoxelMap.h>
 
 #include "xml_utils.h"
 
@@ -80,6 +81,9 @@ void LaserScanner::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	scan_model_.stdError = rangeStdNoise_;
 
 	scan_model_.sensorLabel = name_;
+
+	// Repeatable noise, after `randomize(seed)` in the world file:
+	rng_.randomize(mrpt::random::getRandomGenerator().drawUniform32bit());
 }
 
 void LaserScanner::internalGuiUpdate(
@@ -188,7 +192,7 @@ void LaserScanner::internalGuiUpdate(
 
 	if (gl_sensor_fov_) gl_sensor_fov_->setPose(p);
 	if (gl_sensor_origin_) gl_sensor_origin_->setPose(p);
-	if (glCustomVisual_) glCustomVisual_->setPose(p + scan_model_.sensorPose);
+	if (glCustomVisual_) glCustomVisual_->setPose(sensorGlobalPose(scan_model_.sensorPose));
 }
 
 void LaserScanner::simul_pre_timestep([[maybe_unused]] const TSimulContext& context) {}
@@ -225,9 +229,7 @@ void LaserScanner::simul_post_timestep(const TSimulContext& context)
 	}
 
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + scan_model_.sensorPose.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(sensorGlobalPose(scan_model_.sensorPose).asTPose(), false /*do not notify*/);
 }
 
 void LaserScanner::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
@@ -240,15 +242,22 @@ void LaserScanner::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
 
 void LaserScanner::internal_simulate_lidar_2d_mode(const TSimulContext& context)
 {
-	using mrpt::maps::COccupancyGridMap2D;
 	using mrpt::obs::CObservation2DRangeScan;
 
 	auto tle = mrpt::system::CTimeLoggerEntry(world_->getTimeLogger(), "LaserScanner");
 
 	// Create an array of scans, each reflecting ranges to one kind of world
 	// objects.
-	// Finally, we'll take the shortest range in each direction:
-	std::list<CObservation2DRangeScan> lstScans;
+	// Finally, we'll take the shortest range in each direction.
+	// (Scans are kept between calls, to reuse their buffers)
+	size_t numScans = 0;
+	auto newScan = [this, &numScans]() -> CObservation2DRangeScan&
+	{
+		if (numScans >= partialScans_.size()) partialScans_.resize(numScans + 1);
+		auto& s = partialScans_[numScans++];
+		s = scan_model_;
+		return s;
+	};
 
 	const size_t nRays = scan_model_.getScanSize();
 	const double maxRange = scan_model_.maxRange;
@@ -267,25 +276,57 @@ void LaserScanner::internal_simulate_lidar_2d_mode(const TSimulContext& context)
 		// If not a grid map, ignore:
 		const OccupancyGridMap* grid = dynamic_cast<const OccupancyGridMap*>(element.get());
 		if (!grid) continue;
-		const COccupancyGridMap2D& occGrid = grid->getOccGrid();
 
 		// Create new scan:
-		lstScans.emplace_back(scan_model_);
-		CObservation2DRangeScan& scan = lstScans.back();
+		CObservation2DRangeScan& scan = newScan();
 
 		// Ray tracing over the gridmap:
-		occGrid.laserScanSimulator(
-			scan, vehPose, 0.5f, scan_model_.getScanSize(), rangeStdNoise_, 1, angleStdNoise_);
+		grid->getRaycaster().simulateScan(
+			scan, vehPose, nRays, rangeStdNoise_, angleStdNoise_, &rng_);
 	}
 	world_->getTimeLogger().leave("LaserScanner.scan.1.gridmap");
 
+	// voxel maps:
+	// -------------
+	for (const auto& element : elements)
+	{
+		const VoxelMap* voxels = dynamic_cast<const VoxelMap*>(element.get());
+		if (!voxels) continue;
+
+		auto tleVox = mrpt::system::CTimeLoggerEntry(
+			world_->getTimeLogger(), "LaserScanner.scan.1.voxelmap");
+
+		CObservation2DRangeScan& scan = newScan();
+		ASSERT_(nRays >= 2);
+		scan.resizeScanAndAssign(nRays, maxRange, false);
+
+		// 3D ray tracing within the sensor plane:
+		const auto sensorGlobalPose = vehicle_.getCPose3D() + scan.sensorPose;
+		const auto& R = sensorGlobalPose.getRotationMatrix();
+		const mrpt::math::TPoint3Df origin = sensorGlobalPose.translation();
+
+		double A = (scan.rightToLeft ? -0.5 : +0.5) * scan.aperture;
+		const double AA = (scan.rightToLeft ? 1.0 : -1.0) * (scan.aperture / (nRays - 1));
+
+		for (size_t i = 0; i < nRays; i++, A += AA)
+		{
+			const double c = cos(A), s = sin(A);
+			const mrpt::math::TPoint3Df dir(
+				R(0, 0) * c + R(0, 1) * s, R(1, 0) * c + R(1, 1) * s, R(2, 0) * c + R(2, 1) * s);
+
+			const auto hit = voxels->raycast(origin, dir, maxRange);
+			scan.setScanRangeValidity(i, hit.has_value());
+			scan.setScanRange(
+				i, hit ? *hit + rng_.drawGaussian1D_normalized() * rangeStdNoise_ : maxRange);
+		}
+	}
+
 	// ray trace on Box2D polygons:
 	// ------------------------------
 	world_->getTimeLogger().enter("LaserScanner.scan.2.polygons");
 	{
 		// Create new scan:
-		lstScans.push_back(CObservation2DRangeScan(scan_model_));
-		CObservation2DRangeScan& scan = lstScans.back();
+		CObservation2DRangeScan& scan = newScan();
 
 		// Avoid the lidar seeing the vehicle owns shape:
 		std::map<b2Fixture*, uintptr_t> orgUserData;
@@ -357,9 +398,6 @@ void LaserScanner::internal_simulate_lidar_2d_mode(const TSimulContext& context)
 		double A = sensorPose.phi() + (scan.rightToLeft ? -0.5 : +0.5) * scan.aperture;
 		const double AA = (scan.rightToLeft ? 1.0 : -1.0) * (scan.aperture / (nRays - 1));
 
-		// Each thread must create its own rng:
-		thread_local mrpt::random::CRandomGenerator rnd;
-
 		for (size_t i = 0; i < nRays; i++, A += AA)
 		{
 			const b2Vec2 endPt =
@@ -376,7 +414,7 @@ void LaserScanner::internal_simulate_lidar_2d_mode(const TSimulContext& context)
 				range = std::sqrt(
 					mrpt::square(callback.point_.x - sensorPt.x) +
 					mrpt::square(callback.point_.y - sensorPt.y));
-				range += rnd.drawGaussian1D_normalized() * rangeStdNoise_;
+				range += rng_.drawGaussian1D_normalized() * rangeStdNoise_;
 			}
 			else
 			{
@@ -394,15 +432,16 @@ void LaserScanner::internal_simulate_lidar_2d_mode(const TSimulContext& context)
 	// ----------------------------------------
 	world_->getTimeLogger().enter("LaserScanner.scan.3.merge");
 
-	auto lastScan = CObservation2DRangeScan::Create(scan_model_);
+	auto lastScan = obsPool_.get(scan_model_);
 
 	lastScan->timestamp = world_->get_simul_timestamp();
 	lastScan->sensorLabel = name_;
 
 	lastScan->resizeScanAndAssign(nRays, maxRange, false);
 
-	for (const auto& scan : lstScans)
+	for (size_t scanIdx = 0; scanIdx < numScans; scanIdx++)
 	{
+		const auto& scan = partialScans_[scanIdx];
 		for (size_t i = 0; i < nRays; i++)
 		{
 			if (scan.getScanRangeValidity(i))
@@ -454,7 +493,7 @@ void LaserScanner::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	if (glCustomVisual_) glCustomVisual_->setVisibility(false);
 
 	// Start making a copy of the pattern observation:
-	auto curObs = mrpt::obs::CObservation2DRangeScan::Create(scan_model_);
+	auto curObs = obsPool_.get(scan_model_);
 
 	const size_t nRays = scan_model_.getScanSize();
 	const double maxRange = scan_model_.maxRange;
@@ -493,7 +532,7 @@ void LaserScanner::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	const auto fixedAxisConventionRot =
 		mrpt::poses::CPose3D(0, 0, 0, -90.0_deg, 0.0_deg, -90.0_deg);
 
-	const auto vehiclePose = mrpt::poses::CPose3D(vehicle_.getPose());
+	const auto vehiclePose = vehicle_.getCPose3D();
 
 	// ----------------------------------------------------------
 	// Decompose the 2D lidar FOV into "n" depth camera images,
@@ -9,6 +9,7 @@
 
 #include <mrpt/core/lock_helper.h>
 #include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/math/wrap2pi.h>
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/stock_objects.h>
 #include <mrpt/random.h>
@@ -39,6 +40,15 @@ using namespace rapidxml;
 
 // TODO(jlbc): Also store obs as CObservationRotatingScan??
 
+namespace
+{
+// The 360 degrees scan is rendered as several depth images with this
+// horizontal FOV each:
+constexpr double camModel_hFOV = 120.01 * M_PI / 180.0;
+constexpr double scanAperture = 2 * M_PI;
+constexpr bool scanIsCW = false;
+}  // namespace
+
 Lidar3D::Lidar3D(Simulable& parent, const rapidxml::xml_node<char>* root) : SensorBase(parent)
 {
 	Lidar3D::loadConfigFrom(root);
@@ -71,6 +81,11 @@ void Lidar3D::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	params["horz_resolution_factor"] = TParamEntry("%lf", &horzResolutionFactor_);
 	params["vert_resolution_factor"] = TParamEntry("%lf", &vertResolutionFactor_);
 
+	params["horz_decimation"] = TParamEntry("%i", &horzDecimation_);
+	params["vert_decimation"] = TParamEntry("%i", &vertDecimation_);
+	params["azimuth_min_degrees"] = TParamEntry("%lf", &azimuthMin_);
+	params["azimuth_max_degrees"] = TParamEntry("%lf", &azimuthMax_);
+
 	params["max_vert_relative_depth_to_interpolatate"] =
 		TParamEntry("%f", &maxDepthInterpolationStepVert_);
 	params["max_horz_relative_depth_to_interpolatate"] =
@@ -78,6 +93,179 @@ void Lidar3D::loadConfigFrom(const rapidxml::xml_node<char>* root)
 
 	// Parse XML params:
 	parse_xmlnode_children_as_param(*root, params, varValues_);
+
+	ASSERT_GE_(vertNumRays_, 1);
+	ASSERT_GE_(horzDecimation_, 1);
+	ASSERT_GE_(vertDecimation_, 1);
+
+	fbo_renderer_depth_.reset();
+	computeScanGeometry();
+}
+
+void Lidar3D::computeScanGeometry()
+{
+	using mrpt::square;
+
+	// Build list of vertical angles, in increasing order (first negative, below
+	// horizontal plane, final ones positive, above it):
+	vertical_ray_angles_.clear();
+	if (vertical_ray_angles_str_.empty())
+	{
+		// even distribution (a single ring lies on the horizontal plane):
+		for (int i = 0; i < vertNumRays_; i++)
+		{
+			vertical_ray_angles_.push_back(
+				vertNumRays_ == 1 ? 0.0
+								  : vertical_fov_ * (-0.5 + i * 1.0 / (vertNumRays_ - 1)));
+		}
+	}
+	else
+	{
+		// custom distribution:
+		std::vector<std::string> vertAnglesStrs;
+		mrpt::system::tokenize(vertical_ray_angles_str_, " \t\r\n", vertAnglesStrs);
+		ASSERT_EQUAL_(vertAnglesStrs.size(), static_cast<size_t>(vertNumRays_));
+		std::set<double> angs;
+		for (const auto& s : vertAnglesStrs) angs.insert(std::stod(s));
+		ASSERT_EQUAL_(angs.size(), static_cast<size_t>(vertNumRays_));
+		for (const auto a : angs) vertical_ray_angles_.push_back(a);
+	}
+
+	// Pass to radians:
+	for (double& a : vertical_ray_angles_) a = mrpt::DEG2RAD(a);
+
+	// Keep one out of "vertDecimation_" rings, remembering their original index:
+	std::vector<double> keptAngles;
+	ringIds_.clear();
+	for (int i = 0; i < vertNumRays_; i += vertDecimation_)
+	{
+		keptAngles.push_back(vertical_ray_angles_[i]);
+		ringIds_.push_back(static_cast<uint16_t>(i));
+	}
+	vertical_ray_angles_ = std::move(keptAngles);
+
+	const size_t nRows = vertical_ray_angles_.size();
+
+	// Horizontal rays actually simulated:
+	const int nHorzRays = horzNumRays_ / horzDecimation_;
+	ASSERT_GT_(nHorzRays, 1);
+
+	// The FBO is for camModel_hFOV only:
+	// Minimum horz resolution=360deg /120 deg
+	auto& camModel = fboCamModel_;
+	camModel = mrpt::img::TCamera();
+	camModel.ncols = mrpt::round(horzResolutionFactor_ * nHorzRays / (2 * M_PI / camModel_hFOV));
+	camModel.cx(camModel.ncols / 2.0);
+	camModel.fx(camModel.cx() / tan(camModel_hFOV * 0.5));	// tan(FOV/2)=cx/fx
+
+	// worst vFOV case: at each sub-scan render corner:
+	// (derivation in hand notes... to be passed to a paper)
+	// (clamped, since after decimation all rings might be above or below the horizon)
+	const double vertFOVMax = std::max(0.0, vertical_ray_angles_.back());
+	const double vertFOVMin = std::max(0.0, -vertical_ray_angles_.front());
+
+	// Rows above and below the horizon row "cy", rounded up so the outermost
+	// rings at the sub-scan corners still fall within the image:
+	const int FBO_NROWS_UP = std::ceil(
+		vertResolutionFactor_ * tan(vertFOVMax) *
+		sqrt(square(camModel.fx()) + square(camModel.cx())));
+	const int FBO_NROWS_DOWN = std::ceil(
+		vertResolutionFactor_ * tan(vertFOVMin) *
+		sqrt(square(camModel.fx()) + square(camModel.cx())));
+
+	camModel.nrows = FBO_NROWS_DOWN + FBO_NROWS_UP + 1;
+	camModel.cy(FBO_NROWS_UP);
+	camModel.fy(camModel.fx());
+
+	// ----------------------------------------------------------
+	// Decompose the horizontal lidar FOV into "n" depth images,
+	// of camModel_hFOV each.
+	// ----------------------------------------------------------
+	const double firstAngle = -scanAperture * 0.5;
+
+	const unsigned int numRenders = std::ceil((scanAperture / camModel_hFOV) - 1e-3);
+	const int numHorzRaysPerRender =
+		mrpt::round(nHorzRays * std::min<double>(1.0, (camModel_hFOV / scanAperture)));
+
+	ASSERT_(numHorzRaysPerRender > 1);
+
+	renderMidAngles_.resize(numRenders);
+	for (size_t renderIdx = 0; renderIdx < numRenders; renderIdx++)
+	{
+		renderMidAngles_[renderIdx] =
+			firstAngle +
+			(camModel_hFOV / 2.0 + camModel_hFOV * renderIdx) * (scanIsCW ? 1 : -1);
+	}
+	const auto rayHorzAngle = [&](int i) {
+		return (scanIsCW ? -1 : 1) *
+			   (camModel_hFOV * 0.5 - i * camModel_hFOV / (numHorzRaysPerRender - 1));
+	};
+
+	// Precomputed LUT of bearings to pixel coordinates:
+	//                         cx - u
+	//  tan(horzBearing) = --------------
+	//                          fx
+	//
+	//                             cy - v
+	//  tan(vertBearing) = -------------------------
+	//                      fy / cos(horzBearing)
+	//
+	lut_.clear();
+	lut_.resize(numHorzRaysPerRender);
+
+	for (int i = 0; i < numHorzRaysPerRender; i++)
+	{
+		lut_[i].column.resize(nRows);
+
+		const double horzAng = rayHorzAngle(i);
+
+		const double cosHorzAng = std::cos(horzAng);
+
+		const auto pixel_u = mrpt::saturate_val<float>(
+			camModel.cx() - camModel.fx() * std::tan(horzAng), 0, camModel.ncols - 1);
+
+		for (size_t j = 0; j < nRows; j++)
+		{
+			auto& entry = lut_[i].column[j];
+
+			const double vertAng = vertical_ray_angles_.at(j);
+			const double cosVertAng = std::cos(vertAng);
+
+			const auto pixel_v = camModel.cy() - camModel.fy() * std::tan(vertAng) / cosHorzAng;
+
+			// out of the simulated camera (only if vert_resolution_factor<1):
+			if (pixel_v < -0.5 || pixel_v > camModel.nrows - 0.5) continue;
+
+			entry.u = pixel_u;
+			entry.v = mrpt::saturate_val<float>(pixel_v, 0, camModel.nrows - 1);
+			entry.depth2range = 1.0f / (cosHorzAng * cosVertAng);
+		}
+	}
+
+	// Azimuth sector: flag the rays within it, and the sub-scans with any of them.
+	const double sectorMin = mrpt::DEG2RAD(azimuthMin_);
+	const double sectorWidth = mrpt::DEG2RAD(azimuthMax_ - azimuthMin_);
+	const bool fullCircle = std::abs(sectorWidth) >= 2 * M_PI - 1e-6;
+	const double sectorWidthWrap = mrpt::math::wrapTo2Pi(sectorWidth);
+
+	const size_t nCols = nHorzRays;
+	rayInSector_.assign(nCols, 0);
+	renderInSector_.assign(numRenders, 0);
+	for (size_t renderIdx = 0; renderIdx < numRenders; renderIdx++)
+	{
+		for (int i = 0; i < numHorzRaysPerRender; i++)
+		{
+			const size_t iAbs = i + numHorzRaysPerRender * renderIdx;
+			if (iAbs >= nCols) break;
+
+			const double azimuth = renderMidAngles_[renderIdx] + rayHorzAngle(i);
+			const bool inSector =
+				fullCircle || mrpt::math::wrapTo2Pi(azimuth - sectorMin) <= sectorWidthWrap;
+
+			rayInSector_[iAbs] = inSector;
+			if (inSector) renderInSector_[renderIdx] = 1;
+		}
+	}
 }
 
 void Lidar3D::internalGuiUpdate(
@@ -143,7 +331,7 @@ void Lidar3D::internalGuiUpdate(
 		gui_uptodate_ = true;
 	}
 
-	const mrpt::poses::CPose3D p = vehicle_.getCPose3D() + sensorPoseOnVeh_;
+	const mrpt::poses::CPose3D p = sensorGlobalPose(sensorPoseOnVeh_);
 
 	if (glPoints_) glPoints_->setPose(p);
 	if (gl_sensor_fov_) gl_sensor_fov_->setPose(p);
@@ -177,9 +365,7 @@ void Lidar3D::simul_post_timestep(const TSimulContext& context)
 	}
 
 	// Keep sensor global pose up-to-date:
-	const auto& p = vehicle_.getPose();
-	const auto globalSensorPose = p + sensorPoseOnVeh_.asTPose();
-	Simulable::setPose(globalSensorPose, false /*do not notify*/);
+	Simulable::setPose(sensorGlobalPose(sensorPoseOnVeh_).asTPose(), false /*do not notify*/);
 }
 
 void Lidar3D::notifySimulableSetPose(const mrpt::math::TPose3D& newPose)
@@ -319,62 +505,9 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	curObs->pointcloud = curPtsPtr;
 
 	// Create FBO on first use, now that we are here at the GUI / OpenGL thread.
-	constexpr double camModel_hFOV = 120.01_deg;
-
-	// This FBO is for camModel_hFOV only:
-	// Minimum horz resolution=360deg /120 deg
-	const int FBO_NCOLS =
-		mrpt::round(horzResolutionFactor_ * horzNumRays_ / (2 * M_PI / camModel_hFOV));
-
-	mrpt::img::TCamera camModel;
-	camModel.ncols = FBO_NCOLS;
-	camModel.cx(camModel.ncols / 2.0);
-	camModel.fx(camModel.cx() / tan(camModel_hFOV * 0.5));	// tan(FOV/2)=cx/fx
-
-	// Build list of vertical angles, in increasing order (first negative, below
-	// horizontal plane, final ones positive, above it):
-	if (vertical_ray_angles_.empty())
-	{
-		if (vertical_ray_angles_str_.empty())
-		{
-			// even distribution:
-			vertical_ray_angles_.resize(vertNumRays_);
-			for (int i = 0; i < vertNumRays_; i++)
-			{
-				vertical_ray_angles_[i] = vertical_fov_ * (-0.5 + i * 1.0 / (vertNumRays_ - 1));
-			}
-		}
-		else
-		{
-			// custom distribution:
-			std::vector<std::string> vertAnglesStrs;
-			mrpt::system::tokenize(vertical_ray_angles_str_, " \t\r\n", vertAnglesStrs);
-			ASSERT_EQUAL_(vertAnglesStrs.size(), static_cast<size_t>(vertNumRays_));
-			std::set<double> angs;
-			for (const auto& s : vertAnglesStrs) angs.insert(std::stod(s));
-			ASSERT_EQUAL_(angs.size(), static_cast<size_t>(vertNumRays_));
-			for (const auto a : angs) vertical_ray_angles_.push_back(a);
-		}
-
-		// Pass to radians:
-		for (double& a : vertical_ray_angles_) a = mrpt::DEG2RAD(a);
-	}
-
-	// worst vFOV case: at each sub-scan render corner:
-	// (derivation in hand notes... to be passed to a paper)
-	using mrpt::square;
-	const double vertFOVMax = vertical_ray_angles_.back();
-	const double vertFOVMin = std::abs(vertical_ray_angles_.front());
-
-	const int FBO_NROWS_UP = vertResolutionFactor_ * tan(vertFOVMax) *
-							 sqrt(square(camModel.fx()) + square(camModel.cx()));
-	const int FBO_NROWS_DOWN = vertResolutionFactor_ * tan(vertFOVMin) *
-							   sqrt(square(camModel.fx()) + square(camModel.cx()));
-
-	const int FBO_NROWS = FBO_NROWS_DOWN + FBO_NROWS_UP + 1;
-	camModel.nrows = FBO_NROWS;
-	camModel.cy(FBO_NROWS_UP + 1);
-	camModel.fy(camModel.fx());
+	const auto& camModel = fboCamModel_;
+	const int FBO_NCOLS = camModel.ncols;
+	const int FBO_NROWS = camModel.nrows;
 
 	if (!fbo_renderer_depth_)
 	{
@@ -392,8 +525,8 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 		fbo_renderer_depth_ = std::make_shared<mrpt::opengl::CFBORender>(p);
 	}
 
-	const size_t nCols = horzNumRays_;
-	const size_t nRows = vertNumRays_;
+	const size_t nCols = rayInSector_.size();
+	const size_t nRows = vertical_ray_angles_.size();
 
 	mrpt::math::CMatrixDouble rangeImage(nRows, nCols);
 	rangeImage.setZero();  // 0=invalid (no lidar return)
@@ -411,76 +544,9 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	const auto fixedAxisConventionRot =
 		mrpt::poses::CPose3D(0, 0, 0, -90.0_deg, 0.0_deg, -90.0_deg);
 
-	const auto vehiclePose = mrpt::poses::CPose3D(vehicle_.getPose());
+	const auto vehiclePose = vehicle_.getCPose3D();
 
-	// ----------------------------------------------------------
-	// Decompose the horizontal lidar FOV into "n" depth images,
-	// of camModel_hFOV each.
-	// ----------------------------------------------------------
-	ASSERT_GT_(horzNumRays_, 1);
-	ASSERT_GT_(vertNumRays_, 1);
-
-	constexpr bool scanIsCW = false;
-	constexpr double aperture = 2 * M_PI;
-
-	const double firstAngle = -aperture * 0.5;
-
-	const unsigned int numRenders = std::ceil((aperture / camModel_hFOV) - 1e-3);
-	const auto numHorzRaysPerRender =
-		mrpt::round(horzNumRays_ * std::min<double>(1.0, (camModel_hFOV / aperture)));
-
-	ASSERT_(numHorzRaysPerRender > 0);
-
-	// Precomputed LUT of bearings to pixel coordinates:
-	//                         cx - u
-	//  tan(horzBearing) = --------------
-	//                          fx
-	//
-	//                             cy - v
-	//  tan(vertBearing) = -------------------------
-	//                      fy / cos(horzBearing)
-	//
-	if (lut_.empty())
-	{
-		lut_.resize(numHorzRaysPerRender);
-
-		for (int i = 0; i < numHorzRaysPerRender; i++)
-		{
-			lut_[i].column.resize(nRows);
-
-			const double horzAng =
-				(scanIsCW ? -1 : 1) *
-				(camModel_hFOV * 0.5 - i * camModel_hFOV / (numHorzRaysPerRender - 1));
-
-			const double cosHorzAng = std::cos(horzAng);
-
-			const auto pixel_u = mrpt::saturate_val<float>(
-				camModel.cx() - camModel.fx() * std::tan(horzAng), 0, camModel.ncols - 1);
-
-			for (size_t j = 0; j < nRows; j++)
-			{
-				auto& entry = lut_[i].column[j];
-
-				const double vertAng = vertical_ray_angles_.at(j);
-				const double cosVertAng = std::cos(vertAng);
-
-				const auto pixel_v = camModel.cy() - camModel.fy() * std::tan(vertAng) / cosHorzAng;
-
-				// out of the simulated camera (should not happen?)
-				if (pixel_v < 0 || pixel_v >= static_cast<int>(camModel.nrows)) continue;
-
-				entry.u = pixel_u;
-				entry.v = pixel_v;
-				entry.depth2range = 1.0f / (cosHorzAng * cosVertAng);
-			}
-		}
-	}
-	else
-	{
-		// check:
-		ASSERT_EQUAL_(lut_.size(), static_cast<size_t>(numHorzRaysPerRender));
-		ASSERT_EQUAL_(lut_.at(0).column.size(), nRows);
-	}
+	const int numHorzRaysPerRender = static_cast<int>(lut_.size());
 
 	// ----------------------------------------------------------
 	// "DEPTH camera" to generate lidar readings:
@@ -512,10 +578,12 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 	const auto& depth_log2lin_lut = depth_log2lin.lut_from_zn_zf(minRange_, maxRange_);
 #endif
 
-	for (size_t renderIdx = 0; renderIdx < numRenders; renderIdx++)
+	for (size_t renderIdx = 0; renderIdx < renderMidAngles_.size(); renderIdx++)
 	{
-		const double thisRenderMidAngle =
-			firstAngle + (camModel_hFOV / 2.0 + camModel_hFOV * renderIdx) * (scanIsCW ? 1 : -1);
+		// Nothing to simulate in this sub-scan?
+		if (!renderInSector_[renderIdx]) continue;
+
+		const double thisRenderMidAngle = renderMidAngles_[renderIdx];
 
 		const auto thisDepthSensorPoseWrtSensor =
 			mrpt::poses::CPose3D::FromYawPitchRoll(thisRenderMidAngle, 0.0, 0.0) +
@@ -561,6 +629,7 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 		{
 			const int iAbs = i + numHorzRaysPerRender * renderIdx;
 			if (iAbs >= rangeImage.cols()) continue;  // we don't need this image part
+			if (!rayInSector_[iAbs]) continue;
 
 			for (unsigned int j = 0; j < nRows; j++)
 			{
@@ -611,7 +680,7 @@ void Lidar3D::simulateOn3DScene(mrpt::opengl::COpenGLScene& world3DScene)
 
 #if defined(HAVE_POINTS_XYZIRT)
 				// Add "ring" field:
-				curPtsPtr->getPointsBufferRef_ring()->push_back(j);
+				curPtsPtr->getPointsBufferRef_ring()->push_back(ringIds_[j]);
 
 				// Add "timestamp" field: all to zero since we are simulating an ideal "flash"
 				// lidar:
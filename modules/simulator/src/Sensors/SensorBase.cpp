@@ -8,6 +8,7 @@
   +-------------------------------------------------------------------------+ */
 
 #include <mrpt/core/format.h>
+#include <mvsim/Sensors/CameraRig.h>
 #include <mvsim/Sensors/CameraSensor.h>
 #include <mvsim/Sensors/DepthCameraSensor.h>
 #include <mvsim/Sensors/GNSS.h>
@@ -49,6 +50,7 @@ void register_all_sensors()
 	REGISTER_SENSOR("laser", LaserScanner)
 	REGISTER_SENSOR("rgbd_camera", DepthCameraSensor)
 	REGISTER_SENSOR("camera", CameraSensor)
+	REGISTER_SENSOR("camera_rig", CameraRig)
 	REGISTER_SENSOR("lidar3d", Lidar3D)
 	REGISTER_SENSOR("imu", IMU)
 	REGISTER_SENSOR("gnss", GNSS)
@@ -90,6 +92,24 @@ SensorBase::SensorBase(Simulable& vehicle)
 
 SensorBase::~SensorBase() = default;
 
+mrpt::poses::CPose3D SensorBase::sensorGlobalPose(
+	const mrpt::poses::CPose3D& sensorPoseOnVehicle) const
+{
+	const uint64_t vehVersion = vehicle_.getPoseVersion();
+
+	std::lock_guard lck(globalPoseCacheMtx_);
+
+	if (!globalPoseCache_ || globalPoseCache_->vehiclePoseVersion != vehVersion ||
+		!(globalPoseCache_->sensorPoseOnVehicle == sensorPoseOnVehicle))
+	{
+		auto& c = globalPoseCache_.emplace();
+		c.vehiclePoseVersion = vehVersion;
+		c.sensorPoseOnVehicle = sensorPoseOnVehicle;
+		c.globalPose = vehicle_.getCPose3D() + sensorPoseOnVehicle;
+	}
+	return globalPoseCache_->globalPose;
+}
+
 SensorBase::Ptr SensorBase::factory(Simulable& parent, const rapidxml::xml_node<char>* root)
 {
 	register_all_sensors();
@@ -161,6 +181,9 @@ void SensorBase::reportNewObservation(
 {
 	if (!obs) return;
 
+	// In partitioned mode, only the tile simulating the vehicle reports it:
+	if (!world_->isPartitionPublisher(vehicle_.getName())) return;
+
 	// Notify the world:
 	world_->dispatchOnObservation(vehicle_, obs);
 
@@ -189,6 +212,7 @@ void SensorBase::reportNewObservation_lidar_2d(
 
 #if defined(MVSIM_HAS_ZMQ) && defined(MVSIM_HAS_PROTOBUF)
 	if (publishTopic_.empty()) return;
+	if (!world_->isPartitionPublisher(vehicle_.getName())) return;
 
 	mvsim_msgs::ObservationLidar2D msg;
 	msg.set_unixtimestamp(mrpt::Clock::toDouble(obs->timestamp));
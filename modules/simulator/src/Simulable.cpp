@@ -63,19 +63,19 @@ void Simulable::simul_post_timestep(const TSimulContext& context)
 	{
 		std::unique_lock lck(q_mtx_);
 
-		// simulable_parent_->physical_objects_mtx(): already locked by caller
-
 		// Pos:
 		const b2Vec2& pos = b2dBody_->GetPosition();
 		const float angle = b2dBody_->GetAngle();
+		if (q_.x != pos(0) || q_.y != pos(1) || q_.yaw != angle) poseVersion_++;
 		q_.x = pos(0);
 		q_.y = pos(1);
 		q_.yaw = angle;
 		// The rest (z,pitch,roll) will be always 0, unless other
 		// world-element modifies them! (e.g. elevation map)
 
-		// Update the GUI element **poses** only:
-		if (auto* vo = meAsVisualObject(); vo) vo->guiUpdate(std::nullopt, std::nullopt);
+		// Note: 3D scene objects are not touched from here. The GUI/sensors
+		// thread pulls the latest q_ once per frame, in
+		// World::internalUpdate3DSceneObjects().
 
 		// Vel:
 		const b2Vec2& vel = b2dBody_->GetLinearVelocity();
@@ -133,6 +133,17 @@ void Simulable::apply_force(
 { /* default: do nothing*/
 }
 
+Simulable::KinematicState Simulable::getKinematicState() const
+{
+	std::shared_lock lck(q_mtx_);
+
+	KinematicState s;
+	s.pose = q_;
+	s.twist = dq_;
+	s.linearAcceleration = ddq_lin_;
+	return s;
+}
+
 mrpt::math::TTwist2D Simulable::getVelocityLocal() const
 {
 	std::shared_lock lck(q_mtx_);
@@ -152,7 +163,20 @@ mrpt::poses::CPose2D Simulable::getCPose2D() const
 mrpt::poses::CPose3D Simulable::getCPose3D() const
 {
 	std::shared_lock lck(q_mtx_);
-	return mrpt::poses::CPose3D(q_);
+	std::lock_guard lckCache(cachedCPose3DMtx_);
+
+	if (cachedCPose3DVersion_ != poseVersion_)
+	{
+		cachedCPose3D_ = mrpt::poses::CPose3D(q_);
+		cachedCPose3DVersion_ = poseVersion_;
+	}
+	return cachedCPose3D_;
+}
+
+uint64_t Simulable::getPoseVersion() const
+{
+	std::shared_lock lck(q_mtx_);
+	return poseVersion_;
 }
 
 bool Simulable::isInCollision() const
@@ -382,6 +406,9 @@ void Simulable::internalHandlePublish(const TSimulContext& context)
 
 	if (publishPoseTopic_.empty() && publishRelativePoseTopic_.empty()) return;
 
+	// In partitioned mode, only one tile publishes each object:
+	if (!context.world->isPartitionPublisher(name_)) return;
+
 	auto& client = context.world->commsClient();
 
 	const double tNow = mrpt::Clock::toDouble(mrpt::Clock::now());
@@ -471,10 +498,8 @@ void Simulable::setPose(const mrpt::math::TPose3D& p, bool notifyChange) const
 
 		Simulable& me = const_cast<Simulable&>(*this);
 
+		if (!(me.q_ == p)) me.poseVersion_++;
 		me.q_ = p;
-
-		// Update the GUI element poses only:
-		if (auto* vo = me.meAsVisualObject(); vo) vo->guiUpdate(std::nullopt, std::nullopt);
 	}
 
 	if (notifyChange) const_cast<Simulable*>(this)->notifySimulableSetPose(p);
@@ -20,6 +20,7 @@
 #include <mvsim/VehicleDynamics/VehicleDifferential.h>
 #include <mvsim/World.h>
 
+#include <limits>
 #include <map>
 #include <rapidxml.hpp>
 #include <string>
@@ -359,25 +360,47 @@ VehicleBase::Ptr VehicleBase::factory(World* parent, const std::string& xml_text
 
 void VehicleBase::simul_pre_timestep(const TSimulContext& context)
 {
-	Simulable::simul_pre_timestep(context);
 	for (auto& s : sensors_) s->simul_pre_timestep(context);
 
+	const size_t nW = getNumWheels();
+
+	// Sleeping vehicles still run their controllers, so a new command wakes
+	// them up, but skip all the rest:
+	const bool wasSleeping = sleeping_;
+	if (wasSleeping)
+	{
+		wheelTorque_.assign(nW, 0.0);
+		invoke_motor_controllers(context, wheelTorque_);
+		if (!internal_must_wake_up(wheelTorque_)) return;
+		internal_wake_up();
+	}
+
+	Simulable::simul_pre_timestep(context);
+
 	// Update wheels position (they may turn, etc. as in an Ackermann
-	// configuration)
+	// configuration). Only for those whose yaw actually changed:
+	fixture_wheels_yaw_.resize(fixture_wheels_.size(), std::numeric_limits<double>::quiet_NaN());
 	for (size_t i = 0; i < fixture_wheels_.size(); i++)
 	{
+		const Wheel& w = wheels_info_[i];
+		if (w.yaw == fixture_wheels_yaw_[i]) continue;
+
 		b2PolygonShape* wheelShape = dynamic_cast<b2PolygonShape*>(fixture_wheels_[i]->GetShape());
-		wheelShape->SetAsBox(
-			wheels_info_[i].diameter * 0.5, wheels_info_[i].width * 0.5,
-			b2Vec2(wheels_info_[i].x, wheels_info_[i].y), wheels_info_[i].yaw);
+		wheelShape->SetAsBox(w.diameter * 0.5, w.width * 0.5, b2Vec2(w.x, w.y), w.yaw);
+		fixture_wheels_yaw_[i] = w.yaw;
 	}
 
 	// Apply motor forces/torques:
-	const std::vector<double> wheelTorque = invoke_motor_controllers(context);
+	if (!wasSleeping)
+	{
+		wheelTorque_.assign(nW, 0.0);
+		invoke_motor_controllers(context, wheelTorque_);
+	}
+	ASSERT_EQUAL_(wheelTorque_.size(), nW);
+
+	lastMotorTorquesNull_ = !internal_must_wake_up(wheelTorque_);
 
 	// Apply friction model at each wheel:
-	const size_t nW = getNumWheels();
-	ASSERT_EQUAL_(wheelTorque.size(), nW);
 
 	// Part of the vehicle weight on each wheel:
 	const double gravity = parent()->get_gravity();
@@ -385,13 +408,20 @@ void VehicleBase::simul_pre_timestep(const TSimulContext& context)
 	const double massPerWheel = getChassisMass() / nW;
 	const double weightPerWheel = massPerWheel * gravity;
 
-	const std::vector<mrpt::math::TVector2D> wheelLocalVels =
-		getWheelsVelocityLocal(getVelocityLocal());
+	getWheelsVelocityLocal(getVelocityLocal(), wheelLocalVels_);
 
-	ASSERT_EQUAL_(wheelLocalVels.size(), nW);
+	// Look up the wheel loggers only once:
+	if (wheelLoggers_.size() != nW)
+	{
+		wheelLoggers_.resize(nW);
+		for (size_t i = 0; i < nW; i++)
+			wheelLoggers_[i] = getLoggerPtr(LOGGER_WHEEL + std::to_string(i + 1));
+	}
 
 	// For visualization only
-	std::vector<mrpt::math::TSegment3D> forceVectors, torqueVectors;
+	const bool showForces = world_->guiOptions_.show_forces;
+	forceVectors_.clear();
+	torqueVectors_.clear();
 
 	for (size_t i = 0; i < nW; i++)
 	{
@@ -399,11 +429,12 @@ void VehicleBase::simul_pre_timestep(const TSimulContext& context)
 		Wheel& w = getWheelInfo(i);
 
 		FrictionBase::TFrictionInput fi(context, w);
-		fi.motorTorque = -wheelTorque[i];  // "-" => Forwards is negative
+		fi.motorTorque = -wheelTorque_[i];	// "-" => Forwards is negative
 		fi.weight = weightPerWheel;
-		fi.wheelCogLocalVel = wheelLocalVels[i];
+		fi.wheelCogLocalVel = wheelLocalVels_[i];
 
-		friction_->setLogger(getLoggerPtr(LOGGER_WHEEL + std::to_string(i + 1)));
+		auto& logger = wheelLoggers_[i];
+		friction_->setLogger(logger);
 
 		// eval friction (in the frame of the vehicle):
 		const mrpt::math::TPoint2D F_r = friction_->evaluate_friction(fi);
@@ -421,20 +452,17 @@ void VehicleBase::simul_pre_timestep(const TSimulContext& context)
 
 		// log
 		{
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(
-				DL_TIMESTAMP, context.simul_time);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(WL_TORQUE, fi.motorTorque);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(WL_WEIGHT, fi.weight);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(
-				WL_VEL_X, fi.wheelCogLocalVel.x);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(
-				WL_VEL_Y, fi.wheelCogLocalVel.y);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(WL_FRIC_X, F_r.x);
-			loggers_[LOGGER_WHEEL + std::to_string(i + 1)]->updateColumn(WL_FRIC_Y, F_r.y);
+			logger->updateColumn(DL_TIMESTAMP, context.simul_time);
+			logger->updateColumn(WL_TORQUE, fi.motorTorque);
+			logger->updateColumn(WL_WEIGHT, fi.weight);
+			logger->updateColumn(WL_VEL_X, fi.wheelCogLocalVel.x);
+			logger->updateColumn(WL_VEL_Y, fi.wheelCogLocalVel.y);
+			logger->updateColumn(WL_FRIC_X, F_r.x);
+			logger->updateColumn(WL_FRIC_Y, F_r.y);
 		}
 
 		// save it for optional rendering:
-		if (world_->guiOptions_.show_forces)
+		if (showForces)
 		{
 			// [meters/N]
 			const double forceScale = world_->guiOptions_.force_scale;
@@ -443,21 +471,21 @@ void VehicleBase::simul_pre_timestep(const TSimulContext& context)
 			const mrpt::math::TPoint3D pt2 =
 				pt1 + mrpt::math::TPoint3D(wForce.x, wForce.y, 0) * forceScale;
 
-			forceVectors.emplace_back(pt1, pt2);
+			forceVectors_.emplace_back(pt1, pt2);
 
 			const mrpt::math::TPoint3D pt2_t =
-				pt1 + mrpt::math::TPoint3D(0, 0, wheelTorque[i]) * forceScale;
+				pt1 + mrpt::math::TPoint3D(0, 0, wheelTorque_[i]) * forceScale;
 
-			torqueVectors.emplace_back(pt1, pt2_t);
+			torqueVectors_.emplace_back(pt1, pt2_t);
 		}
 	}
 
 	// Save forces for optional rendering:
-	if (world_->guiOptions_.show_forces)
+	if (showForces)
 	{
 		std::lock_guard<std::mutex> csl(forceSegmentsForRenderingMtx_);
-		forceSegmentsForRendering_ = forceVectors;
-		torqueSegmentsForRendering_ = torqueVectors;
+		forceSegmentsForRendering_ = forceVectors_;
+		torqueSegmentsForRendering_ = torqueVectors_;
 	}
 }
 
@@ -490,8 +518,9 @@ void VehicleBase::simul_post_timestep(const TSimulContext& context)
 			w.setPhi(::fmod(cur_abs_phi, 2 * M_PI) * (w.getPhi() < 0.0 ? -1.0 : 1.0));
 	}
 
-	const auto q = getPose();
-	const auto dq = getTwist();
+	const auto ks = getKinematicState();
+	const auto& q = ks.pose;
+	const auto& dq = ks.twist;
 
 	loggers_[LOGGER_POSE]->updateColumn(DL_TIMESTAMP, context.simul_time);
 	loggers_[LOGGER_POSE]->updateColumn(PL_Q_X, q.x);
@@ -507,11 +536,83 @@ void VehicleBase::simul_post_timestep(const TSimulContext& context)
 	{
 		writeLogStrings();
 	}
+
+	internal_update_sleeping_state(context);
+}
+
+bool VehicleBase::internal_must_wake_up(const std::vector<double>& wheelTorque)
+{
+	// New motor command?
+	for (const double t : wheelTorque)
+		if (std::abs(t) > 1e-6) return true;
+
+	if (!sleeping_) return false;
+
+	// Steering changes give no torque (e.g. an Ackermann vehicle at rest told
+	// to turn its wheels only), but the wheel fixtures must follow them:
+	for (size_t i = 0; i < fixture_wheels_yaw_.size(); i++)
+		if (wheels_info_[i].yaw != fixture_wheels_yaw_[i]) return true;
+
+	// Any new twist command, even if it does not need any torque yet:
+	if (auto* c = getControllerInterface(); c && c->getTwistCommand() != sleepingTwistCommand_)
+		return true;
+
+	// Woken up by Box2D (e.g. touched by an awake body)?
+	if (b2dBody_ && b2dBody_->IsAwake()) return true;
+
+	// Moved from outside (e.g. set_pose service, or the GUI)?
+	const auto p = getPose();
+	return p.x != sleepingPose_.x || p.y != sleepingPose_.y || p.yaw != sleepingPose_.yaw;
+}
+
+void VehicleBase::internal_update_sleeping_state(const TSimulContext& context)
+{
+	if (sleeping_ || !b2dBody_ || !world_->sleepingEnabled_) return;
+
+	// Animations are driven by Simulable::simul_pre_timestep(), which sleeping
+	// vehicles skip:
+	if (isAnimated()) return;
+
+	const auto dq = getTwist();
+	const bool atRest = lastMotorTorquesNull_ &&
+						std::hypot(dq.vx, dq.vy) < world_->sleepLinearSpeed_ &&
+						std::abs(dq.omega) < world_->sleepAngularSpeed_;
+	if (!atRest)
+	{
+		timeAtRest_ = 0;
+		return;
+	}
+
+	timeAtRest_ += context.dt;
+	if (timeAtRest_ < world_->sleepTime_) return;
+
+	// Go to sleep:
+	sleeping_ = true;
+	sleepingPose_ = getPose();
+	if (auto* c = getControllerInterface(); c) sleepingTwistCommand_ = c->getTwistCommand();
+	setTwist(mrpt::math::TTwist2D(0, 0, 0));
+	for (auto& w : wheels_info_) w.setW(0);
+	b2dBody_->SetAwake(false);
+}
+
+void VehicleBase::internal_wake_up()
+{
+	sleeping_ = false;
+	timeAtRest_ = 0;
+	if (b2dBody_) b2dBody_->SetAwake(true);
 }
 
 /** Last time-step velocity of each wheel's center point (in local coords) */
 std::vector<mrpt::math::TVector2D> VehicleBase::getWheelsVelocityLocal(
 	const mrpt::math::TTwist2D& veh_vel_local) const
+{
+	std::vector<mrpt::math::TVector2D> vels;
+	getWheelsVelocityLocal(veh_vel_local, vels);
+	return vels;
+}
+
+void VehicleBase::getWheelsVelocityLocal(
+	const mrpt::math::TTwist2D& veh_vel_local, std::vector<mrpt::math::TVector2D>& vels) const
 {
 	// Each wheel velocity is:
 	// v_w = v_veh + \omega \times wheel_pos
@@ -521,7 +622,7 @@ std::vector<mrpt::math::TVector2D> VehicleBase::getWheelsVelocityLocal(
 	const double w = veh_vel_local.omega;  // vehicle w
 
 	const size_t nW = this->getNumWheels();
-	std::vector<mrpt::math::TVector2D> vels(nW);
+	vels.resize(nW);
 
 	for (size_t i = 0; i < nW; i++)
 	{
@@ -530,7 +631,6 @@ std::vector<mrpt::math::TVector2D> VehicleBase::getWheelsVelocityLocal(
 		vels[i].x = veh_vel_local.vx - w * wheel.y;
 		vels[i].y = veh_vel_local.vy + w * wheel.x;
 	}
-	return vels;
 }
 
 void VehicleBase::internal_internalGuiUpdate_sensors(
@@ -648,6 +748,8 @@ void VehicleBase::create_multibody_system(b2World& world)
 
 		fixture_wheels_[i] = b2dBody_->CreateFixture(&fixtureDef);
 	}
+	fixture_wheels_yaw_.clear();
+	for (const auto& w : wheels_info_) fixture_wheels_yaw_.push_back(w.yaw);
 }
 
 void VehicleBase::internalGuiUpdate(
@@ -698,10 +800,8 @@ void VehicleBase::internalGuiUpdate(
 
 	// Update them:
 	// ----------------------------------
-	// If "viz" does not have a value, it's because we are already inside a
-	// setPose() change event, so my caller already holds the mutex and we don't
-	// need/can't acquire it again:
-	const auto objectPose = viz.has_value() ? getPose() : getPoseNoLock();
+	// Pull the latest pose written by the physics thread:
+	const auto objectPose = getPose();
 
 	if (glInit_)
 	{
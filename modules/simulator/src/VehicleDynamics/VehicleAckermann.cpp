@@ -161,11 +161,11 @@ void DynamicsAckermann::dynamics_load_params_from_xml(const rapidxml::xml_node<c
 }
 
 // See docs in base class:
-std::vector<double> DynamicsAckermann::invoke_motor_controllers(const TSimulContext& context)
+void DynamicsAckermann::invoke_motor_controllers(
+	const TSimulContext& context, std::vector<double>& out_torque_per_wheel)
 {
 	// Longitudinal forces at each wheel:
-	std::vector<double> out_torque_per_wheel;
-	out_torque_per_wheel.assign(4, 0.0);
+	ASSERT_EQUAL_(out_torque_per_wheel.size(), 4U);
 
 	if (controller_)
 	{
@@ -186,7 +186,6 @@ std::vector<double> DynamicsAckermann::invoke_motor_controllers(const TSimulCont
 		computeFrontWheelAngles(
 			co.steer_ang, wheels_info_[WHEEL_FL].yaw, wheels_info_[WHEEL_FR].yaw);
 	}
-	return out_torque_per_wheel;
 }
 
 void DynamicsAckermann::computeFrontWheelAngles(
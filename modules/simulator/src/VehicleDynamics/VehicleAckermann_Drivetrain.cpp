@@ -216,12 +216,11 @@ void DynamicsAckermannDrivetrain::dynamics_load_params_from_xml(
 }
 
 // See docs in base class:
-std::vector<double> DynamicsAckermannDrivetrain::invoke_motor_controllers(
-	const TSimulContext& context)
+void DynamicsAckermannDrivetrain::invoke_motor_controllers(
+	const TSimulContext& context, std::vector<double>& out_torque_per_wheel)
 {
 	// Longitudinal forces at each wheel:
-	std::vector<double> out_torque_per_wheel;
-	out_torque_per_wheel.assign(4, 0.0);
+	ASSERT_EQUAL_(out_torque_per_wheel.size(), 4U);
 	double torque_split_per_wheel[4] = {0.0};
 
 	if (controller_)
@@ -340,7 +339,6 @@ std::vector<double> DynamicsAckermannDrivetrain::invoke_motor_controllers(
 		computeFrontWheelAngles(
 			co.steer_ang, wheels_info_[WHEEL_FL].yaw, wheels_info_[WHEEL_FR].yaw);
 	}
-	return out_torque_per_wheel;
 }
 
 void DynamicsAckermannDrivetrain::computeFrontWheelAngles(
@@ -125,12 +125,10 @@ void DynamicsDifferential::dynamics_load_params_from_xml(const rapidxml::xml_nod
 }
 
 // See docs in base class:
-std::vector<double> DynamicsDifferential::invoke_motor_controllers(const TSimulContext& context)
+void DynamicsDifferential::invoke_motor_controllers(
+	const TSimulContext& context, std::vector<double>& otpw)
 {
 	// Longitudinal forces at each wheel:
-	std::vector<double> otpw;
-	otpw.assign(getNumWheels(), 0.0);
-
 	if (controller_)
 	{
 		// Invoke controller:
@@ -161,7 +159,6 @@ std::vector<double> DynamicsDifferential::invoke_motor_controllers(const TSimulC
 				THROW_EXCEPTION("Unexpected number of wheels!");
 		};
 	}
-	return otpw;
 }
 
 void DynamicsDifferential::invoke_motor_controllers_post_step(const TSimulContext& context)
@@ -10,6 +10,7 @@
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/CPolyhedron.h>
 #include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/version.h>
 #include <mvsim/Block.h>
 #include <mvsim/CollisionShapeCache.h>
@@ -50,10 +51,8 @@ void VisualObject::guiUpdate(
 	const auto* meSim = dynamic_cast<Simulable*>(this);
 	ASSERT_(meSim);
 
-	// If "viz" does not have a value, it's because we are already inside a
-	// setPose() change event, so my caller already holds the mutex and we don't
-	// need/can't acquire it again:
-	const auto objectPose = viz.has_value() ? meSim->getPose() : meSim->getPoseNoLock();
+	// Pull the latest pose written by the physics thread:
+	const auto objectPose = meSim->getPose();
 
 	if (glCustomVisual_ && viz.has_value() && physical.has_value())
 	{
@@ -225,6 +224,8 @@ bool VisualObject::implParseVisual(const rapidxml::xml_node<char>& visNode)
 
 	if (modelURI.empty()) return false;
 
+	mrpt::system::CTicTac tic;
+
 	const std::string localFileName = world_->xmlPathToActualPath(modelURI);
 
 	auto& gModelsCache = ModelsCache::Instance();
@@ -235,6 +236,9 @@ bool VisualObject::implParseVisual(const rapidxml::xml_node<char>& visNode)
 	addCustomVisualization(
 		glModel, mrpt::poses::CPose3D(modelPose), modelScale, objectName, modelURI);
 
+	// Includes the collision shape:
+	world_->register_resource_load("model", modelURI, tic.Tac());
+
 	return true;  // yes, we have a custom viz model
 
 	MRPT_TRY_END
@@ -10,11 +10,13 @@
 #include <mrpt/math/TTwist2D.h>
 #include <mrpt/obs/CObservationOdometry.h>
 #include <mrpt/poses/CPose3DQuat.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/system/filesystem.h>	 // filePathSeparatorsToNative()
 #include <mrpt/version.h>
 #include <mvsim/World.h>
 
 #include <algorithm>  // count()
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <stdexcept>
@@ -22,12 +24,26 @@
 using namespace mvsim;
 using namespace std;
 
+namespace
+{
+// Number of World objects alive in this process, since some OpenGL resources
+// (e.g. the 3D models cache) are shared among all of them:
+std::atomic_int g_numLiveWorlds = 0;
+}  // namespace
+
 // Default ctor: inits empty world.
-World::World() : mrpt::system::COutputLogger("mvsim::World") { this->clear_all(); }
+World::World() : mrpt::system::COutputLogger("mvsim::World")
+{
+	g_numLiveWorlds++;
+	this->clear_all();
+}
 
 // Dtor.
 World::~World()
 {
+	// Do not leave other partitions waiting for us:
+	if (partitionConnected_) internal_partition_publish_shutdown();
+
 	if (gui_thread_.joinable())
 	{
 		MRPT_LOG_DEBUG("Dtor: Waiting for GUI thread to quit...");
@@ -42,6 +58,8 @@ World::~World()
 
 	this->clear_all();
 	box2d_world_.reset();
+
+	g_numLiveWorlds--;
 }
 
 // Resets the entire simulation environment to an empty world.
@@ -65,6 +83,9 @@ void World::clear_all()
 	vehicles_.clear();
 	worldElements_.clear();
 	blocks_.clear();
+
+	std::lock_guard<std::mutex> lckStats(resourceLoadStatsMtx_);
+	resourceLoadStats_.clear();
 }
 
 void World::internal_initialize()
@@ -99,7 +120,13 @@ void World::internal_initialize()
 
 std::string World::xmlPathToActualPath(const std::string& modelURI) const
 {
+	if (!RemoteResourcesManager::is_remote(modelURI))
+		return local_to_abs_path(remoteResources_.resolve_path(modelURI));
+
+	mrpt::system::CTicTac tic;
 	std::string actualFileName = remoteResources_.resolve_path(modelURI);
+	register_resource_load("fetch", modelURI, tic.Tac());
+
 	return local_to_abs_path(actualFileName);
 }
 
@@ -147,6 +174,8 @@ void World::connectToServer()
 	//
 	client_.setVerbosityLevel(this->getMinLoggingLevel());
 	client_.serverHostAddress(serverAddress_);
+	// Each partition process needs a unique node name:
+	if (partitionOptions_.enabled()) client_.setName("World_" + partitionOptions_.name);
 	client_.connect();
 
 	// Let objects register topics / services:
@@ -159,6 +188,10 @@ void World::connectToServer()
 	}
 	lckListObjs.unlock();
 
+	// Distributed simulation, if enabled. It must be before advertising the
+	// services, whose names depend on the tile:
+	internal_partition_connect();
+
 	// global services:
 	internal_advertiseServices();
 }
@@ -185,6 +218,14 @@ void World::free_opengl_resources()
 	worldPhysical_.clear();
 	worldVisual_->clear();
 
+	internal_free_shared_opengl_resources();
+}
+
+void World::internal_free_shared_opengl_resources()
+{
+	// Other worlds in this process may still be using them:
+	if (g_numLiveWorlds > 1) return;
+
 	VisualObject::FreeOpenGLResources();
 }
 
@@ -193,11 +234,10 @@ bool World::sensor_has_to_create_egl_context()
 	// If we have a GUI, reuse that context:
 	if (!headless()) return false;
 
-	// otherwise, just the first time:
-	static bool first = true;
-	bool ret = first;
-	first = false;
-	return ret;
+	// otherwise, just the first time for this world. Several worlds may
+	// live in one process (e.g. Python vectorized environments), each one
+	// with its own headless rendering thread and context:
+	return !eglContextCreated_.exchange(true);
 }
 
 std::optional<mvsim::TJoyStickEvent> World::getJoystickState() const
@@ -279,11 +319,7 @@ std::set<float> World::getElevationsAt(const mrpt::math::TPoint2Df& worldXY) con
 
 	// Optimized search for potential objects that influence this query:
 	// 1) world elements: assuming they are few, visit them all.
-	for (const auto& obj : worldElements_)
-	{
-		const auto optZ = obj->getElevationAt(worldXY);
-		if (optZ) ret.insert(*optZ);
-	}
+	for (const auto& obj : worldElements_) obj->getElevationsAt(worldXY, ret);
 
 	// 2) blocks: by hashed 2D LUT.
 	const World::LUTCache& lut = getLUTCacheOfObjects();
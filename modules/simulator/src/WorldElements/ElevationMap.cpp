@@ -8,6 +8,7 @@
   +-------------------------------------------------------------------------+ */
 
 #include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/version.h>
 #include <mvsim/VehicleBase.h>
 #include <mvsim/World.h>
@@ -69,7 +70,9 @@ void ElevationMap::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	mrpt::math::CMatrixFloat elevation_data;
 	if (!sElevationImgFile.empty())
 	{
-		sElevationImgFile = world_->local_to_abs_path(sElevationImgFile);
+		mrpt::system::CTicTac tic;
+		const auto uri = sElevationImgFile;
+		sElevationImgFile = world_->xmlPathToActualPath(sElevationImgFile);
 
 		mrpt::img::CImage imgElev;
 		if (!imgElev.loadFromFile(sElevationImgFile, 0 /*force load grayscale*/))
@@ -77,6 +80,8 @@ void ElevationMap::loadConfigFrom(const rapidxml::xml_node<char>* root)
 				"[ElevationMap] ERROR: Cannot read elevation image '%s'",
 				sElevationImgFile.c_str()));
 
+		world_->register_resource_load("elevation_map", uri, tic.Tac());
+
 		// Scale: [0,1] => [min_z,max_z]
 		// Get image normalized in range [0,1]
 		imgElev.getAsMatrix(elevation_data);
@@ -112,6 +117,8 @@ void ElevationMap::loadConfigFrom(const rapidxml::xml_node<char>* root)
 	bool has_mesh_image = false;
 	if (!sTextureImgFile.empty())
 	{
+		mrpt::system::CTicTac tic;
+		const auto uri = sTextureImgFile;
 		sTextureImgFile = world_->xmlPathToActualPath(sTextureImgFile);
 
 		if (!mesh_image.loadFromFile(sTextureImgFile))
@@ -119,6 +126,8 @@ void ElevationMap::loadConfigFrom(const rapidxml::xml_node<char>* root)
 				"[ElevationMap] ERROR: Cannot read texture image '%s'", sTextureImgFile.c_str()));
 		has_mesh_image = true;
 
+		world_->register_resource_load("texture", uri, tic.Tac());
+
 		// Apply rotation:
 		switch (texture_rotate)
 		{
@@ -12,6 +12,7 @@
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/poses/CPose2D.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/version.h>
 #include <mvsim/World.h>
@@ -46,7 +47,9 @@ void OccupancyGridMap::doLoadConfigFrom(const rapidxml::xml_node<char>* root)
 	if (!xml_file || !xml_file->value())
 		throw std::runtime_error("Error: <file></file> XML entry not found inside gridmap node!");
 
-	const string sFile = world_->local_to_abs_path(xml_file->value());
+	mrpt::system::CTicTac tic;
+
+	const string sFile = world_->xmlPathToActualPath(xml_file->value());
 	const string sFileExt = mrpt::system::extractFileExtension(sFile, true /*ignore gz*/);
 
 	// ROS YAML map files:
@@ -83,6 +86,10 @@ void OccupancyGridMap::doLoadConfigFrom(const rapidxml::xml_node<char>* root)
 				mrpt::format("[OccupancyGridMap] ERROR: File not found '%s'", sFile.c_str()));
 	}
 
+	updateRaycaster();
+
+	world_->register_resource_load("gridmap", xml_file->value(), tic.Tac());
+
 	{
 		// Other general params:
 		TParameterDefinitions ps;
@@ -170,6 +177,8 @@ void OccupancyGridMap::simul_pre_timestep([[maybe_unused]] const TSimulContext&
 		{
 			TInfoPerCollidableobj& ipv = obstacles_for_each_obj_[obj_idx];
 			ipv.max_obstacles_ranges = itVeh->second->getMaxVehicleRadius() * 1.50f;
+			ipv.sleeping =
+				itVeh->second->isSleeping() || world_->isPartitionGhost(itVeh->first);
 			const mrpt::math::TPose3D& pose = itVeh->second->getPose();
 			ipv.pose = mrpt::poses::CPose2D(
 				pose.x, pose.y,
@@ -179,6 +188,7 @@ void OccupancyGridMap::simul_pre_timestep([[maybe_unused]] const TSimulContext&
 		{
 			TInfoPerCollidableobj& ipv = obstacles_for_each_obj_[obj_idx];
 			ipv.max_obstacles_ranges = block.second->getMaxBlockRadius() * 1.50f;
+			ipv.sleeping = block.second->isSleeping();
 			const mrpt::math::TPose3D& pose = block.second->getPose();
 			/* angle=0, no need to rotate everything to later rotate back again!
 			 */
@@ -200,18 +210,19 @@ void OccupancyGridMap::simul_pre_timestep([[maybe_unused]] const TSimulContext&
 		{
 			// 1) Simulate scan to get obstacles around the vehicle:
 			TInfoPerCollidableobj& ipv = obstacles_for_each_obj_[obj_idx];
+			if (ipv.sleeping && ipv.collide_body && !show_grid_collision_points_) continue;
+
 			mrpt::obs::CObservation2DRangeScan::Ptr& scan = ipv.scan;
 			// Upon first time, reserve mem:
 			if (!scan) scan = mrpt::obs::CObservation2DRangeScan::Create();
 
 			const float veh_max_obstacles_ranges = ipv.max_obstacles_ranges;
-			const float occup_threshold = 0.5f;
 			const size_t nRays = 50;
 
 			scan->aperture = 2.0 * M_PI;  // 360 field of view
 			scan->maxRange = veh_max_obstacles_ranges;
 
-			grid_.laserScanSimulator(*scan, ipv.pose, occup_threshold, nRays, 0.0f /*noise*/);
+			raycaster_.simulateScan(*scan, ipv.pose, nRays);
 
 			// Since we'll dilate obstacle points, let's give a bit more space
 			// as compensation:
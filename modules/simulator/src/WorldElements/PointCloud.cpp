@@ -7,13 +7,22 @@
   |   See COPYING                                                           |
   +-------------------------------------------------------------------------+ */
 
+#include <mrpt/core/bits_math.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/system/CTicTac.h>
 #include <mvsim/World.h>
 #include <mvsim/WorldElements/PointCloud.h>
 
+#include <algorithm>
+#include <array>
+#include <future>
+#include <limits>
+#include <numeric>
 #include <rapidxml.hpp>
 
+#include "PointCloudLoaders.h"
 #include "xml_utils.h"
 
 using namespace rapidxml;
@@ -32,36 +41,237 @@ void PointCloud::doLoadConfigFrom(const rapidxml::xml_node<char>* root)
 {
 	gui_uptodate_ = false;
 
+	{
+		// Other general params:
+		TParameterDefinitions ps;
+		ps["points_size"] = TParamEntry("%lf", &render_points_size_);
+		ps["points_color"] = TParamEntry("%color", &render_points_color_);
+		ps["pose_3d"] = TParamEntry("%pose3d", &pointcloud_pose_);
+		ps["decimation"] = TParamEntry("%u", &decimation_);
+		ps["bin_floats_per_point"] = TParamEntry("%u", &bin_floats_per_point_);
+		ps["octree_max_points_per_leaf"] = TParamEntry("%u", &octree_max_points_per_leaf_);
+		ps["render_max_points"] = TParamEntry("%u", &render_max_points_);
+		ps["visible_to_sensors"] = TParamEntry("%bool", &visible_to_sensors_);
+		ps["sensor_max_points"] = TParamEntry("%i", &sensor_max_points_);
+		ps["sensor_points_size"] = TParamEntry("%lf", &sensor_points_size_);
+		parse_xmlnode_children_as_param(*root, ps, world_->user_defined_variables());
+	}
+	ASSERT_GE_(decimation_, 1U);
+	ASSERT_GE_(octree_max_points_per_leaf_, 1U);
+
+	const mrpt::system::CTicTac tictac;
+
+	auto pts = mrpt::maps::CSimplePointsMap::Create();
+
 	if (auto x2d = root->first_node("file_txt_2d"); x2d && x2d->value())
 	{
 		const string sFile = world_->local_to_abs_path(x2d->value());
-
-		points_ = mrpt::maps::CSimplePointsMap::Create();
-		points_->load2D_from_text_file(sFile);
+		pts->load2D_from_text_file(sFile);
 	}
 	else if (auto x3d = root->first_node("file_txt_3d"); x3d && x3d->value())
 	{
 		const string sFile = world_->local_to_abs_path(x3d->value());
+		pts->load3D_from_text_file(sFile);
+	}
+	else if (auto xPly = root->first_node("file_ply"); xPly && xPly->value())
+	{
+		load_points_ply(world_->local_to_abs_path(xPly->value()), *pts, decimation_);
+	}
+	else if (auto xLas = root->first_node("file_las"); xLas && xLas->value())
+	{
+		// Georeferenced files: keep the points near the origin (in float32)
+		// and the rest of their coordinates in the (double) pose:
+		const auto origin =
+			load_points_las(world_->local_to_abs_path(xLas->value()), *pts, decimation_);
+		pointcloud_pose_ = pointcloud_pose_ + mrpt::poses::CPose3D::FromTranslation(origin);
 
-		points_ = mrpt::maps::CSimplePointsMap::Create();
-		points_->load3D_from_text_file(sFile);
+		world_->logFmt(
+			mrpt::system::LVL_INFO, "[PointCloud] LAS points are relative to (%.03f, %.03f, %.03f)",
+			origin.x, origin.y, origin.z);
+	}
+	else if (auto xBin = root->first_node("file_bin_xyz"); xBin && xBin->value())
+	{
+		load_points_raw_float32(
+			world_->local_to_abs_path(xBin->value()), *pts, bin_floats_per_point_, decimation_);
 	}
 	else
 	{
 		THROW_EXCEPTION("Error: No valid <file_*></file_*> XML tag was found");
 	}
 
+	points_ = pts;
+	points_->renderOptions.point_size = render_points_size_;
+	points_->renderOptions.color = mrpt::img::TColorf(render_points_color_);
+
+	internal_build_octree();
+
+	world_->logFmt(
+		mrpt::system::LVL_DEBUG, "[PointCloud] Loaded %zu points (%zu octree leaves) in %.03f s",
+		points_->size(), octreeLeaves_.size(), tictac.Tac());
+
+	gui_uptodate_ = false;
+}
+
+namespace
+{
+struct OctreeBuilder
+{
+	const float *xs, *ys, *zs;
+	std::vector<uint32_t>& idxs;
+	size_t maxPointsPerLeaf;
+
+	static constexpr int MAX_DEPTH = 20;
+
+	using leaves_t = std::vector<std::pair<size_t, size_t>>;
+
+	void split(
+		size_t i0, size_t i1, const mrpt::math::TPoint3Df& lo, const mrpt::math::TPoint3Df& hi,
+		int depth, leaves_t& leaves) const
 	{
-		// Other general params:
-		TParameterDefinitions ps;
-		ps["points_size"] = TParamEntry("%lf", &render_points_size_);
-		ps["pose_3d"] = TParamEntry("%pose3d", &pointcloud_pose_);
-		parse_xmlnode_children_as_param(*root, ps, world_->user_defined_variables());
+		if (i1 == i0) return;
+		if (i1 - i0 <= maxPointsPerLeaf || depth >= MAX_DEPTH)
+		{
+			leaves.emplace_back(i0, i1);
+			return;
+		}
+
+		const auto c = (lo + hi) * 0.5f;
+		const auto first = idxs.begin();
+
+		// Partition into octants, one axis at a time. Child "k" has bit 0 of k
+		// set if x>=c.x, bit 1 for y>=c.y, and bit 2 for z>=c.z.
+		std::array<size_t, 9> bounds;
+		bounds[0] = i0;
+		bounds[8] = i1;
+		bounds[4] = std::partition(
+						first + i0, first + i1, [&](uint32_t i) { return zs[i] < c.z; }) -
+			first;
+		for (size_t h = 0; h < 8; h += 4)
+		{
+			bounds[h + 2] = std::partition(
+								first + bounds[h], first + bounds[h + 4],
+								[&](uint32_t i) { return ys[i] < c.y; }) -
+				first;
+		}
+		for (size_t q = 0; q < 8; q += 2)
+		{
+			bounds[q + 1] = std::partition(
+								first + bounds[q], first + bounds[q + 2],
+								[&](uint32_t i) { return xs[i] < c.x; }) -
+				first;
+		}
+
+		const auto childBox = [&](size_t k)
+		{
+			return std::make_pair(
+				mrpt::math::TPoint3Df(
+					(k & 1) ? c.x : lo.x, (k & 2) ? c.y : lo.y, (k & 4) ? c.z : lo.z),
+				mrpt::math::TPoint3Df(
+					(k & 1) ? hi.x : c.x, (k & 2) ? hi.y : c.y, (k & 4) ? hi.z : c.z));
+		};
+
+		if (depth > 0)
+		{
+			for (size_t k = 0; k < 8; k++)
+			{
+				const auto [cLo, cHi] = childBox(k);
+				split(bounds[k], bounds[k + 1], cLo, cHi, depth + 1, leaves);
+			}
+			return;
+		}
+
+		// Root: build the 8 subtrees in parallel.
+		std::array<leaves_t, 8> childLeaves;
+		std::array<std::future<void>, 8> futs;
+		for (size_t k = 0; k < 8; k++)
+		{
+			futs[k] = std::async(
+				std::launch::async,
+				[&, k]()
+				{
+					const auto [cLo, cHi] = childBox(k);
+					split(bounds[k], bounds[k + 1], cLo, cHi, depth + 1, childLeaves[k]);
+				});
+		}
+		for (auto& f : futs) f.wait();
+		for (size_t k = 0; k < 8; k++)
+		{
+			futs[k].get();
+			leaves.insert(leaves.end(), childLeaves[k].begin(), childLeaves[k].end());
+		}
 	}
+};
+}  // namespace
 
-	points_->renderOptions.point_size = render_points_size_;
+void PointCloud::internal_build_octree()
+{
+	octreeLeaves_.clear();
+	octreeIndices_.clear();
 
-	gui_uptodate_ = false;
+	const size_t n = points_->size();
+	if (n == 0) return;
+
+	ASSERTMSG_(
+		n < std::numeric_limits<uint32_t>::max(),
+		"Point clouds with more than 2^32 points are not supported");
+
+	const auto& xs = points_->getPointsBufferRef_x();
+	const auto& ys = points_->getPointsBufferRef_y();
+	const auto& zs = points_->getPointsBufferRef_z();
+
+	mrpt::math::TPoint3Df lo(xs[0], ys[0], zs[0]), hi = lo;
+	for (size_t i = 1; i < n; i++)
+	{
+		mrpt::keep_min(lo.x, xs[i]);
+		mrpt::keep_min(lo.y, ys[i]);
+		mrpt::keep_min(lo.z, zs[i]);
+		mrpt::keep_max(hi.x, xs[i]);
+		mrpt::keep_max(hi.y, ys[i]);
+		mrpt::keep_max(hi.z, zs[i]);
+	}
+
+	octreeIndices_.resize(n);
+	std::iota(octreeIndices_.begin(), octreeIndices_.end(), 0);
+
+	const OctreeBuilder builder{
+		xs.data(), ys.data(), zs.data(), octreeIndices_, octree_max_points_per_leaf_};
+	builder.split(0, n, lo, hi, 0, octreeLeaves_);
+}
+
+size_t PointCloud::internal_decimation_for(size_t maxPoints) const
+{
+	const size_t n = octreeIndices_.size();
+	return (maxPoints == 0 || n <= maxPoints) ? 1 : (n + maxPoints - 1) / maxPoints;
+}
+
+mrpt::opengl::CSetOfObjects::Ptr PointCloud::internal_create_gl_points(
+	size_t maxPoints, double pointSize) const
+{
+	auto glPts = mrpt::opengl::CSetOfObjects::Create();
+	glPts->setName("PointCloud");
+	glPts->setPose(pointcloud_pose_);
+
+	const size_t decim = internal_decimation_for(maxPoints);
+
+	const auto& xs = points_->getPointsBufferRef_x();
+	const auto& ys = points_->getPointsBufferRef_y();
+	const auto& zs = points_->getPointsBufferRef_z();
+
+	// One object per octree leaf, so each one can be culled on its own:
+	for (const auto& [i0, i1] : octreeLeaves_)
+	{
+		auto glLeaf = mrpt::opengl::CPointCloud::Create();
+		glLeaf->reserve((i1 - i0 + decim - 1) / decim);
+		for (size_t k = i0; k < i1; k += decim)
+		{
+			const auto i = octreeIndices_[k];
+			glLeaf->insertPoint(xs[i], ys[i], zs[i]);
+		}
+		glLeaf->setPointSize(static_cast<float>(pointSize));
+		glLeaf->setColor_u8(render_points_color_);
+		glPts->insert(glLeaf);
+	}
+	return glPts;
 }
 
 void PointCloud::internalGuiUpdate(
@@ -71,22 +281,37 @@ void PointCloud::internalGuiUpdate(
 {
 	using namespace mrpt::math;
 
-	// 1st time call?? -> Create objects
-	if (!gl_points_ && viz && physical)
-	{
-		gl_points_ = mrpt::opengl::CSetOfObjects::Create();
-		gl_points_->setName("PointCloud");
-		gl_points_->setPose(pointcloud_pose_);
-		viz->get().insert(gl_points_);
-		physical->get().insert(gl_points_);
-	}
+	// 1st call OR points changed?
+	if (gui_uptodate_ || !points_ || !viz || !physical) return;
 
-	// 1st call OR gridmap changed?
-	if (!gui_uptodate_ && points_)
+	if (gl_points_) viz->get().removeObject(gl_points_);
+	if (gl_points_) physical->get().removeObject(gl_points_);
+	if (gl_points_sensors_) physical->get().removeObject(gl_points_sensors_);
+	gl_points_sensors_.reset();
+
+	gl_points_ = internal_create_gl_points(render_max_points_, render_points_size_);
+	viz->get().insert(gl_points_);
+
+	if (visible_to_sensors_)
 	{
-		points_->getVisualizationInto(*gl_points_);
-		gui_uptodate_ = true;
+		const double sensorPtSize =
+			sensor_points_size_ > 0 ? sensor_points_size_ : render_points_size_;
+		const size_t sensorMaxPts =
+			sensor_max_points_ < 0 ? render_max_points_ : static_cast<size_t>(sensor_max_points_);
+
+		if (internal_decimation_for(sensorMaxPts) == internal_decimation_for(render_max_points_) &&
+			sensorPtSize == render_points_size_)
+		{
+			physical->get().insert(gl_points_);
+		}
+		else
+		{
+			gl_points_sensors_ = internal_create_gl_points(sensorMaxPts, sensorPtSize);
+			physical->get().insert(gl_points_sensors_);
+		}
 	}
+
+	gui_uptodate_ = true;
 }
 
 void PointCloud::simul_pre_timestep([[maybe_unused]] const TSimulContext& context) {}
@@ -234,10 +234,8 @@ void VerticalPlane::internalGuiUpdate(
 	}
 
 	// Update them:
-	// If "viz" does not have a value, it's because we are already inside a
-	// setPose() change event, so my caller already holds the mutex and we
-	// don't need/can't acquire it again:
-	const auto objectPose = viz.has_value() ? getPose() : getPoseNoLock();
+	// Pull the latest pose written by the physics thread:
+	const auto objectPose = getPose();
 	glGroup_->setPose(objectPose);
 }
 
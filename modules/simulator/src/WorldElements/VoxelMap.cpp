@@ -0,0 +1,580 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <box2d/b2_fixture.h>
+#include <box2d/b2_polygon_shape.h>
+#include <box2d/b2_world.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/img/color_maps.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/opengl/COctoMapVoxels.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/system/CTicTac.h>
+#include <mvsim/World.h>
+#include <mvsim/WorldElements/VoxelMap.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <rapidxml.hpp>
+
+#include "PointCloudLoaders.h"
+#include "xml_utils.h"
+
+using namespace rapidxml;
+using namespace mvsim;
+using namespace std;
+
+// Compact binary file format (little-endian):
+//  - "MVSIMVOX" (8 bytes), version (uint32), resolution (float32),
+//    number of blocks (uint64)
+//  - For each block: bx, by, bz (int32) and the 8 words (uint64) of its
+//    8x8x8 voxel bits, see VoxelMap::Block.
+static const char VOXEL_FILE_MAGIC[8] = {'M', 'V', 'S', 'I', 'M', 'V', 'O', 'X'};
+static const uint32_t VOXEL_FILE_VERSION = 1;
+
+VoxelMap::VoxelMap(World* parent, const rapidxml::xml_node<char>* root) : WorldElementBase(parent)
+{
+	doLoadConfigFrom(root);
+}
+
+VoxelMap::~VoxelMap() {}
+
+void VoxelMap::doLoadConfigFrom(const rapidxml::xml_node<char>* root)
+{
+	gui_uptodate_ = false;
+
+	float resolution = 0.10f;
+	unsigned int binFloatsPerPoint = 3;
+	unsigned int decimation = 1;
+	std::string saveTo;
+	{
+		TParameterDefinitions ps;
+		ps["resolution"] = TParamEntry("%f", &resolution);
+		ps["decimation"] = TParamEntry("%u", &decimation);
+		ps["bin_floats_per_point"] = TParamEntry("%u", &binFloatsPerPoint);
+		ps["save_to"] = TParamEntry("%s", &saveTo);
+		ps["collision_min_height"] = TParamEntry("%lf", &collision_min_height_);
+		ps["collision_max_height"] = TParamEntry("%lf", &collision_max_height_);
+		ps["show_collisions"] = TParamEntry("%bool", &show_collisions_);
+		ps["restitution"] = TParamEntry("%lf", &restitution_);
+		ps["lateral_friction"] = TParamEntry("%lf", &lateral_friction_);
+		parse_xmlnode_children_as_param(*root, ps, world_->user_defined_variables());
+	}
+
+	const mrpt::system::CTicTac tictac;
+
+	if (auto xFile = root->first_node("file"); xFile && xFile->value())
+	{
+		loadFromFile(world_->local_to_abs_path(xFile->value()));
+	}
+	else
+	{
+		// Voxelize a point cloud:
+		mrpt::maps::CSimplePointsMap pts;
+		mrpt::math::TPoint3D origin(0, 0, 0);
+		if (auto xPly = root->first_node("file_ply"); xPly && xPly->value())
+			load_points_ply(world_->local_to_abs_path(xPly->value()), pts, decimation);
+		else if (auto xLas = root->first_node("file_las"); xLas && xLas->value())
+			origin = load_points_las(world_->local_to_abs_path(xLas->value()), pts, decimation);
+		else if (auto xBin = root->first_node("file_bin_xyz"); xBin && xBin->value())
+			load_points_raw_float32(
+				world_->local_to_abs_path(xBin->value()), pts, binFloatsPerPoint, decimation);
+		else
+			THROW_EXCEPTION("Error: No valid <file*></file*> XML tag was found");
+
+		clear(resolution);
+		insertPoints(pts, origin);
+	}
+
+	world_->logFmt(
+		mrpt::system::LVL_DEBUG, "[VoxelMap] Loaded %zu voxels (%zu blocks) in %.03f s",
+		occupiedCount(), blocks_.size(), tictac.Tac());
+
+	if (!saveTo.empty()) saveToFile(world_->local_to_abs_path(saveTo));
+}
+
+void VoxelMap::clear(float resolution)
+{
+	ASSERT_GT_(resolution, .0f);
+	resolution_ = resolution;
+	blocks_.clear();
+	columns_.clear();
+	gui_uptodate_ = false;
+}
+
+bool VoxelMap::isOccupied(int32_t ix, int32_t iy, int32_t iz) const
+{
+	const Block* b = findBlock(ix >> BLOCK_BITS, iy >> BLOCK_BITS, iz >> BLOCK_BITS);
+	return b && b->get(ix & BLOCK_MASK, iy & BLOCK_MASK, iz & BLOCK_MASK);
+}
+
+void VoxelMap::setOccupied(int32_t ix, int32_t iy, int32_t iz, bool occupied)
+{
+	const int32_t bx = ix >> BLOCK_BITS, by = iy >> BLOCK_BITS, bz = iz >> BLOCK_BITS;
+	const uint64_t bit = 1ULL << ((ix & BLOCK_MASK) | ((iy & BLOCK_MASK) << BLOCK_BITS));
+
+	const auto key = blockKey(bx, by, bz);
+	auto it = blocks_.find(key);
+	if (!occupied)
+	{
+		if (it == blocks_.end()) return;
+		auto& layer = it->second.layers[iz & BLOCK_MASK];
+		if (!(layer & bit)) return;
+		layer &= ~bit;
+		gui_uptodate_ = false;
+
+		// Free blocks which become empty:
+		const auto& layers = it->second.layers;
+		if (std::any_of(layers.begin(), layers.end(), [](uint64_t l) { return l != 0; })) return;
+		blocks_.erase(it);
+
+		const auto itCol = columns_.find(columnKey(bx, by));
+		auto& col = itCol->second;
+		col.erase(std::lower_bound(col.begin(), col.end(), bz));
+		if (col.empty()) columns_.erase(itCol);
+		return;
+	}
+	if (it == blocks_.end())
+	{
+		it = blocks_.emplace(key, Block()).first;
+
+		auto& col = columns_[columnKey(bx, by)];
+		col.insert(std::lower_bound(col.begin(), col.end(), bz), bz);
+	}
+	it->second.layers[iz & BLOCK_MASK] |= bit;
+	gui_uptodate_ = false;
+}
+
+void VoxelMap::insertPoints(const mrpt::maps::CPointsMap& pts, const mrpt::math::TPoint3D& offset)
+{
+	const auto& xs = pts.getPointsBufferRef_x();
+	const auto& ys = pts.getPointsBufferRef_y();
+	const auto& zs = pts.getPointsBufferRef_z();
+	const auto toIdx = [this](double x)
+	{ return static_cast<int32_t>(std::floor(x / resolution_)); };
+
+	for (size_t i = 0; i < xs.size(); i++)
+		setOccupied(toIdx(xs[i] + offset.x), toIdx(ys[i] + offset.y), toIdx(zs[i] + offset.z));
+}
+
+size_t VoxelMap::occupiedCount() const
+{
+	size_t n = 0;
+	for (const auto& [key, b] : blocks_)
+		for (const auto layer : b.layers) n += std::bitset<64>(layer).count();
+	return n;
+}
+
+void VoxelMap::saveToFile(const std::string& file) const
+{
+	std::ofstream f(file, std::ios::binary);
+	if (!f.is_open()) THROW_EXCEPTION_FMT("Cannot write to file: '%s'", file.c_str());
+
+	const uint64_t nBlocks = blocks_.size();
+	f.write(VOXEL_FILE_MAGIC, sizeof(VOXEL_FILE_MAGIC));
+	f.write(reinterpret_cast<const char*>(&VOXEL_FILE_VERSION), sizeof(VOXEL_FILE_VERSION));
+	f.write(reinterpret_cast<const char*>(&resolution_), sizeof(resolution_));
+	f.write(reinterpret_cast<const char*>(&nBlocks), sizeof(nBlocks));
+
+	for (const auto& [colKey, bzs] : columns_)
+	{
+		const int32_t off = 1 << 20;
+		const int32_t bx = static_cast<int32_t>(colKey & ((1ULL << 21) - 1)) - off;
+		const int32_t by = static_cast<int32_t>((colKey >> 21) & ((1ULL << 21) - 1)) - off;
+		for (const int32_t bz : bzs)
+		{
+			const Block* b = findBlock(bx, by, bz);
+			ASSERT_(b);
+			const int32_t idx[3] = {bx, by, bz};
+			f.write(reinterpret_cast<const char*>(idx), sizeof(idx));
+			f.write(reinterpret_cast<const char*>(b->layers.data()), sizeof(b->layers));
+		}
+	}
+	if (!f.good()) THROW_EXCEPTION_FMT("Error writing to file: '%s'", file.c_str());
+}
+
+void VoxelMap::loadFromFile(const std::string& file)
+{
+	std::ifstream f(file, std::ios::binary);
+	if (!f.is_open()) THROW_EXCEPTION_FMT("Cannot open file: '%s'", file.c_str());
+
+	char magic[sizeof(VOXEL_FILE_MAGIC)];
+	uint32_t version = 0;
+	float resolution = 0;
+	uint64_t nBlocks = 0;
+	f.read(magic, sizeof(magic));
+	f.read(reinterpret_cast<char*>(&version), sizeof(version));
+	f.read(reinterpret_cast<char*>(&resolution), sizeof(resolution));
+	f.read(reinterpret_cast<char*>(&nBlocks), sizeof(nBlocks));
+
+	if (!f.good() || std::memcmp(magic, VOXEL_FILE_MAGIC, sizeof(magic)) != 0)
+		THROW_EXCEPTION_FMT("Not a valid voxel map file: '%s'", file.c_str());
+	if (version != VOXEL_FILE_VERSION)
+		THROW_EXCEPTION_FMT(
+			"Unsupported voxel map file version %u in '%s'", version, file.c_str());
+
+	clear(resolution);
+	blocks_.reserve(nBlocks);
+
+	for (uint64_t i = 0; i < nBlocks; i++)
+	{
+		int32_t idx[3];
+		Block b;
+		f.read(reinterpret_cast<char*>(idx), sizeof(idx));
+		f.read(reinterpret_cast<char*>(b.layers.data()), sizeof(b.layers));
+		if (!f.good()) THROW_EXCEPTION_FMT("Voxel map file '%s' is truncated", file.c_str());
+
+		blocks_[blockKey(idx[0], idx[1], idx[2])] = b;
+		columns_[columnKey(idx[0], idx[1])].push_back(idx[2]);
+	}
+	for (auto& [key, bzs] : columns_) std::sort(bzs.begin(), bzs.end());
+}
+
+void VoxelMap::getElevationsAt(const mrpt::math::TPoint2Df& worldXY, std::set<float>& out) const
+{
+	const int32_t ix = coord2idx(worldXY.x), iy = coord2idx(worldXY.y);
+	const int32_t bx = ix >> BLOCK_BITS, by = iy >> BLOCK_BITS;
+	const int32_t lx = ix & BLOCK_MASK, ly = iy & BLOCK_MASK;
+
+	const auto itCol = columns_.find(columnKey(bx, by));
+	if (itCol == columns_.end()) return;
+	const auto& bzs = itCol->second;
+
+	for (size_t k = 0; k < bzs.size(); k++)
+	{
+		const int32_t bz = bzs[k];
+		const Block* b = findBlock(bx, by, bz);
+		const Block* above =
+			(k + 1 < bzs.size() && bzs[k + 1] == bz + 1) ? findBlock(bx, by, bz + 1) : nullptr;
+
+		// A floor is the top face of an occupied voxel with free space above:
+		for (int32_t lz = 0; lz < BLOCK_SIZE; lz++)
+		{
+			if (!b->get(lx, ly, lz)) continue;
+			const bool occAbove = (lz + 1 < BLOCK_SIZE) ? b->get(lx, ly, lz + 1)
+													  : (above && above->get(lx, ly, 0));
+			if (!occAbove) out.insert((bz * BLOCK_SIZE + lz + 1) * resolution_);
+		}
+	}
+}
+
+std::optional<float> VoxelMap::getElevationAt(const mrpt::math::TPoint2Df& worldXY) const
+{
+	std::set<float> zs;
+	getElevationsAt(worldXY, zs);
+	if (zs.empty()) return {};
+	return *zs.rbegin();
+}
+
+bool VoxelMap::isColumnOccupied(int32_t ix, int32_t iy, int32_t iz0, int32_t iz1) const
+{
+	const int32_t bx = ix >> BLOCK_BITS, by = iy >> BLOCK_BITS;
+	const auto itCol = columns_.find(columnKey(bx, by));
+	if (itCol == columns_.end()) return false;
+
+	const uint64_t bit = 1ULL << ((ix & BLOCK_MASK) | ((iy & BLOCK_MASK) << BLOCK_BITS));
+	const auto& bzs = itCol->second;
+	for (auto it = std::lower_bound(bzs.begin(), bzs.end(), iz0 >> BLOCK_BITS);
+		 it != bzs.end() && *it <= (iz1 >> BLOCK_BITS); ++it)
+	{
+		const Block* b = findBlock(bx, by, *it);
+		const int32_t lz0 = std::max(iz0 - *it * BLOCK_SIZE, 0);
+		const int32_t lz1 = std::min(iz1 - *it * BLOCK_SIZE, BLOCK_SIZE - 1);
+		for (int32_t lz = lz0; lz <= lz1; lz++)
+			if (b->layers[lz] & bit) return true;
+	}
+	return false;
+}
+
+// 3D DDA voxel traversal, see: J. Amanatides, A. Woo, "A Fast Voxel Traversal
+// Algorithm for Ray Tracing", Eurographics 1987.
+std::optional<float> VoxelMap::raycast(
+	const mrpt::math::TPoint3Df& origin, const mrpt::math::TPoint3Df& dir, float maxRange) const
+{
+	constexpr float INF = std::numeric_limits<float>::infinity();
+
+	int32_t idx[3] = {coord2idx(origin.x), coord2idx(origin.y), coord2idx(origin.z)};
+	const float o[3] = {origin.x, origin.y, origin.z};
+	const float d[3] = {dir.x, dir.y, dir.z};
+
+	int32_t step[3];
+	float tMax[3], tDelta[3];
+	for (int i = 0; i < 3; i++)
+	{
+		if (d[i] > 0)
+		{
+			step[i] = 1;
+			tDelta[i] = resolution_ / d[i];
+			tMax[i] = ((idx[i] + 1) * resolution_ - o[i]) / d[i];
+		}
+		else if (d[i] < 0)
+		{
+			step[i] = -1;
+			tDelta[i] = -resolution_ / d[i];
+			tMax[i] = (idx[i] * resolution_ - o[i]) / d[i];
+		}
+		else
+		{
+			step[i] = 0;
+			tDelta[i] = INF;
+			tMax[i] = INF;
+		}
+	}
+
+	// Cache of the current block, to only look up the hash map when entering
+	// a new one:
+	int32_t curBlock[3] = {
+		std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min(),
+		std::numeric_limits<int32_t>::min()};
+	const Block* b = nullptr;
+
+	float t = 0;
+	while (t <= maxRange)
+	{
+		const int32_t bIdx[3] = {
+			idx[0] >> BLOCK_BITS, idx[1] >> BLOCK_BITS, idx[2] >> BLOCK_BITS};
+		if (bIdx[0] != curBlock[0] || bIdx[1] != curBlock[1] || bIdx[2] != curBlock[2])
+		{
+			std::copy(bIdx, bIdx + 3, curBlock);
+			b = findBlock(bIdx[0], bIdx[1], bIdx[2]);
+		}
+		if (b && b->get(idx[0] & BLOCK_MASK, idx[1] & BLOCK_MASK, idx[2] & BLOCK_MASK))
+			return t;
+
+		// Step to the next voxel:
+		const int axis = (tMax[0] < tMax[1]) ? (tMax[0] < tMax[2] ? 0 : 2)
+											 : (tMax[1] < tMax[2] ? 1 : 2);
+		t = tMax[axis];
+		idx[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+	}
+	return {};
+}
+
+void VoxelMap::internalGuiUpdate(
+	const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& viz,
+	const mrpt::optional_ref<mrpt::opengl::COpenGLScene>& physical,
+	[[maybe_unused]] bool childrenOnly)
+{
+	using namespace mrpt::math;
+
+	// 1st time call?? -> Create objects
+	if (!gl_voxels_ && viz && physical)
+	{
+		gl_voxels_ = mrpt::opengl::CSetOfObjects::Create();
+		gl_voxels_->setName("VoxelMap");
+		viz->get().insert(gl_voxels_);
+		physical->get().insert(gl_voxels_);
+	}
+
+	// 1st call OR map changed?
+	if (!gui_uptodate_ && gl_voxels_)
+	{
+		auto glVox = mrpt::opengl::COctoMapVoxels::Create();
+		glVox->resizeVoxelSets(1);
+		glVox->reserveVoxels(0, occupiedCount());
+		glVox->showGridLines(false);
+		glVox->showVoxels(0, true);
+
+		// Color by height:
+		float zMin = std::numeric_limits<float>::max(), zMax = -zMin;
+		for (const auto& [key, b] : blocks_)
+		{
+			const auto bz = static_cast<int32_t>((key >> 42) & ((1ULL << 21) - 1)) - (1 << 20);
+			mrpt::keep_min(zMin, bz * BLOCK_SIZE * resolution_);
+			mrpt::keep_max(zMax, (bz + 1) * BLOCK_SIZE * resolution_);
+		}
+		const float zSpan = std::max(zMax - zMin, resolution_);
+
+		const double inf = std::numeric_limits<double>::max();
+		TPoint3D bbMin(inf, inf, inf), bbMax(-inf, -inf, -inf);
+
+		for (const auto& [key, b] : blocks_)
+		{
+			constexpr uint64_t m = (1ULL << 21) - 1;
+			const int32_t bx = static_cast<int32_t>(key & m) - (1 << 20);
+			const int32_t by = static_cast<int32_t>((key >> 21) & m) - (1 << 20);
+			const int32_t bz = static_cast<int32_t>((key >> 42) & m) - (1 << 20);
+
+			for (int32_t lz = 0; lz < BLOCK_SIZE; lz++)
+			{
+				if (!b.layers[lz]) continue;
+				const float z = idx2coord(bz * BLOCK_SIZE + lz);
+				const auto color = mrpt::img::colormap(mrpt::img::cmJET, (z - zMin) / zSpan);
+
+				for (int32_t ly = 0; ly < BLOCK_SIZE; ly++)
+				{
+					for (int32_t lx = 0; lx < BLOCK_SIZE; lx++)
+					{
+						if (!b.get(lx, ly, lz)) continue;
+						const TPoint3D pt(
+							idx2coord(bx * BLOCK_SIZE + lx), idx2coord(by * BLOCK_SIZE + ly), z);
+						glVox->push_back_Voxel(
+							0, mrpt::opengl::COctoMapVoxels::TVoxel(pt, resolution_, color));
+						for (int i = 0; i < 3; i++)
+						{
+							mrpt::keep_min(bbMin[i], pt[i]);
+							mrpt::keep_max(bbMax[i], pt[i]);
+						}
+					}
+				}
+			}
+		}
+		if (!blocks_.empty()) glVox->setBoundingBox(bbMin, bbMax);
+
+		gl_voxels_->clear();
+		gl_voxels_->insert(glVox);
+		gui_uptodate_ = true;
+	}
+
+	// Update obstacles:
+	if (viz)
+	{
+		std::lock_guard<std::mutex> csl(gl_obs_clouds_buffer_cs_);
+		gl_obs_clouds_.resize(gl_obs_clouds_buffer_.size());
+		for (size_t i = 0; i < gl_obs_clouds_.size(); i++)
+		{
+			auto& gl_objs = gl_obs_clouds_[i];
+			if (!gl_objs)
+			{
+				gl_objs = mrpt::opengl::CSetOfObjects::Create();
+				viz->get().insert(gl_objs);
+			}
+			gl_objs->clear();
+			if (gl_obs_clouds_buffer_[i]) gl_objs->insert(gl_obs_clouds_buffer_[i]);
+		}
+	}
+}
+
+void VoxelMap::simul_pre_timestep([[maybe_unused]] const TSimulContext& context)
+{
+	// Make a list of objects subject to collide with the voxels, as in
+	// OccupancyGridMap:
+	{
+		const World::VehicleList& lstVehs = this->world_->getListOfVehicles();
+		const World::BlockList& lstBlocks = this->world_->getListOfBlocks();
+		obstacles_for_each_obj_.resize(lstVehs.size() + lstBlocks.size());
+
+		size_t obj_idx = 0;
+		for (const auto& [name, veh] : lstVehs)
+		{
+			auto& ipv = obstacles_for_each_obj_[obj_idx++];
+			ipv.max_obstacles_ranges = veh->getMaxVehicleRadius() * 1.50f;
+			ipv.sleeping = veh->isSleeping() || world_->isPartitionGhost(name);
+			ipv.pose = veh->getPose();
+		}
+		for (const auto& [name, block] : lstBlocks)
+		{
+			auto& ipv = obstacles_for_each_obj_[obj_idx++];
+			ipv.max_obstacles_ranges = block->getMaxBlockRadius() * 1.50f;
+			ipv.sleeping = block->isSleeping();
+			ipv.pose = block->getPose();
+		}
+	}
+
+	// Physical properties of each occupied voxel column:
+	const float cellSemiWidth = resolution_ * 0.4f;
+	b2PolygonShape sqrPoly;
+	sqrPoly.SetAsBox(cellSemiWidth, cellSemiWidth);
+	sqrPoly.m_radius = 1e-3;  // The "skin" depth of the body
+	b2FixtureDef fixtureDef;
+	fixtureDef.shape = &sqrPoly;
+	fixtureDef.restitution = restitution_;
+	fixtureDef.density = 0;	 // Fixed (inf. mass)
+	fixtureDef.friction = lateral_friction_;
+
+	// As in OccupancyGridMap, keep only the closest obstacle within each of
+	// these angular sectors around each object:
+	constexpr size_t nSectors = 50;
+
+	std::lock_guard<std::mutex> csl(gl_obs_clouds_buffer_cs_);
+	gl_obs_clouds_buffer_.resize(obstacles_for_each_obj_.size());
+
+	for (size_t obj_idx = 0; obj_idx < obstacles_for_each_obj_.size(); obj_idx++)
+	{
+		auto& ipv = obstacles_for_each_obj_[obj_idx];
+		if (ipv.sleeping && ipv.collide_body && !show_collisions_) continue;
+
+		const auto& p = ipv.pose;
+		const float R = ipv.max_obstacles_ranges;
+		const int32_t iz0 = coord2idx(p.z + collision_min_height_);
+		const int32_t iz1 = coord2idx(p.z + collision_max_height_);
+
+		std::array<float, nSectors> closestDist;
+		std::array<mrpt::math::TPoint2Df, nSectors> closestPt;
+		closestDist.fill(std::numeric_limits<float>::max());
+
+		for (int32_t iy = coord2idx(p.y - R); iy <= coord2idx(p.y + R); iy++)
+		{
+			for (int32_t ix = coord2idx(p.x - R); ix <= coord2idx(p.x + R); ix++)
+			{
+				const float lx = idx2coord(ix) - p.x, ly = idx2coord(iy) - p.y;
+				const float dist = std::hypot(lx, ly);
+				if (dist > R) continue;
+
+				const auto sector = std::min(
+					nSectors - 1,
+					static_cast<size_t>((std::atan2(ly, lx) + M_PI) / (2 * M_PI) * nSectors));
+				if (dist >= closestDist[sector]) continue;
+				if (!isColumnOccupied(ix, iy, iz0, iz1)) continue;
+
+				closestDist[sector] = dist;
+				closestPt[sector] = {lx, ly};
+			}
+		}
+
+		// Create Box2D objects upon first usage:
+		if (!ipv.collide_body)
+		{
+			b2BodyDef bdef;
+			ipv.collide_body = world_->getBox2DWorld()->CreateBody(&bdef);
+			ASSERT_(ipv.collide_body);
+		}
+		// Obstacles are given in coordinates local to the object:
+		ipv.collide_body->SetTransform(b2Vec2(p.x, p.y), .0f);
+
+		mrpt::opengl::CPointCloud::Ptr& gl_pts = gl_obs_clouds_buffer_[obj_idx];
+		gl_pts.reset();
+		if (show_collisions_)
+		{
+			gl_pts = mrpt::opengl::CPointCloud::Create();
+			gl_pts->setPointSize(4.0f);
+			gl_pts->setColor(0, 0, 1);
+			gl_pts->setPose(mrpt::poses::CPose3D(p.x, p.y, p.z, 0, 0, 0));
+		}
+
+		ipv.collide_fixtures.resize(nSectors);
+		for (size_t k = 0; k < nSectors; k++)
+		{
+			auto& fixture = ipv.collide_fixtures[k];
+			if (!fixture) fixture = ipv.collide_body->CreateFixture(&fixtureDef);
+
+			if (closestDist[k] == std::numeric_limits<float>::max())
+			{
+				// Box2D's way of saying: don't collide with this!
+				fixture->SetSensor(true);
+				fixture->GetUserData().pointer = INVISIBLE_FIXTURE_USER_DATA;
+				continue;
+			}
+
+			fixture->SetSensor(false);
+			fixture->GetUserData().pointer = 0;
+
+			auto* poly = dynamic_cast<b2PolygonShape*>(fixture->GetShape());
+			ASSERT_(poly != nullptr);
+			const auto& pt = closestPt[k];
+			poly->SetAsBox(cellSemiWidth, cellSemiWidth, b2Vec2(pt.x, pt.y), .0f /*angle*/);
+
+			if (gl_pts) gl_pts->insertPoint(pt.x, pt.y, .0f);
+		}
+	}
+}
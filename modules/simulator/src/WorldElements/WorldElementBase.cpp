@@ -15,6 +15,7 @@
 #include <mvsim/WorldElements/PointCloud.h>
 #include <mvsim/WorldElements/SkyBox.h>
 #include <mvsim/WorldElements/VerticalPlane.h>
+#include <mvsim/WorldElements/VoxelMap.h>
 
 #include <map>
 #include <rapidxml.hpp>
@@ -44,6 +45,7 @@ void register_all_world_elements()
 	REGISTER_WORLD_ELEMENT("vertical_plane", VerticalPlane)
 	REGISTER_WORLD_ELEMENT("pointcloud", PointCloud)
 	REGISTER_WORLD_ELEMENT("skybox", SkyBox)
+	REGISTER_WORLD_ELEMENT("voxel_map", VoxelMap)
 }
 
 WorldElementBase::Ptr WorldElementBase::factory(
@@ -154,6 +154,11 @@ void World::GUI::prepare_control_window()
 		 })
 		->setChecked(parent_.guiOptions_.show_sensor_points);
 
+	w->add<nanogui::CheckBox>(
+		 "Selected vehicle sensors only",
+		 [&](bool b) { parent_.guiOptions_.show_only_selected_vehicle_sensors = b; })
+		->setChecked(parent_.guiOptions_.show_only_selected_vehicle_sensors);
+
 	w->add<nanogui::CheckBox>(
 		 "View sensor poses",
 		 [&](bool b)
@@ -742,6 +747,7 @@ void World::internal_GUI_thread()
 				me.internalGraphicsLoopTasksForSimulation();
 
 				me.internal_process_pending_gui_user_tasks();
+				me.internal_process_pending_gui_observations();
 
 				// handle mouse operations:
 				me.gui_.handle_mouse_operations();
@@ -770,8 +776,7 @@ void World::internal_GUI_thread()
 			[this](const Simulable& veh, const mrpt::obs::CObservation::Ptr& obs)
 		{
 			// obs->getDescriptionAsText(std::cout);
-			this->enqueue_task_to_run_in_gui_thread([this, obs, &veh]()
-													{ internal_gui_on_observation(veh, obs); });
+			this->internal_gui_enqueue_observation(veh, obs);
 		};
 
 		this->registerCallbackOnObservation(lambdaOnObservation);
@@ -811,7 +816,7 @@ void World::internal_GUI_thread()
 
 		lckListObjs.unlock();
 
-		VisualObject::FreeOpenGLResources();
+		internal_free_shared_opengl_resources();
 
 		// Now, destroy window:
 		gui_.gui_win.reset();
@@ -904,6 +909,53 @@ void World::internal_process_pending_gui_user_tasks()
 	guiUserPendingTasksMtx_.unlock();
 }
 
+void World::internal_gui_enqueue_observation(
+	const Simulable& veh, const mrpt::obs::CObservation::Ptr& obs)
+{
+	// Only these are visualized in the GUI, ignore the rest:
+	if (!obs || !(dynamic_cast<const mrpt::obs::CObservation3DRangeScan*>(obs.get()) ||
+				  dynamic_cast<const mrpt::obs::CObservationImage*>(obs.get())))
+		return;
+
+	auto lck = mrpt::lockHelper(guiPendingObservationsMtx_);
+	guiPendingObservations_[{&veh, obs->sensorLabel}] = obs;
+}
+
+void World::internal_process_pending_gui_observations()
+{
+	decltype(guiPendingObservations_) pending;
+	{
+		auto lck = mrpt::lockHelper(guiPendingObservationsMtx_);
+		pending.swap(guiPendingObservations_);
+	}
+
+	for (const auto& [key, obs] : pending)
+	{
+		const Simulable& veh = *key.first;
+		if (!internal_gui_is_sensor_viz_enabled(veh)) continue;
+
+		internal_gui_on_observation(veh, obs);
+	}
+}
+
+bool World::internal_gui_is_sensor_viz_enabled(const Simulable& veh) const
+{
+	if (!guiOptions_.show_only_selected_vehicle_sensors) return true;
+
+	if (!guiOptions_.follow_vehicle.empty() && veh.getName() == guiOptions_.follow_vehicle)
+		return true;
+
+	const auto& sel = gui_.gui_selectedObject.simulable;
+	if (!sel) return false;
+	if (sel.get() == &veh) return true;
+
+	// A sensor of this vehicle is selected?
+	if (const auto* sensor = dynamic_cast<const SensorBase*>(sel.get()); sensor)
+		return &sensor->vehicle() == &veh;
+
+	return false;
+}
+
 void World::internalRunSensorsOn3DScene(mrpt::opengl::COpenGLScene& physicalObjects)
 {
 	auto tle = mrpt::system::CTimeLoggerEntry(timlogger_, "internalRunSensorsOn3DScene");
@@ -919,6 +971,10 @@ void World::internalRunSensorsOn3DScene(mrpt::opengl::COpenGLScene& physicalObje
 void World::internalUpdate3DSceneObjects(
 	mrpt::opengl::COpenGLScene& viz, mrpt::opengl::COpenGLScene& physical)
 {
+	// This is the only place where the poses of 3D scene objects are updated
+	// from the latest dynamical state of each object (written by the physics
+	// thread), once per GUI frame and right before rendering sensors.
+
 	// Update view of map elements
 	// -----------------------------
 	auto tle = mrpt::system::CTimeLoggerEntry(timlogger_, "update_GUI.2.map-elements");
@@ -9,6 +9,7 @@
 #include <mrpt/core/format.h>
 #include <mrpt/core/get_env.h>
 #include <mrpt/core/lock_helper.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/system/filesystem.h>	 // extractFileDirectory()
 #include <mvsim/World.h>
 
@@ -59,6 +60,10 @@ void World::load_from_XML(const std::string& xml_text, const std::string& fileNa
 	simulableObjects_.emplace("__standaloneSensorHost", standaloneSensorHost);
 	simulableObjectsMtx_.unlock();
 
+	// Start downloading all remote models at once, instead of one by one
+	// as they are found while parsing:
+	remoteResources_.prefetch(RemoteResourcesManager::find_remote_uris(xml_text, basePath_));
+
 	// Parse the XML input:
 	const auto [xml, root] = readXmlTextAndGetRoot(xml_text, fileNameForPath);
 	(void)xml;	// unused
@@ -113,6 +118,7 @@ void World::register_standard_xml_tag_parsers()
 	register_tag_parser("gui", &World::parse_tag_gui);
 	register_tag_parser("georeference", &World::parse_tag_georeference);
 	register_tag_parser("lights", &World::parse_tag_lights);
+	register_tag_parser("partition", &World::parse_tag_partition);
 	register_tag_parser("walls", &World::parse_tag_walls);
 	register_tag_parser("include", &World::parse_tag_include);
 	register_tag_parser("variable", &World::parse_tag_variable);
@@ -232,6 +238,19 @@ void World::parse_tag_georeference(const XmlParserContext& ctx)
 	georeferenceOptions_.parse_from(*ctx.node, *this);
 }
 
+void World::parse_tag_partition(const XmlParserContext& ctx)
+{
+	partitionOptions_.parse_from(*ctx.node, *this);
+
+	if (partitionOptions_.enabled())
+	{
+		const auto& lim = partitionOptions_.limits;
+		ASSERTMSG_(
+			lim.x_max > lim.x_min && lim.y_max > lim.y_min,
+			"<partition>: tile limits must fulfill x_max>x_min and y_max>y_min");
+	}
+}
+
 void World::parse_tag_walls(const XmlParserContext& ctx) { process_load_walls(*ctx.node); }
 
 void World::parse_tag_include(const XmlParserContext& ctx)
@@ -254,8 +273,10 @@ void World::parse_tag_include(const XmlParserContext& ctx)
 		vars[attr->name()] = attr->value();
 	}
 
+	mrpt::system::CTicTac tic;
 	const auto [xml, root] = readXmlAndGetRoot(absFile, vars);
 	(void)xml;	// unused
+	register_resource_load("include", relFile, tic.Tac());
 
 	// recursive parse:
 	const auto newBasePath = mrpt::system::extractFileDirectory(absFile);
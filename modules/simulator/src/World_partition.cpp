@@ -0,0 +1,544 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/Clock.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/system/string_utils.h>
+#include <mvsim/World.h>
+
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+#include <mvsim/mvsim-msgs/PartitionState.pb.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "xml_utils.h"
+
+using namespace mvsim;
+
+// Experimental distributed simulation: the world is split into rectangular
+// tiles, each one simulated by one process. All processes load the same world
+// file, and each one only simulates the vehicles owned by its tile: those
+// within it or, for vehicles outside of all tiles, the nearest tile.
+//
+// Before the first time step, all processes exchange handshake messages with
+// their tile limits until each one is known to receive the messages of all the
+// others. Then, at the beginning of each time step, each process publishes the
+// state of the vehicles it simulated in the former step (poses, twists,
+// controller setpoints and wheels), and the service calls it received for
+// objects it does not simulate. It waits for all the other tiles to do the same
+// (lockstep), then mirrors the received states. Since all processes then agree
+// on all vehicle poses, the ownership of each vehicle is consistent among
+// them, and hand-offs happen implicitly when a vehicle crosses a tile border.
+
+void World::PartitionOptions::parse_from(
+	const rapidxml::xml_node<char>& node, mrpt::system::COutputLogger& logger)
+{
+	parse_xmlnode_children_as_param(node, params, {}, "[World::PartitionOptions]", &logger);
+}
+
+double World::PartitionTileLimits::distanceTo(double x, double y) const
+{
+	const double dx = std::max({x_min - x, .0, x - x_max});
+	const double dy = std::max({y_min - y, .0, y - y_max});
+	return std::hypot(dx, dy);
+}
+
+bool World::isPartitionPublisher(const std::string& objectName) const
+{
+	if (!partitionConnected_) return true;
+	if (vehicles_.count(objectName) != 0) return !isPartitionGhost(objectName);
+	return partitionIsPrimary_;
+}
+
+const std::string& World::internal_partition_owner(double x, double y) const
+{
+	// Ties (e.g. points on a shared border) are broken by name, so all the
+	// processes take the same decision:
+	const std::string* best = &partitionOptions_.name;
+	double bestDist = std::numeric_limits<double>::max();
+	for (const auto& [name, tile] : partitionTiles_)
+	{
+		const double d = tile.distanceTo(x, y);
+		if (d < bestDist)
+		{
+			bestDist = d;
+			best = &name;
+		}
+	}
+	return *best;
+}
+
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+namespace
+{
+void toProto(const mrpt::math::TPose3D& p, mvsim_msgs::Pose& po)
+{
+	po.set_x(p.x);
+	po.set_y(p.y);
+	po.set_z(p.z);
+	po.set_yaw(p.yaw);
+	po.set_pitch(p.pitch);
+	po.set_roll(p.roll);
+}
+void toProto(const mrpt::math::TTwist2D& t, mvsim_msgs::Twist& tw)
+{
+	tw.set_vx(t.vx);
+	tw.set_vy(t.vy);
+	tw.set_vz(0);
+	tw.set_wx(0);
+	tw.set_wy(0);
+	tw.set_wz(t.omega);
+}
+mrpt::math::TPose3D fromProto(const mvsim_msgs::Pose& p)
+{
+	return {p.x(), p.y(), p.z(), p.yaw(), p.pitch(), p.roll()};
+}
+mrpt::math::TTwist2D fromProto(const mvsim_msgs::Twist& t) { return {t.vx(), t.vy(), t.wz()}; }
+
+std::string partitionTopic(const std::string& tileName) { return "partition/" + tileName; }
+
+std::string joinNames(const std::vector<std::string>& names)
+{
+	std::string s;
+	for (const auto& n : names) s += (s.empty() ? "" : ", ") + n;
+	return s;
+}
+}  // namespace
+#endif
+
+void World::internal_partition_connect()
+{
+	if (!partitionOptions_.enabled()) return;
+
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+	client_.advertiseTopic<mvsim_msgs::PartitionState>(partitionTopic(partitionOptions_.name));
+
+	std::vector<std::string> peers;
+	mrpt::system::tokenize(partitionOptions_.peers, " \t\r\n,", peers);
+
+	ASSERTMSG_(
+		std::find(peers.begin(), peers.end(), partitionOptions_.name) == peers.end(),
+		"<partition>: <peers> must not include this tile own <name>");
+
+	{
+		auto lck = mrpt::lockHelper(partitionMtx_);
+		for (const auto& peer : peers) partitionPeerStates_[peer];
+		partitionTiles_[partitionOptions_.name] = partitionOptions_.limits;
+	}
+
+	partitionIsPrimary_ = std::all_of(
+		peers.begin(), peers.end(),
+		[this](const std::string& peer) { return partitionOptions_.name < peer; });
+
+	for (const auto& peer : peers)
+	{
+		client_.subscribeTopic<mvsim_msgs::PartitionState>(
+			partitionTopic(peer),
+			[this](const mvsim_msgs::PartitionState& msg)
+			{ internal_partition_on_peer_state(msg); });
+	}
+
+	internal_partition_handshake();
+
+	{
+		auto lck = mrpt::lockHelper(partitionMtx_);
+		partitionConnected_ = true;
+	}
+
+	// Initial ownership, from the initial poses (the same in all processes):
+	auto lckListObjs = mrpt::lockHelper(getListOfSimulableObjectsMtx());
+	internal_partition_update_ghosts();
+	lckListObjs.unlock();
+
+	const auto& lim = partitionOptions_.limits;
+	MRPT_LOG_INFO_FMT(
+		"[partition] Simulating tile '%s' x=[%.02f,%.02f] y=[%.02f,%.02f] in lockstep with %u "
+		"other tiles%s. Initially owned vehicles: %u/%u",
+		partitionOptions_.name.c_str(), lim.x_min, lim.x_max, lim.y_min, lim.y_max,
+		static_cast<unsigned>(peers.size()), partitionIsPrimary_ ? " (primary)" : "",
+		static_cast<unsigned>(vehicles_.size() - partitionGhosts_.size()),
+		static_cast<unsigned>(vehicles_.size()));
+#else
+	THROW_EXCEPTION("Partitioned simulation requires MVSIM built with ZMQ and Protobuf");
+#endif
+}
+
+void World::internal_partition_handshake()
+{
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+	// ZMQ drops messages published before a subscriber is connected, so keep
+	// sending handshakes, listing the tiles we have heard from, until all of
+	// them have heard from us. The last handshake is always sent, since the
+	// peers may be waiting for it.
+	const double t0 = mrpt::Clock::nowDouble();
+	double lastLog = t0;
+
+	for (;;)
+	{
+		mvsim_msgs::PartitionState msg;
+		msg.set_partitionname(partitionOptions_.name);
+		msg.set_stepindex(0);
+		msg.set_simultime(get_simul_time());
+		msg.set_handshake(true);
+		msg.set_xmin(partitionOptions_.limits.x_min);
+		msg.set_xmax(partitionOptions_.limits.x_max);
+		msg.set_ymin(partitionOptions_.limits.y_min);
+		msg.set_ymax(partitionOptions_.limits.y_max);
+
+		std::vector<std::string> missing;
+		{
+			auto lck = mrpt::lockHelper(partitionMtx_);
+			for (const auto& [peer, states] : partitionPeerStates_)
+			{
+				const bool heard = partitionTiles_.count(peer) != 0;
+				if (heard) msg.add_peersseen(peer);
+				if (!heard || partitionPeersReady_.count(peer) == 0) missing.push_back(peer);
+			}
+		}
+
+		{
+			auto lck = mrpt::lockHelper(partitionPublishMtx_);
+			client_.publishTopic(partitionTopic(partitionOptions_.name), msg);
+		}
+
+		if (missing.empty()) break;
+
+		const double t = mrpt::Clock::nowDouble();
+		if (t - t0 > partitionOptions_.startup_timeout)
+		{
+			THROW_EXCEPTION_FMT(
+				"[partition] Timeout waiting for these tiles to start up: %s",
+				joinNames(missing).c_str());
+		}
+		if (t - lastLog > 2.0)
+		{
+			lastLog = t;
+			MRPT_LOG_INFO_FMT(
+				"[partition] Waiting for these tiles to start up: %s", joinNames(missing).c_str());
+		}
+
+		std::unique_lock<std::mutex> lck(partitionMtx_);
+		partitionCV_.wait_for(lck, std::chrono::milliseconds(100));
+	}
+#endif
+}
+
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+void World::internal_partition_on_peer_state(const mvsim_msgs::PartitionState& msg)
+{
+	const auto& peer = msg.partitionname();
+
+	if (msg.shutdown())
+	{
+		MRPT_LOG_INFO_STREAM("[partition] Tile '" << peer << "' is shutting down, so do we.");
+		simulator_must_close(true);
+		partitionCV_.notify_all();
+		return;
+	}
+
+	PartitionStepData data;
+	if (!msg.handshake())
+	{
+		for (const auto& o : msg.objects())
+		{
+			auto& st = data.objects[o.objectid()];
+			st.pose = fromProto(o.pose());
+			st.twist = fromProto(o.twist());
+			if (o.has_twistsetpoint()) st.twistSetPoint = fromProto(o.twistsetpoint());
+			st.wheelPhi.assign(o.wheelphi().begin(), o.wheelphi().end());
+			st.wheelW.assign(o.wheelw().begin(), o.wheelw().end());
+			st.wheelYaw.assign(o.wheelyaw().begin(), o.wheelyaw().end());
+		}
+		for (const auto& c : msg.commands())
+		{
+			auto& cmd = data.commands.emplace_back();
+			cmd.objectId = c.objectid();
+			if (c.has_setpose()) cmd.setPose = fromProto(c.setpose());
+			if (c.has_setcontrollertwist())
+				cmd.setControllerTwist = fromProto(c.setcontrollertwist());
+		}
+	}
+
+	{
+		auto lck = mrpt::lockHelper(partitionMtx_);
+		auto it = partitionPeerStates_.find(peer);
+		if (it == partitionPeerStates_.end())
+		{
+			MRPT_LOG_WARN_STREAM("[partition] Ignoring state from unknown tile '" << peer << "'");
+			return;
+		}
+
+		if (msg.handshake())
+		{
+			// Tile limits are only changed until our own handshake is done:
+			if (!partitionConnected_)
+			{
+				auto& tile = partitionTiles_[peer];
+				tile.x_min = msg.xmin();
+				tile.x_max = msg.xmax();
+				tile.y_min = msg.ymin();
+				tile.y_max = msg.ymax();
+			}
+			for (const auto& seen : msg.peersseen())
+				if (seen == partitionOptions_.name) partitionPeersReady_.insert(peer);
+		}
+		else
+			it->second[msg.stepindex()] = std::move(data);
+	}
+	partitionCV_.notify_all();
+}
+#endif
+
+void World::internal_partition_publish_shutdown()
+{
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+	try
+	{
+		mvsim_msgs::PartitionState msg;
+		msg.set_partitionname(partitionOptions_.name);
+		msg.set_stepindex(0);
+		msg.set_simultime(get_simul_time());
+		msg.set_shutdown(true);
+
+		auto lck = mrpt::lockHelper(partitionPublishMtx_);
+		client_.publishTopic(partitionTopic(partitionOptions_.name), msg);
+	}
+	catch (const std::exception& e)
+	{
+		MRPT_LOG_ERROR_STREAM("[partition] Could not notify shutdown to other tiles: " << e.what());
+	}
+#endif
+}
+
+bool World::internal_partition_forward(const PartitionCommand& cmd)
+{
+	if (!partitionConnected_) return false;
+
+	const bool isVehicle = vehicles_.count(cmd.objectId) != 0;
+	if (isVehicle && !isPartitionGhost(cmd.objectId)) return false;
+
+	{
+		auto lck = mrpt::lockHelper(partitionMtx_);
+		partitionPendingCommands_.push_back(cmd);
+	}
+
+	// Other objects are simulated by all tiles, so apply it here too:
+	return isVehicle;
+}
+
+void World::internal_partition_apply_command(const PartitionCommand& cmd, bool fromPeer)
+{
+	auto it = simulableObjects_.find(cmd.objectId);
+	if (it == simulableObjects_.end() || !it->second) return;
+
+	auto veh = std::dynamic_pointer_cast<VehicleBase>(it->second);
+	if (veh)
+	{
+		// Vehicles: only by the tile simulating them, right now.
+		if (isPartitionGhost(cmd.objectId)) return;
+	}
+	else if (!fromPeer)
+	{
+		// Other objects: the service call already applied it here.
+		return;
+	}
+
+	if (cmd.setPose) it->second->setPose(*cmd.setPose);
+
+	if (cmd.setControllerTwist && veh)
+	{
+		if (auto* controller = veh->getControllerInterface(); controller)
+			controller->setTwistCommand(*cmd.setControllerTwist);
+	}
+}
+
+void World::internal_partition_sync()
+{
+	if (!partitionConnected_) return;
+
+#if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
+	const uint64_t step = partitionStepIndex_++;
+
+	std::vector<PartitionCommand> ownCommands;
+	{
+		auto lck = mrpt::lockHelper(partitionMtx_);
+		ownCommands.swap(partitionPendingCommands_);
+	}
+
+	// 1) Publish the state of the vehicles simulated here in the former step,
+	// and the commands for objects simulated elsewhere:
+	{
+		mvsim_msgs::PartitionState msg;
+		msg.set_partitionname(partitionOptions_.name);
+		msg.set_stepindex(step);
+		msg.set_simultime(get_simul_time());
+
+		auto lckListObjs = mrpt::lockHelper(getListOfSimulableObjectsMtx());
+		for (const auto& [name, veh] : vehicles_)
+		{
+			if (isPartitionGhost(name)) continue;
+
+			const auto ks = veh->getKinematicState();
+
+			auto* o = msg.add_objects();
+			o->set_objectid(name);
+			toProto(ks.pose, *o->mutable_pose());
+			toProto(ks.twist, *o->mutable_twist());
+
+			if (const auto* controller = veh->getControllerInterface(); controller)
+			{
+				if (const auto sp = controller->getTwistCommand(); sp)
+					toProto(*sp, *o->mutable_twistsetpoint());
+			}
+			for (size_t i = 0; i < veh->getNumWheels(); i++)
+			{
+				const auto& w = veh->getWheelInfo(i);
+				o->add_wheelphi(w.getPhi());
+				o->add_wheelw(w.getW());
+				o->add_wheelyaw(w.yaw);
+			}
+		}
+		lckListObjs.unlock();
+
+		for (const auto& cmd : ownCommands)
+		{
+			auto* c = msg.add_commands();
+			c->set_objectid(cmd.objectId);
+			if (cmd.setPose) toProto(*cmd.setPose, *c->mutable_setpose());
+			if (cmd.setControllerTwist)
+				toProto(*cmd.setControllerTwist, *c->mutable_setcontrollertwist());
+		}
+
+		auto lck = mrpt::lockHelper(partitionPublishMtx_);
+		client_.publishTopic(partitionTopic(partitionOptions_.name), msg);
+	}
+
+	// 2) Lockstep: wait for all other tiles to reach this same step:
+	std::map<std::string, PartitionStepData> peerStates;
+	{
+		std::unique_lock<std::mutex> lck(partitionMtx_);
+
+		const bool allReady = partitionCV_.wait_for(
+			lck, std::chrono::duration<double>(partitionOptions_.sync_timeout),
+			[&]()
+			{
+				if (simulator_must_close()) return true;
+				for (const auto& [peer, states] : partitionPeerStates_)
+					if (states.count(step) == 0) return false;
+				return true;
+			});
+
+		if (!allReady)
+		{
+			MRPT_LOG_WARN_FMT(
+				"[partition] Timeout waiting for other tiles at step %lu. Going on "
+				"with the latest known states.",
+				static_cast<unsigned long>(step));
+		}
+
+		for (auto& [peer, states] : partitionPeerStates_)
+		{
+			if (auto it = states.find(step); it != states.end())
+				peerStates[peer] = std::move(it->second);
+
+			// Discard this and older steps:
+			states.erase(states.begin(), states.upper_bound(step));
+		}
+	}
+
+	// 3) Mirror the state of the vehicles simulated by other tiles, so it is
+	// already up to date if they are handed off to this one:
+	auto lckListObjs = mrpt::lockHelper(getListOfSimulableObjectsMtx());
+	for (const auto& [peer, data] : peerStates)
+	{
+		for (const auto& [name, st] : data.objects)
+		{
+			if (!isPartitionGhost(name)) continue;
+
+			auto it = vehicles_.find(name);
+			if (it == vehicles_.end()) continue;
+			auto& veh = it->second;
+
+			veh->setPose(st.pose);
+			veh->setTwist(st.twist);
+
+			if (auto* controller = veh->getControllerInterface(); controller && st.twistSetPoint)
+				controller->setTwistCommand(*st.twistSetPoint);
+
+			const size_t nW = std::min(
+				{veh->getNumWheels(), st.wheelPhi.size(), st.wheelW.size(), st.wheelYaw.size()});
+			for (size_t i = 0; i < nW; i++)
+			{
+				auto& w = veh->getWheelInfo(i);
+				w.setPhi(st.wheelPhi[i]);
+				w.setW(st.wheelW[i]);
+				w.yaw = st.wheelYaw[i];
+			}
+		}
+	}
+
+	// 4) Hand-offs:
+	internal_partition_update_ghosts();
+
+	// 5) Service calls forwarded by any tile, now that the owner of each
+	// vehicle is known:
+	for (const auto& cmd : ownCommands) internal_partition_apply_command(cmd, false);
+	for (const auto& [peer, data] : peerStates)
+		for (const auto& cmd : data.commands) internal_partition_apply_command(cmd, true);
+#endif
+}
+
+void World::internal_partition_update_ghosts()
+{
+	std::unique_lock lckGhosts(partitionGhostsMtx_);
+
+	for (const auto& [name, veh] : vehicles_)
+	{
+		b2Body* b = veh->getBox2DChassisBody();
+		const auto ks = veh->getKinematicState();
+		const auto& p = ks.pose;
+		const bool wasGhost = partitionGhosts_.count(name) != 0;
+
+		if (internal_partition_owner(p.x, p.y) == partitionOptions_.name)
+		{
+			if (wasGhost)
+			{
+				MRPT_LOG_DEBUG_STREAM("[partition] Taking over vehicle '" << name << "'");
+				partitionGhosts_.erase(name);
+			}
+			if (b)
+			{
+				b->SetType(b2_dynamicBody);
+				b->SetEnabled(true);
+			}
+			continue;
+		}
+
+		if (!wasGhost)
+		{
+			MRPT_LOG_DEBUG_STREAM("[partition] Handing off vehicle '" << name << "'");
+			partitionGhosts_.insert(name);
+		}
+		if (!b) continue;
+
+		// Ghosts are kinematic bodies moved from the states received from
+		// their owner tile, and only kept near this tile borders:
+		const auto& tw = ks.twist;
+		b->SetType(b2_kinematicBody);
+		b->SetEnabled(
+			partitionOptions_.limits.distanceTo(p.x, p.y) <= partitionOptions_.ghost_margin);
+		b->SetTransform(b2Vec2(p.x, p.y), p.yaw);
+		b->SetLinearVelocity(b2Vec2(tw.vx, tw.vy));
+		b->SetAngularVelocity(tw.omega);
+	}
+}
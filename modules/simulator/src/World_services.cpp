@@ -23,6 +23,8 @@
 #endif
 
 #include <map>
+#include <string>
+#include <vector>
 
 using namespace mvsim;
 
@@ -38,29 +40,32 @@ mvsim_msgs::SrvSetPoseAnswer World::srv_set_pose(const mvsim_msgs::SrvSetPose& r
 	auto lckListObjs = mrpt::lockHelper(getListOfSimulableObjectsMtx());
 	if (auto itV = simulableObjects_.find(sId); itV != simulableObjects_.end())
 	{
+		mrpt::math::TPose3D p(
+			req.pose().x(), req.pose().y(), req.pose().z(), req.pose().yaw(), req.pose().pitch(),
+			req.pose().roll());
+
 		if (req.has_relativeincrement() && req.relativeincrement())
 		{
-			auto p = mrpt::poses::CPose3D(itV->second->getPose());
-			p = p + mrpt::poses::CPose3D(
-						req.pose().x(), req.pose().y(), req.pose().z(), req.pose().yaw(),
-						req.pose().pitch(), req.pose().roll());
-			itV->second->setPose(p.asTPose());
+			p = (itV->second->getCPose3D() + mrpt::poses::CPose3D(p)).asTPose();
 
 			auto* absPose = ans.mutable_objectglobalpose();
-			absPose->set_x(p.x());
-			absPose->set_y(p.y());
-			absPose->set_z(p.z());
-			absPose->set_yaw(p.yaw());
-			absPose->set_pitch(p.pitch());
-			absPose->set_roll(p.roll());
-		}
-		else
-		{
-			itV->second->setPose(
-				{req.pose().x(), req.pose().y(), req.pose().z(), req.pose().yaw(),
-				 req.pose().pitch(), req.pose().roll()});
+			absPose->set_x(p.x);
+			absPose->set_y(p.y);
+			absPose->set_z(p.z);
+			absPose->set_yaw(p.yaw);
+			absPose->set_pitch(p.pitch);
+			absPose->set_roll(p.roll);
 		}
+
 		ans.set_success(true);
+
+		// Vehicles simulated by another partition: leave it to its owner.
+		PartitionCommand cmd;
+		cmd.objectId = sId;
+		cmd.setPose = p;
+		if (internal_partition_forward(cmd)) return ans;
+
+		itV->second->setPose(p);
 		ans.set_objectisincollision(itV->second->hadCollision());
 		itV->second->resetCollisionFlag();
 	}
@@ -153,6 +158,15 @@ mvsim_msgs::SrvSetControllerTwistAnswer World::srv_set_controller_twist(
 	const mrpt::math::TTwist2D t(
 		req.twistsetpoint().vx(), req.twistsetpoint().vy(), req.twistsetpoint().wz());
 
+	PartitionCommand cmd;
+	cmd.objectId = sId;
+	cmd.setControllerTwist = t;
+	if (internal_partition_forward(cmd))
+	{
+		ans.set_success(true);
+		return ans;
+	}
+
 	const bool ctrlAcceptTwist = controller->setTwistCommand(t);
 	if (!ctrlAcceptTwist)
 	{
@@ -174,6 +188,9 @@ mvsim_msgs::SrvShutdownAnswer World::srv_shutdown(
 
 	this->simulator_must_close(true);
 
+	// and make all other partitions close too:
+	if (partitionConnected_) internal_partition_publish_shutdown();
+
 	return ans;
 }
 
@@ -182,19 +199,28 @@ mvsim_msgs::SrvShutdownAnswer World::srv_shutdown(
 void World::internal_advertiseServices()
 {
 #if MVSIM_HAS_ZMQ && MVSIM_HAS_PROTOBUF
-	// global services:
-	client_.advertiseService<mvsim_msgs::SrvSetPose, mvsim_msgs::SrvSetPoseAnswer>(
-		"set_pose", [this](const auto& req) { return srv_set_pose(req); });
-
-	client_.advertiseService<mvsim_msgs::SrvGetPose, mvsim_msgs::SrvGetPoseAnswer>(
-		"get_pose", [this](const auto& req) { return srv_get_pose(req); });
+	// global services. In partitioned mode, each tile serves them under its
+	// own namespace ("<tile>/set_pose",...), and the primary tile also under
+	// the global names:
+	std::vector<std::string> prefixes;
+	if (!partitionOptions_.enabled() || partitionIsPrimary_) prefixes.push_back("");
+	if (partitionOptions_.enabled()) prefixes.push_back(partitionOptions_.name + "/");
+
+	for (const auto& prefix : prefixes)
+	{
+		client_.advertiseService<mvsim_msgs::SrvSetPose, mvsim_msgs::SrvSetPoseAnswer>(
+			prefix + "set_pose", [this](const auto& req) { return srv_set_pose(req); });
 
-	client_.advertiseService<
-		mvsim_msgs::SrvSetControllerTwist, mvsim_msgs::SrvSetControllerTwistAnswer>(
-		"set_controller_twist", [this](const auto& req) { return srv_set_controller_twist(req); });
+		client_.advertiseService<mvsim_msgs::SrvGetPose, mvsim_msgs::SrvGetPoseAnswer>(
+			prefix + "get_pose", [this](const auto& req) { return srv_get_pose(req); });
 
-	client_.advertiseService<mvsim_msgs::SrvShutdown, mvsim_msgs::SrvShutdownAnswer>(
-		"shutdown", [this](const auto& req) { return srv_shutdown(req); });
+		client_.advertiseService<
+			mvsim_msgs::SrvSetControllerTwist, mvsim_msgs::SrvSetControllerTwistAnswer>(
+			prefix + "set_controller_twist",
+			[this](const auto& req) { return srv_set_controller_twist(req); });
 
+		client_.advertiseService<mvsim_msgs::SrvShutdown, mvsim_msgs::SrvShutdownAnswer>(
+			prefix + "shutdown", [this](const auto& req) { return srv_shutdown(req); });
+	}
 #endif
 }
@@ -18,6 +18,9 @@
 #include <mrpt/version.h>
 #include <mvsim/World.h>
 
+#include <future>
+#include <thread>
+
 using namespace mvsim;
 using namespace std;
 
@@ -77,13 +80,20 @@ void World::internal_one_timestep(double dt)
 	context.simul_time = get_simul_time();
 	context.dt = dt;
 
+	// 0) Partitioned simulation: lockstep sync and vehicles hand-off
+	if (partitionConnected_)
+	{
+		mrpt::system::CTimeLoggerEntry tle(timlogger_, "timestep.0.partition_sync");
+		internal_partition_sync();
+	}
+
 	auto lckListObjs = mrpt::lockHelper(getListOfSimulableObjectsMtx());
 
 	// 1) Pre-step
 	{
 		mrpt::system::CTimeLoggerEntry tle(timlogger_, "timestep.1.prestep");
 		for (auto& e : simulableObjects_)
-			if (e.second) e.second->simul_pre_timestep(context);
+			if (e.second && !isPartitionGhost(e.first)) e.second->simul_pre_timestep(context);
 	}
 	// 2) vehicles terrain elevation
 	{
@@ -109,18 +119,22 @@ void World::internal_one_timestep(double dt)
 	{
 		mrpt::system::CTimeLoggerEntry tle(timlogger_, "timestep.4.save_dynstate");
 
+		// Note: no 3D scene object is modified from this thread. This lock
+		// only ensures the GUI/sensors thread, which pulls object poses into
+		// the 3D scenes once per frame, sees a consistent post-step state:
 		const auto lckPhys = mrpt::lockHelper(physical_objects_mtx());
 		const auto lckCopy = mrpt::lockHelper(copy_of_objects_dynstate_mtx_);
 
 		for (auto& e : simulableObjects_)
 		{
 			if (!e.second) continue;
-			// process:
-			e.second->simul_post_timestep(context);
+			// process (ghosts of other partitions are only mirrored here):
+			if (!isPartitionGhost(e.first)) e.second->simul_post_timestep(context);
 
 			// save our own copy of the kinematic state:
-			copy_of_objects_dynstate_pose_[e.first] = e.second->getPose();
-			copy_of_objects_dynstate_twist_[e.first] = e.second->getTwist();
+			const auto ks = e.second->getKinematicState();
+			copy_of_objects_dynstate_pose_[e.first] = ks.pose;
+			copy_of_objects_dynstate_twist_[e.first] = ks.twist;
 
 			if (e.second->hadCollision()) copy_of_objects_had_collision_.insert(e.first);
 		}
@@ -245,10 +259,11 @@ void World::internalPostSimulStepForRawlog()
 		auto obs = mrpt::obs::CObservationOdometry::Create();
 		obs->timestamp = get_simul_timestamp();
 		obs->sensorLabel = "odom";
-		obs->odometry = veh.second->getCPose2D();
+		const auto ks = veh.second->getKinematicState();
+		obs->odometry = mrpt::poses::CPose2D(ks.pose.x, ks.pose.y, ks.pose.yaw);
 
 		obs->hasVelocities = true;
-		obs->velocityLocal = veh.second->getVelocityLocal();
+		obs->velocityLocal = ks.velocityLocal();
 
 		// TODO: Simul noisy odometry and odom velocity
 
@@ -312,125 +327,146 @@ void World::internal_simul_pre_step_terrain_elevation()
 	//       and apply gravity force.
 	const double gravity = get_gravity();
 
-	mrpt::tfest::TMatchingPairList corrs;
-	mrpt::poses::CPose3D optimalTf;
-
 	std::map<const VehicleBase*, std::vector<float>> wheel_heights_per_vehicle;
 
+	// Sleeping vehicles keep their former pose, ghosts get it from their
+	// partition:
+	std::vector<VehicleBase*> activeVehs;
 	const World::VehicleList& lstVehs = getListOfVehicles();
 	for (auto& [name, veh] : lstVehs)
 	{
-		const size_t nWheels = veh->getNumWheels();
-
-		// 1) Compute its 3D pose according to the mesh tilt angle.
-		// Idea: run a least-squares method to find the best
-		// SE(3) transformation that map the wheels contact point,
-		// as seen in local & global coordinates.
-		// (For large tilt angles, may have to run it iteratively...)
-		// -------------------------------------------------------------
-		// the final downwards direction (unit vector (0,0,-1)) as seen in
-		// vehicle local frame.
-		mrpt::math::TPoint3D dir_down;
-		for (int iter = 0; iter < 2; iter++)
+		if (veh->isSleeping() || isPartitionGhost(name)) continue;
+		activeVehs.push_back(veh.get());
+		// Create map entries now, so the map is not modified from workers:
+		wheel_heights_per_vehicle[veh.get()];
+	}
+
+	// Make sure the LUT is built before querying it from several threads:
+	getLUTCacheOfObjects();
+
+	// Vehicles are independent from each other here, so they can be processed
+	// in parallel:
+	internal_parallel_for(
+		activeVehs.size(),
+		[&](size_t vehIdx)
 		{
-			const mrpt::math::TPose3D& cur_pose = veh->getPose();
+			VehicleBase* veh = activeVehs[vehIdx];
+
+			mrpt::tfest::TMatchingPairList corrs;
+			mrpt::poses::CPose3D optimalTf;
+
+			const size_t nWheels = veh->getNumWheels();
+
+			// 1) Compute its 3D pose according to the mesh tilt angle.
+			// Idea: run a least-squares method to find the best
+			// SE(3) transformation that map the wheels contact point,
+			// as seen in local & global coordinates.
+			// (For large tilt angles, may have to run it iteratively...)
+			// -------------------------------------------------------------
+			// the final downwards direction (unit vector (0,0,-1)) as seen in
+			// vehicle local frame.
+			mrpt::math::TPoint3D dir_down;
+			for (int iter = 0; iter < 2; iter++)
+			{
+				const mrpt::math::TPose3D& cur_pose = veh->getPose();
 
-			// This object is faster for repeated point projections
-			const mrpt::poses::CPose3D cur_cpose(cur_pose);
+				// This object is faster for repeated point projections
+				const mrpt::poses::CPose3D cur_cpose(cur_pose);
 
-			mrpt::math::TPose3D new_pose = cur_pose;
-			corrs.clear();
+				mrpt::math::TPose3D new_pose = cur_pose;
+				corrs.clear();
 
-			bool all_equal = true;
-			std::optional<float> equal_zs;
+				bool all_equal = true;
+				std::optional<float> equal_zs;
 
-			// Store wheels height for the posterior stage of collision detection:
-			auto& wheelHeights = wheel_heights_per_vehicle[veh.get()];
-			wheelHeights.resize(nWheels);
+				// Store wheels height for the posterior stage of collision detection:
+				auto& wheelHeights = wheel_heights_per_vehicle.at(veh);
+				wheelHeights.resize(nWheels);
 
-			for (size_t iW = 0; iW < nWheels; iW++)
-			{
-				const Wheel& wheel = veh->getWheelInfo(iW);
+				for (size_t iW = 0; iW < nWheels; iW++)
+				{
+					const Wheel& wheel = veh->getWheelInfo(iW);
 
-				// Local frame
-				mrpt::tfest::TMatchingPair corr;
+					// Local frame
+					mrpt::tfest::TMatchingPair corr;
 
-				corr.localIdx = iW;
-				corr.local = mrpt::math::TPoint3D(wheel.x, wheel.y, 0);
+					corr.localIdx = iW;
+					corr.local = mrpt::math::TPoint3D(wheel.x, wheel.y, 0);
 
-				// Global frame
-				const mrpt::math::TPoint3D gPt = cur_cpose.composePoint({wheel.x, wheel.y, 0.0});
+					// Global frame
+					const mrpt::math::TPoint3D gPt =
+						cur_cpose.composePoint({wheel.x, wheel.y, 0.0});
 
-				const mrpt::math::TPoint3D gPtWheelsAxis =
-					gPt + mrpt::math::TPoint3D(.0, .0, 0.5 * wheel.diameter);
+					const mrpt::math::TPoint3D gPtWheelsAxis =
+						gPt + mrpt::math::TPoint3D(.0, .0, 0.5 * wheel.diameter);
 
-				// Get "the ground" under my wheel axis:
-				const float z = this->getHighestElevationUnder(gPtWheelsAxis);
+					// Get "the ground" under my wheel axis:
+					const float z = this->getHighestElevationUnder(gPtWheelsAxis);
 
-				wheelHeights[iW] = z;
+					wheelHeights[iW] = z;
 
-				if (!equal_zs) equal_zs = z;
-				if (std::abs(*equal_zs - z) > 1e-4) all_equal = false;
+					if (!equal_zs) equal_zs = z;
+					if (std::abs(*equal_zs - z) > 1e-4) all_equal = false;
 
-				corr.globalIdx = iW;
-				corr.global = mrpt::math::TPoint3D(gPt.x, gPt.y, z);
+					corr.globalIdx = iW;
+					corr.global = mrpt::math::TPoint3D(gPt.x, gPt.y, z);
 
-				corrs.push_back(corr);
-			}  // end for each Wheel
+					corrs.push_back(corr);
+				}  // end for each Wheel
 
-			if (all_equal && equal_zs.has_value())
-			{
-				// Optimization: just use the constant elevation without optimizing:
-				new_pose.z = *equal_zs;
-				new_pose.pitch = 0;
-				new_pose.roll = 0;
-			}
-			else if (corrs.size() >= 3)
-			{
-				// Register:
-				double transf_scale;
-				mrpt::poses::CPose3DQuat tmpl;
+				if (all_equal && equal_zs.has_value())
+				{
+					// Optimization: just use the constant elevation without optimizing:
+					new_pose.z = *equal_zs;
+					new_pose.pitch = 0;
+					new_pose.roll = 0;
+				}
+				else if (corrs.size() >= 3)
+				{
+					// Register:
+					double transf_scale;
+					mrpt::poses::CPose3DQuat tmpl;
 
-				mrpt::tfest::se3_l2(corrs, tmpl, transf_scale, true /*force scale unity*/);
+					mrpt::tfest::se3_l2(corrs, tmpl, transf_scale, true /*force scale unity*/);
 
-				optimalTf = mrpt::poses::CPose3D(tmpl);
+					optimalTf = mrpt::poses::CPose3D(tmpl);
 
-				new_pose.z = optimalTf.z();
-				new_pose.yaw = optimalTf.yaw();
-				new_pose.pitch = optimalTf.pitch();
-				new_pose.roll = optimalTf.roll();
-			}
+					new_pose.z = optimalTf.z();
+					new_pose.yaw = optimalTf.yaw();
+					new_pose.pitch = optimalTf.pitch();
+					new_pose.roll = optimalTf.roll();
+				}
 
-			veh->setPose(new_pose);
+				veh->setPose(new_pose);
 
-		}  // end iters
+			}  // end iters
 
-		// compute "down" direction:
-		{
-			mrpt::poses::CPose3D rot_only;
-			rot_only.setRotationMatrix(optimalTf.getRotationMatrix());
-			rot_only.inverseComposePoint(.0, .0, -1.0, dir_down.x, dir_down.y, dir_down.z);
-		}
+			// compute "down" direction:
+			{
+				mrpt::poses::CPose3D rot_only;
+				rot_only.setRotationMatrix(optimalTf.getRotationMatrix());
+				rot_only.inverseComposePoint(.0, .0, -1.0, dir_down.x, dir_down.y, dir_down.z);
+			}
 
-		// 2) Apply gravity force
-		// -------------------------------------------------------------
-		{
-			// To chassis:
-			const double chassis_weight = veh->getChassisMass() * gravity;
-			const mrpt::math::TPoint2D chassis_com = veh->getChassisCenterOfMass();
-			veh->apply_force(
-				{dir_down.x * chassis_weight, dir_down.y * chassis_weight}, chassis_com);
-
-			// To wheels:
-			for (size_t iW = 0; iW < nWheels; iW++)
+			// 2) Apply gravity force
+			// -------------------------------------------------------------
 			{
-				const Wheel& wheel = veh->getWheelInfo(iW);
-				const double wheel_weight = wheel.mass * gravity;
+				// To chassis:
+				const double chassis_weight = veh->getChassisMass() * gravity;
+				const mrpt::math::TPoint2D chassis_com = veh->getChassisCenterOfMass();
 				veh->apply_force(
-					{dir_down.x * wheel_weight, dir_down.y * wheel_weight}, {wheel.x, wheel.y});
+					{dir_down.x * chassis_weight, dir_down.y * chassis_weight}, chassis_com);
+
+				// To wheels:
+				for (size_t iW = 0; iW < nWheels; iW++)
+				{
+					const Wheel& wheel = veh->getWheelInfo(iW);
+					const double wheel_weight = wheel.mass * gravity;
+					veh->apply_force(
+						{dir_down.x * wheel_weight, dir_down.y * wheel_weight}, {wheel.x, wheel.y});
+				}
 			}
-		}
-	}  // end for each vehicle
+		});  // end for each vehicle
 
 	// (2/2) Collisions due to steep slopes
 
@@ -447,6 +483,14 @@ void World::internal_simul_pre_step_terrain_elevation()
 		if (!e.has_value()) e.emplace();
 
 		TInfoPerCollidableobj& ipv = e.value();
+		ipv.sleeping = veh->isSleeping() || isPartitionGhost(name);
+		if (ipv.sleeping)
+		{
+			ipv.wheel_heights = nullptr;
+			objIdx++;
+			continue;
+		}
+
 		ipv.pose = veh->getCPose3D();
 		ipv.representativeHeight = 1.05 * veh->chassisZMax();
 		ipv.contour = veh->getChassisShape();
@@ -484,11 +528,33 @@ void World::internal_simul_pre_step_terrain_elevation()
 	}
 #endif
 
+	// 1) get obstacles around each vehicle. This only queries the world, so
+	// it can run in parallel:
+	internal_parallel_for(
+		obstacles_for_each_obj_.size(),
+		[&](size_t idx)
+		{
+			auto& e = obstacles_for_each_obj_[idx];
+			if (!e.has_value() || e->sleeping) return;
+
+			TInfoPerCollidableobj& ipv = e.value();
+
+			ipv.contour_heights.assign(ipv.contour.size(), 0);
+			for (size_t k = 0; k < ipv.contour.size(); k++)
+			{
+				const auto ptLocal = mrpt::math::TPoint3D(
+					ipv.contour.at(k).x, ipv.contour.at(k).y, ipv.representativeHeight);
+				const auto ptGlobal = ipv.pose.composePoint(ptLocal);
+				const float z = getHighestElevationUnder(ptGlobal);
+				ipv.contour_heights.at(k) = z;
+			}
+		});
+
 	// For each object, create a ground body with fixtures at each potential collision point
 	// around the vehicle, so it can collide with the environment:
 	for (auto& e : obstacles_for_each_obj_)
 	{
-		if (!e.has_value()) continue;
+		if (!e.has_value() || e->sleeping) continue;
 
 		TInfoPerCollidableobj& ipv = e.value();
 
@@ -498,16 +564,6 @@ void World::internal_simul_pre_step_terrain_elevation()
 		for (const auto z : *ipv.wheel_heights) avrg_wheels_z += z;
 		avrg_wheels_z /= 1.0f * ipv.wheel_heights->size();
 
-		ipv.contour_heights.assign(ipv.contour.size(), 0);
-		// 1) get obstacles around the vehicle:
-		for (size_t k = 0; k < ipv.contour.size(); k++)
-		{
-			const auto ptLocal = mrpt::math::TPoint3D(
-				ipv.contour.at(k).x, ipv.contour.at(k).y, ipv.representativeHeight);
-			const auto ptGlobal = ipv.pose.composePoint(ptLocal);
-			const float z = getHighestElevationUnder(ptGlobal);
-			ipv.contour_heights.at(k) = z;
-		}
 		// 2) Create a Box2D "ground body" with square "fixtures" so the
 		// vehicle can collide with the occ. grid:
 
@@ -579,6 +635,41 @@ void World::internal_simul_pre_step_terrain_elevation()
 	}  // end for object
 }
 
+void World::internal_parallel_for(size_t n, const std::function<void(size_t)>& func)
+{
+	const size_t nThreads = simulThreads_ > 0 ? static_cast<size_t>(simulThreads_)
+											  : std::thread::hardware_concurrency();
+
+	if (nThreads <= 1 || n <= 1)
+	{
+		for (size_t i = 0; i < n; i++) func(i);
+		return;
+	}
+
+	if (!simulWorkerPool_)
+	{
+		simulWorkerPool_ = std::make_unique<mrpt::WorkerThreadsPool>(
+			nThreads, mrpt::WorkerThreadsPool::POLICY_FIFO, "mvsim_simul");
+	}
+
+	// Split into contiguous chunks, one per thread:
+	const size_t nChunks = std::min(nThreads, n);
+	std::vector<std::future<void>> futs;
+	futs.reserve(nChunks);
+	for (size_t c = 0; c < nChunks; c++)
+	{
+		const size_t i0 = c * n / nChunks, i1 = (c + 1) * n / nChunks;
+		futs.emplace_back(simulWorkerPool_->enqueue(
+			[&func, i0, i1]()
+			{
+				for (size_t i = i0; i < i1; i++) func(i);
+			}));
+	}
+	// Wait for all of them before get(), which may rethrow an exception:
+	for (auto& f : futs) f.wait();
+	for (auto& f : futs) f.get();
+}
+
 const World::LUTCache& World::getLUTCacheOfObjects() const
 {
 	if (!lut2d_objects_is_up_to_date_) internal_update_lut_cache();
@@ -10,6 +10,7 @@
 #include "parse_utils.h"
 
 #include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
 #include <mrpt/core/get_env.h>
 #include <mrpt/expr/CRuntimeCompiledExpression.h>
 #include <mrpt/random/RandomGenerators.h>
@@ -19,9 +20,12 @@
 #include <mrpt/version.h>
 
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <unordered_map>
 
 thread_local const bool MVSIM_VERBOSE_PARSE = mrpt::get_env<bool>("MVSIM_VERBOSE_PARSE", false);
 
@@ -29,117 +33,110 @@ using namespace mvsim;
 
 namespace
 {
-std::string parseEnvVars(const std::string& text)
-{
-	MRPT_TRY_START
+using variables_t = std::map<std::string, std::string>;
 
-	const auto start = text.find("$env{");
-	if (start == std::string::npos) return text;
+// Name prefix given to `${VAR}` references inside `$f{}` which are bound to
+// the compiled expression as variables instead of being pasted as text:
+const char* const BOUND_VAR_PREFIX = "mvsim_var_";
 
-	const std::string pre = text.substr(0, start);
-	const std::string post = text.substr(start + 5);
-
-	const auto post_end = post.find('}');
-	if (post_end == std::string::npos)
-	{
-		THROW_EXCEPTION_FMT(
-			"Column=%u: Cannot find matching `}` for `$env{` in: `%s`",
-			static_cast<unsigned int>(start), text.c_str());
-	}
+// Max number of compiled `$f{}` expressions kept in the cache:
+constexpr size_t MAX_CACHED_EXPRESSIONS = 4096;
 
-	const auto varname = post.substr(0, post_end);
-	std::string varvalue;
-	const char* v = ::getenv(varname.c_str());
-	if (v != nullptr)
-		varvalue = std::string(v);
-	else
-	{
-		THROW_EXCEPTION_FMT(
-			"parseEnvVars(): Undefined environment variable found: $env{%s}", varname.c_str());
-	}
+enum class ExprKind : uint8_t
+{
+	None = 0,
+	Var,  // ${VAR}
+	Env,  // $env{VAR}
+	Cmd,  // $(cmd)
+	Math  // $f{expr}
+};
+
+struct ExprStart
+{
+	ExprKind kind = ExprKind::None;
+	size_t prefixLen = 0;
+	char endChar = '\0';
+};
 
-	return parseEnvVars(pre + varvalue + post.substr(post_end + 1));
-	MRPT_TRY_END
+// Identifies the kind of `$` expression starting at text[pos]=='$'
+ExprStart matchExprStart(const std::string& text, size_t pos)
+{
+	const char* s = text.c_str() + pos;
+	if (s[1] == '{') return {ExprKind::Var, 2, '}'};
+	if (s[1] == '(') return {ExprKind::Cmd, 2, ')'};
+	if (s[1] == 'f' && s[2] == '{') return {ExprKind::Math, 3, '}'};
+	if (!std::strncmp(s + 1, "env{", 4)) return {ExprKind::Env, 5, '}'};
+	return {};
 }
 
-std::string parseVars(
-	const std::string& text, const std::map<std::string, std::string>& variableNamesValues)
+// Returns the position of the `endChar` closing an expression whose contents
+// start at `pos`, skipping over any nested `$` expression.
+size_t findExprEnd(const std::string& text, size_t pos, const char endChar)
 {
-	MRPT_TRY_START
-
-	const auto start = text.find("${");
-	if (start == std::string::npos) return text;
-
-	const std::string pre = text.substr(0, start);
-	const std::string post = text.substr(start + 2);
-
-	const auto post_end = post.find('}');
-	if (post_end == std::string::npos)
-	{
-		THROW_EXCEPTION_FMT(
-			"Column=%u: Cannot find matching `}` for `${` in: `%s`",
-			static_cast<unsigned int>(start), text.c_str());
-	}
-
-	const auto varname = post.substr(0, post_end);
-	std::string varvalue;
-	if (const auto it = variableNamesValues.find(varname); it != variableNamesValues.end())
-	{
-		varvalue = it->second;
-	}
-	else
+	while (pos < text.size())
 	{
-		std::string allKnown;
-		for (const auto& kv : variableNamesValues)
+		const char ch = text[pos];
+		if (ch == endChar) return pos;
+		if (ch == '$')
 		{
-			allKnown += kv.first;
-			allKnown += ",";
+			if (const auto nested = matchExprStart(text, pos); nested.kind != ExprKind::None)
+			{
+				const auto nestedEnd =
+					findExprEnd(text, pos + nested.prefixLen, nested.endChar);
+				if (nestedEnd == std::string::npos) return std::string::npos;
+				pos = nestedEnd + 1;
+				continue;
+			}
 		}
-
-		THROW_EXCEPTION_FMT(
-			"parseVars(): Undefined variable found: ${%s}. Known ones are: %s", varname.c_str(),
-			allKnown.c_str());
+		pos++;
 	}
-
-	return parseVars(pre + varvalue + post.substr(post_end + 1), variableNamesValues);
-	MRPT_TRY_END
+	return std::string::npos;
 }
 
-std::string parseCmdRuns(const std::string& text)
-{
-	MRPT_TRY_START
-
-	const auto start = text.find("$(");
-	if (start == std::string::npos) return text;
+bool isIdentifierStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool isIdentifierChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
 
-	const std::string pre = text.substr(0, start);
-	const std::string post = text.substr(start + 2);
+bool isValidIdentifier(const std::string& s)
+{
+	if (s.empty() || !isIdentifierStart(s[0])) return false;
+	return std::all_of(s.begin(), s.end(), &isIdentifierChar);
+}
 
-	const auto post_end = post.find(')');
-	if (post_end == std::string::npos)
+// Strict check for a plain, unsigned decimal literal ("12", "0.5", "1e-3")
+// whose textual replacement inside an expression is equivalent to binding it
+// as a variable.
+bool isPlainUnsignedNumber(const std::string& s, double& value)
+{
+	size_t i = 0;
+	const size_t n = s.size();
+	size_t nDigits = 0;
+	while (i < n && std::isdigit(static_cast<unsigned char>(s[i]))) i++, nDigits++;
+	if (i < n && s[i] == '.')
 	{
-		THROW_EXCEPTION_FMT(
-			"Column=%u: Cannot find matching `)` for `$(` in: `%s`",
-			static_cast<unsigned int>(start), text.c_str());
+		i++;
+		while (i < n && std::isdigit(static_cast<unsigned char>(s[i]))) i++, nDigits++;
 	}
-
-	const auto cmd = post.substr(0, post_end);
-
-	// Launch command and get console output:
-	std::string cmdOut;
-
-	int ret = mrpt::system::executeCommand(cmd, &cmdOut);
-	if (ret != 0)
+	if (!nDigits) return false;
+	if (i < n && (s[i] == 'e' || s[i] == 'E'))
 	{
-		THROW_EXCEPTION_FMT("Error (retval=%i) executing external command: `%s`", ret, cmd.c_str());
+		i++;
+		if (i < n && (s[i] == '+' || s[i] == '-')) i++;
+		if (i == n || !std::isdigit(static_cast<unsigned char>(s[i]))) return false;
+		while (i < n && std::isdigit(static_cast<unsigned char>(s[i]))) i++;
 	}
-	// Clear whitespaces:
-	cmdOut = mrpt::system::trim(cmdOut);
-	cmdOut.erase(std::remove(cmdOut.begin(), cmdOut.end(), '\r'), cmdOut.end());
-	cmdOut.erase(std::remove(cmdOut.begin(), cmdOut.end(), '\n'), cmdOut.end());
+	if (i != n) return false;
+	value = std::strtod(s.c_str(), nullptr);
+	return true;
+}
 
-	return parseCmdRuns(pre + cmdOut + post.substr(post_end + 1));
-	MRPT_TRY_END
+// Same (lenient) conversion used so far for variables referenced by name in
+// `$f{}` expressions: leading whitespace and trailing garbage are ignored.
+bool toNumber(const std::string& s, double& value)
+{
+	const char* begin = s.c_str();
+	char* end = nullptr;
+	value = std::strtod(begin, &end);
+	return end != begin;
 }
 
 double my_rand()
@@ -164,54 +161,255 @@ double randomize(double seed)
 	return 0;
 }
 
-// Examples: "$f{180/5}",   "$f{ ${MAX_SPEED} * sin(deg2rad(45)) }"
-std::string parseMathExpr(
-	const std::string& text, const std::map<std::string, std::string>& variableNamesValues)
+/** A compiled `$f{}` expression, with the storage for the variables it is
+ * bound to, so it can be re-evaluated for new variable values without
+ * compiling it again. */
+struct CompiledExpr
+{
+	mrpt::expr::CRuntimeCompiledExpression expr;
+	std::map<std::string, double> values;
+};
+
+using expr_cache_t = std::unordered_map<std::string, std::unique_ptr<CompiledExpr>>;
+
+expr_cache_t& exprCache()
+{
+	thread_local expr_cache_t cache;
+	return cache;
+}
+
+bool sameVariableNames(
+	const std::map<std::string, double>& a, const std::map<std::string, double>& b)
+{
+	return a.size() == b.size() &&
+		   std::equal(
+			   a.begin(), a.end(), b.begin(),
+			   [](const auto& x, const auto& y) { return x.first == y.first; });
+}
+
+// Examples: "180/5",   "mvsim_var_MAX_SPEED * sin(deg2rad(45))"
+double evalMathExpr(
+	const std::string& sExpr, const variables_t& variableNamesValues,
+	std::map<std::string, double>& boundValues)
 {
 	MRPT_TRY_START
 
-	const auto start = text.find("$f{");
-	if (start == std::string::npos) return text;
+	// Variables referenced by name within the expression:
+	for (size_t i = 0; i < sExpr.size();)
+	{
+		const char ch = sExpr[i];
+		if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.')
+		{
+			// Skip numeric literals, including exponents ("1e3"):
+			while (i < sExpr.size() && (isIdentifierChar(sExpr[i]) || sExpr[i] == '.')) i++;
+			continue;
+		}
+		if (!isIdentifierStart(ch))
+		{
+			i++;
+			continue;
+		}
+		const size_t idStart = i;
+		while (i < sExpr.size() && isIdentifierChar(sExpr[i])) i++;
+		const auto name = sExpr.substr(idStart, i - idStart);
+
+		if (boundValues.count(name)) continue;
+		const auto it = variableNamesValues.find(name);
+		if (it == variableNamesValues.end()) continue;
+		if (double val = 0; toNumber(it->second, val)) boundValues[name] = val;
+	}
+
+	auto& cache = exprCache();
+	auto& entry = cache[sExpr];
+	if (entry && sameVariableNames(entry->values, boundValues))
+	{
+		// Cache hit: just refresh the variable values, in place, since the
+		// compiled expression holds pointers to them:
+		auto itNew = boundValues.cbegin();
+		for (auto& kv : entry->values) kv.second = (itNew++)->second;
+		return entry->expr.eval();
+	}
+
+	auto ce = std::make_unique<CompiledExpr>();
+	ce->values = boundValues;
 
-	const std::string pre = text.substr(0, start);
-	const std::string post = text.substr(start + 3);
+	ce->expr.register_function("rand", &my_rand);
+	ce->expr.register_function("unifrnd", &my_unifrnd);
+	ce->expr.register_function("randn", &randn);
+	ce->expr.register_function("randomize", &randomize);
 
-	const auto post_end = post.find('}');
-	if (post_end == std::string::npos)
+	std::map<std::string, double*> varPtrs;
+	for (auto& kv : ce->values) varPtrs[kv.first] = &kv.second;
+	ce->expr.register_symbol_table(varPtrs);
+
+	// Compile expression (will throw on syntax error):
+	try
+	{
+		ce->expr.compile(sExpr);
+	}
+	catch (...)
 	{
-		THROW_EXCEPTION_FMT(
-			"Column=%u: Cannot find matching `}` for `${` in: `%s`",
-			static_cast<unsigned int>(start), text.c_str());
+		cache.erase(sExpr);
+		throw;
 	}
 
-	const auto sExpr = post.substr(0, post_end);
+	const double val = ce->expr.eval();
 
-	mrpt::expr::CRuntimeCompiledExpression expr;
+	if (cache.size() > MAX_CACHED_EXPRESSIONS)
+	{
+		cache.clear();
+		cache[sExpr] = std::move(ce);
+	}
+	else
+		entry = std::move(ce);
 
-	expr.register_function("rand", &my_rand);
-	expr.register_function("unifrnd", &my_unifrnd);
-	expr.register_function("randn", &randn);
-	expr.register_function("randomize", &randomize);
+	return val;
 
-	std::map<std::string, double> numericVars;
-	for (const auto& kv : variableNamesValues)
+	MRPT_TRY_END
+}
+
+std::string runCmd(const std::string& cmd)
+{
+	// Launch command and get console output:
+	std::string cmdOut;
+
+	int ret = mrpt::system::executeCommand(cmd, &cmdOut);
+	if (ret != 0)
 	{
-		std::stringstream ss(kv.second);
+		THROW_EXCEPTION_FMT("Error (retval=%i) executing external command: `%s`", ret, cmd.c_str());
+	}
+	// Clear whitespaces:
+	cmdOut = mrpt::system::trim(cmdOut);
+	cmdOut.erase(std::remove(cmdOut.begin(), cmdOut.end(), '\r'), cmdOut.end());
+	cmdOut.erase(std::remove(cmdOut.begin(), cmdOut.end(), '\n'), cmdOut.end());
+	return cmdOut;
+}
 
-		double val = 0;
-		if (!(ss >> val)) continue;
+const std::string& getVarValue(const std::string& varname, const variables_t& variableNamesValues)
+{
+	if (const auto it = variableNamesValues.find(varname); it != variableNamesValues.end())
+		return it->second;
 
-		numericVars[kv.first] = val;
+	std::string allKnown;
+	for (const auto& kv : variableNamesValues)
+	{
+		allKnown += kv.first;
+		allKnown += ",";
 	}
 
-	// Compile expression (will throw on syntax error):
-	expr.compile(sExpr, numericVars);
-	const double val = expr.eval();
+	THROW_EXCEPTION_FMT(
+		"parseVars(): Undefined variable found: ${%s}. Known ones are: %s", varname.c_str(),
+		allKnown.c_str());
+}
 
-	return parseCmdRuns(pre + mrpt::format("%g", val) + post.substr(post_end + 1));
+/** Single left-to-right pass over text[begin,end), appending to `out` the
+ * text with all `${}`, `$env{}`, `$()` and `$f{}` expressions replaced.
+ * Expressions may be nested, e.g. `$f{ ${MAX_SPEED} * 2 }`; the inner ones are
+ * solved first.
+ *
+ * If `boundValues` is not null, we are within a `$f{}` expression: numeric
+ * `${VAR}` references are then emitted as expression variables (and their
+ * values stored in `boundValues`) so the expression text, hence its compiled
+ * form, remains the same for different variable values.
+ */
+void expandOnce(
+	std::string& out, const std::string& text, size_t begin, size_t end,
+	const variables_t& variableNamesValues, std::map<std::string, double>* boundValues)
+{
+	MRPT_TRY_START
+
+	size_t pos = begin;
+	while (pos < end)
+	{
+		const auto start = text.find('$', pos);
+		if (start == std::string::npos || start >= end)
+		{
+			out.append(text, pos, end - pos);
+			break;
+		}
+		out.append(text, pos, start - pos);
+
+		const auto e = matchExprStart(text, start);
+		if (e.kind == ExprKind::None)
+		{
+			out.push_back('$');
+			pos = start + 1;
+			continue;
+		}
+
+		const auto bodyStart = start + e.prefixLen;
+		const auto bodyEnd = findExprEnd(text, bodyStart, e.endChar);
+		if (bodyEnd == std::string::npos || bodyEnd >= end)
+		{
+			THROW_EXCEPTION_FMT(
+				"Column=%u: Cannot find matching `%c` for `%s` in: `%s`",
+				static_cast<unsigned int>(start), e.endChar,
+				text.substr(start, e.prefixLen).c_str(), text.c_str());
+		}
+		pos = bodyEnd + 1;
+
+		// Solve nested expressions in the body first:
+		std::string body;
+		std::map<std::string, double> mathBoundValues;
+		expandOnce(
+			body, text, bodyStart, bodyEnd, variableNamesValues,
+			e.kind == ExprKind::Math ? &mathBoundValues : nullptr);
+
+		switch (e.kind)
+		{
+			case ExprKind::Var:
+			{
+				const auto& varvalue = getVarValue(body, variableNamesValues);
+
+				// Only bind it as a variable if it is safe to do so, i.e. it
+				// is not pasted next to other characters forming a token:
+				double val = 0;
+				if (boundValues && isValidIdentifier(body) &&
+					isPlainUnsignedNumber(varvalue, val) &&
+					(start == begin || !(isIdentifierChar(text[start - 1]) ||
+										 text[start - 1] == '.' || text[start - 1] == '}')) &&
+					(pos == end || !(isIdentifierChar(text[pos]) || text[pos] == '.' ||
+									 text[pos] == '$')))
+				{
+					const auto boundName = BOUND_VAR_PREFIX + body;
+					(*boundValues)[boundName] = val;
+					out += boundName;
+				}
+				else
+					out += varvalue;
+			}
+			break;
+
+			case ExprKind::Env:
+			{
+				const char* v = ::getenv(body.c_str());
+				if (!v)
+				{
+					THROW_EXCEPTION_FMT(
+						"parseEnvVars(): Undefined environment variable found: $env{%s}",
+						body.c_str());
+				}
+				out += v;
+			}
+			break;
+
+			case ExprKind::Cmd:
+				out += runCmd(body);
+				break;
+
+			case ExprKind::Math:
+				out += mrpt::format(
+					"%g", evalMathExpr(body, variableNamesValues, mathBoundValues));
+				break;
+
+			default:
+				break;
+		}
+	}
 
 	MRPT_TRY_END
 }
+
 }  // namespace
 
 std::string mvsim::parse(
@@ -227,17 +425,16 @@ std::string mvsim::parse(
 
 	std::string s = input;
 
-	std::string prevValue = s;
-	for (int iter = 0; iter < 10; iter++)
+	for (int iter = 0; iter < 10 && s.find('$') != std::string::npos; iter++)
 	{
-		s = parseVars(s, variableNamesValues);
-		s = parseEnvVars(s);
-		s = parseCmdRuns(s);
-		s = parseMathExpr(s, variableNamesValues);
+		std::string out;
+		out.reserve(s.size());
+		expandOnce(out, s, 0, s.size(), variableNamesValues, nullptr);
+
 		// We may need to iterate since, in general, each expression generator
 		// might generate another kind of expression:
-		if (s == prevValue) break;
-		prevValue = s;
+		if (out == s) break;
+		s = std::move(out);
 	}
 
 	if (MVSIM_VERBOSE_PARSE)
@@ -18,6 +18,11 @@ namespace mvsim
  * - `${VAR}`: Variable names.
  * - `$env{VAR}`: Environment variables.
  * - `$(cmd)`: The output from an external program.
+ * - `$f{expr}`: The result of a math expression. Compiled expressions are
+ *   cached (per thread) by their text, and numeric `${VAR}` references within
+ *   them are bound as expression variables, so the same expression evaluated
+ *   for different variable values (e.g. within a `<for>` loop) is only
+ *   compiled once.
  *
  */
 std::string parse(
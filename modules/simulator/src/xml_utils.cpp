@@ -98,6 +98,24 @@ void TParamEntry::parse(
 		mrpt::img::TColor& col = *reinterpret_cast<mrpt::img::TColor*>(val);
 		col = mrpt::img::TColor(r, g, b, a);
 	}
+	// "%roi" ==> mvsim::TImageROI
+	else if (std::string(frmt) == std::string("%roi"))
+	{
+		int x0 = 0, y0 = 0, w = 0, h = 0;
+		char extra = 0;
+		if (4 != ::sscanf(str.c_str(), "%d %d %d %d %c", &x0, &y0, &w, &h, &extra) || x0 < 0 ||
+			y0 < 0 || w <= 0 || h <= 0)
+			throw std::runtime_error(mrpt::format(
+				"%s Error parsing '%s'='%s' (Expected format:'X0 Y0 WIDTH HEIGHT', with "
+				"non-negative corner and positive size, in pixels)",
+				functionNameContext, varName.c_str(), str.c_str()));
+
+		TImageROI& roi = *reinterpret_cast<TImageROI*>(val);
+		roi.x0 = x0;
+		roi.y0 = y0;
+		roi.width = w;
+		roi.height = h;
+	}
 	// "%pose2d"
 	// "%pose2d_ptr3d"
 	else if (!strncmp(frmt, "%pose2d", strlen("%pose2d")))
@@ -372,56 +390,74 @@ static std::tuple<std::string, std::string> splitVerticalBar(const std::string&
 
 static std::string parseVars(
 	const std::string& text, const std::map<std::string, std::string>& variables,
-	const std::set<std::string>& varsRetain, const size_t searchStartPos = 0)
+	const std::set<std::string>& varsRetain)
 {
 	MRPT_TRY_START
 
-	const auto start = text.find("${", searchStartPos);
-	if (start == std::string::npos) return text;
+	// Single pass, appending to the output, instead of re-building the whole
+	// (potentially large) text after each replacement:
+	std::string out;
+	out.reserve(text.size());
 
-	const std::string pre = text.substr(0, start);
-	const std::string post = text.substr(start + 2);
-
-	const auto post_end = findClosing(0, post, '}', '{');
-	if (post_end == std::string::npos)
+	size_t pos = 0;
+	for (;;)
 	{
-		THROW_EXCEPTION_FMT(
-			"Column=%u: Cannot find matching `}` for `${` in: `%s`",
-			static_cast<unsigned int>(start), text.c_str());
-	}
+		const auto start = text.find("${", pos);
+		if (start == std::string::npos)
+		{
+			out.append(text, pos, std::string::npos);
+			break;
+		}
+		out.append(text, pos, start - pos);
 
-	const auto varnameOrg = post.substr(0, post_end);
+		const auto post_end = findClosing(start + 2, text, '}', '{');
+		if (post_end == std::string::npos)
+		{
+			THROW_EXCEPTION_FMT(
+				"Column=%u: Cannot find matching `}` for `${` in: `%s`",
+				static_cast<unsigned int>(start), text.c_str());
+		}
 
-	const auto [varname, defaultValue] = splitVerticalBar(varnameOrg);
+		const auto varnameOrg = text.substr(start + 2, post_end - start - 2);
 
-	if (varsRetain.count(varname) != 0)
-	{
-		// Skip replacing this one:
-		return parseVars(text, variables, varsRetain, start + 2);
-	}
+		const auto [varname, defaultValue] = splitVerticalBar(varnameOrg);
 
-	std::string varvalue;
-	if (auto itVal = variables.find(varname); itVal != variables.end())
-	{
-		varvalue = itVal->second;
-	}
-	else if (const char* v = ::getenv(varname.c_str()); v != nullptr)
-	{
-		varvalue = std::string(v);
-	}
-	else
-	{
-		if (!defaultValue.empty())
+		if (varsRetain.count(varname) != 0)
+		{
+			// Skip replacing this one:
+			out.append("${");
+			pos = start + 2;
+			continue;
+		}
+
+		std::string varvalue;
+		if (auto itVal = variables.find(varname); itVal != variables.end())
 		{
-			varvalue = defaultValue;
+			varvalue = itVal->second;
+		}
+		else if (const char* v = ::getenv(varname.c_str()); v != nullptr)
+		{
+			varvalue = std::string(v);
 		}
 		else
 		{
-			THROW_EXCEPTION_FMT("mvsim::parseVars(): Undefined variable: ${%s}", varname.c_str());
+			if (!defaultValue.empty())
+			{
+				varvalue = defaultValue;
+			}
+			else
+			{
+				THROW_EXCEPTION_FMT(
+					"mvsim::parseVars(): Undefined variable: ${%s}", varname.c_str());
+			}
 		}
+
+		// The value itself may contain more variables:
+		out += parseVars(varvalue, variables, varsRetain);
+		pos = post_end + 1;
 	}
 
-	return parseVars(pre + varvalue + post.substr(post_end + 1), variables, varsRetain);
+	return out;
 	MRPT_TRY_END
 }
 
@@ -169,6 +169,7 @@ Available options:
  --headless              Launch without GUI (e.g. suitable for dockerized envs.)
  --full-profiler         Enable full profiling (generates file with all timings)
  --realtime-factor <1.0> Run slower (<1) or faster (>1) than real time if !=1.0
+ --no-server             Use an already running comms server (e.g. `mvsim server`)
  -v, --verbosity         Set verbosity level: DEBUG, INFO (default), WARN, ERROR
 )XXX");
 		return 0;
@@ -217,7 +218,7 @@ Available options:
 	}
 
 	// Start network server:
-	commonLaunchServer();
+	if (!cli->argNoServer.isSet()) commonLaunchServer();
 
 	// Attach world as a mvsim communications node:
 	app->world.connectToServer();
@@ -26,7 +26,7 @@ std::unique_ptr<cli_flags> cli;
 const std::map<std::string, cmd_t> cliCommands = {
 	{"help", cmd_t(&printListCommands)},  {"server", cmd_t(&launchStandAloneServer)},
 	{"launch", cmd_t(&launchSimulation)}, {"node", cmd_t(&commandNode)},
-	{"topic", cmd_t(&commandTopic)},
+	{"topic", cmd_t(&commandTopic)},	  {"warmup", cmd_t(&commandWarmup)},
 };
 
 void setConsoleErrorColor()
@@ -106,6 +106,7 @@ Available commands:
     mvsim server              Start a standalone communication server.
     mvsim node                List connected nodes, etc.
     mvsim topic               Inspect, publish, etc. topics.
+    mvsim warmup <WORLD.xml>  Download and preprocess all resources of a world.
     mvsim --version           Shows program version.
     mvsim --help              Shows this information.
 
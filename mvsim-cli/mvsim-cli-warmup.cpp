@@ -0,0 +1,96 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+#include <mvsim/RemoteResourcesManager.h>
+#include <mvsim/World.h>
+
+#include <iostream>
+#include <map>
+#include <rapidxml_utils.hpp>
+
+#include "mvsim-cli.h"
+
+int commandWarmup()
+{
+	using namespace mvsim;
+
+	// check args:
+	const auto& unlabeledArgs = cli->argCmd.getValue();
+	const bool badArgs = unlabeledArgs.size() != 2;
+
+	if (cli->argHelp.isSet() || badArgs)
+	{
+		fprintf(
+			stdout,
+			R"XXX(Usage: mvsim warmup <WORLD_MODEL.xml> [options]
+
+Loads a world without running it, so all its remote resources are downloaded
+and its 3D models preprocessed into the local caches, then reports the time
+spent on each one. Later launches of worlds using them start faster.
+Collision shapes are not cached on disk: they are computed again from the
+(cached) 3D models on each launch.
+
+Available options:
+ --details               List every resource, not only a summary per type.
+ -v, --verbosity         Set verbosity level: DEBUG, INFO (default), WARN, ERROR
+)XXX");
+		return badArgs ? 1 : 0;
+	}
+
+	const auto verbosityLevel = mrpt::typemeta::TEnumType<mrpt::system::VerbosityLevel>::name2value(
+		cli->argVerbosity.getValue());
+
+	const auto sXMLfilename = unlabeledArgs.at(1);
+
+	World world;
+	world.setMinLoggingLevel(verbosityLevel);
+	world.headless(true);
+
+	mrpt::system::CTicTac tic;
+	try
+	{
+		rapidxml::file<> fil_xml(sXMLfilename.c_str());
+		world.load_from_XML(fil_xml.data(), sXMLfilename.c_str());
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << mrpt::exception_to_str(e) << std::endl;
+		return 1;
+	}
+	const double totalTime = tic.Tac();
+
+	const auto stats = world.resource_load_stats();
+
+	if (cli->argDetails.isSet())
+	{
+		for (const auto& s : stats)
+			std::cout << mrpt::format(
+				"%-14s %9.3f s  %s\n", s.kind.c_str(), s.elapsed, s.uri.c_str());
+		std::cout << "\n";
+	}
+
+	// Summary per type of resource:
+	std::map<std::string, std::pair<size_t, double>> perKind;
+	for (const auto& s : stats)
+	{
+		auto& k = perKind[s.kind];
+		k.first++;
+		k.second += s.elapsed;
+	}
+	for (const auto& [kind, k] : perKind)
+		std::cout << mrpt::format("%-14s %5zu items %9.3f s\n", kind.c_str(), k.first, k.second);
+
+	std::cout << mrpt::format(
+		"\nWorld '%s' loaded in %.3f s.\nCache directory: '%s'\n", sXMLfilename.c_str(),
+		totalTime, RemoteResourcesManager::cache_directory().c_str());
+
+	return 0;
+}
@@ -36,6 +36,10 @@ struct cli_flags
 
 	TCLAP::SwitchArg argHeadless{"", "headless", "Runs the simulator without any GUI window.", cmd};
 
+	TCLAP::SwitchArg argNoServer{
+		"", "no-server",
+		"Do not start a comms server, connect to an already running one instead.", cmd};
+
 	TCLAP::SwitchArg argDetails{"", "details", "Shows details in the specified subcommand", cmd};
 
 	TCLAP::SwitchArg argVersion{"", "version", "Shows program version and exits", cmd};
@@ -66,6 +70,7 @@ int launchStandAloneServer();  // "server"
 int launchSimulation();	 // "launch"
 int commandNode();	// "node"
 int commandTopic();	 // "topic"
+int commandWarmup();  // "warmup"
 
 void setConsoleErrorColor();
 void setConsoleNormalColor();
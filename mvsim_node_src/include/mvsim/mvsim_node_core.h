@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <mrpt/core/Clock.h>
 #include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/obs/CObservation.h>
 #include <mrpt/obs/CObservation3DRangeScan.h>
@@ -22,6 +23,12 @@
 #include <tf2/LinearMath/Transform.h>
 
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
 
 #if PACKAGE_ROS_VERSION == 1
@@ -151,8 +158,16 @@ class MVSimNode
 	/// obstacles, etc.)
 	mvsim_node::shared_ptr<mvsim::World> mvsim_world_ = mvsim_node::make_shared<mvsim::World>();
 
-	mrpt::WorkerThreadsPool ros_publisher_workers_{
-		4 /*threads*/, mrpt::WorkerThreadsPool::POLICY_FIFO};
+	/// Threads converting observations to ROS messages and publishing them,
+	/// so the simulation never waits for them. Created in the ctor.
+	std::unique_ptr<mrpt::WorkerThreadsPool> ros_publisher_workers_;
+
+	/// Number of threads in ros_publisher_workers_ (Default=4)
+	int publisher_threads_ = 4;
+
+	/// Maximum number of observations of each sensor waiting to be
+	/// published. If exceeded, the oldest ones are dropped. (Default=2)
+	int publisher_queue_len_ = 2;
 
 	/// (Defaul=1.0) >1: speed-up, <1: slow-down
 	double realtime_factor_ = 1.0;
@@ -254,19 +269,61 @@ class MVSimNode
 
 		Msg_MarkerArray chassis_shape_msg;
 #endif
+		/// Wheel poses in the last published chassis_shape_msg
+		std::vector<std::optional<mrpt::math::TPose3D>> last_wheel_poses;
+
+		/// All transforms published so far to "<VEH>/tf_static", and the
+		/// pose of each child frame. See sendStaticTF()
+		Msg_TFMessage static_tfs;
+		std::map<std::string, mrpt::poses::CPose3D> static_tf_poses;
+		/// Number of changes to static_tfs, and the last one published, which
+		/// is protected by static_tf_publish_mtx_ instead
+		uint64_t static_tfs_version = 0, static_tfs_published_version = 0;
 	};
 
 	/// Pubs/Subs for each vehicle. Initialized by initPubSubs(), called
 	/// from notifyROSWorldIsUpdated()
 	std::vector<TPubSubPerVehicle> pubsub_vehicles_;
 	std::mutex pubsub_vehicles_mtx_;
+	std::mutex static_tf_publish_mtx_;	//!< See sendStaticTF()
 
 	/** Initialize all pub/subs required for each vehicle, for the specific
 	 * vehicle \a veh */
 	void initPubSubs(TPubSubPerVehicle& out_pubsubs, mvsim::VehicleBase* veh);
 
+	/** Publishes the transform frame_id -> child_frame_id in the vehicle
+	 * "<VEH>/tf_static" topic, unless it was already sent with this same
+	 * value. Locks pubsub_vehicles_mtx_ internally, but not while
+	 * publishing. */
+	void sendStaticTF(
+		TPubSubPerVehicle& pubs, const std::string& frame_id, const std::string& child_frame_id,
+		const mrpt::poses::CPose3D& p);
+
 	// === End ROS Publishers ====
 
+	/** Observations of one sensor pending to be published. Each queue is
+	 * drained by at most one worker thread at a time, so observations from one
+	 * sensor are published in order, while different sensors run in parallel.
+	 */
+	struct ObsPublishQueue
+	{
+		std::deque<std::pair<mrpt::Clock::time_point, mrpt::obs::CObservation::Ptr>> pending;
+		bool drainScheduled = false;
+		size_t dropped = 0;
+	};
+
+	/// Publish queues, indexed by (vehicle, sensor label)
+	std::map<std::pair<const mvsim::Simulable*, std::string>, ObsPublishQueue> obsPublishQueues_;
+	std::mutex obsPublishQueuesMtx_;
+
+	/** Called from the simulator thread that generated an observation: only
+	 * pushes it into its sensor queue, never blocking on ROS. */
+	void enqueueObservation(const mvsim::Simulable& veh, const mrpt::obs::CObservation::Ptr& obs);
+
+	/** Runs in ros_publisher_workers_: publishes all pending observations of
+	 * one queue, registering the latency of each one in profiler_. */
+	void drainObservationQueue(const mvsim::Simulable* veh, ObsPublishQueue* q);
+
 	// === ROS Hooks ====
 	void onROSMsgCmdVel(Msg_Twist_CSPtr cmd, mvsim::VehicleBase* veh);
 	// === End ROS Hooks====
@@ -278,9 +335,6 @@ class MVSimNode
 	ros_Time base_last_cmd_;  //!< received a vel_cmd (for watchdog)
 	ros_Duration base_watchdog_timeout_ = ros_Duration(1, 0);
 
-	/// Unit transform (const, once)
-	const tf2::Transform tfIdentity_ = tf2::Transform::getIdentity();
-
 	struct TThreadParams
 	{
 		TThreadParams() = default;
@@ -8,12 +8,15 @@
   +-------------------------------------------------------------------------+ */
 
 #include <mrpt/core/lock_helper.h>
+#include <mrpt/system/datetime.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>	 // kbhit()
 #include <mrpt/version.h>
 #include <mvsim/WorldElements/OccupancyGridMap.h>
 #include <mvsim/mvsim_node_core.h>
 
+#include <algorithm>
+
 #include "rapidxml_utils.hpp"
 
 #if MRPT_VERSION >= 0x020b04  // >=2.11.4?
@@ -140,6 +143,8 @@ MVSimNode::MVSimNode(rclcpp::Node::SharedPtr& n)
 	localn_.param("gui_refresh_period", gui_refresh_period_ms_, gui_refresh_period_ms_);
 	localn_.param("headless", headless_, headless_);
 	localn_.param("period_ms_publish_tf", period_ms_publish_tf_, period_ms_publish_tf_);
+	localn_.param("publisher_threads", publisher_threads_, publisher_threads_);
+	localn_.param("publisher_queue_len", publisher_queue_len_, publisher_queue_len_);
 	localn_.param("do_fake_localization", do_fake_localization_, do_fake_localization_);
 	localn_.param(
 		"force_publish_vehicle_namespace", force_publish_vehicle_namespace_,
@@ -182,6 +187,11 @@ MVSimNode::MVSimNode(rclcpp::Node::SharedPtr& n)
 	publisher_history_len_ =
 		n_->declare_parameter<int>("publisher_history_len", publisher_history_len_);
 
+	publisher_threads_ = n_->declare_parameter<int>("publisher_threads", publisher_threads_);
+
+	publisher_queue_len_ =
+		n_->declare_parameter<int>("publisher_queue_len", publisher_queue_len_);
+
 	force_publish_vehicle_namespace_ = n_->declare_parameter<bool>(
 		"force_publish_vehicle_namespace", force_publish_vehicle_namespace_);
 
@@ -211,6 +221,10 @@ MVSimNode::MVSimNode(rclcpp::Node::SharedPtr& n)
 	base_last_cmd_ = rclcpp::Time(0);
 #endif
 
+	ASSERT_GE_(publisher_queue_len_, 1);
+	ros_publisher_workers_ = std::make_unique<mrpt::WorkerThreadsPool>(
+		std::max(1, publisher_threads_), mrpt::WorkerThreadsPool::POLICY_FIFO, "mvsim_ros_pub");
+
 	mvsim_world_->registerCallbackOnObservation(
 		[this](const mvsim::Simulable& veh, const mrpt::obs::CObservation::Ptr& obs)
 		{
@@ -218,27 +232,84 @@ MVSimNode::MVSimNode(rclcpp::Node::SharedPtr& n)
 
 			mrpt::system::CTimeLoggerEntry tle(profiler_, "lambda_onNewObservation");
 
-			const mvsim::Simulable* vehPtr = &veh;
-			const mrpt::obs::CObservation::Ptr obsCopy = obs;
-			const auto fut = ros_publisher_workers_.enqueue(
-				[this, vehPtr, obsCopy]()
-				{
-					try
-					{
-						onNewObservation(*vehPtr, obsCopy);
-					}
-					catch (const std::exception& e)
-					{
-						ROS12_ERROR(
-							"[MVSimNode] Error processing observation with "
-							"label "
-							"'%s':\n%s",
-							obsCopy ? obsCopy->sensorLabel.c_str() : "(nullptr)", e.what());
-					}
-				});
+			enqueueObservation(veh, obs);
 		});
 }
 
+void MVSimNode::enqueueObservation(
+	const mvsim::Simulable& veh, const mrpt::obs::CObservation::Ptr& obs)
+{
+	auto lck = mrpt::lockHelper(obsPublishQueuesMtx_);
+
+	ObsPublishQueue& q = obsPublishQueues_[{&veh, obs->sensorLabel}];
+
+	q.pending.emplace_back(mrpt::Clock::now(), obs);
+
+	// Drop-oldest policy, if the publishers cannot keep up with the sensor rate:
+	bool dropped = false;
+	while (q.pending.size() > static_cast<size_t>(publisher_queue_len_))
+	{
+		q.pending.pop_front();
+		q.dropped++;
+		dropped = true;
+	}
+
+	if (!q.drainScheduled)
+	{
+		q.drainScheduled = true;
+		ros_publisher_workers_->enqueue(
+			[this, vehPtr = &veh, qPtr = &q]() { drainObservationQueue(vehPtr, qPtr); });
+	}
+	const size_t totalDropped = q.dropped;
+	lck.unlock();
+
+	if (dropped)
+	{
+		ROS12_WARN_THROTTLE(
+			5.0,
+			"[MVSimNode] Publishers too slow for sensor '%s' of '%s': %zu observations dropped "
+			"so far. Consider increasing the 'publisher_threads' parameter.",
+			obs->sensorLabel.c_str(), veh.getName().c_str(), totalDropped);
+	}
+}
+
+void MVSimNode::drainObservationQueue(const mvsim::Simulable* veh, ObsPublishQueue* q)
+{
+	using namespace std::string_literals;
+
+	for (;;)
+	{
+		mrpt::Clock::time_point enqueueTime;
+		mrpt::obs::CObservation::Ptr obs;
+		{
+			auto lck = mrpt::lockHelper(obsPublishQueuesMtx_);
+			if (q->pending.empty())
+			{
+				q->drainScheduled = false;
+				return;
+			}
+			std::tie(enqueueTime, obs) = std::move(q->pending.front());
+			q->pending.pop_front();
+		}
+
+		try
+		{
+			onNewObservation(*veh, obs);
+		}
+		catch (const std::exception& e)
+		{
+			ROS12_ERROR(
+				"[MVSimNode] Error processing observation with label '%s':\n%s",
+				obs->sensorLabel.c_str(), e.what());
+		}
+
+		// Time from the observation generation to its publication:
+		profiler_.registerUserMeasure(
+			"publish_latency."s + veh->getName() + "."s + obs->sensorLabel,
+			mrpt::system::timeDifference(enqueueTime, mrpt::Clock::now()));
+	}
+}
+
 void MVSimNode::launch_mvsim_server()
 {
 	ROS12_INFO("[MVSimNode] launch_mvsim_server()");
@@ -285,7 +356,7 @@ void MVSimNode::terminateSimulation()
 
 	mvsim_world_->free_opengl_resources();
 
-	ros_publisher_workers_.clear();
+	if (ros_publisher_workers_) ros_publisher_workers_->clear();
 	// Don't destroy mvsim_server_ yet, since "world" needs to unregister.
 	mvsim_world_.reset();
 	std::cout << "[MVSimNode::terminateSimulation] All done." << std::endl;
@@ -585,7 +656,7 @@ void MVSimNode::initPubSubs(TPubSubPerVehicle& pubsubs, mvsim::VehicleBase* veh)
 	pubsubs.pub_tf = mvsim_node::make_shared<ros::Publisher>(
 		n_.advertise<Msg_TFMessage>(vehVarName("tf", *veh), publisher_history_len_));
 	pubsubs.pub_tf_static = mvsim_node::make_shared<ros::Publisher>(
-		n_.advertise<Msg_TFMessage>(vehVarName("tf_static", *veh), publisher_history_len_));
+		n_.advertise<Msg_TFMessage>(vehVarName("tf_static", *veh), 1, true /*latch*/));
 #else
 	// pub: <VEH>/odom
 	pubsubs.pub_odom =
@@ -748,15 +819,56 @@ void MVSimNode::initPubSubs(TPubSubPerVehicle& pubsubs, mvsim::VehicleBase* veh)
 	}
 
 	// TF STATIC(namespace <Ri>): /base_link -> /base_footprint
-	Msg_TransformStamped tx;
-	tx.header.frame_id = "base_link";
-	tx.child_frame_id = "base_footprint";
-	tx.header.stamp = myNow();
-	tx.transform = tf2::toMsg(tfIdentity_);
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tx);
-	pubsubs.pub_tf_static->publish(tfMsg);
+	sendStaticTF(pubsubs, "base_link", "base_footprint", mrpt::poses::CPose3D::Identity());
+}
+
+void MVSimNode::sendStaticTF(
+	TPubSubPerVehicle& pubs, const std::string& frame_id, const std::string& child_frame_id,
+	const mrpt::poses::CPose3D& p)
+{
+	Msg_TFMessage msg;
+	decltype(pubs.pub_tf_static) pub;
+	uint64_t version = 0;
+	{
+		auto lck = mrpt::lockHelper(pubsub_vehicles_mtx_);
+
+		// Already sent with this same value?
+		if (auto it = pubs.static_tf_poses.find(child_frame_id);
+			it != pubs.static_tf_poses.end() && it->second == p)
+			return;
+
+		pubs.static_tf_poses[child_frame_id] = p;
+
+		Msg_TransformStamped tx;
+		tx.header.frame_id = frame_id;
+		tx.child_frame_id = child_frame_id;
+		tx.header.stamp = myNow();
+		tx.transform = tf2::toMsg(mrpt2ros::toROS_tfTransform(p));
+
+		// The topic is latched, keeping only the last message, so it must always
+		// contain all static transforms, not only the new one:
+		auto& tfs = pubs.static_tfs.transforms;
+		auto it = std::find_if(
+			tfs.begin(), tfs.end(),
+			[&](const Msg_TransformStamped& t) { return t.child_frame_id == child_frame_id; });
+		if (it != tfs.end())
+			*it = tx;
+		else
+			tfs.push_back(tx);
+
+		msg = pubs.static_tfs;
+		pub = pubs.pub_tf_static;
+		version = ++pubs.static_tfs_version;
+	}
+
+	// Publish without holding pubsub_vehicles_mtx_. Concurrent calls may get
+	// here in any order, so a message older than the last published one is
+	// dropped instead of replacing it in the latched topic:
+	auto lck = mrpt::lockHelper(static_tf_publish_mtx_);
+	if (version < pubs.static_tfs_published_version) return;
+	pubs.static_tfs_published_version = version;
+
+	pub->publish(msg);
 }
 
 void MVSimNode::onROSMsgCmdVel(Msg_Twist_CSPtr cmd, mvsim::VehicleBase* veh)
@@ -812,11 +924,19 @@ void MVSimNode::spinNotifyROS()
 			const auto& veh = it->second;
 			auto& pubs = pubsub_vehicles_[i];
 
+			// Distributed simulation: only the tile simulating it publishes it
+			if (!mvsim_world_->isPartitionPublisher(it->first)) continue;
+
+			// All dynamic TFs of this vehicle are sent in one single message:
+			Msg_TFMessage tfMsg;
+			const auto now = myNow();
+
 			// 1) Ground-truth pose and velocity
 			// --------------------------------------------
-			const mrpt::math::TPose3D& gh_veh_pose = veh->getPose();
+			const auto gh_veh_state = veh->getKinematicState();
+			const mrpt::math::TPose3D& gh_veh_pose = gh_veh_state.pose;
 			// [vx,vy,w] in global frame
-			const auto& gh_veh_vel = veh->getTwist();
+			const auto& gh_veh_vel = gh_veh_state.twist;
 
 			{
 				Msg_Odometry gtOdoMsg;
@@ -858,12 +978,10 @@ void MVSimNode::spinNotifyROS()
 						Msg_TransformStamped tx;
 						tx.header.frame_id = "map";
 						tx.child_frame_id = "odom";
-						tx.header.stamp = myNow();
+						tx.header.stamp = now;
 						tx.transform = tf2::toMsg(tf2::Transform::getIdentity());
 
-						Msg_TFMessage tfMsg;
 						tfMsg.transforms.push_back(tx);
-						pubs.pub_tf->publish(tfMsg);
 					}
 				}
 			}
@@ -877,20 +995,28 @@ void MVSimNode::spinNotifyROS()
 				ASSERT_EQUAL_(msg_shapes.markers.size(), (1 + veh->getNumWheels()));
 
 				// [0] Chassis shape: static no need to update.
-				// [1:N] Wheel shapes: may move
+				// [1:N] Wheel shapes: may move (e.g. steering wheels)
+				bool anyChange = false;
+				pubs.last_wheel_poses.resize(veh->getNumWheels());
 				for (size_t j = 0; j < veh->getNumWheels(); j++)
 				{
+					const mrpt::math::TPose3D wheelPose = veh->getWheelInfo(j).pose();
+
+					auto& lastPose = pubs.last_wheel_poses[j];
+					if (lastPose && *lastPose == wheelPose) continue;
+					lastPose = wheelPose;
+					anyChange = true;
+
 					// visualization_msgs::Marker
 					auto& wheel_shape_msg = msg_shapes.markers[1 + j];
-					const auto& w = veh->getWheelInfo(j);
 
 					// Set local pose of the wheel wrt the vehicle:
-					wheel_shape_msg.pose = mrpt2ros::toROS_Pose(w.pose());
+					wheel_shape_msg.pose = mrpt2ros::toROS_Pose(wheelPose);
 
 				}  // end for each wheel
 
-				// Publish Initial pose
-				pubs.pub_chassis_markers->publish(msg_shapes);
+				// Only republish on changes, since the topic is latched:
+				if (anyChange) pubs.pub_chassis_markers->publish(msg_shapes);
 			}
 
 			// 3) odometry transform
@@ -903,12 +1029,10 @@ void MVSimNode::spinNotifyROS()
 					Msg_TransformStamped tx;
 					tx.header.frame_id = "odom";
 					tx.child_frame_id = "base_link";
-					tx.header.stamp = myNow();
+					tx.header.stamp = now;
 					tx.transform = tf2::toMsg(mrpt2ros::toROS_tfTransform(odo_pose));
 
-					Msg_TFMessage tfMsg;
 					tfMsg.transforms.push_back(tx);
-					pubs.pub_tf->publish(tfMsg);
 				}
 
 				// Apart from TF, publish to the "odom" topic as well
@@ -938,6 +1062,10 @@ void MVSimNode::spinNotifyROS()
 				pubs.pub_collision->publish(colMsg);
 			}
 
+			// 5) Send all TFs
+			// --------------------------------------------
+			pubs.pub_tf->publish(tfMsg);
+
 		}  // end for each vehicle
 
 	}  // end publish tf
@@ -1036,19 +1164,8 @@ void MVSimNode::internalOn(
 	}
 	lck.unlock();
 
-	// Send TF:
-	mrpt::poses::CPose3D sensorPose = obs.sensorPose;
-	auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-	Msg_TransformStamped tfStmp;
-	tfStmp.transform = tf2::toMsg(transform);
-	tfStmp.header.frame_id = "base_link";
-	tfStmp.child_frame_id = obs.sensorLabel;
-	tfStmp.header.stamp = myNow();
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tfStmp);
-	pubs.pub_tf->publish(tfMsg);
+	// Send TF (static, only if changed):
+	sendStaticTF(pubs, "base_link", obs.sensorLabel, obs.sensorPose);
 
 	// Send observation:
 	{
@@ -1084,19 +1201,8 @@ void MVSimNode::internalOn(const mvsim::VehicleBase& veh, const mrpt::obs::CObse
 	}
 	lck.unlock();
 
-	// Send TF:
-	mrpt::poses::CPose3D sensorPose = obs.sensorPose;
-	auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-	Msg_TransformStamped tfStmp;
-	tfStmp.transform = tf2::toMsg(transform);
-	tfStmp.header.frame_id = "base_link";
-	tfStmp.child_frame_id = obs.sensorLabel;
-	tfStmp.header.stamp = myNow();
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tfStmp);
-	pubs.pub_tf->publish(tfMsg);
+	// Send TF (static, only if changed):
+	sendStaticTF(pubs, "base_link", obs.sensorLabel, obs.sensorPose);
 
 	// Send observation:
 	{
@@ -1138,19 +1244,8 @@ void MVSimNode::internalOn(const mvsim::VehicleBase& veh, const mrpt::obs::CObse
 	}
 	lck.unlock();
 
-	// Send TF:
-	mrpt::poses::CPose3D sensorPose = obs.sensorPose;
-	auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-	Msg_TransformStamped tfStmp;
-	tfStmp.transform = tf2::toMsg(transform);
-	tfStmp.header.frame_id = "base_link";
-	tfStmp.child_frame_id = obs.sensorLabel;
-	tfStmp.header.stamp = myNow();
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tfStmp);
-	pubs.pub_tf->publish(tfMsg);
+	// Send TF (static, only if changed):
+	sendStaticTF(pubs, "base_link", obs.sensorLabel, obs.sensorPose);
 
 	// Send observation:
 	{
@@ -1273,20 +1368,8 @@ void MVSimNode::internalOn(const mvsim::VehicleBase& veh, const mrpt::obs::CObse
 	}
 	lck.unlock();
 
-	// Send TF:
-	mrpt::poses::CPose3D sensorPose;
-	obs.getSensorPose(sensorPose);
-	auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-	Msg_TransformStamped tfStmp;
-	tfStmp.transform = tf2::toMsg(transform);
-	tfStmp.header.frame_id = "base_link";
-	tfStmp.child_frame_id = obs.sensorLabel;
-	tfStmp.header.stamp = myNow();
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tfStmp);
-	pubs.pub_tf->publish(tfMsg);
+	// Send TF (static, only if changed):
+	sendStaticTF(pubs, "base_link", obs.sensorLabel, obs.sensorPose());
 
 	// Send observation:
 	Msg_Header msg_header;
@@ -1346,19 +1429,9 @@ void MVSimNode::internalOn(
 	// --------
 	if (obs.hasIntensityImage)
 	{
-		// Send TF:
-		mrpt::poses::CPose3D sensorPose = obs.sensorPose + obs.relativePoseIntensityWRTDepth;
-		auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-		Msg_TransformStamped tfStmp;
-		tfStmp.transform = tf2::toMsg(transform);
-		tfStmp.header.frame_id = "base_link";
-		tfStmp.child_frame_id = lbImage;
-		tfStmp.header.stamp = now;
-
-		Msg_TFMessage tfMsg;
-		tfMsg.transforms.push_back(tfStmp);
-		pubs.pub_tf->publish(tfMsg);
+		// Send TF (static, only if changed):
+		sendStaticTF(
+			pubs, "base_link", lbImage, obs.sensorPose + obs.relativePoseIntensityWRTDepth);
 
 		// Send observation:
 		{
@@ -1376,19 +1449,8 @@ void MVSimNode::internalOn(
 	// --------
 	if (obs.hasRangeImage)
 	{
-		// Send TF:
-		mrpt::poses::CPose3D sensorPose = obs.sensorPose;
-		auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-		Msg_TransformStamped tfStmp;
-		tfStmp.transform = tf2::toMsg(transform);
-		tfStmp.header.frame_id = "base_link";
-		tfStmp.child_frame_id = lbPoints;
-		tfStmp.header.stamp = now;
-
-		Msg_TFMessage tfMsg;
-		tfMsg.transforms.push_back(tfStmp);
-		pubs.pub_tf->publish(tfMsg);
+		// Send TF (static, only if changed):
+		sendStaticTF(pubs, "base_link", lbPoints, obs.sensorPose);
 
 		// Send observation:
 		{
@@ -1398,11 +1460,20 @@ void MVSimNode::internalOn(
 			msg_header.stamp = now;
 			msg_header.frame_id = lbPoints;
 
-			mrpt::obs::T3DPointsProjectionParams pp;
-			pp.takeIntoAccountSensorPoseOnRobot = false;
-
 			mrpt::maps::CSimplePointsMap pts;
-			const_cast<mrpt::obs::CObservation3DRangeScan&>(obs).unprojectInto(pts, pp);
+			if (obs.hasPoints3D)
+			{
+				// Already unprojected by the sensor:
+				pts.reserve(obs.points3D_x.size());
+				for (size_t i = 0; i < obs.points3D_x.size(); i++)
+					pts.insertPointFast(obs.points3D_x[i], obs.points3D_y[i], obs.points3D_z[i]);
+			}
+			else
+			{
+				mrpt::obs::T3DPointsProjectionParams pp;
+				pp.takeIntoAccountSensorPoseOnRobot = false;
+				const_cast<mrpt::obs::CObservation3DRangeScan&>(obs).unprojectInto(pts, pp);
+			}
 			mrpt2ros::toROS(pts, msg_header, msg_pts);
 			pubPts->publish(mvsim_node::make_shared<Msg_PointCloud2>(msg_pts));
 		}
@@ -1441,19 +1512,8 @@ void MVSimNode::internalOn(
 	// POINTS
 	// --------
 
-	// Send TF:
-	mrpt::poses::CPose3D sensorPose = obs.sensorPose;
-	auto transform = mrpt2ros::toROS_tfTransform(sensorPose);
-
-	Msg_TransformStamped tfStmp;
-	tfStmp.transform = tf2::toMsg(transform);
-	tfStmp.header.frame_id = "base_link";
-	tfStmp.child_frame_id = lbPoints;
-	tfStmp.header.stamp = now;
-
-	Msg_TFMessage tfMsg;
-	tfMsg.transforms.push_back(tfStmp);
-	pubs.pub_tf->publish(tfMsg);
+	// Send TF (static, only if changed):
+	sendStaticTF(pubs, "base_link", lbPoints, obs.sensorPose);
 
 	// Send observation:
 	{
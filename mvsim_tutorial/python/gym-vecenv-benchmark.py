@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# This example shows how to:
+# - Run N copies of a world in parallel, as a Gym-style vectorized env.
+# - Measure the achieved environment steps per second.
+#
+# Install python3-mvsim, or test with a local build with:
+# export PYTHONPATH=$HOME/code/mvsim/build/:$PYTHONPATH
+#
+# Usage (from the mvsim source root):
+#   mvsim_tutorial/python/gym-vecenv-benchmark.py --num-envs 8
+# ---------------------------------------------------------------------
+
+import argparse
+import numpy as np
+from mvsim_simulator.gym import VecEnv
+
+parser = argparse.ArgumentParser(prog='gym-vecenv-benchmark')
+parser.add_argument('--world', dest='worldFile', action='store',
+                    default='mvsim_tutorial/demo_2robots.world.xml')
+parser.add_argument('--vehicle', dest='vehicleName', action='store', default='r1')
+parser.add_argument('--lidar', dest='lidarName', action='store', default='laser1')
+parser.add_argument('--num-envs', dest='numEnvs', type=int, action='store', default=4)
+parser.add_argument('--steps', dest='steps', type=int, action='store', default=1000)
+args = parser.parse_args()
+
+
+def reward_fn(obs, actions):
+    # Move forward, avoid collisions:
+    return actions[:, 0] - 10.0 * obs["collisions"]
+
+
+env = VecEnv(args.worldFile, args.numEnvs, args.vehicleName, args.lidarName,
+             reward_fn=reward_fn, max_episode_steps=200)
+obs = env.reset()
+print("ranges: " + str(obs["ranges"].shape) + " poses: " + str(obs["poses"].shape))
+
+rng = np.random.default_rng()
+totalReward = np.zeros(args.numEnvs)
+for i in range(args.steps):
+    actions = np.zeros((args.numEnvs, 3))
+    actions[:, 0] = rng.uniform(0.0, 1.0, args.numEnvs)  # vx
+    actions[:, 2] = rng.uniform(-0.5, 0.5, args.numEnvs)  # w
+    obs, rewards, dones, infos = env.step(actions)
+    totalReward += rewards
+
+print("Total rewards: " + str(totalReward))
+print("Achieved env steps/s: %.01f" % env.steps_per_second)
+env.close()
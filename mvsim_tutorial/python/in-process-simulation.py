@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# This example shows how to:
+# - Run a simulation within the Python process (no mvsim server needed).
+# - Drive a vehicle with its internal twist controller.
+# - Read 2D lidar data as NumPy arrays.
+#
+# Install python3-mvsim, or test with a local build with:
+# export PYTHONPATH=$HOME/code/mvsim/build/:$PYTHONPATH
+#
+# Usage (from the mvsim source root):
+#   mvsim_tutorial/python/in-process-simulation.py
+# ---------------------------------------------------------------------
+
+import argparse
+import numpy as np
+from mvsim_simulator import pymvsim_simulator
+
+parser = argparse.ArgumentParser(prog='in-process-simulation')
+parser.add_argument('--world', dest='worldFile', action='store',
+                    default='mvsim_tutorial/demo_2robots.world.xml')
+parser.add_argument('--vehicle', dest='vehicleName', action='store', default='r1')
+parser.add_argument('--lidar', dest='lidarName', action='store', default='laser1')
+parser.add_argument('--steps', dest='steps', type=int, action='store', default=500)
+args = parser.parse_args()
+
+world = pymvsim_simulator.World()
+world.load(args.worldFile, headless=True)
+print("Vehicles: " + str(world.vehicles()))
+
+for episode in range(2):
+    world.reset()
+    for i in range(args.steps):
+        vx, w = 1.0, 0.0
+        ranges = world.lidar_ranges(args.vehicleName, args.lidarName)
+        if ranges is not None and len(ranges) > 0:
+            # Turn away from obstacles ahead (central third of the scan):
+            n = len(ranges)
+            if np.min(ranges[n // 3:2 * n // 3]) < 2.0:
+                vx, w = 0.2, 0.8
+
+        world.set_twist_command(args.vehicleName, vx, 0.0, w)
+        world.step()
+
+    print("Episode %i: t=%.03f pose=%s" %
+          (episode, world.time, str(world.get_pose(args.vehicleName))))
+
+world.close()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# Smoke test of "mvsim warmup": loads a bundled world into an empty
+# cache directory, twice, and checks the reports and exit codes.
+# ---------------------------------------------------------------------
+
+import os
+import shutil
+import subprocess
+import tempfile
+
+TESTS_DIR = os.environ['TESTS_DIR']
+MVSIM_CLI_EXE_PATH = os.environ['MVSIM_CLI_EXE_PATH']
+WORLD_FILE = TESTS_DIR + "/../mvsim_tutorial/demo_walls.world.xml"
+
+
+def warmup(args, storage_dir):
+    env = dict(os.environ, MVSIM_STORAGE_DIR=storage_dir + "/")
+    p = subprocess.run([MVSIM_CLI_EXE_PATH, "warmup"] + args, env=env,
+                       stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                       universal_newlines=True, timeout=300)
+    print(p.stdout, flush=True)
+    return p.returncode, p.stdout
+
+
+def check_report(out):
+    assert "World '" + WORLD_FILE + "' loaded in" in out, out
+    # The walls 3D model:
+    assert any(line.startswith("model ") for line in out.splitlines()), out
+
+
+if __name__ == "__main__":
+    storage_dir = tempfile.mkdtemp(prefix="mvsim_test_warmup_")
+    try:
+        # Cold cache, with the list of resources:
+        rc, out = warmup([WORLD_FILE, "--details"], storage_dir)
+        assert rc == 0, rc
+        check_report(out)
+        assert "testWalls.dae" in out, out
+        assert storage_dir in out, out
+
+        # Warm cache:
+        rc, out = warmup([WORLD_FILE], storage_dir)
+        assert rc == 0, rc
+        check_report(out)
+
+        # Missing world file, and missing arguments:
+        rc, out = warmup([TESTS_DIR + "/no_such.world.xml"], storage_dir)
+        assert rc != 0, rc
+        rc, out = warmup([], storage_dir)
+        assert rc != 0, rc
+    finally:
+        shutil.rmtree(storage_dir, ignore_errors=True)
+
+    print("test-cli-warmup: OK", flush=True)
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# Distributed simulation test: runs one comms server and two mvsim
+# processes, each one simulating one tile of the same world, and drives
+# a vehicle across the tile border with the services of both tiles.
+#
+# Test with a local build with:
+# export PYTHONPATH=$HOME/code/mvsim/build/:$PYTHONPATH
+# ---------------------------------------------------------------------
+
+from mvsim_comms import pymvsim_comms
+from mvsim_msgs import SrvShutdown_pb2
+from mvsim_msgs import SrvGetPose_pb2, SrvGetPoseAnswer_pb2
+from mvsim_msgs import SrvSetControllerTwist_pb2, SrvSetControllerTwistAnswer_pb2
+
+import subprocess
+import time
+import os
+
+TESTS_DIR = os.environ['TESTS_DIR']
+MVSIM_CLI_EXE_PATH = os.environ['MVSIM_CLI_EXE_PATH']
+
+
+def get_pose(client, serviceName, robotName):
+    req = SrvGetPose_pb2.SrvGetPose()
+    req.objectId = robotName
+    ans = SrvGetPoseAnswer_pb2.SrvGetPoseAnswer()
+    ans.ParseFromString(client.callService(serviceName, req.SerializeToString()))
+    assert ans.success, "get_pose failed for " + robotName
+    return ans.pose
+
+
+def set_twist(client, serviceName, robotName, vx):
+    req = SrvSetControllerTwist_pb2.SrvSetControllerTwist()
+    req.objectId = robotName
+    req.twistSetPoint.vx = vx
+    req.twistSetPoint.vy = 0
+    req.twistSetPoint.vz = 0
+    req.twistSetPoint.wx = 0
+    req.twistSetPoint.wy = 0
+    req.twistSetPoint.wz = 0
+    ans = SrvSetControllerTwistAnswer_pb2.SrvSetControllerTwistAnswer()
+    ans.ParseFromString(client.callService(serviceName, req.SerializeToString()))
+    assert ans.success, "set_controller_twist failed: " + ans.errorMessage
+
+
+def wait_until(cond, timeout):
+    t0 = time.time()
+    while time.time() - t0 < timeout:
+        if cond():
+            return True
+        time.sleep(0.25)
+    return False
+
+
+if __name__ == "__main__":
+
+    server = subprocess.Popen([MVSIM_CLI_EXE_PATH, "server"])
+    tiles = []
+    for tile in range(2):
+        env = dict(os.environ, MVSIM_TILE=str(tile))
+        tiles.append(subprocess.Popen([MVSIM_CLI_EXE_PATH, "launch",
+                                       TESTS_DIR + "/test-partition.world.xml",
+                                       "--headless", "--no-server"], env=env))
+
+    try:
+        client = pymvsim_comms.mvsim.Client()
+        print("Connecting to server...", flush=True)
+        client.connect()
+        print("Connected successfully.", flush=True)
+
+        # Wait for both tiles to finish their startup handshake:
+        def services_up():
+            try:
+                get_pose(client, "tile0/get_pose", "r1")
+                get_pose(client, "tile1/get_pose", "r1")
+                return True
+            except Exception:
+                return False
+        assert wait_until(services_up, 60.0), "Tiles did not start up"
+
+        # r2 is out of all tiles, hence simulated by the nearest one (tile1),
+        # which must report it where it was initially placed:
+        p2 = get_pose(client, "tile1/get_pose", "r2")
+        assert abs(p2.x - 25.0) < 0.5 and abs(p2.y - 5.0) < 0.5, str(p2)
+
+        # Command r1 through the global service, served by tile0, which
+        # simulates it now:
+        set_twist(client, "set_controller_twist", "r1", 0.5)
+
+        # r1 must cross into tile1 (x>=0), then keep moving there with
+        # the handed-off setpoint:
+        assert wait_until(
+            lambda: get_pose(client, "tile1/get_pose", "r1").x > 1.0, 60.0), \
+            "r1 did not cross the tile border"
+
+        # Stop it through tile0, which must forward it to tile1:
+        set_twist(client, "tile0/set_controller_twist", "r1", 0.0)
+        time.sleep(2.0)
+        x1 = get_pose(client, "tile1/get_pose", "r1").x
+        time.sleep(2.0)
+        x2 = get_pose(client, "tile1/get_pose", "r1").x
+        assert abs(x2 - x1) < 0.05, "r1 did not stop: x1=%f x2=%f" % (x1, x2)
+
+        # Both tiles must agree on its pose:
+        x0 = get_pose(client, "tile0/get_pose", "r1").x
+        assert abs(x0 - x2) < 0.05, "Tiles disagree: %f vs %f" % (x0, x2)
+
+        # Shutting down one tile must close both:
+        req = SrvShutdown_pb2.SrvShutdown()
+        client.callService("tile1/shutdown", req.SerializeToString())
+        for p in tiles:
+            assert p.wait(timeout=30) == 0
+    finally:
+        for p in tiles + [server]:
+            if p.poll() is None:
+                p.kill()
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# In-process simulator bindings test: loads a world, steps it, reads
+# lidar observations, resets it, and checks that closing one World does
+# not break another one that is still running (they share cached 3D
+# models and OpenGL resources).
+#
+# Test with a local build with:
+# export PYTHONPATH=$HOME/code/mvsim/build/:$PYTHONPATH
+# ---------------------------------------------------------------------
+
+from mvsim_simulator import pymvsim_simulator
+
+import math
+import os
+
+import numpy as np
+
+TESTS_DIR = os.environ['TESTS_DIR']
+WORLD_FILE = TESTS_DIR + "/test-python-bindings.world.xml"
+NRAYS = 181
+MAX_RANGE = 20.0
+
+
+def assert_raises(fn):
+    try:
+        fn()
+    except Exception:
+        return
+    raise AssertionError("Expected an exception")
+
+
+def load_world():
+    w = pymvsim_simulator.World()
+    w.load(WORLD_FILE, headless=True)
+    assert w.vehicles() == ["r1"], w.vehicles()
+    return w
+
+
+def check_scan(w):
+    ranges = w.lidar_ranges("r1", "laser1")
+    assert ranges is not None, "No lidar scan yet"
+    assert ranges.shape == (NRAYS,), ranges.shape
+    assert ranges.dtype == np.float32
+    assert not ranges.flags.writeable
+    assert np.all(np.isfinite(ranges))
+    assert np.all(ranges > 0) and np.all(ranges <= MAX_RANGE)
+    # The walls around the robot must be seen:
+    assert np.any(ranges < MAX_RANGE), ranges
+    return ranges
+
+
+def test_step_and_observations():
+    w = load_world()
+    try:
+        assert w.lidar_ranges("r1", "laser1") is None
+        assert w.observation_time("r1", "laser1") is None
+
+        t0 = w.time
+        t = w.step(50)
+        assert abs(t - (t0 + 0.5)) < 1e-6, (t0, t)
+        assert ("r1", "laser1") in w.observations()
+        assert w.observation_time("r1", "laser1") is not None
+        check_scan(w)
+
+        x0, y0, _, yaw0, _, _ = w.get_pose("r1")
+        assert abs(x0 - 5) < 0.05 and abs(y0 - 10) < 0.05, (x0, y0)
+
+        w.set_twist_command("r1", 0.5, 0, 0)
+        w.step(200)
+        x1, y1, _, yaw1, _, _ = w.get_pose("r1")
+        assert x1 - x0 > 0.3, (x0, x1)
+        assert abs(y1 - y0) < 0.1 and abs(yaw1 - yaw0) < 0.1, (y1, yaw1)
+        vx, _, _ = w.get_twist("r1")
+        assert abs(vx - 0.5) < 0.1, vx
+
+        # reset(): back at the initial pose, at rest, with no observations:
+        w.reset()
+        x, y, _, _, _, _ = w.get_pose("r1")
+        assert abs(x - 5) < 1e-6 and abs(y - 10) < 1e-6, (x, y)
+        assert w.get_twist("r1") == (0, 0, 0)
+        assert w.lidar_ranges("r1", "laser1") is None
+        w.step(50)
+        check_scan(w)
+
+        w.set_pose("r1", [6, 10, math.pi / 2])
+        x, y, _, yaw, _, _ = w.get_pose("r1")
+        assert abs(x - 6) < 1e-6 and abs(yaw - math.pi / 2) < 1e-6, (x, yaw)
+
+        assert_raises(lambda: w.get_pose("no_such_robot"))
+    finally:
+        w.close()
+
+
+def test_close_while_another_runs():
+    a = load_world()
+    b = load_world()
+    try:
+        a.step(50)
+        b.step(50)
+        ranges_a = check_scan(a)
+        ranges_b = check_scan(b)
+        assert np.array_equal(ranges_a, ranges_b)
+        copy_a = ranges_a.copy()
+
+        # Arrays taken before closing must outlive their World:
+        a.close()
+        assert np.array_equal(ranges_a, copy_a)
+        assert_raises(lambda: a.step())
+
+        # The other World, sharing the same cached models, must go on:
+        b.set_twist_command("r1", 0.5, 0, 0)
+        b.step(200)
+        check_scan(b)
+        assert b.get_pose("r1")[0] > 5.3
+
+        # And a World loaded afterwards, too:
+        c = load_world()
+        c.step(50)
+        check_scan(c)
+        c.close()
+        b.step(50)
+        check_scan(b)
+    finally:
+        a.close()
+        b.close()
+
+
+if __name__ == "__main__":
+    for test in [test_step_and_observations, test_close_while_another_runs]:
+        print("Running " + test.__name__ + "...", flush=True)
+        test()
+        print(test.__name__ + ": OK", flush=True)
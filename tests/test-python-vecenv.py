@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+
+# ---------------------------------------------------------------------
+# Vectorized environment test: checks the shapes and contents of the
+# batched observations of reset() and step(), partial resets, and that
+# closing one VecEnv does not break another one that is still running.
+#
+# Test with a local build with:
+# export PYTHONPATH=$HOME/code/mvsim/build/:$PYTHONPATH
+# ---------------------------------------------------------------------
+
+from mvsim_simulator import pymvsim_simulator
+from mvsim_simulator.gym import VecEnv
+
+import os
+
+import numpy as np
+
+TESTS_DIR = os.environ['TESTS_DIR']
+WORLD_FILE = TESTS_DIR + "/test-python-bindings.world.xml"
+NUM_ENVS = 3
+NRAYS = 181
+MAX_RANGE = 20.0
+
+
+def assert_raises(fn):
+    try:
+        fn()
+    except Exception:
+        return
+    raise AssertionError("Expected an exception")
+
+
+def check_obs(obs, n=NUM_ENVS):
+    assert set(obs.keys()) == {"ranges", "ranges_valid", "poses", "twists", "collisions"}
+    assert obs["ranges"].shape == (n, NRAYS) and obs["ranges"].dtype == np.float32
+    assert obs["ranges_valid"].shape == (n,) and obs["ranges_valid"].dtype == bool
+    assert obs["poses"].shape == (n, 3) and obs["poses"].dtype == np.float64
+    assert obs["twists"].shape == (n, 3) and obs["twists"].dtype == np.float64
+    assert obs["collisions"].shape == (n,) and obs["collisions"].dtype == bool
+
+    # The lidar period (0.25 s) is longer than one action (0.01 s), but reset()
+    # waits for the first scan, so scans must always be there and be real:
+    assert obs["ranges_valid"].all()
+    r = obs["ranges"]
+    assert np.all(np.isfinite(r)) and np.all(r > 0) and np.all(r <= MAX_RANGE)
+    assert np.all(np.any(r < MAX_RANGE, axis=1)), "The walls must be seen"
+
+
+def test_reset_and_step():
+    env = pymvsim_simulator.VecEnv(WORLD_FILE, NUM_ENVS, "r1", "laser1", 1, 2)
+    try:
+        assert env.num_envs == NUM_ENVS
+        assert env.lidar_size == NRAYS
+        assert abs(env.lidar_max_range - MAX_RANGE) < 1e-6
+
+        obs = env.reset()
+        check_obs(obs)
+        assert np.allclose(obs["poses"][:, :2], [5, 10], atol=0.05), obs["poses"]
+
+        # Different actions per env: forward, backward, and standing still:
+        actions = np.array([[0.5, 0, 0], [-0.5, 0, 0], [0, 0, 0]])
+        for _ in range(150):
+            obs = env.step(actions)
+        check_obs(obs)
+        x = obs["poses"][:, 0]
+        assert x[0] > 5.3 and x[1] < 4.7 and abs(x[2] - 5) < 0.05, x
+        assert obs["twists"][0, 0] > 0.3 and obs["twists"][1, 0] < -0.3, obs["twists"]
+        assert env.env_steps == 150 * NUM_ENVS
+        assert env.env_steps_per_second > 0
+
+        # Partial reset: only env #0 goes back to its initial pose:
+        obs = env.reset([0])
+        check_obs(obs)
+        x = obs["poses"][:, 0]
+        assert abs(x[0] - 5) < 0.05 and x[1] < 4.7, x
+
+        # Wrong action shapes and env indices:
+        assert_raises(lambda: env.step(np.zeros((NUM_ENVS + 1, 3))))
+        assert_raises(lambda: env.step(np.zeros((NUM_ENVS, 2))))
+        assert_raises(lambda: env.reset([NUM_ENVS]))
+    finally:
+        env.close()
+
+
+def test_gym_wrapper():
+    env = VecEnv(WORLD_FILE, NUM_ENVS, "r1", "laser1", max_episode_steps=5)
+    try:
+        check_obs(env.reset())
+        for i in range(5):
+            obs, rewards, dones, infos = env.step(np.zeros((NUM_ENVS, 3)))
+            assert rewards.shape == (NUM_ENVS,)
+            assert dones.shape == (NUM_ENVS,) and len(infos) == NUM_ENVS
+        # All episodes hit max_episode_steps, and were restarted:
+        assert dones.all()
+        check_obs(obs)
+        for info in infos:
+            assert info["TimeLimit.truncated"]
+            assert info["terminal_observation"]["ranges"].shape == (NRAYS,)
+    finally:
+        env.close()
+
+
+def test_close_while_another_runs():
+    a = pymvsim_simulator.VecEnv(WORLD_FILE, 2, "r1", "laser1")
+    b = pymvsim_simulator.VecEnv(WORLD_FILE, 2, "r1", "laser1")
+    try:
+        a.reset()
+        b.reset()
+        actions = np.array([[0.5, 0, 0], [0.5, 0, 0]])
+        for _ in range(10):
+            a.step(actions)
+            b.step(actions)
+
+        a.close()
+
+        for _ in range(100):
+            obs = b.step(actions)
+        check_obs(obs, 2)
+        assert np.all(obs["poses"][:, 0] > 5.3), obs["poses"]
+        check_obs(b.reset(), 2)
+    finally:
+        a.close()
+        b.close()
+
+
+if __name__ == "__main__":
+    for test in [test_reset_and_step, test_gym_wrapper, test_close_while_another_runs]:
+        print("Running " + test.__name__ + "...", flush=True)
+        test()
+        print(test.__name__ + ": OK", flush=True)
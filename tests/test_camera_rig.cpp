@@ -0,0 +1,245 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/obs/CObservationImage.h>
+#include <mvsim/World.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+bool throws(const std::function<void()>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+// A vehicle with the bundled stereo camera definition, and another rig with
+// two cameras of different sizes, one of them unnamed:
+const char* WORLD_XML = R"XML(<mvsim_world version="1.0">
+	<simul_timestep>0.01</simul_timestep>
+
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<chassis mass="15.0" zmin="0.05" zmax="0.4" />
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="r1" class="robot">
+		<init_pose>0 0 0</init_pose>
+
+		<include file="%s/../definitions/stereo_camera.sensor.xml"
+			sensor_name="stereo" sensor_x="0.3" sensor_z="0.5" sensor_period_sec="0.1"
+			cpu_rasterizer="true" baseline="0.2"
+			ncols="160" nrows="120" cx="80" cy="60" fx="100" fy="100"
+		/>
+
+		<sensor class="camera_rig" name="rig">
+			<pose_3d>0.3 0 0.5 0 0 0</pose_3d>
+			<sensor_period>0.1</sensor_period>
+			<cpu_rasterizer>true</cpu_rasterizer>
+			<camera name="front">
+				<ncols>64</ncols> <nrows>48</nrows>
+				<cx>32</cx> <cy>24</cy> <fx>50</fx> <fy>50</fy>
+			</camera>
+			<camera>
+				<ncols>32</ncols> <nrows>24</nrows>
+				<cx>16</cx> <cy>12</cy> <fx>25</fx> <fy>25</fy>
+			</camera>
+		</sensor>
+	</vehicle>
+
+	<block name="box">
+		<shape>
+			<pt>-0.5 -0.5</pt> <pt>-0.5 0.5</pt> <pt>0.5 0.5</pt> <pt>0.5 -0.5</pt>
+		</shape>
+		<mass>30</mass>
+		<zmin>0.0</zmin> <zmax>1.5</zmax>
+		<init_pose>2.5 0 0</init_pose>
+	</block>
+</mvsim_world>
+)XML";
+
+void test_camera_rig_observations()
+{
+	World world;
+	world.setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world.headless(true);
+	world.load_from_XML(mrpt::format(WORLD_XML, MVSIM_TEST_DIR));
+
+	std::mutex obsMtx;
+	std::vector<mrpt::obs::CObservationImage::Ptr> observations;
+	world.registerCallbackOnObservation(
+		[&](const Simulable&, const mrpt::obs::CObservation::Ptr& o)
+		{
+			auto obs = std::dynamic_pointer_cast<mrpt::obs::CObservationImage>(o);
+			if (!obs) return;
+			std::lock_guard<std::mutex> lck(obsMtx);
+			observations.push_back(obs);
+		});
+
+	// Camera-like sensors run on the GUI thread, or on this one when headless:
+	std::atomic_bool done = false;
+	std::thread gfxThread(
+		[&]()
+		{
+			while (!done)
+			{
+				world.internalGraphicsLoopTasksForSimulation();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+
+	// Leave time to render each shot before the next one is requested:
+	for (int i = 0; i < 35; i++)
+	{
+		world.run_simulation(0.01);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	done = true;
+	gfxThread.join();
+
+	std::lock_guard<std::mutex> lck(obsMtx);
+
+	// One image per camera and period, published with the camera name:
+	std::map<std::string, std::vector<mrpt::obs::CObservationImage::Ptr>> perLabel;
+	for (const auto& o : observations) perLabel[o->sensorLabel].push_back(o);
+
+	ASSERT_EQUAL_(perLabel.size(), 4U);
+	for (const char* label : {"stereo_left", "stereo_right", "front", "rig_cam1"})
+		ASSERT_(perLabel.count(label) != 0);
+
+	// Views of the same rig, with the same number of images and timestamps:
+	const auto checkRig = [&](const std::string& first, const std::string& second)
+	{
+		const auto& a = perLabel.at(first);
+		const auto& b = perLabel.at(second);
+		ASSERT_(a.size() >= 2 && a.size() <= 4);
+		ASSERT_EQUAL_(a.size(), b.size());
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			ASSERT_(a[i]->timestamp == b[i]->timestamp);
+			if (i > 0) ASSERT_(a[i]->timestamp != a[i - 1]->timestamp);
+		}
+	};
+	checkRig("stereo_left", "stereo_right");
+	checkRig("front", "rig_cam1");
+
+	// Image sizes and camera models of each view:
+	const auto checkSize = [&](const std::string& label, unsigned w, unsigned h)
+	{
+		for (const auto& o : perLabel.at(label))
+		{
+			ASSERT_EQUAL_(o->image.getWidth(), w);
+			ASSERT_EQUAL_(o->image.getHeight(), h);
+			ASSERT_EQUAL_(o->cameraParams.ncols, w);
+			ASSERT_EQUAL_(o->cameraParams.nrows, h);
+		}
+	};
+	checkSize("stereo_left", 160, 120);
+	checkSize("stereo_right", 160, 120);
+	checkSize("front", 64, 48);
+	checkSize("rig_cam1", 32, 24);
+
+	// Camera poses on the vehicle: rig pose + camera pose on the rig:
+	const auto& left = *perLabel.at("stereo_left").back();
+	const auto& right = *perLabel.at("stereo_right").back();
+	ASSERT_NEAR_(left.cameraPose.x(), 0.3, 1e-6);
+	ASSERT_NEAR_(left.cameraPose.y(), 0.1, 1e-6);
+	ASSERT_NEAR_(right.cameraPose.y(), -0.1, 1e-6);
+	ASSERT_NEAR_(left.cameraPose.z(), 0.5, 1e-6);
+
+	// The box in front is seen from two different viewpoints:
+	bool anyDiff = false;
+	for (unsigned r = 0; r < 120 && !anyDiff; r++)
+		for (unsigned c = 0; c < 160 && !anyDiff; c++)
+			anyDiff = *left.image(c, r) != *right.image(c, r);
+	ASSERT_(anyDiff);
+}
+
+void test_camera_rig_without_cameras()
+{
+	World world;
+	world.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+	world.headless(true);
+
+	const std::string xml = R"XML(<mvsim_world version="1.0">
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="r1" class="robot">
+		<sensor class="camera_rig" name="rig" />
+	</vehicle>
+</mvsim_world>
+)XML";
+	ASSERT_(throws([&]() { world.load_from_XML(xml); }));
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_camera_rig_observations, "test_camera_rig_observations"},
+		{&test_camera_rig_without_cameras, "test_camera_rig_without_cameras"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/opengl/CBox.h>
+#include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/opengl/CSphere.h>
+#include <mvsim/CpuRasterizer.h>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+using mrpt::math::TPoint3D;
+
+namespace
+{
+// A 64x48 camera, with pixel centers at integer coordinates, and the optical
+// center in between pixels so no triangle edge in the tests hits a pixel:
+mrpt::img::TCamera testCamera()
+{
+	mrpt::img::TCamera cam;
+	cam.ncols = 64;
+	cam.nrows = 48;
+	cam.fx(50);
+	cam.fy(50);
+	cam.cx(31.5);
+	cam.cy(23.5);
+	return cam;
+}
+
+// Camera frame: +Z forward, +X right, +Y down.
+const auto cameraPose = mrpt::poses::CPose3D::Identity();
+
+void assertNear(float a, float b, float tol, const std::string& what)
+{
+	if (std::abs(a - b) > tol) THROW_EXCEPTION_FMT("%s: got %f, expected %f", what.c_str(), a, b);
+}
+
+void test_box_depth()
+{
+	// The box front face, at z=5, projects onto x=[21.5,41.5], y=[13.5,33.5]
+	mrpt::opengl::COpenGLScene scene;
+	scene.insert(mrpt::opengl::CBox::Create(TPoint3D(-1, -1, 5), TPoint3D(1, 1, 7)));
+
+	CpuRasterizer r(1);
+	r.updateScene(scene);
+	ASSERT_EQUAL_(r.triangleCount(), 12U);
+
+	mrpt::math::CMatrixFloat depth;
+	r.render_depth(cameraPose, testCamera(), 0.1f, 100.0f, depth);
+	ASSERT_EQUAL_(depth.rows(), 48);
+	ASSERT_EQUAL_(depth.cols(), 64);
+
+	size_t nCovered = 0;
+	for (int row = 0; row < depth.rows(); row++)
+	{
+		for (int col = 0; col < depth.cols(); col++)
+		{
+			const bool inside = col >= 22 && col <= 41 && row >= 14 && row <= 33;
+			const float d = depth(row, col);
+			if (inside)
+			{
+				assertNear(d, 5.0f, 1e-4f, mrpt::format("depth(%i,%i)", row, col));
+				nCovered++;
+			}
+			else
+			{
+				assertNear(d, 0.0f, 0.0f, mrpt::format("depth(%i,%i)", row, col));
+			}
+		}
+	}
+	ASSERT_EQUAL_(nCovered, 20U * 20U);
+
+	// Out of the far plane, nothing is seen:
+	r.render_depth(cameraPose, testCamera(), 0.1f, 4.0f, depth);
+	ASSERT_EQUAL_(depth.sum(), 0.0f);
+
+	// Moving the camera back 5 m, the box is half as large and twice as far:
+	r.render_depth(
+		mrpt::poses::CPose3D::FromTranslation(0, 0, -5), testCamera(), 0.1f, 100.0f, depth);
+	assertNear(depth(23, 31), 10.0f, 1e-3f, "center");
+	assertNear(depth(23, 36), 10.0f, 1e-3f, "inside");
+	assertNear(depth(23, 37), 0.0f, 0.0f, "outside");
+}
+
+void test_thread_determinism()
+{
+	// Overlapping objects, including coplanar faces of different colors, so
+	// the result depends on the order in which triangles are drawn:
+	mrpt::opengl::COpenGLScene scene;
+	auto b1 = mrpt::opengl::CBox::Create(TPoint3D(-2, -1, 5), TPoint3D(0.5, 1, 6));
+	b1->setColor_u8(0xff, 0x00, 0x00);
+	auto b2 = mrpt::opengl::CBox::Create(TPoint3D(-0.5, -1.5, 5), TPoint3D(2, 0.5, 6));
+	b2->setColor_u8(0x00, 0xff, 0x00);
+	auto group = mrpt::opengl::CSetOfObjects::Create();
+	group->setPose(mrpt::poses::CPose3D(0, 0, 8, 0.3, 0.2, 0.1));
+	for (int i = 0; i < 10; i++)
+	{
+		auto s = mrpt::opengl::CSphere::Create(0.5f + 0.1f * i);
+		s->setLocation(-3.0 + 0.6 * i, 0.3 * (i % 3), 0.2 * i);
+		s->setColor_u8(0x10 * i, 0x80, 0xff - 0x10 * i);
+		group->insert(s);
+	}
+	scene.insert(b1);
+	scene.insert(b2);
+	scene.insert(group);
+
+	const auto cam = testCamera();
+	const auto camPose = mrpt::poses::CPose3D(0.2, -0.1, 0.3, 0.05, -0.03, 0.02);
+
+	mrpt::math::CMatrixFloat refDepth;
+	mrpt::img::CImage refRGB;
+	{
+		CpuRasterizer r(1);
+		r.updateScene(scene);
+		r.render_depth(camPose, cam, 0.1f, 100.0f, refDepth);
+		r.render_RGB(camPose, cam, 0.1f, 100.0f, refRGB);
+	}
+	ASSERT_GT_(refDepth.sum(), 0.0f);
+
+	for (unsigned int nThreads : {2U, 3U, 4U, 8U})
+	{
+		CpuRasterizer r(nThreads);
+		// Twice, to also check the reuse of internal buffers:
+		for (int rep = 0; rep < 2; rep++)
+		{
+			mrpt::math::CMatrixFloat depth;
+			mrpt::img::CImage rgb;
+			r.updateScene(scene);
+			r.render_depth(camPose, cam, 0.1f, 100.0f, depth);
+			r.render_RGB(camPose, cam, 0.1f, 100.0f, rgb);
+
+			// Bit-identical:
+			ASSERT_(
+				std::memcmp(depth.data(), refDepth.data(), sizeof(float) * depth.size()) == 0);
+			for (unsigned int row = 0; row < cam.nrows; row++)
+			{
+				ASSERT_(
+					std::memcmp(
+						rgb.ptrLine<uint8_t>(row), refRGB.ptrLine<uint8_t>(row), 3 * cam.ncols) ==
+					0);
+			}
+		}
+	}
+}
+
+void test_near_plane_clipping()
+{
+	// A long floor below the camera (y=1, +Y being down), from behind the
+	// camera to far ahead, so most of its triangles cross the near plane:
+	mrpt::opengl::COpenGLScene scene;
+	scene.insert(mrpt::opengl::CBox::Create(TPoint3D(-200, 1, -10), TPoint3D(200, 1.1, 300)));
+
+	CpuRasterizer r(2);
+	r.updateScene(scene);
+
+	const auto cam = testCamera();
+	const float clipMin = 3.0f;
+	mrpt::math::CMatrixFloat depth;
+	r.render_depth(cameraPose, cam, clipMin, 1000.0f, depth);
+
+	for (int row = 0; row < depth.rows(); row++)
+	{
+		// Distance along +Z from the camera to the floor, for this row:
+		const float dy = static_cast<float>(row - cam.cy());
+		const float expected = dy > 0 ? static_cast<float>(cam.fy()) / dy : 0;
+
+		for (int col = 0; col < depth.cols(); col++)
+		{
+			const float d = depth(row, col);
+			const auto what = mrpt::format("depth(%i,%i)", row, col);
+			if (expected >= clipMin)
+				assertNear(d, expected, 1e-3f * expected, what);
+			else
+				assertNear(d, 0.0f, 0.0f, what);  // above horizon, or clipped
+		}
+	}
+
+	// Rows below 23.5+50/3=40.2 see the floor closer than the near plane:
+	ASSERT_EQUAL_(depth(40, 31) > 0, true);
+	ASSERT_EQUAL_(depth(41, 31), 0.0f);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_box_depth, "test_box_depth"},
+		{&test_thread_determinism, "test_thread_determinism"},
+		{&test_near_plane_clipping, "test_near_plane_clipping"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/math/CMatrixDynamic.h>
+#include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mvsim/Sensors/DepthCameraSensor.h>
+#include <mvsim/World.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <rapidxml.hpp>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const char* WORLD_XML = R"XML(<mvsim_world version="1.0">
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<chassis mass="15.0" zmin="0.05" zmax="0.4" />
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="r1" class="robot" />
+</mvsim_world>
+)XML";
+
+// A small camera with non-square pixels and a non-centered principal point:
+constexpr unsigned int NCOLS = 8, NROWS = 6;
+constexpr double CX = 3.7, CY = 2.6, FX = 5.0, FY = 4.0;
+constexpr float MAX_RANGE = 5.0f, UNITS = 1e-3f;
+
+// Gives access to the depth image conversion of DepthCameraSensor:
+class DepthCameraProbe : public DepthCameraSensor
+{
+   public:
+	using DepthCameraSensor::DepthCameraSensor;
+
+	// Converts a depth image as the sensor does with the rendered ones:
+	mrpt::obs::CObservation3DRangeScan convert(const mrpt::math::CMatrixFloat& depth)
+	{
+		depthImage_ = depth;
+		auto obs = sensor_params_;
+		internal_convert_depth_image(obs);
+		return obs;
+	}
+};
+
+std::shared_ptr<DepthCameraProbe> makeCamera(World& world, bool emitPoints, double noiseSigma)
+{
+	const std::string xml = mrpt::format(
+		"<sensor class=\"rgbd_camera\" name=\"cam\">"
+		"<depth_ncols>%u</depth_ncols><depth_nrows>%u</depth_nrows>"
+		"<depth_cx>%f</depth_cx><depth_cy>%f</depth_cy>"
+		"<depth_fx>%f</depth_fx><depth_fy>%f</depth_fy>"
+		"<depth_clip_max>%f</depth_clip_max><depth_resolution>%f</depth_resolution>"
+		"<depth_noise_sigma>%f</depth_noise_sigma>"
+		"<emit_points>%s</emit_points>"
+		"</sensor>",
+		NCOLS, NROWS, CX, CY, FX, FY, MAX_RANGE, UNITS, noiseSigma,
+		emitPoints ? "true" : "false");
+
+	std::vector<char> buf(xml.begin(), xml.end());
+	buf.push_back('\0');
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(buf.data());
+
+	auto& veh = *world.getListOfVehicles().at("r1");
+	return std::make_shared<DepthCameraProbe>(veh, doc.first_node());
+}
+
+// Synthetic depth image: a slanted plane, with some invalid (0) pixels and
+// some beyond the maximum range.
+mrpt::math::CMatrixFloat syntheticDepth()
+{
+	mrpt::math::CMatrixFloat d(NROWS, NCOLS);
+	for (unsigned int r = 0; r < NROWS; r++)
+		for (unsigned int c = 0; c < NCOLS; c++) d(r, c) = 1.0f + 0.25f * c + 0.1f * r;
+	d(0, 0) = 0;
+	d(2, 5) = 0;
+	d(5, 7) = 0;
+	d(4, 1) = 7.5f;
+	d(1, 6) = MAX_RANGE + 1e-4f;
+	return d;
+}
+
+std::unique_ptr<World> loadWorld()
+{
+	auto world = std::make_unique<World>();
+	world->setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world->headless(true);
+	world->load_from_XML(WORLD_XML);
+	return world;
+}
+
+void test_depth_camera_points_vs_pinhole()
+{
+	auto world = loadWorld();
+	auto cam = makeCamera(*world, true /*points*/, 0 /*noise*/);
+
+	const auto depth = syntheticDepth();
+	const auto obs = cam->convert(depth);
+
+	ASSERT_EQUAL_(static_cast<size_t>(obs.rangeImage.rows()), NROWS);
+	ASSERT_EQUAL_(static_cast<size_t>(obs.rangeImage.cols()), NCOLS);
+	ASSERT_(obs.hasPoints3D);
+
+	size_t nValid = 0;
+	for (unsigned int r = 0; r < NROWS; r++)
+	{
+		for (unsigned int c = 0; c < NCOLS; c++)
+		{
+			// Range image: depth clamped to the max. range, in range units:
+			const float d = std::min(depth(r, c), MAX_RANGE);
+			ASSERT_NEAR_(obs.rangeImage(r, c) * UNITS, d, 2 * UNITS);
+			if (d == 0) continue;
+
+			// 3D point: pinhole unprojection of the pixel, +X forward:
+			const size_t i = nValid++;
+			ASSERT_LT_(i, obs.points3D_x.size());
+			ASSERT_EQUAL_(obs.points3D_idxs_x[i], c);
+			ASSERT_EQUAL_(obs.points3D_idxs_y[i], r);
+
+			const double x = d, y = d * (CX - c) / FX, z = d * (CY - r) / FY;
+			const double tol = 2 * UNITS * (1 + (std::abs(y) + std::abs(z)) / d);
+			ASSERT_NEAR_(obs.points3D_x[i], x, tol);
+			ASSERT_NEAR_(obs.points3D_y[i], y, tol);
+			ASSERT_NEAR_(obs.points3D_z[i], z, tol);
+		}
+	}
+	ASSERT_EQUAL_(nValid, NROWS * NCOLS - 3);
+	ASSERT_EQUAL_(obs.points3D_x.size(), nValid);
+	ASSERT_EQUAL_(obs.points3D_y.size(), nValid);
+	ASSERT_EQUAL_(obs.points3D_z.size(), nValid);
+	ASSERT_EQUAL_(obs.points3D_idxs_x.size(), nValid);
+
+	// Converting again gives the same result (recycled buffers and LUT):
+	const auto obs2 = cam->convert(depth);
+	ASSERT_(obs2.points3D_x == obs.points3D_x);
+	ASSERT_(obs2.points3D_y == obs.points3D_y);
+	ASSERT_(obs2.points3D_z == obs.points3D_z);
+
+	// Without points, only the range image is filled in:
+	auto camNoPts = makeCamera(*world, false /*points*/, 0 /*noise*/);
+	const auto obs3 = camNoPts->convert(depth);
+	ASSERT_(!obs3.hasPoints3D);
+	for (unsigned int r = 0; r < NROWS; r++)
+		for (unsigned int c = 0; c < NCOLS; c++)
+			ASSERT_EQUAL_(obs3.rangeImage(r, c), obs.rangeImage(r, c));
+}
+
+void test_depth_camera_points_noise()
+{
+	auto world = loadWorld();
+	const double sigma = 0.05;
+	auto cam = makeCamera(*world, true /*points*/, sigma);
+
+	const auto depth = syntheticDepth();
+	double sumErr = 0, sumErr2 = 0;
+	size_t n = 0;
+	for (int iter = 0; iter < 20; iter++)
+	{
+		const auto obs = cam->convert(depth);
+		size_t i = 0;
+		for (unsigned int r = 0; r < NROWS; r++)
+		{
+			for (unsigned int c = 0; c < NCOLS; c++)
+			{
+				const float d = std::min(depth(r, c), MAX_RANGE);
+				const float noisy = obs.rangeImage(r, c) * UNITS;
+				// Invalid pixels stay invalid, and noise never goes beyond range:
+				if (d == 0)
+				{
+					ASSERT_EQUAL_(obs.rangeImage(r, c), 0);
+					continue;
+				}
+				ASSERT_(noisy > 0 && noisy <= MAX_RANGE);
+
+				// Points are unprojected from the noisy depth:
+				ASSERT_NEAR_(obs.points3D_x[i], noisy, 1e-6f);
+				ASSERT_NEAR_(obs.points3D_y[i], noisy * (CX - c) / FX, 1e-5f);
+				ASSERT_NEAR_(obs.points3D_z[i], noisy * (CY - r) / FY, 1e-5f);
+				i++;
+
+				if (d < MAX_RANGE - 4 * sigma)
+				{
+					sumErr += noisy - d;
+					sumErr2 += (noisy - d) * (noisy - d);
+					n++;
+				}
+			}
+		}
+		ASSERT_EQUAL_(i, obs.points3D_x.size());
+	}
+
+	const double mean = sumErr / n, stdDev = std::sqrt(sumErr2 / n - mean * mean);
+	ASSERT_LT_(std::abs(mean), 0.01);
+	ASSERT_NEAR_(stdDev, sigma, 0.01);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_depth_camera_points_vs_pinhole, "test_depth_camera_points_vs_pinhole"},
+		{&test_depth_camera_points_noise, "test_depth_camera_points_noise"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
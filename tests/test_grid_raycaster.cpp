@@ -0,0 +1,398 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+#include <mvsim/GridRaycaster.h>
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+bool throws(const std::function<void(void)>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+// An office-like map: outer walls, a few inner walls, and scattered
+// obstacles, with some unknown areas.
+mrpt::maps::COccupancyGridMap2D makeTestGrid()
+{
+	mrpt::maps::COccupancyGridMap2D grid(-25.0f, 25.0f, -25.0f, 25.0f, 0.05f);
+	grid.fill(0.9f);  // free
+
+	const int nx = static_cast<int>(grid.getSizeX()), ny = static_cast<int>(grid.getSizeY());
+	for (int i = 0; i < nx; i++)
+	{
+		grid.setCell(i, 0, 0.05f);
+		grid.setCell(i, ny - 1, 0.05f);
+	}
+	for (int j = 0; j < ny; j++)
+	{
+		grid.setCell(0, j, 0.05f);
+		grid.setCell(nx - 1, j, 0.05f);
+	}
+	// Inner walls, with doors:
+	for (int k = 1; k < 4; k++)
+	{
+		for (int j = 0; j < ny; j++)
+			if (j % 200 > 30) grid.setCell(k * nx / 4, j, 0.05f);
+		for (int i = 0; i < nx; i++)
+			if (i % 150 > 25) grid.setCell(i, k * ny / 4, 0.05f);
+	}
+	// Clutter and unknown areas:
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(1234);
+	for (int n = 0; n < 2000; n++)
+	{
+		const int i = rng.drawUniform32bit() % nx, j = rng.drawUniform32bit() % ny;
+		grid.setCell(i, j, n % 10 == 0 ? 0.5f : 0.1f);
+	}
+	return grid;
+}
+
+void test_raycaster_vs_mrpt()
+{
+	const auto grid = makeTestGrid();
+
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+
+	mrpt::obs::CObservation2DRangeScan scanModel;
+	scanModel.aperture = 2 * M_PI;
+	scanModel.maxRange = 20.0f;
+
+	const size_t nRays = 720, nScans = 200;
+	auto& rng = mrpt::random::getRandomGenerator();
+
+	std::vector<mrpt::poses::CPose2D> poses;
+	for (size_t i = 0; i < nScans; i++)
+		poses.emplace_back(
+			rng.drawUniform(-24.0, 24.0), rng.drawUniform(-24.0, 24.0),
+			rng.drawUniform(-M_PI, M_PI));
+
+	std::vector<mrpt::obs::CObservation2DRangeScan> scansMrpt(nScans, scanModel);
+	std::vector<mrpt::obs::CObservation2DRangeScan> scansMvsim(nScans, scanModel);
+
+	mrpt::system::CTicTac tic;
+	for (size_t i = 0; i < nScans; i++)
+		grid.laserScanSimulator(scansMrpt[i], poses[i], 0.5f, nRays, 0.0f);
+	const double tMrpt = tic.Tac();
+
+	tic.Tic();
+	for (size_t i = 0; i < nScans; i++) raycaster.simulateScan(scansMvsim[i], poses[i], nRays);
+	const double tMvsim = tic.Tac();
+
+	std::cout << "laserScanSimulator(): " << 1e3 * tMrpt / nScans << " ms/scan\n"
+			  << "GridRaycaster:        " << 1e3 * tMvsim / nScans << " ms/scan\n"
+			  << "Speedup:              " << tMrpt / tMvsim << "x\n";
+	ASSERT_LT_(tMvsim, tMrpt);
+
+	// MRPT starts rays at cell corners and marches in steps of 0.8 cells, so
+	// its ranges may overshoot up to one cell, and it may miss the corners of
+	// isolated cells. See test_raycaster_vs_reference() for the exact check:
+	const float tolerance = 1.5f * grid.getResolution();
+	size_t nAgree = 0;
+	for (size_t i = 0; i < nScans; i++)
+	{
+		for (size_t k = 0; k < nRays; k++)
+		{
+			const auto& a = scansMrpt[i];
+			const auto& b = scansMvsim[i];
+			const bool va = a.getScanRangeValidity(k), vb = b.getScanRangeValidity(k);
+			if (va == vb && (!va || std::abs(a.getScanRange(k) - b.getScanRange(k)) < tolerance))
+				nAgree++;
+		}
+	}
+	const double ratio = double(nAgree) / (nScans * nRays);
+	std::cout << "Rays in agreement:    " << 100 * ratio << "%\n";
+	ASSERT_GT_(ratio, 0.90);
+}
+
+// Brute-force reference: samples the ray every 1/100 of a cell.
+GridRaycaster::Hit referenceRaycast(
+	const mrpt::maps::COccupancyGridMap2D& grid, float x, float y, float dirX, float dirY,
+	float maxRange)
+{
+	const auto freeThreshold = mrpt::maps::COccupancyGridMap2D::p2l(0.5f);
+	const double res = grid.getResolution();
+	const double gx = (x - grid.getXMin()) / res, gy = (y - grid.getYMin()) / res;
+	const double maxT = maxRange / res, step = 0.01;
+
+	for (double t = 0; t < maxT; t += step)
+	{
+		const int cx = static_cast<int>(std::floor(gx + t * dirX));
+		const int cy = static_cast<int>(std::floor(gy + t * dirY));
+		if (cx < 0 || cy < 0 || cx >= static_cast<int>(grid.getSizeX()) ||
+			cy >= static_cast<int>(grid.getSizeY()))
+			break;
+
+		const auto v = grid.getRow(cy)[cx];
+		if (v > freeThreshold) continue;
+		if (std::abs(static_cast<int>(v)) <= 1) break;	// unknown
+		return {static_cast<float>(t * res), true};
+	}
+	return {maxRange, false};
+}
+
+void test_raycaster_vs_reference()
+{
+	const auto grid = makeTestGrid();
+
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(4321);
+
+	const size_t nRays = 5000;
+	const float maxRange = 10.0f;
+	// The reference may overshoot up to its sampling step:
+	const float tolerance = 0.02f * grid.getResolution();
+
+	size_t nAgree = 0;
+	for (size_t i = 0; i < nRays; i++)
+	{
+		const float x = rng.drawUniform(-24.0f, 24.0f), y = rng.drawUniform(-24.0f, 24.0f);
+		const double a = rng.drawUniform(-M_PI, M_PI);
+		const float dx = static_cast<float>(std::cos(a)), dy = static_cast<float>(std::sin(a));
+
+		const auto ref = referenceRaycast(grid, x, y, dx, dy, maxRange);
+		const auto hit = raycaster.raycast(x, y, dx, dy, maxRange);
+		if (ref.valid == hit.valid &&
+			(!ref.valid || std::abs(ref.range - hit.range) < tolerance))
+			nAgree++;
+	}
+	// Only rays grazing a cell corner by less than the reference step may
+	// disagree:
+	const double ratio = double(nAgree) / nRays;
+	std::cout << "Rays in agreement with the reference: " << 100 * ratio << "%\n";
+	ASSERT_GT_(ratio, 0.999);
+}
+
+// Exact cases, in a grid with 1/8 m cells (1 m tiles), so all cell and tile
+// boundaries are exactly representable:
+void test_raycaster_geometry()
+{
+	mrpt::maps::COccupancyGridMap2D grid(-4.0f, 4.0f, -4.0f, 4.0f, 0.125f);
+	ASSERT_EQUAL_(grid.getSizeX(), 64U);
+	grid.fill(0.9f);
+	const int ny = static_cast<int>(grid.getSizeY());
+
+	// Wall at x=[2.0,2.125), all along y:
+	for (int j = 0; j < ny; j++) grid.setCell(grid.x2idx(2.05), j, 0.1f);
+	// Isolated cell at x=[1.875,2.0), y=[0.875,1.0):
+	grid.setCell(grid.x2idx(1.9), grid.y2idx(0.9), 0.1f);
+	// Isolated cell right below the y=0 tile boundary, at x=[1.0,1.125):
+	grid.setCell(grid.x2idx(1.05), grid.y2idx(-0.05), 0.1f);
+	// Wall at y=[3.0,3.125), only left of the x=0 tile boundary:
+	for (int i = 0; i < grid.x2idx(0.0); i++) grid.setCell(i, grid.y2idx(3.05), 0.1f);
+
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+
+	const float s2 = static_cast<float>(M_SQRT1_2);
+
+	// Diagonal, through cell corners, up to the wall at x=2:
+	{
+		const auto hit = raycaster.raycast(0.0f, 0.0f, s2, s2, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, static_cast<float>(2.0 * M_SQRT2), 1e-4f);
+	}
+	// Slope 1/2, entering the isolated cell through its left face at y=0.9375:
+	{
+		const float n = std::sqrt(1.25f);
+		const auto hit = raycaster.raycast(0.0f, 0.0f, 1.0f / n, 0.5f / n, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, 1.875f * n, 1e-4f);
+	}
+	// Along the y=0 tile boundary: the ray belongs to the cells above, so the
+	// cell right below it is not hit, but the wall is:
+	{
+		const auto hit = raycaster.raycast(-3.5f, 0.0f, 1.0f, 0.0f, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, 5.5f, 1e-4f);
+	}
+	// Same, backwards, hitting the right face of the wall:
+	{
+		const auto hit = raycaster.raycast(3.5f, 0.0f, -1.0f, 0.0f, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, 1.375f, 1e-4f);
+	}
+	// Along the x=0 tile boundary: the wall at y=3 ends at x=0, so it is not
+	// hit, and the ray leaves the grid:
+	ASSERT_(!raycaster.raycast(0.0f, -3.5f, 0.0f, 1.0f, 10.0f).valid);
+	// ...but it is hit just left of the boundary:
+	{
+		const auto hit = raycaster.raycast(-0.01f, -3.5f, 0.0f, 1.0f, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, 6.5f, 1e-4f);
+	}
+}
+
+void test_raycaster_unknown_cells()
+{
+	mrpt::maps::COccupancyGridMap2D grid(-4.0f, 4.0f, -4.0f, 4.0f, 0.125f);
+	grid.fill(0.9f);
+	const int ny = static_cast<int>(grid.getSizeY());
+
+	// Unknown cells at x=[1.0,1.125), then a wall at x=[3.0,3.125):
+	for (int j = 0; j < ny; j++)
+	{
+		grid.setCell(grid.x2idx(1.05), j, 0.5f);
+		grid.setCell(grid.x2idx(3.05), j, 0.1f);
+	}
+
+	// By default, unknown cells stop rays, with an invalid range:
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+	{
+		const auto hit = raycaster.raycast(0.0f, 0.0f, 1.0f, 0.0f, 10.0f);
+		ASSERT_(!hit.valid);
+		ASSERT_EQUAL_(hit.range, 10.0f);
+	}
+	// Same than MRPT:
+	{
+		mrpt::obs::CObservation2DRangeScan scan;
+		scan.aperture = 0.1;
+		scan.maxRange = 10.0f;
+		grid.laserScanSimulator(scan, mrpt::poses::CPose2D(0, 0, 0), 0.5f, 3, 0.0f);
+		ASSERT_(!scan.getScanRangeValidity(1));
+		raycaster.simulateScan(scan, mrpt::poses::CPose2D(0, 0, 0), 3);
+		ASSERT_(!scan.getScanRangeValidity(1));
+	}
+
+	// With a higher threshold, rays go through them:
+	raycaster.build(grid, 0.6f);
+	{
+		const auto hit = raycaster.raycast(0.0f, 0.0f, 1.0f, 0.0f, 10.0f);
+		ASSERT_(hit.valid);
+		ASSERT_NEAR_(hit.range, 3.0f, 1e-4f);
+	}
+}
+
+// Noise must come from the given generator only, so seeding it gives
+// repeatable scans:
+void test_raycaster_noise_seed()
+{
+	const auto grid = makeTestGrid();
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+
+	mrpt::obs::CObservation2DRangeScan scanModel;
+	scanModel.aperture = 2 * M_PI;
+	scanModel.maxRange = 20.0f;
+	const mrpt::poses::CPose2D pose(1.0, 2.0, 0.3);
+	const size_t nRays = 360;
+
+	auto scanWithSeed = [&](uint32_t seed)
+	{
+		mrpt::random::CRandomGenerator rng(seed);
+		auto scan = scanModel;
+		raycaster.simulateScan(scan, pose, nRays, 0.05f, 0.001f, &rng);
+		return scan;
+	};
+
+	const auto a = scanWithSeed(1), b = scanWithSeed(1), c = scanWithSeed(2);
+	bool anyDifferent = false;
+	for (size_t k = 0; k < nRays; k++)
+	{
+		ASSERT_EQUAL_(a.getScanRange(k), b.getScanRange(k));
+		ASSERT_EQUAL_(a.getScanRangeValidity(k), b.getScanRangeValidity(k));
+		if (a.getScanRange(k) != c.getScanRange(k)) anyDifferent = true;
+	}
+	ASSERT_(anyDifferent);
+
+	// Noise without a generator is an error:
+	auto scan = scanModel;
+	ASSERT_(throws([&]() { raycaster.simulateScan(scan, pose, nRays, 0.05f); }));
+}
+
+void test_raycaster_basic()
+{
+	mrpt::maps::COccupancyGridMap2D grid(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f);
+	grid.fill(0.9f);
+	// A wall at x=2.0 (cell boundary):
+	for (int j = 0; j < static_cast<int>(grid.getSizeY()); j++)
+		grid.setCell(grid.x2idx(2.05), j, 0.1f);
+
+	GridRaycaster raycaster;
+	raycaster.build(grid);
+
+	const auto hit = raycaster.raycast(0.0f, 0.0f, 1.0f, 0.0f, 10.0f);
+	ASSERT_(hit.valid);
+	ASSERT_NEAR_(hit.range, 2.0f, 1e-3f);
+
+	// Out of range:
+	ASSERT_(!raycaster.raycast(0.0f, 0.0f, 1.0f, 0.0f, 1.5f).valid);
+	// Leaves the grid:
+	ASSERT_(!raycaster.raycast(0.0f, 0.0f, -1.0f, 0.0f, 10.0f).valid);
+	// Starts outside of the grid:
+	ASSERT_(!raycaster.raycast(-6.0f, 0.0f, 1.0f, 0.0f, 10.0f).valid);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_raycaster_basic, "test_raycaster_basic"},
+		{&test_raycaster_geometry, "test_raycaster_geometry"},
+		{&test_raycaster_unknown_cells, "test_raycaster_unknown_cells"},
+		{&test_raycaster_noise_seed, "test_raycaster_noise_seed"},
+		{&test_raycaster_vs_reference, "test_raycaster_vs_reference"},
+		{&test_raycaster_vs_mrpt, "test_raycaster_vs_mrpt"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/opengl/CAssimpModel.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/opengl/CSetOfTriangles.h>
+#include <mrpt/system/CDirectoryExplorer.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/version.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ModelsCache.h"
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const std::string testDir = mrpt::system::getTempFileName() + "_mvsim_test_models_cache";
+
+void setEnv(const char* name, const std::string& value)
+{
+#ifdef _WIN32
+	_putenv_s(name, value.c_str());
+#else
+	setenv(name, value.c_str(), 1);
+#endif
+}
+
+// A cube of the given side length, centered at the origin:
+std::string writeCube(const std::string& subDir, double side)
+{
+	const auto dir = testDir + "/" + subDir;
+	if (!mrpt::system::directoryExists(dir)) mrpt::system::createDirectory(dir);
+
+	const auto file = dir + "/cube.obj";
+	std::ofstream f(file);
+	const double h = 0.5 * side;
+	for (int i = 0; i < 8; i++)
+		f << "v " << (i & 1 ? h : -h) << " " << (i & 2 ? h : -h) << " " << (i & 4 ? h : -h)
+		  << "\n";
+	f << "f 1 3 4\nf 1 4 2\nf 5 6 8\nf 5 8 7\nf 1 2 6\nf 1 6 5\n"
+		 "f 3 7 8\nf 3 8 4\nf 1 5 7\nf 1 7 3\nf 2 4 8\nf 2 8 6\n";
+	return file;
+}
+
+std::vector<std::string> binaryCacheFiles()
+{
+	const auto dir = testDir + "/cache/models/";
+	std::vector<std::string> files;
+	if (!mrpt::system::directoryExists(dir)) return files;
+
+	for (const auto& fi : mrpt::system::CDirectoryExplorer::explore(dir, FILE_ATTRIB_ARCHIVE))
+		if (mrpt::system::extractFileExtension(fi.name) == "bin") files.push_back(fi.wholePath);
+	return files;
+}
+
+void assertSameBoundingBox(
+	const mrpt::opengl::CRenderizable::Ptr& a, const mrpt::opengl::CRenderizable::Ptr& b)
+{
+	const auto ba = a->getBoundingBox(), bb = b->getBoundingBox();
+	for (int k = 0; k < 3; k++)
+	{
+		ASSERT_NEAR_(ba.min[k], bb.min[k], 1e-4);
+		ASSERT_NEAR_(ba.max[k], bb.max[k], 1e-4);
+	}
+}
+
+void test_models_cache_keys()
+{
+	auto& mc = ModelsCache::Instance();
+	mc.clear();
+
+	const auto file = writeCube("keys", 1.0);
+	const auto otherFile = writeCube("keys_other", 1.0);
+
+	ModelsCache::Options o;
+	const auto m = mc.get(file, o);
+	ASSERT_(m);
+	// Same file and options: the same object.
+	ASSERT_(mc.get(file, o) == m);
+
+	// Any change in the file or options: a different one.
+	ASSERT_(mc.get(otherFile, o) != m);
+
+	auto oColor = o;
+	oColor.modelColor = mrpt::img::TColor(0xff, 0x00, 0x00);
+	const auto mColor = mc.get(file, oColor);
+	ASSERT_(mColor != m);
+
+	auto oAlpha = o;
+	oAlpha.modelColor.A = 0x80;
+	const auto mAlpha = mc.get(file, oAlpha);
+	ASSERT_(mAlpha != m && mAlpha != mColor);
+
+	auto oCull = o;
+	oCull.modelCull = "BACK";
+	const auto mCull = mc.get(file, oCull);
+	ASSERT_(mCull != m && mCull != mColor && mCull != mAlpha);
+
+	auto oSplit = o;
+	oSplit.splitSize = 0.5f;
+	const auto mSplit = mc.get(file, oSplit);
+	ASSERT_(mSplit != m && mSplit != mColor && mSplit != mAlpha && mSplit != mCull);
+
+	// ...and all of them are kept:
+	ASSERT_(mc.get(file, o) == m);
+	ASSERT_(mc.get(file, oColor) == mColor);
+	ASSERT_(mc.get(file, oAlpha) == mAlpha);
+	ASSERT_(mc.get(file, oCull) == mCull);
+	ASSERT_(mc.get(file, oSplit) == mSplit);
+
+	mc.clear();
+	ASSERT_(mc.get(file, o) != m);
+}
+
+void test_models_cache_binary_round_trip()
+{
+#if MRPT_VERSION >= 0x260
+	auto& mc = ModelsCache::Instance();
+	mc.clear();
+	for (const auto& f : binaryCacheFiles()) mrpt::system::deleteFile(f);
+
+	const auto file = writeCube("round_trip", 2.0);
+	ModelsCache::Options o;
+	o.modelCull = "BACK";
+
+	// First load: with Assimp, and it is written to the binary cache.
+	const auto m1 = mc.get(file, o);
+	ASSERT_(std::dynamic_pointer_cast<mrpt::opengl::CAssimpModel>(m1));
+	ASSERT_EQUAL_(binaryCacheFiles().size(), 1U);
+
+	// Next runs: from the binary cache, with the same triangles.
+	mc.clear();
+	const auto m2 = mc.get(file, o);
+	const auto set = std::dynamic_pointer_cast<mrpt::opengl::CSetOfObjects>(m2);
+	ASSERT_(set);
+	size_t nTris = 0;
+	for (const auto& obj : *set)
+	{
+		auto tris = std::dynamic_pointer_cast<mrpt::opengl::CSetOfTriangles>(obj);
+		ASSERT_(tris);
+		ASSERT_(tris->cullFaces() == mrpt::opengl::TCullFace::BACK);
+		nTris += tris->getTrianglesCount();
+	}
+	ASSERT_EQUAL_(nTris, 12U);
+	assertSameBoundingBox(m1, m2);
+
+	// Other options are a different cache entry:
+	mc.clear();
+	auto oColor = o;
+	oColor.modelColor = mrpt::img::TColor(0x00, 0xff, 0x00);
+	ASSERT_(std::dynamic_pointer_cast<mrpt::opengl::CAssimpModel>(mc.get(file, oColor)));
+	ASSERT_EQUAL_(binaryCacheFiles().size(), 2U);
+
+	// A modified model file invalidates its cache file:
+	writeCube("round_trip", 20.0);
+	mc.clear();
+	const auto m3 = mc.get(file, o);
+	ASSERT_(std::dynamic_pointer_cast<mrpt::opengl::CAssimpModel>(m3));
+	ASSERT_NEAR_(m3->getBoundingBox().max[0], 10.0, 1e-4);
+	mc.clear();
+	assertSameBoundingBox(m3, mc.get(file, o));
+
+	// Corrupted cache files are ignored:
+	for (const auto& f : binaryCacheFiles()) std::ofstream(f) << "garbage";
+	mc.clear();
+	const auto m4 = mc.get(file, o);
+	ASSERT_(std::dynamic_pointer_cast<mrpt::opengl::CAssimpModel>(m4));
+	assertSameBoundingBox(m3, m4);
+
+	// No temporary files are left behind:
+	for (const auto& fi : mrpt::system::CDirectoryExplorer::explore(
+			 testDir + "/cache/models/", FILE_ATTRIB_ARCHIVE))
+		ASSERT_(mrpt::system::extractFileExtension(fi.name) == "bin");
+
+	// And the cache can be disabled:
+	setEnv("MVSIM_MODELS_BINARY_CACHE", "false");
+	mc.clear();
+	ASSERT_(std::dynamic_pointer_cast<mrpt::opengl::CAssimpModel>(mc.get(file, o)));
+	setEnv("MVSIM_MODELS_BINARY_CACHE", "true");
+#else
+	std::cout << "Skipped: the binary cache requires MRPT>=2.6.0\n";
+#endif
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	mrpt::system::createDirectory(testDir);
+	setEnv("MVSIM_STORAGE_DIR", testDir + "/cache/");
+
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_models_cache_keys, "test_models_cache_keys"},
+		{&test_models_cache_binary_round_trip, "test_models_cache_binary_round_trip"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	mrpt::system::deleteFilesInDirectory(testDir, true /*recursive*/);
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+#include <mvsim/World.h>
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "parse_utils.h"
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+using vars_t = std::map<std::string, std::string>;
+
+bool throws(const std::function<void(void)>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+void test_parse_vars()
+{
+	const vars_t vars = {{"X", "3"}, {"NAME", "robot"}, {"N", "X"}};
+
+	ASSERT_EQUAL_(parse("no expressions", vars), "no expressions");
+	ASSERT_EQUAL_(parse("cost: $5", vars), "cost: $5");
+	ASSERT_EQUAL_(parse("/${NAME}/pose", vars), "/robot/pose");
+	ASSERT_EQUAL_(parse("${NAME}${X}", vars), "robot3");
+	// Nested references:
+	ASSERT_EQUAL_(parse("${${N}}", vars), "3");
+
+	ASSERT_(throws([&]() { parse("${UNDEFINED}", vars); }));
+}
+
+void test_parse_math()
+{
+	vars_t vars = {{"X", "3"}, {"A", "1"}, {"B", "2"}, {"S", "2+1"}};
+
+	ASSERT_EQUAL_(parse("$f{180/5}", vars), "36");
+	ASSERT_EQUAL_(parse("$f{${X}*2} $f{X*2}", vars), "6 6");
+	// Nested expressions:
+	ASSERT_EQUAL_(parse("$f{ $f{2*3} + ${X} }", vars), "9");
+	ASSERT_EQUAL_(parse("$f{ $f{ $f{1+1} * ${X} } + 1 }", vars), "7");
+	// Adjacent references are pasted as text, so they form one number:
+	ASSERT_EQUAL_(parse("$f{${A}${B}+1}", vars), "13");
+	// Non-numeric values are pasted as text too:
+	ASSERT_EQUAL_(parse("$f{${S}*2}", vars), "4");
+
+	// The same expressions, now cached, must see the new values:
+	for (int i = 0; i < 5; i++)
+	{
+		vars["X"] = std::to_string(i);
+		vars["S"] = std::to_string(i) + "-1";
+		ASSERT_EQUAL_(parse("$f{${X}*2} $f{X*2}", vars), mrpt::format("%i %i", 2 * i, 2 * i));
+		ASSERT_EQUAL_(parse("$f{ $f{2*3} + ${X} }", vars), std::to_string(6 + i));
+		ASSERT_EQUAL_(parse("$f{${S}*2}", vars), std::to_string(i - 2));
+	}
+
+	// A variable which is not a number any more:
+	vars["X"] = "1+1";
+	ASSERT_EQUAL_(parse("$f{${X}*2}", vars), "3");
+
+	ASSERT_(throws([&]() { parse("$f{1+*}", vars); }));
+	// The failed expression must not be left in the cache:
+	ASSERT_(throws([&]() { parse("$f{1+*}", vars); }));
+}
+
+void test_parse_env_and_cmd()
+{
+#ifdef _WIN32
+	_putenv_s("MVSIM_TEST_PARSE_VAR", "hello");
+#else
+	setenv("MVSIM_TEST_PARSE_VAR", "hello", 1);
+#endif
+	const vars_t vars = {{"V", "MVSIM_TEST_PARSE_VAR"}};
+
+	ASSERT_EQUAL_(parse("$env{MVSIM_TEST_PARSE_VAR}!", vars), "hello!");
+	ASSERT_EQUAL_(parse("$env{${V}}", vars), "hello");
+	ASSERT_(throws([&]() { parse("$env{MVSIM_TEST_UNDEFINED_VAR}", vars); }));
+
+	ASSERT_EQUAL_(parse("[$(echo hi)]", vars), "[hi]");
+	ASSERT_EQUAL_(parse("$f{$(echo 20)/4}", vars), "5");
+}
+
+void test_parse_unterminated()
+{
+	const vars_t vars = {{"X", "3"}};
+
+	for (const char* s : {"${X", "$f{1+2", "$env{HOME", "$(echo", "$f{ ${X} * 2", "${X$f{1}"})
+		ASSERT_(throws([&]() { parse(s, vars); }));
+}
+
+// Startup time of a world with objects generated by a <for> loop, whose XML
+// parsing used to dominate the load time.
+void test_parse_benchmark()
+{
+	const int nObjects = 10000;
+
+	const std::string worldXml = mrpt::format(
+		R"XML(<mvsim_world version="1.0">
+	<variable name="SPREAD" value="100.0"></variable>
+	<for var="i" from="1" to="%i">
+		<block>
+			<shape>
+				<pt>-0.1 -0.1</pt> <pt>-0.1 0.1</pt> <pt>0.1 0.1</pt> <pt>0.1 -0.1</pt>
+			</shape>
+			<zmax>$f{0.5 + 0.1*(${i} %% 7)}</zmax>
+			<init_pose>$f{SPREAD*sin(${i}*0.1)} $f{SPREAD*cos(${i}*0.1)} $f{${i}*3}</init_pose>
+		</block>
+	</for>
+</mvsim_world>
+)XML",
+		nObjects);
+
+	World world;
+	world.setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world.headless(true);
+
+	mrpt::system::CTicTac tic;
+	world.load_from_XML(worldXml);
+	const double tLoad = tic.Tac();
+
+	ASSERT_EQUAL_(world.getListOfBlocks().size(), static_cast<size_t>(nObjects));
+
+	// The parser alone, on the same kind of strings:
+	vars_t vars = {{"SPREAD", "100.0"}};
+	tic.Tic();
+	for (int i = 1; i <= nObjects; i++)
+	{
+		vars["i"] = std::to_string(i);
+		parse("$f{0.5 + 0.1*(${i} % 7)}", vars);
+		parse("$f{SPREAD*sin(${i}*0.1)} $f{SPREAD*cos(${i}*0.1)} $f{${i}*3}", vars);
+	}
+	const double tParse = tic.Tac();
+
+	std::cout << "World with " << nObjects << " blocks loaded in: " << tLoad << " s\n"
+			  << "parse() of their expressions:  " << tParse << " s\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_parse_vars, "test_parse_vars"},
+		{&test_parse_math, "test_parse_math"},
+		{&test_parse_env_and_cmd, "test_parse_env_and_cmd"},
+		{&test_parse_unterminated, "test_parse_unterminated"},
+		{&test_parse_benchmark, "test_parse_benchmark"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,368 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/system/filesystem.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PointCloudLoaders.h"
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const std::string testDir = mrpt::system::getTempFileName() + "_mvsim_test_loaders";
+
+bool throws(const std::function<void(void)>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+std::string writeFile(const std::string& name, const std::vector<uint8_t>& data)
+{
+	const std::string file = testDir + "/" + name;
+	std::ofstream f(file, std::ios::binary);
+	ASSERT_(f.is_open());
+	f.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return file;
+}
+
+std::string writeFile(const std::string& name, const std::string& data)
+{
+	return writeFile(name, std::vector<uint8_t>(data.begin(), data.end()));
+}
+
+template <typename T>
+void put(std::vector<uint8_t>& v, T x)
+{
+	const auto* p = reinterpret_cast<const uint8_t*>(&x);
+	v.insert(v.end(), p, p + sizeof(T));
+}
+
+template <typename T>
+void putAt(std::vector<uint8_t>& v, size_t pos, T x)
+{
+	std::memcpy(v.data() + pos, &x, sizeof(T));
+}
+
+void assertPoint(const mrpt::maps::CPointsMap& m, size_t i, float x, float y, float z, float tol)
+{
+	float px, py, pz;
+	m.getPoint(i, px, py, pz);
+	if (std::abs(px - x) > tol || std::abs(py - y) > tol || std::abs(pz - z) > tol)
+	{
+		THROW_EXCEPTION_FMT(
+			"Point #%zu: got (%f,%f,%f), expected (%f,%f,%f)", i, px, py, pz, x, y, z);
+	}
+}
+
+struct LasPoint
+{
+	double x, y, z;
+};
+
+// Builds an uncompressed LAS file with the given header version, point
+// format and record size, filling only (x,y,z) in each record.
+std::vector<uint8_t> makeLas(
+	uint8_t versionMinor, uint8_t pointFormat, uint16_t recordSize,
+	const std::vector<LasPoint>& pts, const double scale[3], const double offset[3])
+{
+	const uint16_t headerSize = versionMinor >= 4 ? 375 : 227;
+	std::vector<uint8_t> d(headerSize, 0);
+
+	std::memcpy(d.data(), "LASF", 4);
+	d[24] = 1;
+	d[25] = versionMinor;
+	putAt<uint16_t>(d, 94, headerSize);
+	putAt<uint32_t>(d, 96, headerSize);
+	d[104] = pointFormat;
+	putAt<uint16_t>(d, 105, recordSize);
+
+	// LAS 1.4 point formats >=6 only have the 64-bit point count:
+	const bool legacyCount = (pointFormat & 0x7f) < 6;
+	putAt<uint32_t>(d, 107, legacyCount ? static_cast<uint32_t>(pts.size()) : 0);
+	if (versionMinor >= 4) putAt<uint64_t>(d, 247, pts.size());
+
+	double lo[3] = {1e300, 1e300, 1e300}, hi[3] = {-1e300, -1e300, -1e300};
+	for (const auto& p : pts)
+	{
+		const double c[3] = {p.x, p.y, p.z};
+		for (int k = 0; k < 3; k++)
+		{
+			lo[k] = std::min(lo[k], c[k]);
+			hi[k] = std::max(hi[k], c[k]);
+		}
+	}
+	for (int k = 0; k < 3; k++)
+	{
+		putAt<double>(d, 131 + 8 * k, scale[k]);
+		putAt<double>(d, 155 + 8 * k, offset[k]);
+		putAt<double>(d, 179 + 16 * k, hi[k]);
+		putAt<double>(d, 187 + 16 * k, lo[k]);
+	}
+
+	for (const auto& p : pts)
+	{
+		const size_t start = d.size();
+		const double c[3] = {p.x, p.y, p.z};
+		for (int k = 0; k < 3; k++)
+			put<int32_t>(d, static_cast<int32_t>(std::lround((c[k] - offset[k]) / scale[k])));
+		d.resize(start + recordSize, 0);
+	}
+	return d;
+}
+
+void test_ply_ascii()
+{
+	const auto file = writeFile(
+		"ascii.ply",
+		"ply\n"
+		"format ascii 1.0\n"
+		"comment test\n"
+		"element vertex 3\n"
+		"property float intensity\n"
+		"property float x\n"
+		"property float y\n"
+		"property float z\n"
+		"element face 0\n"
+		"property list uchar int vertex_indices\n"
+		"end_header\n"
+		"0.5 1 2 3\n"
+		"0.5 -1.5 2.5 -3.5\r\n"
+		"0.5 10 20 30\n");
+
+	mrpt::maps::CSimplePointsMap m;
+	load_points_ply(file, m);
+	ASSERT_EQUAL_(m.size(), 3U);
+	assertPoint(m, 0, 1, 2, 3, 1e-6f);
+	assertPoint(m, 1, -1.5f, 2.5f, -3.5f, 1e-6f);
+	assertPoint(m, 2, 10, 20, 30, 1e-6f);
+
+	// Loaders append to existing points:
+	load_points_ply(file, m);
+	ASSERT_EQUAL_(m.size(), 6U);
+
+	ASSERT_(throws([&]() { load_points_ply(writeFile("bad.ply", "not a ply"), m); }));
+}
+
+void test_ply_binary()
+{
+	const std::string header =
+		"ply\n"
+		"format binary_little_endian 1.0\n"
+		"element vertex 4\n"
+		"property float x\n"
+		"property uchar red\n"
+		"property float y\n"
+		"property double z\n"
+		"end_header\n";
+	std::vector<uint8_t> d(header.begin(), header.end());
+	for (int i = 0; i < 4; i++)
+	{
+		put<float>(d, 0.25f * i);
+		put<uint8_t>(d, 255);
+		put<float>(d, -1.0f * i);
+		put<double>(d, 100.0 + i);
+	}
+
+	mrpt::maps::CSimplePointsMap m;
+	load_points_ply(writeFile("binary.ply", d), m);
+	ASSERT_EQUAL_(m.size(), 4U);
+	for (int i = 0; i < 4; i++) assertPoint(m, i, 0.25f * i, -1.0f * i, 100.0f + i, 1e-6f);
+
+	// Truncated files must be detected:
+	d.resize(d.size() - 3);
+	ASSERT_(throws([&]() { load_points_ply(writeFile("truncated.ply", d), m); }));
+}
+
+void test_las_1_2()
+{
+	// Georeferenced (UTM-like) coordinates, with millimeter resolution:
+	const double scale[3] = {0.001, 0.001, 0.001};
+	const double offset[3] = {430000.0, 4100000.0, 50.0};
+	const std::vector<LasPoint> pts = {
+		{430123.456, 4100321.987, 51.234},
+		{430123.457, 4100321.988, 51.235},
+		{430999.999, 4100000.001, 49.999}};
+
+	mrpt::maps::CSimplePointsMap m;
+	const auto origin =
+		load_points_las(writeFile("v12.las", makeLas(2, 1, 28, pts, scale, offset)), m);
+	ASSERT_EQUAL_(m.size(), pts.size());
+
+	// Points are relative to the header offset, which is returned:
+	ASSERT_NEAR_(origin.x, offset[0], 1e-9);
+	ASSERT_NEAR_(origin.y, offset[1], 1e-9);
+	ASSERT_NEAR_(origin.z, offset[2], 1e-9);
+
+	// so the millimeter resolution is preserved:
+	for (size_t i = 0; i < pts.size(); i++)
+	{
+		assertPoint(
+			m, i, pts[i].x - offset[0], pts[i].y - offset[1], pts[i].z - offset[2], 2e-4f);
+	}
+
+	// Without offset in the header, the bounding box minimum is used (with
+	// a coarser scale, so the coordinates fit in the int32 fields):
+	const double scale2[3] = {0.01, 0.01, 0.01};
+	const double noOffset[3] = {0, 0, 0};
+	const std::vector<LasPoint> pts2 = {
+		{430123.45, 4100321.98, 51.23}, {430124.0, 4100300.0, 50.0}};
+
+	mrpt::maps::CSimplePointsMap m2;
+	const auto file2 = writeFile("v12_nooffset.las", makeLas(2, 0, 20, pts2, scale2, noOffset));
+	const auto origin2 = load_points_las(file2, m2);
+	ASSERT_NEAR_(origin2.x, 430123.45, 1e-6);
+	ASSERT_NEAR_(origin2.y, 4100300.0, 1e-6);
+	ASSERT_NEAR_(origin2.z, 50.0, 1e-6);
+	assertPoint(m2, 0, 0.0f, 21.98f, 1.23f, 2e-4f);
+	assertPoint(m2, 1, 0.55f, 0.0f, 0.0f, 2e-4f);
+}
+
+void test_las_1_4()
+{
+	const double scale[3] = {0.01, 0.01, 0.01};
+	const double offset[3] = {0, 0, 0};
+	std::vector<LasPoint> pts;
+	for (int i = 0; i < 5; i++) pts.push_back({1.0 * i, 2.0 * i, -0.5 * i});
+
+	// Point format 6 only has the 64-bit point count of LAS 1.4:
+	mrpt::maps::CSimplePointsMap m;
+	load_points_las(writeFile("v14.las", makeLas(4, 6, 30, pts, scale, offset)), m);
+	ASSERT_EQUAL_(m.size(), pts.size());
+
+	// Legacy formats in LAS 1.4 have both counts:
+	mrpt::maps::CSimplePointsMap m2;
+	load_points_las(writeFile("v14_legacy.las", makeLas(4, 1, 28, pts, scale, offset)), m2);
+	ASSERT_EQUAL_(m2.size(), pts.size());
+}
+
+void test_laz_rejected()
+{
+	const double scale[3] = {0.01, 0.01, 0.01};
+	const double offset[3] = {0, 0, 0};
+	const auto file =
+		writeFile("compressed.laz", makeLas(2, 0x80 | 1, 28, {{1, 2, 3}}, scale, offset));
+
+	mrpt::maps::CSimplePointsMap m;
+	ASSERT_(throws([&]() { load_points_las(file, m); }));
+	ASSERT_EQUAL_(m.size(), 0U);
+}
+
+void test_decimation()
+{
+	const size_t N = 10, decim = 3;	 // keeps points #0, #3, #6, #9
+	const size_t expected = 4;
+
+	// PLY:
+	std::string ply = "ply\nformat ascii 1.0\nelement vertex 10\n";
+	ply += "property float x\nproperty float y\nproperty float z\nend_header\n";
+	for (size_t i = 0; i < N; i++) ply += std::to_string(i) + " 0 0\n";
+
+	mrpt::maps::CSimplePointsMap mPly;
+	load_points_ply(writeFile("decim.ply", ply), mPly, decim);
+	ASSERT_EQUAL_(mPly.size(), expected);
+	for (size_t i = 0; i < expected; i++)
+		assertPoint(mPly, i, static_cast<float>(i * decim), 0, 0, 1e-6f);
+
+	// LAS:
+	const double scale[3] = {0.01, 0.01, 0.01};
+	const double offset[3] = {0, 0, 0};
+	std::vector<LasPoint> pts;
+	for (size_t i = 0; i < N; i++) pts.push_back({1.0 * i, 0, 0});
+
+	mrpt::maps::CSimplePointsMap mLas;
+	load_points_las(writeFile("decim.las", makeLas(2, 0, 20, pts, scale, offset)), mLas, decim);
+	ASSERT_EQUAL_(mLas.size(), expected);
+	for (size_t i = 0; i < expected; i++)
+		assertPoint(mLas, i, static_cast<float>(i * decim), 0, 0, 1e-6f);
+
+	// Raw float32, KITTI-like (x,y,z,intensity):
+	std::vector<uint8_t> bin;
+	for (size_t i = 0; i < N; i++)
+	{
+		put<float>(bin, static_cast<float>(i));
+		put<float>(bin, 1.0f);
+		put<float>(bin, 2.0f);
+		put<float>(bin, 0.5f);
+	}
+	mrpt::maps::CSimplePointsMap mBin;
+	const auto binFile = writeFile("decim.bin", bin);
+	load_points_raw_float32(binFile, mBin, 4, decim);
+	ASSERT_EQUAL_(mBin.size(), expected);
+	for (size_t i = 0; i < expected; i++)
+		assertPoint(mBin, i, static_cast<float>(i * decim), 1, 2, 1e-6f);
+
+	// Wrong record size:
+	ASSERT_(throws([&]() { load_points_raw_float32(binFile, mBin, 3); }));
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	mrpt::system::createDirectory(testDir);
+
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_ply_ascii, "test_ply_ascii"},
+		{&test_ply_binary, "test_ply_binary"},
+		{&test_las_1_2, "test_las_1_2"},
+		{&test_las_1_4, "test_las_1_4"},
+		{&test_laz_rejected, "test_laz_rejected"},
+		{&test_decimation, "test_decimation"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	mrpt::system::deleteFilesInDirectory(testDir, true);
+
+	return anyFail ? 1 : 0;
+}
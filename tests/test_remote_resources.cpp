@@ -0,0 +1,338 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/vector_loadsave.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/md5.h>
+#include <mvsim/RemoteResourcesManager.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const std::string testDir = mrpt::system::getTempFileName() + "_mvsim_test_remote";
+
+uint32_t crc32(const std::string& s)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	for (unsigned char c : s)
+	{
+		crc ^= c;
+		for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+void put16(std::vector<uint8_t>& v, uint16_t x)
+{
+	v.push_back(x & 0xff);
+	v.push_back(x >> 8);
+}
+void put32(std::vector<uint8_t>& v, uint32_t x)
+{
+	put16(v, x & 0xffff);
+	put16(v, x >> 16);
+}
+
+bool throws(const std::function<void(void)>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+// Raw deflate stream (no zlib header), as used in ZIP packages:
+std::string deflateRaw(const std::string& data)
+{
+	z_stream zs{};
+	ASSERT_EQUAL_(
+		deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY), Z_OK);
+
+	std::string out(deflateBound(&zs, data.size()), '\0');
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	zs.avail_in = data.size();
+	zs.next_out = reinterpret_cast<Bytef*>(out.data());
+	zs.avail_out = out.size();
+	const int ret = deflate(&zs, Z_FINISH);
+	deflateEnd(&zs);
+
+	ASSERT_EQUAL_(ret, Z_STREAM_END);
+	out.resize(zs.total_out);
+	return out;
+}
+
+// Builds a ZIP package with "stored" (uncompressed) or "deflated" members:
+std::vector<uint8_t> makeZip(
+	const std::vector<std::pair<std::string, std::string>>& files, bool compress = false)
+{
+	std::vector<uint8_t> z, cd;
+	for (const auto& [name, data] : files)
+	{
+		const std::string stored = compress ? deflateRaw(data) : data;
+		const uint16_t version = compress ? 20 : 10, method = compress ? 8 : 0;
+		const uint32_t offset = z.size(), crc = crc32(data), size = data.size(),
+					   storedSize = stored.size();
+
+		put32(z, 0x04034b50);
+		put16(z, version);
+		put16(z, 0);  // flags
+		put16(z, method);
+		put32(z, 0);  // time & date
+		put32(z, crc);
+		put32(z, storedSize);
+		put32(z, size);
+		put16(z, name.size());
+		put16(z, 0);  // extra
+		z.insert(z.end(), name.begin(), name.end());
+		z.insert(z.end(), stored.begin(), stored.end());
+
+		put32(cd, 0x02014b50);
+		put16(cd, version);
+		put16(cd, version);
+		put16(cd, 0);
+		put16(cd, method);
+		put32(cd, 0);
+		put32(cd, crc);
+		put32(cd, storedSize);
+		put32(cd, size);
+		put16(cd, name.size());
+		put16(cd, 0);  // extra
+		put16(cd, 0);  // comment
+		put16(cd, 0);  // disk
+		put16(cd, 0);  // internal attr
+		put32(cd, 0);  // external attr
+		put32(cd, offset);
+		cd.insert(cd.end(), name.begin(), name.end());
+	}
+	const uint32_t cdOffset = z.size(), cdSize = cd.size();
+	z.insert(z.end(), cd.begin(), cd.end());
+
+	put32(z, 0x06054b50);
+	put16(z, 0);
+	put16(z, 0);
+	put16(z, files.size());
+	put16(z, files.size());
+	put32(z, cdSize);
+	put32(z, cdOffset);
+	put16(z, 0);  // comment
+	return z;
+}
+
+std::string readFile(const std::string& f)
+{
+	std::vector<uint8_t> v;
+	ASSERT_(mrpt::io::loadBinaryFile(v, f));
+	return {v.begin(), v.end()};
+}
+
+void test_zip_reader()
+{
+	const auto zipFile = testDir + "/pkg.zip";
+	mrpt::io::vectorToBinaryFile(
+		makeZip({{"model/a.txt", "hello"}, {"model/tex/b.txt", "world"}, {"other/c.txt", "!"}}),
+		zipFile);
+
+	ASSERT_EQUAL_(RemoteResourcesManager::zip_list_members(zipFile).size(), 3U);
+
+	const auto b = RemoteResourcesManager::zip_read_member(zipFile, "model/tex/b.txt");
+	ASSERT_EQUAL_(std::string(b.begin(), b.end()), std::string("world"));
+
+	ASSERT_(throws([&]() { RemoteResourcesManager::zip_read_member(zipFile, "missing.txt"); }));
+}
+
+void test_zip_deflate()
+{
+	std::string big;
+	for (int i = 0; i < 2000; i++) big += "vertex " + std::to_string(i % 17) + " 0.5 1.0\n";
+
+	const auto zipFile = testDir + "/deflated.zip";
+	mrpt::io::vectorToBinaryFile(
+		makeZip({{"model/big.txt", big}, {"model/small.txt", "x"}}, true /*compress*/), zipFile);
+	// Make sure it is really compressed:
+	ASSERT_LT_(mrpt::system::getFileSize(zipFile), big.size() / 4);
+
+	const auto b = RemoteResourcesManager::zip_read_member(zipFile, "model/big.txt");
+	ASSERT_(std::string(b.begin(), b.end()) == big);
+
+	RemoteResourcesManager rrm;
+	const auto f = rrm.resolve_path("file://" + zipFile + "/model/big.txt");
+	ASSERT_(readFile(f) == big);
+	ASSERT_EQUAL_(readFile(mrpt::system::extractFileDirectory(f) + "/small.txt"), std::string("x"));
+}
+
+void test_zip_path_traversal()
+{
+	const auto zipFile = testDir + "/evil.zip";
+	mrpt::io::vectorToBinaryFile(
+		makeZip({{"model/a.txt", "ok"}, {"model/../x", "evil"}, {"../x", "evil"}}), zipFile);
+
+	RemoteResourcesManager rrm;
+
+	// Directly requested:
+	ASSERT_(throws([&]() { rrm.resolve_path("file://" + zipFile + "/../x"); }));
+
+	// ...or in the directory extracted together with a legit file:
+	ASSERT_(throws([&]() { rrm.resolve_path("file://" + zipFile + "/model/a.txt"); }));
+
+	// Nothing was written out of the extraction directory:
+	ASSERT_(!mrpt::system::fileExists(testDir + "/x"));
+	ASSERT_(!mrpt::system::fileExists(testDir + "/cache/x"));
+}
+
+void test_find_remote_uris()
+{
+	const auto writeText = [](const std::string& file, const std::string& text)
+	{ std::ofstream(file) << text; };
+
+	mrpt::system::createDirectory(testDir + "/world");
+	mrpt::system::createDirectory(testDir + "/world/sub");
+
+	// Includes: relative to each file, recursive, and with cycles:
+	writeText(
+		testDir + "/world/sub/inc.xml",
+		"<model_uri>https://server.org/b.zip/b.dae</model_uri>\n"
+		"<include file=\"../other.xml\" />\n"
+		"<include file='${SOMEDIR}/missing.xml' />\n");
+	writeText(
+		testDir + "/world/other.xml",
+		"<model_uri>http://server.org/c.dae</model_uri>\n"
+		"<include file=\"sub/inc.xml\" />\n");
+
+	const std::string xml =
+		"<mvsim_world>\n"
+		"  <model_uri> https://server.org/a.dae </model_uri>\n"
+		"  <model_uri>https://server.org/${VAR}.dae</model_uri>\n"
+		"  <model_uri>/local/file.dae</model_uri>\n"
+		"  <include file=\"sub/inc.xml\" x=\"1\"/>\n"
+		"</mvsim_world>\n";
+
+	// Without a base path, includes are not followed:
+	auto uris = RemoteResourcesManager::find_remote_uris(xml);
+	ASSERT_EQUAL_(uris.size(), 1U);
+	ASSERT_EQUAL_(uris.at(0), std::string("https://server.org/a.dae"));
+
+	uris = RemoteResourcesManager::find_remote_uris(xml, testDir + "/world");
+	std::sort(uris.begin(), uris.end());
+	ASSERT_EQUAL_(uris.size(), 3U);
+	ASSERT_EQUAL_(uris.at(0), std::string("http://server.org/c.dae"));
+	ASSERT_EQUAL_(uris.at(1), std::string("https://server.org/a.dae"));
+	ASSERT_EQUAL_(uris.at(2), std::string("https://server.org/b.zip/b.dae"));
+}
+
+void test_resolve_local_zip()
+{
+	RemoteResourcesManager rrm;
+
+	const auto f = rrm.resolve_path("file://" + testDir + "/pkg.zip/model/a.txt");
+	ASSERT_EQUAL_(readFile(f), std::string("hello"));
+
+	// The rest of the member directory is extracted too, but nothing else:
+	const auto outDir = mrpt::system::extractFileDirectory(f);
+	ASSERT_(mrpt::system::fileExists(outDir + "/tex/b.txt"));
+	ASSERT_(!mrpt::system::fileExists(outDir + "/../other/c.txt"));
+
+	// Second time, it comes from the cache:
+	ASSERT_EQUAL_(rrm.resolve_path("file://" + testDir + "/pkg.zip/model/a.txt"), f);
+
+	// Files extracted from other ZIP contents are extracted again:
+	const auto marker = outDir + "/../.extracted_" + mrpt::system::md5("model/").substr(0, 12);
+	ASSERT_FILE_EXISTS_(marker);
+	mrpt::io::vectorToBinaryFile(std::vector<uint8_t>{'x'}, marker);
+	mrpt::io::vectorToBinaryFile(std::vector<uint8_t>{'y'}, f);
+	RemoteResourcesManager rrm2;
+	ASSERT_EQUAL_(rrm2.resolve_path("file://" + testDir + "/pkg.zip/model/a.txt"), f);
+	ASSERT_EQUAL_(readFile(f), std::string("hello"));
+}
+
+void test_fetch_to_cache()
+{
+	RemoteResourcesManager rrm;
+
+	const auto url = "file://" + testDir + "/pkg.zip";
+	const auto f = rrm.fetch_to_cache(url);
+	ASSERT_(mrpt::system::fileExists(f));
+	ASSERT_(mrpt::system::fileExists(f + ".md5"));
+	ASSERT_EQUAL_(readFile(f), readFile(testDir + "/pkg.zip"));
+
+	// A corrupted cache entry must be fetched again by a new process:
+	mrpt::io::vectorToBinaryFile(std::vector<uint8_t>{'x'}, f);
+	RemoteResourcesManager rrm2;
+	ASSERT_EQUAL_(rrm2.fetch_to_cache(url), f);
+	ASSERT_EQUAL_(readFile(f), readFile(testDir + "/pkg.zip"));
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	mrpt::system::createDirectory(testDir);
+#ifdef _WIN32
+	_putenv_s("MVSIM_STORAGE_DIR", (testDir + "/cache/").c_str());
+#else
+	setenv("MVSIM_STORAGE_DIR", (testDir + "/cache/").c_str(), 1);
+#endif
+
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_zip_reader, "test_zip_reader"},
+		{&test_resolve_local_zip, "test_resolve_local_zip"},
+		{&test_fetch_to_cache, "test_fetch_to_cache"},
+		{&test_zip_deflate, "test_zip_deflate"},
+		{&test_zip_path_traversal, "test_zip_path_traversal"},
+		{&test_find_remote_uris, "test_find_remote_uris"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	mrpt::system::deleteFilesInDirectory(testDir, true /*delete dir too*/);
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,451 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mvsim/Sensors/DepthCameraSensor.h>
+#include <mvsim/Sensors/Lidar3D.h>
+#include <mvsim/World.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <rapidxml.hpp>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+bool throws(const std::function<void()>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+const char* WORLD_XML = R"XML(<mvsim_world version="1.0">
+	<simul_timestep>0.01</simul_timestep>
+
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<chassis mass="15.0" zmin="0.05" zmax="0.4" />
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="r1" class="robot">
+		<init_pose>0 0 0</init_pose>
+		%s
+	</vehicle>
+
+	<block name="box">
+		<shape>
+			<pt>-0.5 -0.5</pt> <pt>-0.5 0.5</pt> <pt>0.5 0.5</pt> <pt>0.5 -0.5</pt>
+		</shape>
+		<mass>30</mass>
+		<zmin>0.0</zmin> <zmax>1.5</zmax>
+		<init_pose>3 0 0</init_pose>
+	</block>
+</mvsim_world>
+)XML";
+
+// Gives access to the scan geometry computed by Lidar3D on load:
+class Lidar3DProbe : public Lidar3D
+{
+   public:
+	using Lidar3D::Lidar3D;
+
+	using Lidar3D::fboCamModel_;
+	using Lidar3D::lut_;
+	using Lidar3D::rayInSector_;
+	using Lidar3D::renderInSector_;
+	using Lidar3D::ringIds_;
+	using Lidar3D::vertical_ray_angles_;
+};
+
+// Gives access to the camera models of DepthCameraSensor after load:
+class DepthCameraProbe : public DepthCameraSensor
+{
+   public:
+	using DepthCameraSensor::DepthCameraSensor;
+
+	const mrpt::img::TCamera& depthCamera() const { return sensor_params_.cameraParams; }
+	const mrpt::img::TCamera& rgbCamera() const { return sensor_params_.cameraParamsIntensity; }
+};
+
+// Loads a sensor of type SENSOR from the given XML, aboard the vehicle "r1":
+template <class SENSOR>
+std::shared_ptr<SENSOR> makeSensor(World& world, const std::string& sensorXml)
+{
+	std::vector<char> buf(sensorXml.begin(), sensorXml.end());
+	buf.push_back('\0');
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(buf.data());
+
+	auto& veh = *world.getListOfVehicles().at("r1");
+	return std::make_shared<SENSOR>(veh, doc.first_node());
+}
+
+std::shared_ptr<Lidar3DProbe> makeLidar(World& world, const std::string& params)
+{
+	return makeSensor<Lidar3DProbe>(
+		world, "<sensor class=\"lidar3d\" name=\"lidar\">" + params + "</sensor>");
+}
+
+// All the simulated rays fall within the rendered depth images:
+void checkLidarLUT(const Lidar3DProbe& l)
+{
+	const auto& cam = l.fboCamModel_;
+	ASSERT_GE_(cam.nrows, 1U);
+	for (const auto& col : l.lut_)
+	{
+		ASSERT_EQUAL_(col.column.size(), l.vertical_ray_angles_.size());
+		for (const auto& e : col.column)
+		{
+			ASSERT_(e.depth2range >= 1.0f && std::isfinite(e.depth2range));
+			ASSERT_(e.u >= 0 && e.u <= cam.ncols - 1);
+			ASSERT_(e.v >= 0 && e.v <= cam.nrows - 1);
+		}
+	}
+}
+
+// Number of (cyclic) runs of contiguous rays within the azimuth sector:
+size_t countSectorRuns(const std::vector<uint8_t>& inSector)
+{
+	size_t runs = 0;
+	for (size_t i = 0; i < inSector.size(); i++)
+		if (inSector[i] && !inSector[(i + inSector.size() - 1) % inSector.size()]) runs++;
+	return runs;
+}
+
+size_t countNonZero(const std::vector<uint8_t>& v)
+{
+	size_t n = 0;
+	for (const auto x : v) n += x ? 1 : 0;
+	return n;
+}
+
+std::unique_ptr<World> loadWorld(const std::string& sensorXml = {})
+{
+	auto world = std::make_unique<World>();
+	world->setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world->headless(true);
+	world->load_from_XML(mrpt::format(WORLD_XML, sensorXml.c_str()));
+	return world;
+}
+
+void test_lidar3d_rings()
+{
+	auto world = loadWorld();
+
+	// Defaults: 16 rings, evenly spread in 30 degrees:
+	{
+		const auto l = makeLidar(*world, "");
+		ASSERT_EQUAL_(l->vertical_ray_angles_.size(), 16U);
+		ASSERT_NEAR_(l->vertical_ray_angles_.front(), mrpt::DEG2RAD(-15.0), 1e-9);
+		ASSERT_NEAR_(l->vertical_ray_angles_.back(), mrpt::DEG2RAD(15.0), 1e-9);
+		ASSERT_EQUAL_(l->rayInSector_.size(), 180U);
+		ASSERT_EQUAL_(countNonZero(l->rayInSector_), 180U);
+		checkLidarLUT(*l);
+	}
+
+	// Vertical decimation keeps the original ring indices:
+	{
+		const auto l =
+			makeLidar(*world, "<vert_nrays>16</vert_nrays><vert_decimation>4</vert_decimation>");
+		ASSERT_EQUAL_(l->vertical_ray_angles_.size(), 4U);
+		ASSERT_(l->ringIds_ == std::vector<uint16_t>({0, 4, 8, 12}));
+		const double expectedDeg[4] = {-15.0, -7.0, 1.0, 9.0};
+		for (size_t i = 0; i < 4; i++)
+			ASSERT_NEAR_(l->vertical_ray_angles_[i], mrpt::DEG2RAD(expectedDeg[i]), 1e-9);
+		checkLidarLUT(*l);
+	}
+
+	// Custom ring angles, decimated:
+	{
+		const auto l = makeLidar(
+			*world,
+			"<vert_nrays>6</vert_nrays><vertical_ray_angles>20 -10 -5 0 5 10</vertical_ray_angles>"
+			"<vert_decimation>2</vert_decimation>");
+		ASSERT_(l->ringIds_ == std::vector<uint16_t>({0, 2, 4}));
+		const double expectedDeg[3] = {-10.0, 0.0, 10.0};
+		for (size_t i = 0; i < 3; i++)
+			ASSERT_NEAR_(l->vertical_ray_angles_[i], mrpt::DEG2RAD(expectedDeg[i]), 1e-9);
+		checkLidarLUT(*l);
+	}
+
+	// A single ring, on the horizontal plane:
+	{
+		const auto l = makeLidar(*world, "<vert_nrays>1</vert_nrays>");
+		ASSERT_EQUAL_(l->vertical_ray_angles_.size(), 1U);
+		ASSERT_EQUAL_(l->vertical_ray_angles_[0], 0.0);
+		ASSERT_EQUAL_(l->fboCamModel_.nrows, 1U);
+		checkLidarLUT(*l);
+	}
+
+	// ...or decimated down to a single ring, all below the horizon:
+	{
+		const auto l =
+			makeLidar(*world, "<vert_nrays>16</vert_nrays><vert_decimation>16</vert_decimation>");
+		ASSERT_(l->ringIds_ == std::vector<uint16_t>({0}));
+		ASSERT_NEAR_(l->vertical_ray_angles_[0], mrpt::DEG2RAD(-15.0), 1e-9);
+		checkLidarLUT(*l);
+	}
+
+	// Bad parameters:
+	ASSERT_(throws([&]() { makeLidar(*world, "<vert_nrays>0</vert_nrays>"); }));
+	ASSERT_(throws([&]() { makeLidar(*world, "<vert_decimation>0</vert_decimation>"); }));
+	ASSERT_(throws([&]() { makeLidar(*world, "<horz_decimation>0</horz_decimation>"); }));
+}
+
+void test_lidar3d_horz_decimation_and_sectors()
+{
+	auto world = loadWorld();
+
+	const auto full = makeLidar(*world, "<horz_nrays>360</horz_nrays>");
+	const auto l =
+		makeLidar(*world, "<horz_nrays>360</horz_nrays><horz_decimation>4</horz_decimation>");
+	ASSERT_EQUAL_(l->rayInSector_.size(), 90U);
+	ASSERT_EQUAL_(countNonZero(l->rayInSector_), 90U);
+	// Smaller depth images:
+	ASSERT_LT_(l->fboCamModel_.ncols, full->fboCamModel_.ncols / 3);
+	checkLidarLUT(*l);
+
+	// A 90 degrees sector in front, within one single sub-scan render:
+	{
+		const auto s = makeLidar(
+			*world,
+			"<horz_nrays>360</horz_nrays>"
+			"<azimuth_min_degrees>-45</azimuth_min_degrees>"
+			"<azimuth_max_degrees>45</azimuth_max_degrees>");
+		const auto n = countNonZero(s->rayInSector_);
+		ASSERT_(n >= 88 && n <= 92);
+		ASSERT_EQUAL_(countSectorRuns(s->rayInSector_), 1U);
+		ASSERT_EQUAL_(s->renderInSector_.size(), 3U);
+		ASSERT_EQUAL_(countNonZero(s->renderInSector_), 1U);
+	}
+
+	// A 20 degrees sector behind, wrapping around +-180 degrees:
+	{
+		const auto s = makeLidar(
+			*world,
+			"<horz_nrays>360</horz_nrays>"
+			"<azimuth_min_degrees>170</azimuth_min_degrees>"
+			"<azimuth_max_degrees>-170</azimuth_max_degrees>");
+		const auto n = countNonZero(s->rayInSector_);
+		ASSERT_(n >= 18 && n <= 22);
+		ASSERT_EQUAL_(countSectorRuns(s->rayInSector_), 1U);
+		ASSERT_EQUAL_(countNonZero(s->renderInSector_), 2U);
+	}
+
+	// Sector and decimation together:
+	{
+		const auto s = makeLidar(
+			*world,
+			"<horz_nrays>360</horz_nrays><horz_decimation>2</horz_decimation>"
+			"<azimuth_min_degrees>0</azimuth_min_degrees>"
+			"<azimuth_max_degrees>180</azimuth_max_degrees>");
+		ASSERT_EQUAL_(s->rayInSector_.size(), 180U);
+		const auto n = countNonZero(s->rayInSector_);
+		ASSERT_(n >= 88 && n <= 92);
+		ASSERT_EQUAL_(countSectorRuns(s->rayInSector_), 1U);
+	}
+}
+
+std::string depthCameraXml(const std::string& params)
+{
+	return "<sensor class=\"rgbd_camera\" name=\"cam\">"
+		   "<depth_ncols>640</depth_ncols><depth_nrows>480</depth_nrows>"
+		   "<depth_cx>320</depth_cx><depth_cy>240</depth_cy>"
+		   "<depth_fx>400</depth_fx><depth_fy>400</depth_fy>"
+		   "<rgb_ncols>640</rgb_ncols><rgb_nrows>480</rgb_nrows>"
+		   "<rgb_cx>320</rgb_cx><rgb_cy>240</rgb_cy>"
+		   "<rgb_fx>400</rgb_fx><rgb_fy>400</rgb_fy>" +
+		   params + "</sensor>";
+}
+
+// A 3D point (camera frame, +Z forward) must be seen at the same place in the
+// full image and in the reduced one:
+void checkSameProjection(
+	const mrpt::img::TCamera& full, const mrpt::img::TCamera& reduced, unsigned int x0,
+	unsigned int y0, unsigned int decimation)
+{
+	for (const auto& [x, y, z] :
+		 std::vector<std::tuple<double, double, double>>{{0, 0, 2}, {0.3, -0.1, 1}, {-1, 0.5, 4}})
+	{
+		const double uFull = full.cx() + full.fx() * x / z;
+		const double vFull = full.cy() + full.fy() * y / z;
+		const double u = reduced.cx() + reduced.fx() * x / z;
+		const double v = reduced.cy() + reduced.fy() * y / z;
+
+		// Pixel centers: full-resolution pixel "i" covers [i-0.5, i+0.5]
+		ASSERT_NEAR_((u + 0.5) * decimation - 0.5 + x0, uFull, 1e-9);
+		ASSERT_NEAR_((v + 0.5) * decimation - 0.5 + y0, vFull, 1e-9);
+	}
+}
+
+void test_depth_camera_roi_and_decimation()
+{
+	auto world = loadWorld();
+
+	const auto full = makeSensor<DepthCameraProbe>(*world, depthCameraXml(""));
+	ASSERT_EQUAL_(full->depthCamera().ncols, 640U);
+	ASSERT_EQUAL_(full->depthCamera().nrows, 480U);
+
+	const auto c = makeSensor<DepthCameraProbe>(
+		*world, depthCameraXml("<depth_roi>0 120 640 240</depth_roi>"
+							   "<depth_decimation>4</depth_decimation>"
+							   "<rgb_roi>100 50 400 300</rgb_roi>"
+							   "<rgb_decimation>2</rgb_decimation>"));
+
+	ASSERT_EQUAL_(c->depthCamera().ncols, 160U);
+	ASSERT_EQUAL_(c->depthCamera().nrows, 60U);
+	ASSERT_NEAR_(c->depthCamera().fx(), 100.0, 1e-9);
+	checkSameProjection(full->depthCamera(), c->depthCamera(), 0, 120, 4);
+
+	ASSERT_EQUAL_(c->rgbCamera().ncols, 200U);
+	ASSERT_EQUAL_(c->rgbCamera().nrows, 150U);
+	checkSameProjection(full->rgbCamera(), c->rgbCamera(), 100, 50, 2);
+
+	// Decimation only:
+	const auto d = makeSensor<DepthCameraProbe>(
+		*world, depthCameraXml("<depth_decimation>3</depth_decimation>"));
+	ASSERT_EQUAL_(d->depthCamera().ncols, 213U);
+	ASSERT_EQUAL_(d->depthCamera().nrows, 160U);
+	checkSameProjection(full->depthCamera(), d->depthCamera(), 0, 0, 3);
+
+	// Malformed or out of the image ROIs, and zero decimation:
+	for (const char* bad :
+		 {"<depth_roi>0 0 641 480</depth_roi>", "<depth_roi>600 0 41 10</depth_roi>",
+		  "<depth_roi>0 0 0 10</depth_roi>", "<depth_roi>-1 0 10 10</depth_roi>",
+		  "<depth_roi>0 0 10</depth_roi>", "<depth_roi>0 0 10 10 10</depth_roi>",
+		  "<depth_roi>0 0 10 ten</depth_roi>", "<rgb_roi>0 470 10 11</rgb_roi>",
+		  "<depth_decimation>0</depth_decimation>"})
+	{
+		ASSERT_(throws([&]() { makeSensor<DepthCameraProbe>(*world, depthCameraXml(bad)); }));
+	}
+}
+
+// Observations of a headless world, rendered on the CPU, have the reduced size:
+void test_depth_camera_observations()
+{
+	auto world = loadWorld(depthCameraXml(
+		"<pose_3d>0.3 0 0.3 0 0 0</pose_3d>"
+		"<relativePoseIntensityWRTDepth>0 0 0 -90 0 -90</relativePoseIntensityWRTDepth>"
+		"<sensor_period>0.05</sensor_period>"
+		"<cpu_rasterizer>true</cpu_rasterizer>"
+		"<depth_roi>0 120 640 240</depth_roi><depth_decimation>4</depth_decimation>"
+		"<rgb_decimation>2</rgb_decimation>"));
+
+	std::mutex obsMtx;
+	std::vector<mrpt::obs::CObservation3DRangeScan::Ptr> observations;
+	world->registerCallbackOnObservation(
+		[&](const Simulable&, const mrpt::obs::CObservation::Ptr& o)
+		{
+			auto obs = std::dynamic_pointer_cast<mrpt::obs::CObservation3DRangeScan>(o);
+			if (!obs) return;
+			std::lock_guard<std::mutex> lck(obsMtx);
+			observations.push_back(obs);
+		});
+
+	// Camera-like sensors run on the GUI thread, or on this one when headless:
+	std::atomic_bool done = false;
+	std::thread gfxThread(
+		[&]()
+		{
+			while (!done)
+			{
+				world->internalGraphicsLoopTasksForSimulation();
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+
+	for (int i = 0; i < 30; i++) world->run_simulation(0.01);
+
+	done = true;
+	gfxThread.join();
+
+	std::lock_guard<std::mutex> lck(obsMtx);
+	ASSERT_GE_(observations.size(), 4U);
+	for (const auto& obs : observations)
+	{
+		ASSERT_(obs->hasRangeImage);
+		ASSERT_EQUAL_(static_cast<size_t>(obs->rangeImage.cols()), 160U);
+		ASSERT_EQUAL_(static_cast<size_t>(obs->rangeImage.rows()), 60U);
+		ASSERT_EQUAL_(obs->cameraParams.ncols, 160U);
+		ASSERT_EQUAL_(obs->cameraParams.nrows, 60U);
+
+		ASSERT_(obs->hasIntensityImage);
+		ASSERT_EQUAL_(obs->intensityImage.getWidth(), 320U);
+		ASSERT_EQUAL_(obs->intensityImage.getHeight(), 240U);
+		ASSERT_EQUAL_(obs->cameraParamsIntensity.ncols, 320U);
+	}
+
+	// The box in front is seen at ~2.2 m, at the center of the depth image:
+	const auto& last = *observations.back();
+	const float centerRange = last.rangeImage(30, 80) * last.rangeUnits;
+	ASSERT_NEAR_(centerRange, 2.2f, 0.1f);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_lidar3d_rings, "test_lidar3d_rings"},
+		{&test_lidar3d_horz_decimation_and_sectors, "test_lidar3d_horz_decimation_and_sectors"},
+		{&test_depth_camera_roi_and_decimation, "test_depth_camera_roi_and_decimation"},
+		{&test_depth_camera_observations, "test_depth_camera_observations"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/system/CTicTac.h>
+#include <mvsim/VehicleBase.h>
+#include <mvsim/World.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+// Bumpy terrain, so vehicles tilt and the per-vehicle terrain fit runs:
+std::string elevationMatrix()
+{
+	std::string s = "[";
+	for (int r = 0; r < 40; r++)
+	{
+		for (int c = 0; c < 40; c++)
+			s += mrpt::format("%.3f ", 0.3 * std::sin(0.4 * r) * std::cos(0.3 * c) + 0.01 * r);
+		s += (r == 39) ? "]" : ";";
+	}
+	return s;
+}
+
+// nVehicles robots on a grid, each with a different twist command:
+std::string worldXml(int simulThreads, int nVehicles)
+{
+	return mrpt::format(
+		R"XML(<mvsim_world version="1.0">
+	<simul_timestep>0.005</simul_timestep>
+	<simul_threads>%i</simul_threads>
+
+	<element class="elevation_map">
+		<resolution>1.0</resolution>
+		<corner_min_x>-20</corner_min_x>
+		<corner_min_y>-20</corner_min_y>
+		<elevation_data_matrix>%s</elevation_data_matrix>
+	</element>
+
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<chassis mass="15.0" zmin="0.05" zmax="0.4" />
+			<controller class="twist_pid">
+				<KP>5</KP> <KI>10</KI> <I_MAX>1</I_MAX> <KD>0</KD>
+				<max_torque>100</max_torque>
+			</controller>
+		</dynamics>
+	</vehicle:class>
+
+	<for var="i" from="0" to="%i">
+		<vehicle name="r${i}" class="robot">
+			<init_pose>$f{-15+4*(${i} %% 8)} $f{-15+4*floor(${i}/8)} $f{${i}*37}</init_pose>
+		</vehicle>
+	</for>
+</mvsim_world>
+)XML",
+		simulThreads, elevationMatrix().c_str(), nVehicles - 1);
+}
+
+std::map<std::string, mrpt::math::TPose3D> simulate(
+	int simulThreads, int nVehicles, double duration, double* wallTime = nullptr)
+{
+	World world;
+	world.setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world.headless(true);
+	world.load_from_XML(worldXml(simulThreads, nVehicles));
+	ASSERT_EQUAL_(world.getListOfVehicles().size(), static_cast<size_t>(nVehicles));
+
+	int i = 0;
+	for (auto& [name, veh] : world.getListOfVehicles())
+	{
+		const double v = 0.3 + 0.1 * (i % 5), w = 0.2 * ((i % 7) - 3);
+		ASSERT_(veh->getControllerInterface()->setTwistCommand({v, 0, w}));
+		i++;
+	}
+
+	mrpt::system::CTicTac tic;
+	for (double t = 0; t < duration; t += 0.05) world.run_simulation(0.05);
+	if (wallTime) *wallTime = tic.Tac();
+
+	std::map<std::string, mrpt::math::TPose3D> poses;
+	for (const auto& [name, veh] : world.getListOfVehicles()) poses[name] = veh->getPose();
+	return poses;
+}
+
+// The per-vehicle work of each step must give bit-identical results no matter
+// how many threads run it:
+void test_threads_determinism()
+{
+	const auto ref = simulate(1, 16, 3.0);
+
+	// The vehicles must have actually moved and tilted:
+	bool anyTilted = false;
+	for (const auto& [name, p] : ref)
+		if (std::abs(p.pitch) > 1e-3 || std::abs(p.roll) > 1e-3) anyTilted = true;
+	ASSERT_(anyTilted);
+
+	for (int nThreads : {2, 4, 0 /*one per core*/})
+	{
+		const auto poses = simulate(nThreads, 16, 3.0);
+		ASSERT_EQUAL_(poses.size(), ref.size());
+		for (const auto& [name, p] : ref)
+		{
+			const auto& q = poses.at(name);
+			if (!(p == q))
+				THROW_EXCEPTION_FMT(
+					"Vehicle '%s' with %i threads: %s != %s", name.c_str(), nThreads,
+					q.asString().c_str(), p.asString().c_str());
+		}
+	}
+}
+
+void test_threads_benchmark()
+{
+	const int nVehicles = 64;
+	const unsigned int nCores = std::max(1U, std::thread::hardware_concurrency());
+
+	double t1 = 0, tN = 0;
+	const auto p1 = simulate(1, nVehicles, 2.0, &t1);
+	const auto pN = simulate(0, nVehicles, 2.0, &tN);
+
+	for (const auto& [name, p] : p1) ASSERT_(p == pN.at(name));
+
+	std::cout << nVehicles << " vehicles on an elevation map, 2 s of simulated time:\n"
+			  << " 1 thread:   " << t1 << " s\n " << nCores << " threads:  " << tN << " s\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_threads_determinism, "test_threads_determinism"},
+		{&test_threads_benchmark, "test_threads_benchmark"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mvsim/Block.h>
+#include <mvsim/VehicleBase.h>
+#include <mvsim/VehicleDynamics/VehicleAckermann.h>
+#include <mvsim/World.h>
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const char* WORLD_XML = R"XML(<mvsim_world version="1.0">
+	<simul_timestep>0.01</simul_timestep>
+	<sleeping_enabled>true</sleeping_enabled>
+	<sleep_time>0.5</sleep_time>
+
+	<vehicle:class name="car">
+		<dynamics class="ackermann">
+			<rl_wheel pos="0  1" mass="6.0" width="0.30" diameter="0.62" />
+			<rr_wheel pos="0 -1" mass="6.0" width="0.30" diameter="0.62" />
+			<fl_wheel mass="6.0" width="0.30" diameter="0.62" />
+			<fr_wheel mass="6.0" width="0.30" diameter="0.62" />
+			<f_wheels_x>1.3</f_wheels_x>
+			<f_wheels_d>2.0</f_wheels_d>
+			<max_steer_ang_deg>30.0</max_steer_ang_deg>
+			<chassis mass="800.0" zmin="0.15" zmax="1.00" />
+			<controller class="raw" />
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="car" class="car">
+		<init_pose>0 0 0</init_pose>
+	</vehicle>
+
+	<vehicle:class name="robot">
+		<dynamics class="differential">
+			<l_wheel pos="0.0  0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<r_wheel pos="0.0 -0.3" mass="4.0" width="0.10" diameter="0.30" />
+			<chassis mass="15.0" zmin="0.05" zmax="0.4" />
+			<controller class="twist_pid">
+				<KP>5</KP> <KI>10</KI> <I_MAX>1</I_MAX> <KD>0</KD>
+				<max_torque>100</max_torque>
+			</controller>
+		</dynamics>
+	</vehicle:class>
+	<vehicle name="robot" class="robot">
+		<init_pose>10 0 0</init_pose>
+	</vehicle>
+
+	<block name="box">
+		<shape>
+			<pt>-0.5 -0.5</pt> <pt>-0.5 0.5</pt> <pt>0.5 0.5</pt> <pt>0.5 -0.5</pt>
+		</shape>
+		<mass>30</mass>
+		<zmin>0.0</zmin> <zmax>1.0</zmax>
+		<init_pose>0 10 0</init_pose>
+	</block>
+</mvsim_world>
+)XML";
+
+void run(World& world, double duration)
+{
+	for (double t = 0; t < duration; t += 0.05) world.run_simulation(0.05);
+}
+
+void test_sleeping_wake_up()
+{
+	World world;
+	world.setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world.headless(true);
+	world.load_from_XML(WORLD_XML);
+
+	auto& car = *world.getListOfVehicles().at("car");
+	auto& robot = *world.getListOfVehicles().at("robot");
+	auto& box = *world.getListOfBlocks().at("box");
+
+	// Everything at rest goes to sleep:
+	run(world, 2.0);
+	ASSERT_(car.isSleeping());
+	ASSERT_(robot.isSleeping());
+	ASSERT_(box.isSleeping());
+
+	// A steering-only command gives no torque, but must wake up the car:
+	auto* ack = dynamic_cast<DynamicsAckermann*>(&car);
+	ASSERT_(ack);
+	auto raw = std::dynamic_pointer_cast<DynamicsAckermann::ControllerRawForces>(
+		ack->getController());
+	ASSERT_(raw);
+	raw->setpoint_steer_ang = 0.3;
+	world.run_simulation(0.01);
+	ASSERT_(!car.isSleeping());
+	ASSERT_(std::abs(car.getWheelInfo(DynamicsAckermann::WHEEL_FL).yaw) > 0.1);
+
+	// ...and it sleeps again, with its wheels steered:
+	run(world, 2.0);
+	ASSERT_(car.isSleeping());
+	ASSERT_(std::abs(car.getWheelInfo(DynamicsAckermann::WHEEL_FL).yaw) > 0.1);
+
+	// A new twist setpoint must wake up a vehicle, even if it is too small to
+	// need any torque yet:
+	ASSERT_(robot.getControllerInterface()->setTwistCommand({1e-9, 0, 0}));
+	world.run_simulation(0.01);
+	ASSERT_(!robot.isSleeping());
+
+	// Moving a sleeping block from outside wakes it up:
+	ASSERT_(box.isSleeping());
+	box.setPose({0, 12, 0, 0, 0, 0});
+	world.run_simulation(0.01);
+	ASSERT_(!box.isSleeping());
+	ASSERT_NEAR_(box.getPose().y, 12.0, 1e-3);
+	run(world, 2.0);
+	ASSERT_(box.isSleeping());
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_sleeping_wake_up, "test_sleeping_wake_up"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	return anyFail ? 1 : 0;
+}
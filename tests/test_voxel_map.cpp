@@ -0,0 +1,295 @@
+/*+-------------------------------------------------------------------------+
+  |                       MultiVehicle simulator (libmvsim)                 |
+  |                                                                         |
+  | Copyright (C) 2014-2024  Jose Luis Blanco Claraco                       |
+  | Copyright (C) 2017  Borys Tymchenko (Odessa Polytechnic University)     |
+  | Distributed under 3-clause BSD License                                  |
+  |   See COPYING                                                           |
+  +-------------------------------------------------------------------------+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/filesystem.h>
+#include <mvsim/World.h>
+#include <mvsim/WorldElements/VoxelMap.h>
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test_utils.h"
+
+using namespace mvsim;
+
+namespace
+{
+const std::string testDir = mrpt::system::getTempFileName() + "_mvsim_test_voxels";
+
+// Voxel map files: a header with the magic, version, resolution and number of
+// blocks, then each block: (bx,by,bz) and 8 layers of 64 bits.
+constexpr uint64_t FILE_HEADER_SIZE = 8 + 4 + 4 + 8;
+constexpr uint64_t FILE_BLOCK_SIZE = 3 * 4 + 8 * 8;
+
+bool throws(const std::function<void(void)>& f)
+{
+	try
+	{
+		f();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+// Test scene, with 0.1 m voxels:
+// - A 2x2 m floor: voxels iz=0, so its elevation is 0.1 m.
+// - A bridge over x=[0.5,1.0], at z=2.0 (iz=20), with elevation 2.1 m.
+// - A wall at x=1.5 (ix=15), from z=0.1 to z=1.0 (iz=1...9).
+const std::string& sceneFile()
+{
+	static const std::string file = [] {
+		std::vector<float> pts;
+		const auto add = [&](float x, float y, float z) { pts.insert(pts.end(), {x, y, z}); };
+		for (int i = 0; i < 20; i++)
+		{
+			for (int j = 0; j < 20; j++)
+			{
+				const float x = 0.1f * i + 0.05f, y = 0.1f * j + 0.05f;
+				add(x, y, 0.05f);
+				if (i >= 5 && i < 10) add(x, y, 2.05f);
+				if (i == 15)
+					for (int k = 1; k < 10; k++) add(x, y, 0.1f * k + 0.05f);
+			}
+		}
+		const std::string f = testDir + "/scene.bin";
+		std::ofstream o(f, std::ios::binary);
+		o.write(reinterpret_cast<const char*>(pts.data()), pts.size() * sizeof(float));
+		return f;
+	}();
+	return file;
+}
+
+// Loads a world with one voxel map, from the given XML contents:
+std::shared_ptr<VoxelMap> loadVoxelMap(World& world, const std::string& voxelMapXml)
+{
+	world.setMinLoggingLevel(mrpt::system::LVL_WARN);
+	world.headless(true);
+	world.load_from_XML(
+		"<mvsim_world version=\"1.0\"><element class=\"voxel_map\">" + voxelMapXml +
+		"</element></mvsim_world>");
+
+	for (const auto& e : world.getListOfWorldElements())
+		if (auto vm = std::dynamic_pointer_cast<VoxelMap>(e); vm) return vm;
+	THROW_EXCEPTION("No voxel_map found in the world");
+}
+
+std::shared_ptr<VoxelMap> loadScene(World& world)
+{
+	return loadVoxelMap(
+		world, "<file_bin_xyz>" + sceneFile() + "</file_bin_xyz><resolution>0.1</resolution>");
+}
+
+std::vector<float> elevations(const VoxelMap& vm, float x, float y)
+{
+	std::set<float> zs;
+	vm.getElevationsAt({x, y}, zs);
+	return {zs.begin(), zs.end()};
+}
+
+void assertNear(float a, float b, const std::string& what)
+{
+	if (std::abs(a - b) > 1e-4f) THROW_EXCEPTION_FMT("%s: got %f, expected %f", what.c_str(), a, b);
+}
+
+void test_elevations()
+{
+	World world;
+	const auto vm = loadScene(world);
+	ASSERT_EQUAL_(vm->occupiedCount(), static_cast<size_t>(20 * 20 + 5 * 20 + 9 * 20));
+
+	auto zs = elevations(*vm, 0.25f, 0.25f);
+	ASSERT_EQUAL_(zs.size(), 1U);
+	assertNear(zs[0], 0.1f, "floor");
+
+	// Two floors under the bridge:
+	zs = elevations(*vm, 0.75f, 1.35f);
+	ASSERT_EQUAL_(zs.size(), 2U);
+	assertNear(zs[0], 0.1f, "floor under the bridge");
+	assertNear(zs[1], 2.1f, "bridge");
+	assertNear(*vm->getElevationAt({0.75f, 1.35f}), 2.1f, "highest floor");
+
+	// The top of the wall is a floor too:
+	zs = elevations(*vm, 1.55f, 0.55f);
+	ASSERT_EQUAL_(zs.size(), 1U);
+	assertNear(zs[0], 1.0f, "wall top");
+
+	// Out of the map:
+	ASSERT_(elevations(*vm, -5.0f, 0.5f).empty());
+	ASSERT_(!vm->getElevationAt({5.0f, 5.0f}).has_value());
+}
+
+void test_raycast()
+{
+	World world;
+	const auto vm = loadScene(world);
+
+	// Horizontal, towards the wall (x=1.5):
+	auto r = vm->raycast({0.05f, 0.35f, 0.55f}, {1, 0, 0}, 10.0f);
+	ASSERT_(r.has_value());
+	assertNear(*r, 1.45f, "wall");
+
+	// Out of range:
+	ASSERT_(!vm->raycast({0.05f, 0.35f, 0.55f}, {1, 0, 0}, 1.0f).has_value());
+
+	// Away from the wall, no hit:
+	ASSERT_(!vm->raycast({1.0f, 0.35f, 0.55f}, {-1, 0, 0}, 10.0f).has_value());
+
+	// Vertical, down to the floor (z=0.1) and up to the bridge (z=2.0):
+	r = vm->raycast({0.75f, 0.35f, 0.55f}, {0, 0, -1}, 10.0f);
+	ASSERT_(r.has_value());
+	assertNear(*r, 0.45f, "floor");
+
+	r = vm->raycast({0.75f, 0.35f, 0.55f}, {0, 0, 1}, 10.0f);
+	ASSERT_(r.has_value());
+	assertNear(*r, 1.45f, "bridge");
+
+	// Diagonal, crossing block boundaries, onto the floor at (1.0, 0.35):
+	const float s = std::sqrt(0.5f);
+	r = vm->raycast({0.55f, 0.35f, 0.55f}, {s, 0, -s}, 10.0f);
+	ASSERT_(r.has_value());
+	assertNear(*r, 0.45f / s, "diagonal");
+}
+
+void test_file_roundtrip()
+{
+	World world;
+	const auto vm = loadScene(world);
+
+	const std::string file = testDir + "/scene.voxels";
+	vm->saveToFile(file);
+
+	World world2;
+	const auto vm2 = loadVoxelMap(world2, "<file>" + file + "</file>");
+
+	ASSERT_EQUAL_(vm2->resolution(), vm->resolution());
+	ASSERT_EQUAL_(vm2->occupiedCount(), vm->occupiedCount());
+	for (int32_t ix = -2; ix < 22; ix++)
+		for (int32_t iy = -2; iy < 22; iy++)
+			for (int32_t iz = -2; iz < 22; iz++)
+				ASSERT_EQUAL_(vm2->isOccupied(ix, iy, iz), vm->isOccupied(ix, iy, iz));
+
+	const auto zs = elevations(*vm2, 0.75f, 1.35f);
+	ASSERT_EQUAL_(zs.size(), 2U);
+	assertNear(zs[1], 2.1f, "bridge after reload");
+
+	// Errors:
+	const std::string badFile = testDir + "/bad.voxels";
+	std::ofstream(badFile) << "MVSIMVOY and more bytes";
+	ASSERT_(throws([&]() { vm2->loadFromFile(badFile); }));
+
+	std::ifstream in(file, std::ios::binary);
+	const std::string contents(std::istreambuf_iterator<char>(in), {});
+	const std::string truncFile = testDir + "/truncated.voxels";
+	std::ofstream(truncFile, std::ios::binary) << contents.substr(0, contents.size() - 10);
+	ASSERT_(throws([&]() { vm2->loadFromFile(truncFile); }));
+}
+
+void test_clear_voxels()
+{
+	World world;
+	const auto vm = loadScene(world);
+
+	const std::string fileBefore = testDir + "/before.voxels";
+	vm->saveToFile(fileBefore);
+
+	// Remove the bridge (iz=20), which spans 2x3 blocks of its own:
+	const size_t nBefore = vm->occupiedCount();
+	for (int32_t ix = 5; ix < 10; ix++)
+		for (int32_t iy = 0; iy < 20; iy++) vm->setOccupied(ix, iy, 20, false);
+	ASSERT_EQUAL_(vm->occupiedCount(), nBefore - 5 * 20);
+
+	// Already free voxels:
+	vm->setOccupied(5, 0, 20, false);
+	vm->setOccupied(100, 100, 100, false);
+	ASSERT_EQUAL_(vm->occupiedCount(), nBefore - 5 * 20);
+
+	ASSERT_EQUAL_(elevations(*vm, 0.75f, 1.35f).size(), 1U);
+	ASSERT_(!vm->raycast({0.75f, 0.35f, 0.55f}, {0, 0, 1}, 10.0f).has_value());
+
+	// Empty blocks must be freed:
+	const std::string fileAfter = testDir + "/after.voxels";
+	vm->saveToFile(fileAfter);
+	const uint64_t sizeBefore = mrpt::system::getFileSize(fileBefore);
+	const uint64_t sizeAfter = mrpt::system::getFileSize(fileAfter);
+	ASSERT_EQUAL_(sizeBefore - sizeAfter, 6 * FILE_BLOCK_SIZE);
+
+	// ...and the map must still be consistent:
+	World world2;
+	const auto vm2 = loadVoxelMap(world2, "<file>" + fileAfter + "</file>");
+	ASSERT_EQUAL_(vm2->occupiedCount(), vm->occupiedCount());
+
+	// Free a whole block column, then occupy it again:
+	for (int32_t ix = 0; ix < 8; ix++)
+		for (int32_t iy = 0; iy < 8; iy++) vm->setOccupied(ix, iy, 0, false);
+	ASSERT_(elevations(*vm, 0.25f, 0.25f).empty());
+	vm->setOccupied(2, 2, 3);
+	const auto zs = elevations(*vm, 0.25f, 0.25f);
+	ASSERT_EQUAL_(zs.size(), 1U);
+	assertNear(zs[0], 0.4f, "new voxel");
+
+	const std::string fileEmpty = testDir + "/empty.voxels";
+	vm->clear(0.1f);
+	vm->saveToFile(fileEmpty);
+	ASSERT_EQUAL_(mrpt::system::getFileSize(fileEmpty), FILE_HEADER_SIZE);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+	mrpt::system::createDirectory(testDir);
+
+	std::vector<std::pair<std::function<void(void)>, std::string>> lst = {
+		{&test_elevations, "test_elevations"},
+		{&test_raycast, "test_raycast"},
+		{&test_file_roundtrip, "test_file_roundtrip"},
+		{&test_clear_voxels, "test_clear_voxels"},
+	};
+
+	bool anyFail = false;
+
+	for (const auto& kv : lst)
+	{
+		try
+		{
+			setConsoleBlueColor();
+			printf("[%20s] Running...\n", kv.second.c_str());
+			setConsoleNormalColor();
+
+			kv.first();
+
+			setConsoleBlueColor();
+			printf("[%20s] Success\n", kv.second.c_str());
+			setConsoleNormalColor();
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << e.what();
+			setConsoleErrorColor();
+			printf("[%20s] FAIL\n", kv.second.c_str());
+			setConsoleNormalColor();
+			anyFail = true;
+		}
+	}
+
+	mrpt::system::deleteFilesInDirectory(testDir, true);
+
+	return anyFail ? 1 : 0;
+}